@@ -60,6 +60,10 @@ void sio2host_deinit(void);
 
 /**
  * \brief Transmits data via UART
+ *
+ * The data is copied into the transmit buffer and sent by interrupt, the
+ * function only waits when the buffer is full.
+ *
  * \param data Pointer to the buffer where the data to be transmitted is present
  * \param length Number of bytes to be transmitted
  *
@@ -67,6 +71,11 @@ void sio2host_deinit(void);
  */
 uint8_t sio2host_tx(uint8_t *data, uint8_t length);
 
+/**
+ * \brief Waits until all the data queued by sio2host_tx has been sent
+ */
+void sio2host_tx_flush(void);
+
 /**
  * \brief Receives data from UART
  *
@@ -77,6 +86,71 @@ uint8_t sio2host_tx(uint8_t *data, uint8_t length);
  */
 uint8_t sio2host_rx(uint8_t *data, uint8_t max_length);
 
+/**
+ * \brief Gives direct access to the received data without copying it
+ *
+ * \param data pointer updated to the oldest unread byte of the receive buffer
+ *
+ * \return number of unread bytes stored contiguously from *data
+ */
+uint16_t sio2host_rx_peek(uint8_t **data);
+
+/**
+ * \brief Releases bytes previously obtained through sio2host_rx_peek
+ *
+ * \param length number of bytes consumed by the caller
+ */
+void sio2host_rx_release(uint16_t length);
+
+/**
+ * \brief Tells whether the end of a receive burst was signalled since the
+ * previous call: a line feed was received, the buffer is half full or, with
+ * sio2host_rx_wake_every_byte, any byte was received
+ *
+ * \return true once per burst, false otherwise
+ */
+bool sio2host_rx_burst_ended(void);
+
+/**
+ * \brief Tells whether the end of a receive burst is waiting to be handled,
+ * without consuming it. Used before putting the core to sleep.
+ */
+bool sio2host_rx_burst_pending(void);
+
+/**
+ * \brief Makes every received byte end a burst instead of line feeds only.
+ * Used for binary frames, which carry no line delimiter.
+ *
+ * \param enable true to wake the reader on every byte, false for lines
+ */
+void sio2host_rx_wake_every_byte(bool enable);
+
+/**
+ * \brief Clock read by the receive interrupt, in microseconds
+ */
+typedef uint64_t (*sio2host_clock_t)(void);
+
+/**
+ * \brief Times every received byte and marks the ones that follow a silence
+ * longer than gap_us. sio2host_rx_peek never returns a span across a mark.
+ * Used for binary frames, whose timeout is between bytes, not between reads.
+ *
+ * \param clock clock read on every byte, NULL to stop marking
+ * \param gap_us silence that starts a new burst
+ */
+void sio2host_rx_mark_gaps(sio2host_clock_t clock, uint32_t gap_us);
+
+/**
+ * \brief Tells whether the next byte returned by sio2host_rx_peek follows
+ * a silence marked by sio2host_rx_mark_gaps, and clears the mark
+ */
+bool sio2host_rx_gap(void);
+
+/**
+ * \brief Number of received bytes dropped because the receive buffer was full
+ */
+uint16_t sio2host_rx_overflow_count(void);
+
 /**
  * \brief This function performs a blocking character receive functionality
  * \return returns the data which is received
@@ -54,8 +54,18 @@ typedef struct parserCmdEntry_tag
         uint8_t flags;
 }parserCmdEntry_t;
 
+/* Binary protocol opcode: high byte is the command group, low byte the command */
+typedef struct parserBinOpcode_tag
+{
+	uint16_t opcode;
+	const char* pCommand;
+}parserBinOpcode_t;
+
 extern const parserCmdEntry_t* gpParserStartCmd;
 extern const uint8_t gParserStartCmdSize;
 
+extern const parserBinOpcode_t gaParserBinOpcode[];
+extern const uint16_t gParserBinOpcodeSize;
+
 
 #endif /* _PARSER_COMMANDS_H */
\ No newline at end of file
@@ -73,6 +73,7 @@ enum
 };
 
 #define PARSER_END_LINE_DELIM_STRING "\r\n"
+#define PARSER_END_LINE_DELIM_LEN    (sizeof(PARSER_END_LINE_DELIM_STRING) - 1U)
 
 typedef struct parserCmdInfo_tag
 {
@@ -82,6 +83,8 @@ typedef struct parserCmdInfo_tag
 	char* pParam4;
 	char* pParam5;
     char* pReplyCmd;
+    uint8_t* pBinData;      /* Raw last parameter of a binary frame, NULL in ASCII mode */
+    uint16_t binDataLen;
 }parserCmdInfo_t;
 
 
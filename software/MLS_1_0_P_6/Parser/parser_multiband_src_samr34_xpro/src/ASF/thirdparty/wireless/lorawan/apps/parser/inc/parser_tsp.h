@@ -42,15 +42,80 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "parser_utils.h"
+
 #define BYTE_VALUE_LEN 255
 
+/* Number of complete command lines that can wait for execution */
+#ifndef PARSER_RX_CMD_QUEUE_SIZE
+#define PARSER_RX_CMD_QUEUE_SIZE    4U
+#endif
+
+/* Host protocol, selected with "sys set protocol <ascii|bin>" */
+typedef enum
+{
+    PARSER_PROTOCOL_ASCII = 0x00U,
+    PARSER_PROTOCOL_BIN
+}parserProtocol_t;
+
+/*
+ * Binary frame: SOF | LEN (2 bytes, LE) | BODY (LEN bytes) | CRC (2 bytes, LE)
+ *   CRC is SYSTEM_Crc16 of BODY, started from SYSTEM_CRC16_INIT_FRAME.
+ *
+ * Host to device BODY:
+ *   FLAGS | OPCODE (2 bytes, LE) | NPARAMS | { PLEN | PDATA[PLEN] }[NPARAMS]
+ *   OPCODE is the fixed value of the command in gaParserBinOpcode, e.g. "mac tx" is 0x0107.
+ *   The high byte of OPCODE is the command group.
+ *   PARSER_BIN_FLAG_RAW_LAST_PARAM marks the last parameter as raw data ("mac tx" payload).
+ *
+ * Device to host BODY:
+ *   TYPE | DATA
+ *   PARSER_BIN_FRAME_REPLY carries the same text as the ASCII reply.
+ *   PARSER_BIN_FRAME_RX_DATA carries the port followed by the raw downlink payload.
+ */
+#define PARSER_BIN_FRAME_SOF                0xA5U
+#define PARSER_BIN_FRAME_HDR_LEN            3U
+#define PARSER_BIN_FRAME_CRC_LEN            2U
+#define PARSER_BIN_FRAME_MAX_BODY_LEN       300U
+
+/* A partial frame is dropped when its next byte comes later than this after
+ * the previous one. The bytes are timed on reception, see sio2host_rx_mark_gaps. */
+#ifndef PARSER_BIN_FRAME_TIMEOUT_MS
+#define PARSER_BIN_FRAME_TIMEOUT_MS         500U
+#endif
+
+#define PARSER_BIN_FLAG_RAW_LAST_PARAM      0x01U
+
+#define PARSER_BIN_FRAME_REPLY              0x00U
+#define PARSER_BIN_FRAME_RX_DATA            0x01U
+
+typedef struct parserRxCmd_tag
+{
+    char cmd[PARSER_DEF_CMD_MAX_LEN];
+    uint16_t wordLen[PARSER_DEF_CMD_MAX_IDX];
+    uint16_t wordStartPos[PARSER_DEF_CMD_MAX_IDX];
+    uint8_t crtWordIdx;
+    uint16_t crtCmdPos;
+    uint16_t crtWordPos;
+    uint16_t binDataPos;
+    uint16_t binDataLen;
+}parserRxCmd_t;
+
 void    Parser_RxClearBuffer(void);
+parserRxCmd_t* Parser_RxGetCmd(void);
+void    Parser_RxReleaseCmd(void);
 void    Parser_RxAddChar(uint8_t rxChar);
+uint16_t Parser_RxAddChunk(const uint8_t* pData, uint16_t dataLen);
+void    Parser_RxDropFrame(void);
 bool    Parser_IsProcessingAllowed (void);
 
 uint8_t Parser_TxChar(void);
 uint8_t Parser_HasCharToTransmit(void);
 
 void    Parser_TxAddReply(char* pReplyStr, uint16_t replyStrLen);
+void    Parser_TxAddBinFrame(uint8_t frameType, const uint8_t* pData, uint16_t dataLen);
+
+void    Parser_SetProtocol(parserProtocol_t protocol);
+parserProtocol_t Parser_GetProtocol(void);
 
 #endif /* _PARSER_TSP_H */
\ No newline at end of file
@@ -50,9 +50,13 @@
 #define PARSER_DEF_CMD_REPLY_LEN    550U
 #define PARSER_DEF_DISPATCH_LEN     3U
 
+/* Returned by the hex lookup table for characters that are not hex digits */
+#define PARSER_HEX_INVALID          0xF0U
+
 /*************************** FUNCTIONS PROTOTYPE ******************************/
 bool Validate_HexValue(void* pValue);
 uint8_t Parser_HexAsciiToInt(uint16_t hexAsciiLen, char* pInHexAscii, uint8_t* pOutInt);
+bool Parser_HexAsciiDecode(const char* pInHexAscii, uint16_t hexAsciiLen, uint8_t* pOutInt);
 void Parser_IntArrayToHexAscii(uint8_t arrayLen, uint8_t* pInArray, char* pOutHexAscii);
 bool Validate_Uint16DecAsciiValue(void* pValue, uint16_t* pDecValue);
 bool Validate_Uint8DecAsciiValue(void* pValue, uint8_t* pDecValue);
@@ -45,6 +45,8 @@
 #include "lorawan.h"
 #include "sys.h"
 #include "pds_interface.h"
+#include "lorawan_pds.h"
+#include "system_task_manager.h"
 
 #define JOIN_DENY_STR_IDX				0U
 #define JOIN_ACCEPT_STR_IDX				1U
@@ -107,12 +109,45 @@
 #define TX_TIMEOUT_IDX							23u
 #define INVALID_PACKET_STR_IDX					25u
 
+/* Number of stack notifications that can wait to be sent to the host */
+#ifndef PARSER_LORA_EVT_QUEUE_SIZE
+#define PARSER_LORA_EVT_QUEUE_SIZE          4U
+#endif
+
+/* A downlink is at most 255 bytes: port + FRMPayload */
+#define PARSER_LORA_EVT_MAX_DATA_LEN        BYTE_VALUE_LEN
+
+typedef enum
+{
+    PARSER_LORA_EVT_RX_DATA = 0x00U,
+    PARSER_LORA_EVT_TRANS_CMPL,
+    PARSER_LORA_EVT_JOIN
+}parserLoraEvtType_t;
+
+/* Stack notification, recorded in the callback and formatted by the APP task */
+typedef struct
+{
+    uint8_t evtType;
+    uint8_t dataLen;
+    StackRetStatus_t status;
+    uint8_t aData[PARSER_LORA_EVT_MAX_DATA_LEN];
+}parserLoraEvt_t;
+
 parserConfiguredJoinParameters_t gParserConfiguredJoinParameters;
 
 LorawanSendReq_t parser_data;
 
+static parserLoraEvt_t maParserLoraEvtQueue[PARSER_LORA_EVT_QUEUE_SIZE];
+static uint8_t mLoraEvtQueueHead;
+static uint8_t mLoraEvtQueueCount;
+static uint16_t mLoraEvtOverflowCount;
+
 static void ParserAppData(void *appHandle, appCbParams_t *data);
 static void ParserJoinData(StackRetStatus_t status);
+static void Parser_LoraEvtPost(uint8_t evtType, StackRetStatus_t status, const uint8_t* pData, uint8_t dataLen);
+static void Parser_LoraEvtSendOldest(void);
+static void ParserAppDataReply(const parserLoraEvt_t* pEvt);
+static void ParserJoinDataReply(StackRetStatus_t status);
 
 static const char* gapParseJoinMode[] =
 {
@@ -273,10 +308,13 @@ void Parser_LoraReset (parserCmdInfo_t* pParserCmdInfo)
 			{
 				uint8_t prevBand = 0xFF;
 				int8_t isSwitchReq = false;
-				PDS_RestoreAll();
+				/* Only the band is needed to choose the path. The same band
+				 * is restored in full after the reset */
+				PDS_RESTORE(PDS_MAC_ISM_BAND);
 				LORAWAN_GetAttr(ISMBAND,NULL,&prevBand);
 				if(prevBand != iCount)
 				{
+					PDS_RestoreAll();
 					PDS_DeleteAll();
 					isSwitchReq = true;
 				}
@@ -332,24 +370,39 @@ void Parser_LoraJoin (parserCmdInfo_t* pParserCmdInfo)
 void Parser_LoraSend (parserCmdInfo_t* pParserCmdInfo)
 {    
     uint8_t portValue;
-    uint16_t asciiDataLen = strlen(pParserCmdInfo->pParam3);
-    uint16_t  dataLen = asciiDataLen >> 1;
+    uint16_t asciiDataLen;
+    uint16_t  dataLen;
     StackRetStatus_t status = LORAWAN_INVALID_PARAMETER;
     uint8_t validationVal;
+    bool bValidData;
 
     validationVal = Validate_Str1Str2AsciiValue(pParserCmdInfo->pParam1, gapParserSendMode[UNCNF_STR_IDX], gapParserSendMode[CNF_STR_IDX]);
 
+    if(pParserCmdInfo->pBinData != NULL)
+    {
+        // Binary protocol: the payload is already raw, no hex conversion needed
+        dataLen = pParserCmdInfo->binDataLen;
+        bValidData = true;
+    }
+    else
+    {
+        // Odd number of characters, an extra '0' character is added to the payload
+        asciiDataLen = strlen(pParserCmdInfo->pParam3);
+        dataLen = (asciiDataLen + 1U) >> 1;
+
+        // Validation and conversion are done in a single pass over the payload
+        bValidData = (dataLen <= 255) &&
+                     Parser_HexAsciiDecode(pParserCmdInfo->pParam3, asciiDataLen, (uint8_t *)aParserData);
+    }
+
     // Parameter validation
     // MacSendIfc function expects a buffer length of max. 255 bytes. Check dataLen (uint16_t) to be less than 255 in order to avoid overflow 
     if(Validate_Uint8DecAsciiValue(pParserCmdInfo->pParam2, &portValue) && (dataLen <= 255) &&
-       (validationVal < 2U) && Validate_HexValue(pParserCmdInfo->pParam3))
+       (validationVal < 2U) && bValidData)
     {
-        Parser_HexAsciiToInt(asciiDataLen, pParserCmdInfo->pParam3, (uint8_t *)aParserData);
-
-        if(asciiDataLen % 2 == 1)
+        if(pParserCmdInfo->pBinData != NULL)
         {
-            //Odd number of characters, an extra '0' character was added to the payload
-            dataLen += 1;
+            memcpy(aParserData, pParserCmdInfo->pBinData, dataLen);
         }
          
         parser_data.confirmed = validationVal;
@@ -872,7 +925,16 @@ void Parser_LoraResume (parserCmdInfo_t* pParserCmdInfo)
 
 void Parser_LoraSave (parserCmdInfo_t* pParserCmdInfo)
 {
-    pParserCmdInfo->pReplyCmd = (char*)gapParserLorawanStatus[LORAWAN_SUCCESS];
+    StackRetStatus_t status = LORAWAN_SUCCESS;
+
+    // The parameters are saved as they change, only the open commit window is written here
+#if (ENABLE_PDS == 1)
+    if(PDS_OK != PDS_Flush())
+    {
+        status = LORAWAN_RESOURCE_UNAVAILABLE;
+    }
+#endif
+    pParserCmdInfo->pReplyCmd = (char*)gapParserLorawanStatus[status];
 }
 
 //void MacGetReceiveWindow2ParametersIfc (uint8_t ifc, bool ismBandDual, uint32_t* frequency, uint8_t* dataRate)
@@ -1519,23 +1581,112 @@ void Parser_LoraGetMcastDr(parserCmdInfo_t* pParserCmdInfo)
 	}
 }
 
+/* Called by the stack: the notification is only recorded here, the reply is
+ * formatted and sent later by the APP task (Parser_LoraEvtProcess) so the MAC
+ * does not wait for the UART and aParserData is not touched from the callback */
 static void ParserAppData(void *appHandle, appCbParams_t *data)
+{
+    if (data->evt == LORAWAN_EVT_RX_DATA_AVAILABLE)
+    {
+        Parser_LoraEvtPost(PARSER_LORA_EVT_RX_DATA, data->param.rxData.status,
+                           data->param.rxData.pData, data->param.rxData.dataLength);
+    }
+    else if(data->evt == LORAWAN_EVT_TRANSACTION_COMPLETE)
+    {
+        Parser_LoraEvtPost(PARSER_LORA_EVT_TRANS_CMPL, data->param.transCmpl.status, NULL, 0U);
+    }
+
+	appHandle = NULL;
+}
+
+static void ParserJoinData(StackRetStatus_t status)
+{
+    //This is called every time the join process is finished
+    Parser_LoraEvtPost(PARSER_LORA_EVT_JOIN, status, NULL, 0U);
+}
+
+/* The stack callbacks and the APP task both run from the scheduler, so the
+ * queue needs no locking */
+static void Parser_LoraEvtPost(uint8_t evtType, StackRetStatus_t status, const uint8_t* pData, uint8_t dataLen)
+{
+    parserLoraEvt_t* pEvt;
+
+    if(mLoraEvtQueueCount >= PARSER_LORA_EVT_QUEUE_SIZE)
+    {
+        // Host is too slow: the oldest notification is lost and counted.
+        // Sending it from here would make the MAC wait for the UART.
+        mLoraEvtOverflowCount ++;
+        mLoraEvtQueueHead = (mLoraEvtQueueHead + 1U) % PARSER_LORA_EVT_QUEUE_SIZE;
+        mLoraEvtQueueCount --;
+    }
+
+    pEvt = &maParserLoraEvtQueue[(mLoraEvtQueueHead + mLoraEvtQueueCount) % PARSER_LORA_EVT_QUEUE_SIZE];
+    pEvt->evtType = evtType;
+    pEvt->status = status;
+    pEvt->dataLen = 0U;
+    if(pData != NULL)
+    {
+        // The stack buffer is reused after the callback returns
+        memcpy(pEvt->aData, pData, dataLen);
+        pEvt->dataLen = dataLen;
+    }
+    mLoraEvtQueueCount ++;
+
+    SYSTEM_PostTask(APP_TASK_ID);
+}
+
+void Parser_LoraEvtProcess(void)
+{
+    while(mLoraEvtQueueCount > 0U)
+    {
+        Parser_LoraEvtSendOldest();
+    }
+}
+
+uint16_t Parser_LoraEvtOverflowCount(void)
+{
+    return mLoraEvtOverflowCount;
+}
+
+static void Parser_LoraEvtSendOldest(void)
+{
+    const parserLoraEvt_t* pEvt = &maParserLoraEvtQueue[mLoraEvtQueueHead];
+
+    if(pEvt->evtType == PARSER_LORA_EVT_JOIN)
+    {
+        ParserJoinDataReply(pEvt->status);
+    }
+    else
+    {
+        ParserAppDataReply(pEvt);
+    }
+
+    mLoraEvtQueueHead = (mLoraEvtQueueHead + 1U) % PARSER_LORA_EVT_QUEUE_SIZE;
+    mLoraEvtQueueCount --;
+}
+
+static void ParserAppDataReply(const parserLoraEvt_t* pEvt)
 {
     uint16_t dataLen;
     uint16_t maxDataLenToTx;
 
-    if (data->evt == LORAWAN_EVT_RX_DATA_AVAILABLE)
+    if (pEvt->evtType == PARSER_LORA_EVT_RX_DATA)
     {
-        uint8_t *pData = data->param.rxData.pData;
-        uint8_t dataLength = data->param.rxData.dataLength;
-        StackRetStatus_t status = data->param.rxData.status;
+        const uint8_t *pData = pEvt->aData;
+        uint8_t dataLength = pEvt->dataLen;
+        StackRetStatus_t status = pEvt->status;
 		
 		//Added for future        
         switch(status)
         {
             case LORAWAN_SUCCESS:
                 //Successful transmission
-                if((dataLength > 0U) && (NULL != pData))
+                if((dataLength > 0U) && (Parser_GetProtocol() == PARSER_PROTOCOL_BIN))
+                {
+                    // Data received, forward port and payload as they are
+                    Parser_TxAddBinFrame(PARSER_BIN_FRAME_RX_DATA, pData, dataLength);
+                }
+                else if(dataLength > 0U)
                 {
                     // Data received
                     strcpy(aParserData, gapParserRxStatus[MAC_RX_DATA_STR_IDX]);
@@ -1550,7 +1701,7 @@ static void ParserAppData(void *appHandle, appCbParams_t *data)
 
                     // Skip port number (&pData[1]), process only data
                     maxDataLenToTx = ((dataLength - 1) <= ((uint16_t)((PARSER_MAX_DATA_LEN - dataLen) >> 1))) ? (dataLength - 1) : ((uint16_t)((PARSER_MAX_DATA_LEN - dataLen) >> 1));
-                    Parser_IntArrayToHexAscii(maxDataLenToTx, &pData[1],  &aParserData[dataLen]);
+                    Parser_IntArrayToHexAscii(maxDataLenToTx, (uint8_t *)&pData[1],  &aParserData[dataLen]);
 
                     Parser_TxAddReply(aParserData, strlen(aParserData));
                 }
@@ -1635,9 +1786,9 @@ static void ParserAppData(void *appHandle, appCbParams_t *data)
                 break;
         }
     }
-    else if(data->evt == LORAWAN_EVT_TRANSACTION_COMPLETE)
+    else if(pEvt->evtType == PARSER_LORA_EVT_TRANS_CMPL)
     {
-        switch(data->param.transCmpl.status)
+        switch(pEvt->status)
         {   
 			case LORAWAN_SUCCESS:
 	        {
@@ -1762,15 +1913,12 @@ static void ParserAppData(void *appHandle, appCbParams_t *data)
 							
         }
     }
-	
-	appHandle = NULL;
 }
 
-static void ParserJoinData(StackRetStatus_t status)
+static void ParserJoinDataReply(StackRetStatus_t status)
 {
     uint8_t statusIdx = JOIN_DENY_STR_IDX;
 
-    //This is called every time the join process is finished
     if(LORAWAN_SUCCESS == status)
     {
         //Sucessful join
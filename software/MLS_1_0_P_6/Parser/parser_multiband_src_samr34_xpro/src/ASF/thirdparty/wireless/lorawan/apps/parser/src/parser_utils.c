@@ -55,87 +55,144 @@ static const char* gapParseOnOff[] =
     "on"
 };
 
+/* Nibble value of every ASCII character, PARSER_HEX_INVALID for non hex digits */
+static const uint8_t maHexAsciiToNibble[256] =
+{
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0
+};
+
+static const char maNibbleToHexAscii[16] =
+{
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+};
+
 bool Validate_HexValue(void* pValue)
  {
-    bool flag = true;
-    char* character;
+    const uint8_t* character = pValue;
+    uint8_t invalid = 0U;
 
-    for(character = pValue; *character; character++)
+    while(*character)
     {
-        if(isxdigit(*character) == 0)
-        {
-            flag = false;
-            break;
-        }
+        invalid |= maHexAsciiToNibble[*character ++];
     }
 
-    return flag;
+    return ((invalid & PARSER_HEX_INVALID) == 0U);
 }
 
 uint8_t Parser_HexAsciiToInt(uint16_t hexAsciiLen, char* pInHexAscii, uint8_t* pOutInt)
 {
     uint16_t rxHexAsciiLen = strlen(pInHexAscii);
-    uint16_t iCtr = 0;
-    uint16_t jCtr = rxHexAsciiLen >> 1;
-    uint8_t retValue = 0;
-    char tempBuff[3];
 
-    if(rxHexAsciiLen % 2 == 0)
+    if(hexAsciiLen != rxHexAsciiLen)
     {
-        jCtr --;
+        return 0;
     }
 
-    if(hexAsciiLen == rxHexAsciiLen)
-    {
-        while(rxHexAsciiLen > 0)
-        {
-            if(rxHexAsciiLen >= 2U)
-            {
-                tempBuff[iCtr] = *(((char*)pInHexAscii) + (rxHexAsciiLen - 2));
-                iCtr ++;
-                tempBuff[iCtr] = *(((char*)pInHexAscii) + (rxHexAsciiLen - 1));
+    return Parser_HexAsciiDecode(pInHexAscii, rxHexAsciiLen, pOutInt) ? 1U : 0U;
+}
 
-                rxHexAsciiLen -= 2U;
-            }
-            else
-            {
-                tempBuff[iCtr] = '0';
-                iCtr ++;
-                tempBuff[iCtr] = *(((char*)pInHexAscii) + (rxHexAsciiLen - 1));
+bool Parser_HexAsciiDecode(const char* pInHexAscii, uint16_t hexAsciiLen, uint8_t* pOutInt)
+{
+    const uint8_t* pIn = (const uint8_t*)pInHexAscii;
+    uint8_t invalid = 0U;
+    uint8_t n0, n1, n2, n3, n4, n5, n6, n7;
 
-                rxHexAsciiLen --;
-            }
+    /* An odd number of characters is right aligned: "abc" gives 0x0a 0xbc */
+    if(hexAsciiLen & 1U)
+    {
+        n0 = maHexAsciiToNibble[*pIn ++];
+        invalid |= n0;
+        *pOutInt ++ = n0;
+        hexAsciiLen --;
+    }
 
-            iCtr ++;
-            tempBuff[iCtr] = '\0';
-            *(pOutInt + jCtr) = xtoi(tempBuff); 
-            iCtr = 0;
-            jCtr --;
-        }
+    /* Four output bytes per iteration, validity is checked once per word */
+    while(hexAsciiLen >= 8U)
+    {
+        n0 = maHexAsciiToNibble[pIn[0]];
+        n1 = maHexAsciiToNibble[pIn[1]];
+        n2 = maHexAsciiToNibble[pIn[2]];
+        n3 = maHexAsciiToNibble[pIn[3]];
+        n4 = maHexAsciiToNibble[pIn[4]];
+        n5 = maHexAsciiToNibble[pIn[5]];
+        n6 = maHexAsciiToNibble[pIn[6]];
+        n7 = maHexAsciiToNibble[pIn[7]];
+        invalid |= n0 | n1 | n2 | n3 | n4 | n5 | n6 | n7;
+
+        pOutInt[0] = (uint8_t)((n0 << 4) | n1);
+        pOutInt[1] = (uint8_t)((n2 << 4) | n3);
+        pOutInt[2] = (uint8_t)((n4 << 4) | n5);
+        pOutInt[3] = (uint8_t)((n6 << 4) | n7);
+
+        pIn += 8;
+        pOutInt += 4;
+        hexAsciiLen -= 8U;
+    }
 
-        retValue = 1;
+    while(hexAsciiLen > 0U)
+    {
+        n0 = maHexAsciiToNibble[pIn[0]];
+        n1 = maHexAsciiToNibble[pIn[1]];
+        invalid |= n0 | n1;
+        *pOutInt ++ = (uint8_t)((n0 << 4) | n1);
+
+        pIn += 2;
+        hexAsciiLen -= 2U;
     }
 
-    return retValue;
+    return ((invalid & PARSER_HEX_INVALID) == 0U);
 }
 
 void Parser_IntArrayToHexAscii(uint8_t arrayLen, uint8_t* pInArray, char* pOutHexAscii)
 {
-    uint8_t iCtr = 0U;
+    uint8_t b0, b1, b2, b3;
 
-    for(iCtr = 0; iCtr < arrayLen; iCtr ++)
+    /* Four input bytes per iteration */
+    while(arrayLen >= 4U)
     {
-        itoa(pInArray[iCtr], (char *)&pOutHexAscii[iCtr << 1], 16);
+        b0 = pInArray[0];
+        b1 = pInArray[1];
+        b2 = pInArray[2];
+        b3 = pInArray[3];
+
+        pOutHexAscii[0] = maNibbleToHexAscii[b0 >> 4];
+        pOutHexAscii[1] = maNibbleToHexAscii[b0 & 0x0FU];
+        pOutHexAscii[2] = maNibbleToHexAscii[b1 >> 4];
+        pOutHexAscii[3] = maNibbleToHexAscii[b1 & 0x0FU];
+        pOutHexAscii[4] = maNibbleToHexAscii[b2 >> 4];
+        pOutHexAscii[5] = maNibbleToHexAscii[b2 & 0x0FU];
+        pOutHexAscii[6] = maNibbleToHexAscii[b3 >> 4];
+        pOutHexAscii[7] = maNibbleToHexAscii[b3 & 0x0FU];
+
+        pInArray += 4;
+        pOutHexAscii += 8;
+        arrayLen -= 4U;
+    }
 
-        if(pInArray[iCtr] <= 15)
-        {
-            /* Special treatment for figures [0..9]  */
-            pOutHexAscii[(iCtr << 1) + 1] = pOutHexAscii[iCtr << 1];
-            pOutHexAscii[iCtr << 1] = '0';
-        }
+    while(arrayLen > 0U)
+    {
+        b0 = *pInArray ++;
+        *pOutHexAscii ++ = maNibbleToHexAscii[b0 >> 4];
+        *pOutHexAscii ++ = maNibbleToHexAscii[b0 & 0x0FU];
+        arrayLen --;
     }
 
-    pOutHexAscii[(iCtr << 1)] = '\0';
+    *pOutHexAscii = '\0';
 }
 
 bool Validate_Uint8DecAsciiValue(void* pValue, uint8_t* pDecValue)
@@ -380,4 +437,4 @@ int xtoi(char *c)
   }
 
   return result;
-}
\ No newline at end of file
+}
@@ -56,9 +56,33 @@ extern "C" {
 #define REG_FIFO_ADDRESS	  0
 #define REG_WRITE_CMD        0x80
 
+/* Number of radio register addresses shadowed by the hal */
+#define RADIO_REG_COUNT      0x80
+
+/* SPI transaction accounting, set to 0 to compile it out */
+#ifndef RADIO_SPI_STATS
+#define RADIO_SPI_STATS      1
+#endif
+
+/* Set to 1 to read the radio on every shadowed register read and count the
+ * values that differ from the shadow */
+#ifndef RADIO_REG_SHADOW_CHECK
+#define RADIO_REG_SHADOW_CHECK 0
+#endif
+
+/* Set to 0 to shift the asynchronous frame writes by polling instead of
+ * with the DMAC */
+#ifndef RADIO_SPI_DMA
+#define RADIO_SPI_DMA        1
+#endif
+
 /***************************************** TYPES ******************************/
 typedef void (*DioInterruptHandler_t)(void);
 
+/* Called when an asynchronous frame transfer is over, from the DMAC interrupt
+ * or from the next radio SPI access if that comes first */
+typedef void (*RadioSpiDoneCallback_t)(void);
+
 typedef enum _RFCtrl1
 {
 	RFO_LF = 0,
@@ -72,6 +96,17 @@ typedef enum _RFCtrl2
 	TX = 1
 }RFCtrl2_t;
 
+#if (RADIO_SPI_STATS == 1)
+/* SPI transaction accounting since reset */
+typedef struct _RadioSpiStats
+{
+	uint32_t transactions;      // Chip select assertions
+	uint32_t saved;             // Transactions avoided by the register shadow
+	uint16_t lastCycleSaved;    // Saved during the last TX or RX cycle
+	uint16_t mismatches;        // Shadow values found wrong, RADIO_REG_SHADOW_CHECK only
+}RadioSpiStats_t;
+#endif
+
 /*********************************************************************//**
 \brief	Possible Radio Clock sources supported.
 *************************************************************************/
@@ -110,12 +145,59 @@ void RADIO_Reset(void);
 void RADIO_RegisterWrite(uint8_t reg, uint8_t value);
 
 /** 
- * \brief This function is used to read a byte of data from the radio register
+ * \brief This function is used to read a byte of data from the radio register.
+ * Configuration registers are served from the shadow once known, status
+ * registers are always read from the radio
  * \param[in] reg Radio register to be read
  * \retval  Value read from the radio register
  */
 uint8_t RADIO_RegisterRead(uint8_t reg);
 
+/** 
+ * \brief This function is used to write consecutive registers in a single burst, without
+ * going through the queue of RADIO_RegisterStage, so that it can be called from an interrupt
+ * \param[in] reg First radio register to be written
+ * \param[in] values Values to be written into the radio registers
+ * \param[in] count Number of registers to be written
+ */
+void RADIO_RegisterBurstWrite(uint8_t reg, const uint8_t *values, uint8_t count);
+
+/** 
+ * \brief This function is used to queue a register write for RADIO_RegisterSequenceWrite,
+ * a later value for the same register replaces the queued one. The queue is not shared
+ * with the interrupts, which write with RADIO_RegisterBurstWrite
+ * \param[in] reg Radio register to be written
+ * \param[in] value Value to be written into the radio register
+ */
+void RADIO_RegisterStage(uint8_t reg, uint8_t value);
+
+/** 
+ * \brief This function is used to write the queued registers in address order. Registers
+ * already holding the queued value are skipped and consecutive addresses are written
+ * in a single burst
+ */
+void RADIO_RegisterSequenceWrite(void);
+
+/** 
+ * \brief This function is used to forget the register values last written, so that the
+ * next sequence writes every register
+ */
+void RADIO_RegisterCacheInvalidate(void);
+
+#if (RADIO_SPI_STATS == 1)
+/** 
+ * \brief This function is used to get the SPI transaction accounting
+ * \param[out] stats SPI transaction accounting since reset
+ */
+void RADIO_GetSpiStats(RadioSpiStats_t *stats);
+
+/** 
+ * \brief This function is called at the start of each TX or RX cycle to
+ * close the count of the transactions saved in the previous one
+ */
+void RADIO_SpiStatsNewCycle(void);
+#endif
+
 /** 
  * \brief This function is used to  write a stream of data into the Radio Frame buffer
  * \param[in] FIFO offset to be written to
@@ -124,6 +206,17 @@ uint8_t RADIO_RegisterRead(uint8_t reg);
  */
 void RADIO_FrameWrite(uint8_t offset, uint8_t* buffer, uint8_t bufferLen);
 
+/** 
+ * \brief This function is used to start writing a stream of data into the Radio Frame
+ * buffer and return before it is shifted out. The buffer must be left untouched until
+ * the callback, any other radio SPI access waits for the end of the transfer
+ * \param[in] FIFO offset to be written to
+ * \param[in] buffer Pointer to the data to be written into the frame buffer
+ * \param[in] bufferLen Length of the data to be written
+ * \param[in] callback Function called once the data is in the frame buffer
+ */
+void RADIO_FrameWriteAsync(uint8_t offset, uint8_t* buffer, uint8_t bufferLen, RadioSpiDoneCallback_t callback);
+
 /** 
  * \brief This function is used to  read a stream of data from the Radio Frame buffer
  * \param[in] FIFO offset to be read from
@@ -57,6 +57,13 @@ void HAL_Sleep(HAL_SleepMode_t mode)
 {
 	switch (mode)
 	{
+		case SLEEP_MODE_IDLE:
+		{
+			/* CPU stops, clocks and peripherals keep running */
+			system_set_sleepmode(SYSTEM_SLEEPMODE_IDLE);
+			system_sleep();
+			break;
+		}
 		case SLEEP_MODE_STANDBY:
 		{
 			system_set_sleepmode(SYSTEM_SLEEPMODE_STANDBY);
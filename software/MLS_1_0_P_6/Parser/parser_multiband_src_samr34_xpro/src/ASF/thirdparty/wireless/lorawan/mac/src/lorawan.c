@@ -94,6 +94,14 @@ static const uint8_t FskSyncWordBuff[3] = {0xC1, 0x94, 0xC1};
 /* LoRaWAN Spec 1.0.2 section 5.8 for TxParamSetupReq MAC command defines EIRP values. These values are stored in below array */	
 static const uint8_t maxEIRPTable[] = {8,10,12,13,14,16,18,20,21,24,26,27,29,30,33,36};
 
+#if (SWTIMER_STATS == 1)
+/* End of the last transmission and the delays the receive windows were
+   programmed with, to account their opening error */
+static uint64_t rxWindowTxDoneTime;
+static uint32_t rxWindowOpenDelay[2];
+static LorawanRxWindowStats_t rxWindowStats[2];
+#endif
+
 
 /************************ PRIVATE FUNCTION PROTOTYPES *************************/
 
@@ -133,12 +141,20 @@ static uint8_t CountfOptsLength (uint8_t *flag);
 
 static uint8_t LorawanGetMaxPayloadSize (uint8_t dataRate);
 
+#if (SWTIMER_STATS == 1)
+static void SetRxWindowReference (uint64_t txDoneTime, uint32_t delay1, uint32_t delay2);
+
+static void RecordRxWindowOpen (uint8_t window);
+#endif
+
 static void FindSmallestDataRate (void);
 
 static void TransmissionErrorCallback (void);
 
 static void StopReceiveWindow2Timer(void);
 
+static void StartReceiveWindowTimer(uint8_t timerId, uint64_t txDoneTime, uint32_t delay, void *callback);
+
 static void handleTransmissionTimeoutCallback(void);
 
 static uint32_t calcPacketTimeOnAir(uint8_t datarate, uint8_t preambleLen,
@@ -201,7 +217,7 @@ void LORAWAN_Init(AppDataCb_t appdata, JoinResponseCb_t joindata) // this functi
 		RADIO_Init();
 		status = RADIO_SetAttr(RADIO_CALLBACK, (void *)&radioCallback);
 
-		srand (RADIO_ReadRandom ());  // for the loRa random function we need a seed that is obtained from the radio
+		srand (RADIO_GetRandom ());  // seeds the radio random generator on the first call, rand() is kept for the application
 
 	}
 	
@@ -224,6 +240,12 @@ void LORAWAN_Init(AppDataCb_t appdata, JoinResponseCb_t joindata) // this functi
 		mac_filemarks.itemListAddr = pds_mac_fid2_item_list;
 		mac_filemarks.fIDcb = Lorawan_Pds_fid2_CB;
 		PDS_RegFile(PDS_FILE_MAC_02_IDX,mac_filemarks);	
+		/* The frame counters are appended to the PDS journal instead of
+		 * rewriting their file row at every uplink or downlink. Keep this
+		 * order, it gives the journal ids of the counters */
+		PDS_REG_JOURNAL_ITEM(PDS_MAC_FCNT_UP);
+		PDS_REG_JOURNAL_ITEM(PDS_MAC_FCNT_DOWN);
+		PDS_REG_JOURNAL_ITEM(PDS_MAC_MCAST_FCNT_DWN);
 	}
 
     {
@@ -666,7 +688,7 @@ void LorawanLinkCheckConfigure (uint16_t period)
         // if network is joined, the timer can start, otherwise after the network is joined the link check timer will start counting automatially
         if (loRa.macStatus.networkJoined == ENABLED)
         {
-            SwTimerStart(loRa.linkCheckTimerId, MS_TO_US(loRa.periodForLinkCheck), SW_TIMEOUT_RELATIVE, (void *)LorawanLinkCheckCallback, NULL);
+            SwTimerStartWithSlack(loRa.linkCheckTimerId, MS_TO_US(loRa.periodForLinkCheck), SW_TIMEOUT_RELATIVE, LINK_CHECK_TIMER_SLACK, (void *)LorawanLinkCheckCallback, NULL);
         }
     }
 
@@ -703,8 +725,46 @@ void LORAWAN_ForceEnable (void)
     loRa.macStatus.silentImmediately = DISABLED;
 }
 
+#if (SWTIMER_STATS == 1)
+static void SetRxWindowReference (uint64_t txDoneTime, uint32_t delay1, uint32_t delay2)
+{
+    rxWindowTxDoneTime = txDoneTime;
+    rxWindowOpenDelay[0] = delay1;
+    rxWindowOpenDelay[1] = delay2;
+}
+
+static void RecordRxWindowOpen (uint8_t window)
+{
+    LorawanRxWindowStats_t *stats = &rxWindowStats[window];
+    int32_t error = (int32_t)((SwTimerGetTime() - rxWindowTxDoneTime) - rxWindowOpenDelay[window]);
+
+    stats->openCount++;
+    stats->lastError = error;
+    stats->totalError += error;
+    if ((1 == stats->openCount) || (error > stats->maxError))
+    {
+        stats->maxError = error;
+    }
+}
+#endif
+
+void LORAWAN_GetRxWindowStats(uint8_t window, LorawanRxWindowStats_t *stats)
+{
+#if (SWTIMER_STATS == 1)
+    if (window < 2)
+    {
+        *stats = rxWindowStats[window];
+        return;
+    }
+#endif
+    memset(stats, 0, sizeof(LorawanRxWindowStats_t));
+}
+
 void LorawanReceiveWindow1Callback (void)
 {	
+#if (SWTIMER_STATS == 1)
+    RecordRxWindowOpen(0);
+#endif
 
     if(loRa.macStatus.macPause == DISABLED)
     {
@@ -735,6 +795,9 @@ void LorawanReceiveWindow1Callback (void)
 
 void LorawanReceiveWindow2Callback(void)
 {
+#if (SWTIMER_STATS == 1)
+    RecordRxWindowOpen(1);
+#endif
 
     // Make sure the radio is not currently receiving (because a long packet is being received on RX window 1
     if (loRa.macStatus.macPause == DISABLED)
@@ -807,7 +870,7 @@ void LorawanLinkCheckCallback (void)
     //Set link check timeout to the configured interval
     if (loRa.macStatus.linkCheck == ENABLED)
     {
-        SwTimerStart(loRa.linkCheckTimerId, MS_TO_US(loRa.periodForLinkCheck), SW_TIMEOUT_RELATIVE, (void *)LorawanLinkCheckCallback, NULL);
+        SwTimerStartWithSlack(loRa.linkCheckTimerId, MS_TO_US(loRa.periodForLinkCheck), SW_TIMEOUT_RELATIVE, LINK_CHECK_TIMER_SLACK, (void *)LorawanLinkCheckCallback, NULL);
     }
 }
 
@@ -1083,7 +1146,7 @@ void UpdateJoinSuccessState(void)
 	// if the link check mechanism was enabled, then its timer will begin counting
     if (loRa.macStatus.linkCheck == ENABLED)
     {
-        SwTimerStart(loRa.linkCheckTimerId, MS_TO_US(loRa.periodForLinkCheck), SW_TIMEOUT_RELATIVE, (void *)LorawanLinkCheckCallback, NULL);
+        SwTimerStartWithSlack(loRa.linkCheckTimerId, MS_TO_US(loRa.periodForLinkCheck), SW_TIMEOUT_RELATIVE, LINK_CHECK_TIMER_SLACK, (void *)LorawanLinkCheckCallback, NULL);
     }
     if (AppPayload.JoinResponse != NULL)
     {
@@ -1182,10 +1245,10 @@ void SetJoinFailState(StackRetStatus_t status)
 	PDS_STORE(PDS_MAC_LORAWAN_STATUS);
 }
 
-//Generates a 16-bit random number based on some measurements made by the radio (seed is initialized inside mac Reset)
+//Generates a 16-bit random number from the radio random generator, reseeded with RSSI measurements
 uint16_t Random (uint16_t max)
 {
-    return (rand () % max);
+    return (RADIO_GetRandom () % max);
 }
 
 /*********************************************************************//**
@@ -4460,6 +4523,8 @@ void LORAWAN_TxDone(void *param)
 				int8_t rxWindowOffset1,rxWindowOffset2;
 				LorawanSendReq_t *LoRaCurrentSendReq = (LorawanSendReq_t *)loRa.appHandle;
 
+				bool storeFCntUp = false;
+
 				loRa.lbt.elapsedChannels = 0;
 				PDS_STORE(PDS_MAC_LBT_PARAMS);
 				if ((0 == loRa.counterRepetitionsUnconfirmedUplink) && (0 == loRa.counterRepetitionsConfirmedUplink))
@@ -4468,10 +4533,8 @@ void LORAWAN_TxDone(void *param)
 					{
 						loRa.fCntUp.value ++;  // the uplink frame counter increments for every new transmission (it does not increment for a retransmission)
 						/* If maxFcntPdsUpdateValue is '0', means every-time the Frame counter will be updated in PDS */
-						if((0 == loRa.maxFcntPdsUpdateValue) || (0 == (loRa.fCntUp.value & ((1 << loRa.maxFcntPdsUpdateValue) - 1))))
-						{
-							PDS_STORE(PDS_MAC_FCNT_UP);
-						}
+						/* Stored once the receive window timers run, the journal append writes the NVM */
+						storeFCntUp = (0 == loRa.maxFcntPdsUpdateValue) || (0 == (loRa.fCntUp.value & ((1 << loRa.maxFcntPdsUpdateValue) - 1)));
 						if (LORAWAN_CNF == LoRaCurrentSendReq->confirmed)
 						{
 							loRa.lorawanMacStatus.ackRequiredFromNextDownlinkMessage = ENABLED;
@@ -4529,8 +4592,12 @@ void LORAWAN_TxDone(void *param)
 				{
 					uint32_t timeout1 = (uint32_t) (loRa.protocolParameters.joinAcceptDelay1 + rxWindowOffset1);
 					uint32_t timeout2 = (uint32_t) (loRa.protocolParameters.joinAcceptDelay2 + rxWindowOffset2);
-					SwTimerStart(loRa.joinAccept1TimerId, MS_TO_US(timeout1 - loRa.radioClkStableDelay), SW_TIMEOUT_RELATIVE, (void *)LorawanReceiveWindow1Callback, NULL);
-					SwTimerStart(loRa.joinAccept2TimerId, MS_TO_US(timeout2 - loRa.radioClkStableDelay), SW_TIMEOUT_RELATIVE, (void *)LorawanReceiveWindow2Callback, NULL);
+#if (SWTIMER_STATS == 1)
+					SetRxWindowReference(localParam.TX.txDoneTime, MS_TO_US(timeout1 - loRa.radioClkStableDelay), MS_TO_US(timeout2 - loRa.radioClkStableDelay));
+#endif
+					StartReceiveWindowTimer(loRa.joinAccept1TimerId, localParam.TX.txDoneTime, MS_TO_US(timeout1 - loRa.radioClkStableDelay), (void *)LorawanReceiveWindow1Callback);
+					StartReceiveWindowTimer(loRa.joinAccept2TimerId, localParam.TX.txDoneTime, MS_TO_US(timeout2 - loRa.radioClkStableDelay), (void *)LorawanReceiveWindow2Callback);
+					PDS_HoldFor(MS_TO_US(timeout2));
 					if(loRa.featuresSupported & JOIN_BACKOFF_SUPPORT)
 					{
 					loRa.joinreqinfo.joinReqTimeOnAir= localParam.TX.timeOnAir;		
@@ -4553,8 +4620,13 @@ void LORAWAN_TxDone(void *param)
 				{	
 					uint32_t timeout1 = (uint32_t) (loRa.protocolParameters.receiveDelay1 + rxWindowOffset1);
 					uint32_t timeout2 = (uint32_t) (loRa.protocolParameters.receiveDelay2 + rxWindowOffset2);
-					SwTimerStart(loRa.receiveWindow1TimerId, MS_TO_US(timeout1 - loRa.radioClkStableDelay), SW_TIMEOUT_RELATIVE, (void *)LorawanReceiveWindow1Callback, NULL);
-					SwTimerStart(loRa.receiveWindow2TimerId, MS_TO_US(timeout2 - loRa.radioClkStableDelay), SW_TIMEOUT_RELATIVE, (void *)LorawanReceiveWindow2Callback, NULL);
+#if (SWTIMER_STATS == 1)
+					SetRxWindowReference(localParam.TX.txDoneTime, MS_TO_US(timeout1 - loRa.radioClkStableDelay), MS_TO_US(timeout2 - loRa.radioClkStableDelay));
+#endif
+					StartReceiveWindowTimer(loRa.receiveWindow1TimerId, localParam.TX.txDoneTime, MS_TO_US(timeout1 - loRa.radioClkStableDelay), (void *)LorawanReceiveWindow1Callback);
+					StartReceiveWindowTimer(loRa.receiveWindow2TimerId, localParam.TX.txDoneTime, MS_TO_US(timeout2 - loRa.radioClkStableDelay), (void *)LorawanReceiveWindow2Callback);
+					PDS_HoldFor(MS_TO_US(timeout2));
+					PDS_UplinkDone();
 					if (CLASS_C == loRa.edClass)
 					{
 						loRa.enableRxcWindow = true;
@@ -4562,6 +4634,11 @@ void LORAWAN_TxDone(void *param)
 					}
 				}
 
+				if (storeFCntUp)
+				{
+					PDS_STORE(PDS_MAC_FCNT_UP);
+				}
+
 				if((loRa.featuresSupported & DUTY_CYCLE_SUPPORT) || (loRa.aggregatedDutyCycle != 0))
 				{
 					UpdateDutyCycleTimer_t  update_dutyCycle_timer;
@@ -5184,6 +5261,29 @@ static void StopReceiveWindow2Timer(void)
 	
 }
 
+/**
+ * @Summary
+    This function starts a receive window timer at the given delay from
+	the end of the transmission, so that the processing done since then
+	does not delay the window
+*/
+
+static void StartReceiveWindowTimer(uint8_t timerId, uint64_t txDoneTime, uint32_t delay, void *callback)
+{
+	uint64_t now = SwTimerGetTime();
+	uint64_t expiryTime = txDoneTime + delay;
+
+	if (expiryTime >= (now + SWTIMER_MIN_TIMEOUT))
+	{
+		SwTimerStart(timerId, (uint32_t)expiryTime, SW_TIMEOUT_ABSOLUTE, callback, NULL);
+	}
+	else
+	{
+		/* Already due, the window opens as soon as possible */
+		SwTimerStart(timerId, SWTIMER_MIN_TIMEOUT, SW_TIMEOUT_RELATIVE, callback, NULL);
+	}
+}
+
 static void handleTransmissionTimeoutCallback(void)
 {
 	loRa.macStatus.macState = IDLE;
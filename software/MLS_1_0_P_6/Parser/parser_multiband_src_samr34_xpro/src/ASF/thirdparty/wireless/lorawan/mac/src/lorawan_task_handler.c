@@ -103,20 +103,18 @@ void LORAWAN_PostTask(const lorawanTaskID_t taskID)
  ******************************************************************************/
 SYSTEM_TaskStatus_t LORAWAN_TaskHandler(void)
 {
+	uint8_t task_id;
+
 	while (lorawanTaskBitMap)
 	{
-		for (uint8_t task_id = 0; task_id < LORAWAN_TASKS_SIZE; task_id++ )
-		{
-			if(lorawanTaskBitMap & ( 1 << task_id))
-			{
-				ATOMIC_SECTION_ENTER
-				lorawanTaskBitMap &= ~( 1U << task_id);
-				ATOMIC_SECTION_EXIT
+		/* Highest priority pending task */
+		task_id = SYSTEM_GetFirstTaskId(lorawanTaskBitMap);
 
-				lorawanHandlers[task_id]();
-                break;
-			}
-		}
+		ATOMIC_SECTION_ENTER
+		lorawanTaskBitMap &= ~( 1U << task_id);
+		ATOMIC_SECTION_EXIT
+
+		lorawanHandlers[task_id]();
 	}
 
     return SYSTEM_TASK_SUCCESS;
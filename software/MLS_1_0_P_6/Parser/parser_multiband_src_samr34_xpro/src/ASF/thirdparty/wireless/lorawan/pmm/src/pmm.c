@@ -46,7 +46,6 @@
 #include "conf_pmm.h"
 
 /* Timer headers */
-#include "hw_timer.h"
 #include "sw_timer.h"
 #include "sleep_timer.h"
 
@@ -69,14 +69,58 @@
 				PDS_Restore(file, itemNum); \
 				} while(0)
 
+#define PDS_REG_JOURNAL_ITEM(item)		do {	\
+				PdsFileItemIdx_t file = item >> 8; \
+				uint8_t itemNum =  (uint8_t)item & 0xFF; \
+				PDS_RegJournalItem(file, itemNum); \
+				} while(0)
+
 #define PDS_FILE_START_OFFSET     	0x00
 
-#define PDS_NVM_VERSION				0x01	
+/* The NVM header version names the CRC of the row, a row written with
+ * either version is read back by both builds */
+#define PDS_NVM_VERSION_CRC16		0x01
+#define PDS_NVM_VERSION_CRC32		0x02
+
+/* Set to 1 to compute the row CRC with the DSU CRC32 engine */
+#ifndef PDS_HW_CRC
+#define PDS_HW_CRC					0
+#endif
+
+#if (PDS_HW_CRC == 1)
+#define PDS_NVM_VERSION				PDS_NVM_VERSION_CRC32
+#else
+#define PDS_NVM_VERSION				PDS_NVM_VERSION_CRC16
+#endif
 #define PDS_WL_VERSION				0x01
 #define PDS_FILES_VERSION			0x01
 
 #define PDS_MAGIC					0xa5
 
+/* Time a file stays dirty after its first store or delete mark, so that
+ * the marks of one MAC processing burst go to flash in one row write.
+ * 0 writes the dirty files on the next PDS task pass */
+#ifndef PDS_COMMIT_WINDOW_MS
+#define PDS_COMMIT_WINDOW_MS		50
+#endif
+
+/* Time the PDS task keeps off the flash after the last receive window of
+ * an uplink has opened, see PDS_HoldFor */
+#ifndef PDS_RX_HOLD_GUARD_MS
+#define PDS_RX_HOLD_GUARD_MS		50
+#endif
+
+/* Times a file whose row write failed is written again before its marks
+ * are left for its next store or delete */
+#ifndef PDS_WRITE_RETRIES
+#define PDS_WRITE_RETRIES			3
+#endif
+
+/* Set to 0 to compile out the row write accounting */
+#ifndef PDS_STATS
+#define PDS_STATS					1
+#endif
+
 /******************************************************************************
                                Types section
 *******************************************************************************/
@@ -89,7 +133,8 @@ typedef enum _PdsStatus
 	PDS_NOT_FOUND, // If file or item cannot be found
 	PDS_NOT_ENOUGH_MEMORY, // If Not enough space is alloted for wear leveling, there must be at least one other row available for each row used 
 	PDS_INVLIAD_FILE_IDX,
-	PDS_ITEM_DELETED
+	PDS_ITEM_DELETED,
+	PDS_BUSY // The NVM controller has not finished the previous command
 } PdsStatus_t;
 
 /* PDS Item Operations */
@@ -148,6 +193,22 @@ typedef struct _PdsFileMarks
 	void         (*fIDcb)(void);
 } PdsFileMarks_t;
 
+/* PDS row write statistics */
+typedef struct _PdsWriteStats
+{
+	uint32_t marks;				// Store and delete marks set on items
+	uint32_t commits;			// Commits that left no file dirty
+	uint32_t rowsWritten;		// Rows written to NVM
+	uint32_t journalWrites;		// Items appended to the counter journal
+	uint32_t uplinks;			// Uplinks reported with PDS_UplinkDone
+	uint16_t rowsSinceUplink;	// Rows written since the last uplink
+	uint16_t lastUplinkRows;	// Rows written between the last two uplinks
+	uint16_t maxUplinkRows;		// Most rows written between two uplinks
+	uint32_t initTimeUs;		// Duration of the last PDS_Init
+	uint32_t restoreTimeUs;		// Duration of the last PDS_RestoreAll
+	uint32_t writeFailures;		// Row writes that failed, retries included
+} PdsWriteStats_t;
+
 #define PDS_SIZE_OF_ITEM_HDR         sizeof(ItemHeader_t)
 
 /******************************************************************************
@@ -238,6 +299,18 @@ PdsStatus_t PDS_StoreAll(void);
 ******************************************************************************/
 PdsStatus_t PDS_RegFile(PdsFileItemIdx_t argFileId, PdsFileMarks_t argFileMarks);
 
+/**************************************************************************//**
+\brief	This function keeps an item of a registered file in the counter journal.
+		Each store of the item then appends its value to the journal instead
+		of rewriting the file row. The items must be registered in the same
+		order at every start, as the order gives their journal ids.
+
+\param[in] pdsFileItemIdx - The file id of the item.
+\param[in] item - The item id of the item in PDS, of at most 4 bytes.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t PDS_RegJournalItem(PdsFileItemIdx_t pdsFileItemIdx, uint8_t item);
+
 /**************************************************************************//**
 \brief This function un-registers a file to the PDS.
 
@@ -246,6 +319,38 @@ PdsStatus_t PDS_RegFile(PdsFileItemIdx_t argFileId, PdsFileMarks_t argFileMarks)
 ******************************************************************************/
 PdsStatus_t PDS_UnRegFile(PdsFileItemIdx_t argFileId);
 
+/**************************************************************************//**
+\brief	Closes the row write count of the current uplink. Called by the MAC
+		when an uplink has been transmitted.
+******************************************************************************/
+void PDS_UplinkDone(void);
+
+/**************************************************************************//**
+\brief	Keeps the PDS task off the flash until the receive windows of an
+		uplink have opened. Called by the MAC when an uplink has been
+		transmitted. The pending row writes resume after the hold.
+
+\param[in] timeUs - Time from now to the opening of the last receive window.
+******************************************************************************/
+void PDS_HoldFor(uint32_t timeUs);
+
+/**************************************************************************//**
+\brief	Writes all the pending store and delete marks to NVM before returning,
+		instead of at the end of the commit window, after the queued journal
+		entries. To be called before a reset. The receive window hold is not
+		observed.
+
+\param[out] status - PDS_OK, or the error of the first row write that failed.
+******************************************************************************/
+PdsStatus_t PDS_Flush(void);
+
+/**************************************************************************//**
+\brief Reads the row write statistics.
+
+\param[out] stats - The statistics, all zero when PDS_STATS is 0.
+******************************************************************************/
+void PDS_GetWriteStats(PdsWriteStats_t *stats);
+
 #endif  /*_PDS_INTERFACE_H */
 
 /* eof pds_interface.h */
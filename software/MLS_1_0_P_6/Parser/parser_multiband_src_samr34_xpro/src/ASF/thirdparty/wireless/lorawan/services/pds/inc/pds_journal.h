@@ -0,0 +1,186 @@
+/**
+* \file  pds_journal.h
+*
+* \brief     This is the Pds counter journal header file which contains Pds counter
+*	journal headers.
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+
+#ifndef _PDS_JOURNAL_H_
+#define _PDS_JOURNAL_H_
+
+/******************************************************************************
+                   Includes section
+******************************************************************************/
+#include "compiler.h"
+#include "pds_nvm.h"
+#include "pds_interface.h"
+
+/******************************************************************************
+                   Defines section
+******************************************************************************/
+/* Number of items that can be journaled */
+#define PDS_JOURNAL_MAX_COUNTERS		4
+
+/* Counter id of the entry that starts a journal row */
+#define PDS_JOURNAL_ROW_HEADER_ID		0xFE
+
+/* Counter id of an erased entry */
+#define PDS_JOURNAL_ERASED_ID			0xFF
+
+/* Marks an entry holding a value or a deleted item */
+#define PDS_JOURNAL_VALUE				PDS_MAGIC
+#define PDS_JOURNAL_DELETED				0x5a
+
+#define PDS_JOURNAL_ENTRIES_PER_ROW		(EEPROM_ROW_SIZE / sizeof(PdsJournalEntry_t))
+
+/* Writes of an entry, or switches to the next row, before the counters
+ * queued are handed to the file rows */
+#define PDS_JOURNAL_WRITE_ATTEMPTS		2
+
+/******************************************************************************
+                               Types section
+*******************************************************************************/
+COMPILER_PACK_SET(1)
+typedef struct _PdsJournalEntry
+{
+	uint8_t counterId;
+	uint8_t type;
+	uint16_t crc;
+	uint32_t value;
+} PdsJournalEntry_t;
+COMPILER_PACK_RESET()
+
+/* Steps of the queued writes, each one waits for the NVM controller */
+typedef enum _PdsJournalWriteState
+{
+	PDS_JOURNAL_WRITE_IDLE = 0,
+	PDS_JOURNAL_WRITE_ERASE,
+	PDS_JOURNAL_WRITE_ENTRY,
+	PDS_JOURNAL_WRITE_INVALIDATE
+} PdsJournalWriteState_t;
+
+/* Queued writes and the step in progress */
+typedef struct _PdsJournalWrite
+{
+	PdsJournalEntry_t entry;
+	PdsJournalWriteState_t state;
+	/* Counters whose last value is not in the rows yet */
+	uint8_t pendingMask;
+	/* Counters whose entries are being invalidated */
+	uint8_t invalidateMask;
+	/* Entry programmed or scanned */
+	uint8_t row;
+	uint8_t entryIdx;
+	uint8_t failures[PDS_JOURNAL_MAX_COUNTERS];
+	uint8_t switchFailures;
+} PdsJournalWrite_t;
+
+/******************************************************************************
+                   Prototypes section
+******************************************************************************/
+
+/**************************************************************************//**
+\brief	Replays the journal rows into the RAM copy of the counters and finds
+		the next free entry.
+
+\param[in] none
+\param[out] none
+******************************************************************************/
+void pdsJournalInit(void);
+
+/**************************************************************************//**
+\brief	Queues a counter value for the journal, the PDS task appends it.
+		If the append fails, the older entries of the counter are
+		invalidated and pdsJournalWriteFailed is called, so that the value
+		is stored in the file row instead.
+
+\param[in] 	counterId - The journal id of the counter.
+\param[in] 	value - The value of the counter.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsJournalWrite(uint8_t counterId, uint32_t value);
+
+/**************************************************************************//**
+\brief	Queues a deleted mark for a counter, the PDS task appends it. If the
+		append fails, the entries of the counter are invalidated instead.
+
+\param[in] 	counterId - The journal id of the counter.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsJournalDelete(uint8_t counterId);
+
+/**************************************************************************//**
+\brief	Reads the last value of a counter written to the journal.
+
+\param[in] 	counterId - The journal id of the counter.
+\param[in] 	value - The last value of the counter.
+\param[out] - return true if the journal holds a value of the counter
+******************************************************************************/
+bool pdsJournalRead(uint8_t counterId, uint32_t *value);
+
+/**************************************************************************//**
+\brief	Forgets the journal content and the queued writes. The rows are
+		erased by pdsNvmEraseAll.
+
+\param[out] - void
+******************************************************************************/
+void pdsJournalDeleteAll(void);
+
+/**************************************************************************//**
+\brief	Takes the queued journal writes one step further when the NVM
+		controller is ready, see PDS_JOURNAL_TASK_ID.
+
+\param[out] status - PDS_BUSY until the queued writes are over, then PDS_OK.
+******************************************************************************/
+PdsStatus_t pdsJournalResume(void);
+
+/**************************************************************************//**
+\brief	Checks if journal writes are queued or in progress.
+
+\param[out] - return true or false
+******************************************************************************/
+bool pdsJournalIsWriting(void);
+
+/**************************************************************************//**
+\brief	Stores the item of a counter in its file row, after its journal
+		append failed. Implemented by pds_interface.c.
+
+\param[in] 	counterId - The journal id of the counter.
+******************************************************************************/
+void pdsJournalWriteFailed(uint8_t counterId);
+
+#endif  /* _PDS_JOURNAL_H_ */
+
+/* eof pds_journal.h */
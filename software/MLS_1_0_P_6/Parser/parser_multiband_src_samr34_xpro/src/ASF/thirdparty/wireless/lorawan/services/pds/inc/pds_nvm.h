@@ -60,6 +60,21 @@
 #define EEPROM_ROW_SIZE         (EEPROM_PAGE_SIZE*EEPROM_PAGE_PER_ROW)
 #define EEPROM_NUM_ROWS         (EEPROM_SIZE/EEPROM_ROW_SIZE)
 
+/* Set to 0 to keep the journaled items in their file rows */
+#ifndef PDS_JOURNAL
+#define PDS_JOURNAL             1
+#endif
+
+/* The counter journal alternates between the last two rows of the EEPROM,
+ * the wear leveling uses the others */
+#if (PDS_JOURNAL == 1)
+#define PDS_JOURNAL_ROWS        2
+#else
+#define PDS_JOURNAL_ROWS        0
+#endif
+#define PDS_WL_NUM_ROWS         (EEPROM_NUM_ROWS - PDS_JOURNAL_ROWS)
+#define PDS_JOURNAL_FIRST_ROW   (PDS_WL_NUM_ROWS)
+
 
 /******************************************************************************
                                Types section
@@ -78,16 +93,42 @@
 PdsStatus_t pdsNvmInit(void);
 
 /**************************************************************************//**
-\brief	This function will calculate the crc of the buffer contents and writes
-		the buffer contents to nvm. It will also read the same content to verify
-		if its written properly.
+\brief	Fills the NVM header of a buffer with the version, size and crc of
+		its contents before the buffer is written to a row.
 
-\param[in] 	pdsFileItemIdx - The file id to be written.
 \param[in] 	buffer - The buffer containing data to be written.
 \param[in] 	size - The size of the data in the buffer.
-\param[out] status - The return status of the function's operation of type PdsStatus_t.
 ******************************************************************************/
-PdsStatus_t pdsNvmWrite(uint16_t rowId, PdsMem_t *buffer, uint16_t size);
+void pdsNvmSetHeader(PdsMem_t *buffer, uint16_t size);
+
+/**************************************************************************//**
+\brief	Issues the erase of a row and returns without waiting for it.
+
+\param[in] 	rowId - The rowId to be erased.
+\param[out] status - PDS_BUSY if the NVM controller is busy, PDS_OK once
+		the erase is issued.
+******************************************************************************/
+PdsStatus_t pdsNvmEraseStart(uint16_t rowId);
+
+/**************************************************************************//**
+\brief	Issues the write of one page of an erased row and returns without
+		waiting for it.
+
+\param[in] 	rowId - The row to be written.
+\param[in] 	page - The page of the row.
+\param[in] 	data - The page contents, EEPROM_PAGE_SIZE bytes.
+\param[out] status - PDS_BUSY if the NVM controller is busy, PDS_OK once
+		the write is issued.
+******************************************************************************/
+PdsStatus_t pdsNvmWritePageStart(uint16_t rowId, uint8_t page, uint8_t *data);
+
+/**************************************************************************//**
+\brief	Checks if the NVM controller has finished the last command.
+
+\param[out] status - PDS_BUSY while the command runs, then PDS_ERROR if it
+		failed or PDS_OK.
+******************************************************************************/
+PdsStatus_t pdsNvmCheckReady(void);
 
 /**************************************************************************//**
 \brief	This function will read the contents of NVM and verify the crc.
@@ -107,6 +148,41 @@ PdsStatus_t pdsNvmRead(uint16_t rowId, PdsMem_t *buffer, uint16_t size);
 ******************************************************************************/
 PdsStatus_t pdsNvmErase(uint16_t rowId);
 
+/**************************************************************************//**
+\brief	Issues the program of bytes of an erased part of a row, without
+		erasing the row and without CRC, and returns without waiting for
+		it. Bytes to leave untouched must be 0xFF in the buffer, as
+		programming cannot set bits back to 1.
+
+\param[in] 	rowId - The row to be programmed.
+\param[in] 	offset - The offset of the data in the row.
+\param[in] 	buffer - The data to be programmed.
+\param[in] 	size - The size of the data, not crossing a page boundary.
+\param[out] status - PDS_BUSY if the NVM controller is busy, PDS_OK once
+		the program is issued.
+******************************************************************************/
+PdsStatus_t pdsNvmProgramStart(uint16_t rowId, uint16_t offset, uint8_t *buffer, uint16_t size);
+
+/**************************************************************************//**
+\brief	Reads bytes of a row without CRC check.
+
+\param[in] 	rowId - The row to be read.
+\param[in] 	offset - The offset of the data in the row.
+\param[in] 	buffer - The buffer for the data read.
+\param[in] 	size - The size of the data.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsNvmReadRaw(uint16_t rowId, uint16_t offset, uint8_t *buffer, uint16_t size);
+
+/**************************************************************************//**
+\brief	Calculates the CRC used by the PDS headers.
+
+\param[in] 	length - The amount of data for which CRC is to be calculated.
+\param[in] 	data - The data.
+\param[out] uint16_t - The calculated 16 bit CRC.
+******************************************************************************/
+uint16_t pdsNvmCrc(uint16_t length, uint8_t *data);
+
 /**************************************************************************//**
 \brief	Erases all the contents of NVM of all rows.
 
@@ -54,31 +54,42 @@
 /******************************************************************************
                                Types section
 *******************************************************************************/
-typedef struct _RowMap
-{
-    uint32_t counter;
-    uint16_t memId;
-    uint16_t previousIdx;
-} RowMap_t;
-
+/* Latest copy of a file, maxCounterRowIdx is USHRT_MAX if none */
 typedef struct _FileMap
 {
     uint16_t maxCounterRowIdx;
+    uint32_t counter;
 } FileMap_t;
 
-typedef struct _UpdateFileMap
+/* Steps of a row write, each one waits for the NVM controller */
+typedef enum _PdsWlWriteState
+{
+	PDS_WL_WRITE_IDLE = 0,
+	PDS_WL_WRITE_ERASE,
+	PDS_WL_WRITE_PROGRAM,
+	PDS_WL_WRITE_VERIFY
+} PdsWlWriteState_t;
+
+/* Row write in progress */
+typedef struct _PdsWlWrite
 {
+    PdsMem_t *buffer;
     uint32_t counter;
-    uint16_t memId;
     uint16_t rowIdx;
-} UpdateFileMap_t;
+    uint16_t size;
+    PdsFileItemIdx_t fileId;
+    PdsWlWriteState_t state;
+    uint8_t page;
+    uint8_t numPages;
+} PdsWlWrite_t;
 
 /******************************************************************************
                    Prototypes section
 ******************************************************************************/
 
 /**************************************************************************//**
-\brief Initializes the WL PDS by updating the row and file map.
+\brief Initializes the WL PDS by building the file map and the row masks from
+		the row headers, in a single pass over the rows.
 
 \param[in] none
 \param[out] status - The return status of the function's operation of type PdsStatus_t.
@@ -88,7 +99,7 @@ PdsStatus_t pdsWlInit(void);
 /**************************************************************************//**
 \brief	This function will find the free row index to write to, updates the WL_Struct
 		header and writes to NVM. If the nvm write is successful it updates the
-		row and file map.
+		file map and the row masks.
 
 \param[in] 	pdsFileItemIdx - The file id to be written to.
 \param[in] 	buffer - The buffer containing data to be written.
@@ -97,6 +108,34 @@ PdsStatus_t pdsWlInit(void);
 ******************************************************************************/
 PdsStatus_t pdsWlWrite(PdsFileItemIdx_t pdsFileItemIdx, PdsMem_t *buffer, uint16_t size);
 
+/**************************************************************************//**
+\brief	Starts writing a file to a free row. The write goes on in
+		pdsWlWriteResume, the buffer must stay untouched until it is over.
+
+\param[in] 	pdsFileItemIdx - The file id to be written to.
+\param[in] 	buffer - The buffer containing data to be written.
+\param[in] 	size - The size of the data in the buffer.
+\param[out] status - PDS_BUSY once the write is started, or the error that
+		prevented it.
+******************************************************************************/
+PdsStatus_t pdsWlWriteStart(PdsFileItemIdx_t pdsFileItemIdx, PdsMem_t *buffer, uint16_t size);
+
+/**************************************************************************//**
+\brief	Takes the row write one step further when the NVM controller is
+		ready. The file map and the row masks are updated when the row
+		is verified.
+
+\param[out] status - PDS_BUSY until the write is over, then its result.
+******************************************************************************/
+PdsStatus_t pdsWlWriteResume(void);
+
+/**************************************************************************//**
+\brief	Checks if a row write is in progress.
+
+\param[out] - return true or false
+******************************************************************************/
+bool pdsWlIsWriting(void);
+
 /**************************************************************************//**
 \brief	This function will find extract the row where the file is stored and 
 		read from NVM.
@@ -116,7 +155,7 @@ PdsStatus_t pdsWlRead(PdsFileItemIdx_t pdsFileItemIdx, PdsMem_t *buffer, uint16_
 bool isFileFound(PdsFileItemIdx_t pdsFileItemIdx);
 
 /**************************************************************************//**
-\brief This function Erases Filemap and Rowmap array in WL and Initiates NVM Erase all.
+\brief This function Erases the file map and the row masks in WL and Initiates NVM Erase all.
 
 \param[out] - void
 ******************************************************************************/
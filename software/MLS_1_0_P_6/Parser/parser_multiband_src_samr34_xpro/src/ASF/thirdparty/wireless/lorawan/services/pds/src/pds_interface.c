@@ -43,6 +43,8 @@
 #include "pds_common.h"
 #include "pds_task_handler.h"
 #include "pds_wl.h"
+#include "pds_journal.h"
+#include "sw_timer.h"
 
 /******************************************************************************
                    Global section
@@ -55,9 +57,35 @@
 #if (ENABLE_PDS == 1)	
 bool isFileSet[PDS_MAX_FILE_IDX];
 static bool pdsUnInitFlag = false;
+static uint8_t pdsCommitTimerId;
+static bool isCommitTimerCreated = false;
+/* No flash work before this time, see PDS_HoldFor */
+static uint64_t pdsHoldEndTime = 0;
+#if (PDS_STATS == 1)
+PdsWriteStats_t pdsWriteStats;
+#endif
+#if (PDS_JOURNAL == 1)
+/* Items kept in the counter journal as (file << 8) | item, the index in the
+ * array is the journal counter id */
+static uint16_t journalItems[PDS_JOURNAL_MAX_COUNTERS];
+static uint8_t numJournalItems = 0;
+#endif
 #endif
 PdsFileMarks_t fileMarks[PDS_MAX_FILE_IDX];
 
+/******************************************************************************
+                   Prototypes section
+******************************************************************************/
+#if (ENABLE_PDS == 1)
+static void pdsScheduleCommit(void);
+#if (PDS_JOURNAL == 1)
+static uint8_t pdsJournalCounterId(PdsFileItemIdx_t pdsFileItemIdx, uint8_t item);
+static PdsStatus_t pdsJournalStore(PdsFileItemIdx_t pdsFileItemIdx, uint8_t item);
+static void pdsJournalRestoreFile(PdsFileItemIdx_t pdsFileItemIdx);
+#endif
+static void pdsCommitWindowCallback(void *param);
+#endif
+
 
 /******************************************************************************
                    Implementations section
@@ -72,8 +100,23 @@ PdsFileMarks_t fileMarks[PDS_MAX_FILE_IDX];
 PdsStatus_t PDS_Init(void)
 {
 #if (ENABLE_PDS == 1)	
+#if (PDS_STATS == 1)
+	uint64_t startTime = SwTimerGetTime();
+#endif
 	PdsStatus_t status = pdsWlInit();
+#if (PDS_JOURNAL == 1)
+	pdsJournalInit();
+#endif
 	pdsUnInitFlag = false;
+	if (false == isCommitTimerCreated)
+	{
+		/* Without the timer the dirty files are written on the next task
+		 * pass and the receive windows do not hold the flash work */
+		isCommitTimerCreated = (LORAWAN_SUCCESS == SwTimerCreate(&pdsCommitTimerId));
+	}
+#if (PDS_STATS == 1)
+	pdsWriteStats.initTimeUs = (uint32_t)(SwTimerGetTime() - startTime);
+#endif
 	return status;
 #else
 	return PDS_OK;
@@ -115,9 +158,20 @@ PdsStatus_t PDS_Store(PdsFileItemIdx_t pdsFileItemIdx, uint8_t item)
 		{
 			if (PDS_MAX_FILE_IDX > pdsFileItemIdx)
 			{
+#if (PDS_JOURNAL == 1)
+				/* A journaled item goes to the file row only if the journal
+				 * fails, see pdsJournalWriteFailed */
+				if (PDS_OK == pdsJournalStore(pdsFileItemIdx, item))
+				{
+					return status;
+				}
+#endif
 				*((fileMarks[pdsFileItemIdx].fileMarkListAddr) + item) = PDS_OP_STORE;
 				isFileSet[pdsFileItemIdx] = true;
-				pdsPostTask(PDS_STORE_DELETE_TASK_ID);
+#if (PDS_STATS == 1)
+				pdsWriteStats.marks++;
+#endif
+				pdsScheduleCommit();
 			}
 			else
 			{
@@ -157,6 +211,14 @@ PdsStatus_t PDS_Restore(PdsFileItemIdx_t pdsFileItemIdx, uint8_t item)
 		(0 != fileMarks[pdsFileItemIdx].itemListAddr)			\
 		)
 		{
+#if (PDS_JOURNAL == 1)
+			uint32_t value;
+			if (pdsJournalRead(pdsJournalCounterId(pdsFileItemIdx, item), &value))
+			{
+				memcpy((void *)(fileMarks[pdsFileItemIdx].itemListAddr[item].ramAddress), (void *)&value, fileMarks[pdsFileItemIdx].itemListAddr[item].size);
+				return status;
+			}
+#endif
 			memset(&buffer, 0, sizeof(PdsMem_t));
 			memcpy((void *)&itemInfo, (void *)(fileMarks[pdsFileItemIdx].itemListAddr + (fileMarks[pdsFileItemIdx].numItems - 1)), sizeof(ItemMap_t));
 			size = itemInfo.itemOffset + itemInfo.size + sizeof(ItemHeader_t);
@@ -220,9 +282,21 @@ PdsStatus_t PDS_Delete(PdsFileItemIdx_t pdsFileItemIdx, uint8_t item)
 		{
 			if (PDS_MAX_FILE_IDX > pdsFileItemIdx)
 			{
+#if (PDS_JOURNAL == 1)
+				/* The file row is marked anyway, but a journal value left
+				 * behind would still be restored */
+				if ((PDS_JOURNAL_MAX_COUNTERS > pdsJournalCounterId(pdsFileItemIdx, item)) && \
+					(PDS_OK != pdsJournalDelete(pdsJournalCounterId(pdsFileItemIdx, item))))
+				{
+					status = PDS_ERROR;
+				}
+#endif
 				*((fileMarks[pdsFileItemIdx].fileMarkListAddr) + item) = PDS_OP_DELETE;
 				isFileSet[pdsFileItemIdx] = true;
-				pdsPostTask(PDS_STORE_DELETE_TASK_ID);
+#if (PDS_STATS == 1)
+				pdsWriteStats.marks++;
+#endif
+				pdsScheduleCommit();
 			}
 			else
 			{
@@ -281,6 +355,9 @@ PdsStatus_t PDS_DeleteAll(void)
 	if (false == pdsUnInitFlag)
 	{
 		pdsWlDeleteAll();
+#if (PDS_JOURNAL == 1)
+		pdsJournalDeleteAll();
+#endif
 	}
 #endif
 	return PDS_OK;
@@ -303,6 +380,9 @@ PdsStatus_t PDS_RestoreAll(void)
 		ItemHeader_t itemHeader;
 		PdsMem_t buffer;
 		uint16_t size;
+#if (PDS_STATS == 1)
+		uint64_t startTime = SwTimerGetTime();
+#endif
 		
 		for (uint8_t pdsFileItemIdx = 0; pdsFileItemIdx < PDS_MAX_FILE_IDX; pdsFileItemIdx++)
 		{
@@ -332,12 +412,18 @@ PdsStatus_t PDS_RestoreAll(void)
 						memcpy((void *)(itemInfo.ramAddress), (void *)(ptr), itemHeader.size);
 					}
 				}
+#if (PDS_JOURNAL == 1)
+				pdsJournalRestoreFile((PdsFileItemIdx_t)pdsFileItemIdx);
+#endif
 				if(fileMarks[pdsFileItemIdx].fIDcb != NULL)
 				{
 					fileMarks[pdsFileItemIdx].fIDcb();
 				}
 			}
 		}
+#if (PDS_STATS == 1)
+		pdsWriteStats.restoreTimeUs = (uint32_t)(SwTimerGetTime() - startTime);
+#endif
 	}
 #endif	
 	return status;
@@ -365,11 +451,15 @@ PdsStatus_t PDS_StoreAll(void)
 				for (uint8_t itemIdx = 0; itemIdx < fileMarks[pdsFileItemIdx].numItems; itemIdx++)
 				{
 					*(fileMarks[pdsFileItemIdx].fileMarkListAddr + itemIdx) = PDS_OP_STORE;
+#if (PDS_JOURNAL == 1)
+					/* The journal value would override the file value at restore */
+					pdsJournalStore((PdsFileItemIdx_t)pdsFileItemIdx, itemIdx);
+#endif
 				}
 				isFileSet[pdsFileItemIdx] = true;
 			}
 		}
-		pdsPostTask(PDS_STORE_DELETE_TASK_ID);
+		pdsScheduleCommit();
 	}
 #endif	
 	return PDS_OK;
@@ -400,6 +490,42 @@ PdsStatus_t PDS_RegFile(PdsFileItemIdx_t argFileId, PdsFileMarks_t argFileMarks)
 	return status;
 }
 
+/**************************************************************************//**
+\brief	This function keeps an item of a registered file in the counter journal.
+		Each store of the item then appends its value to the journal instead
+		of rewriting the file row. The items must be registered in the same
+		order at every start, as the order gives their journal ids.
+
+\param[in] pdsFileItemIdx - The file id of the item.
+\param[in] item - The item id of the item in PDS, of at most 4 bytes.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t PDS_RegJournalItem(PdsFileItemIdx_t pdsFileItemIdx, uint8_t item)
+{
+	PdsStatus_t status = PDS_OK;
+#if (ENABLE_PDS == 1) && (PDS_JOURNAL == 1)
+	if ((PDS_MAX_FILE_IDX <= pdsFileItemIdx) || (0 == fileMarks[pdsFileItemIdx].itemListAddr) || \
+		(item >= fileMarks[pdsFileItemIdx].numItems))
+	{
+		status = PDS_INVLIAD_FILE_IDX;
+	}
+	else if (PDS_JOURNAL_MAX_COUNTERS > pdsJournalCounterId(pdsFileItemIdx, item))
+	{
+		/* Already registered */
+	}
+	else if ((PDS_JOURNAL_MAX_COUNTERS <= numJournalItems) || \
+		(sizeof(uint32_t) < fileMarks[pdsFileItemIdx].itemListAddr[item].size))
+	{
+		status = PDS_NOT_ENOUGH_MEMORY;
+	}
+	else
+	{
+		journalItems[numJournalItems++] = ((uint16_t)pdsFileItemIdx << 8) | item;
+	}
+#endif
+	return status;
+}
+
 /**************************************************************************//**
 \brief This function registers a file to the PDS.
 
@@ -425,4 +551,224 @@ PdsStatus_t PDS_UnRegFile(PdsFileItemIdx_t argFileId)
 	return status;
 }
 
-/* eof pds_interface.c */
\ No newline at end of file
+/**************************************************************************//**
+\brief	Closes the row write count of the current uplink. Called by the MAC
+		when an uplink has been transmitted.
+******************************************************************************/
+void PDS_UplinkDone(void)
+{
+#if (ENABLE_PDS == 1) && (PDS_STATS == 1)
+	pdsWriteStats.uplinks++;
+	pdsWriteStats.lastUplinkRows = pdsWriteStats.rowsSinceUplink;
+	if (pdsWriteStats.rowsSinceUplink > pdsWriteStats.maxUplinkRows)
+	{
+		pdsWriteStats.maxUplinkRows = pdsWriteStats.rowsSinceUplink;
+	}
+	pdsWriteStats.rowsSinceUplink = 0;
+#endif
+}
+
+/**************************************************************************//**
+\brief	Keeps the PDS task off the flash until the receive windows of an
+		uplink have opened. Called by the MAC when an uplink has been
+		transmitted. The pending row writes resume after the hold.
+
+\param[in] timeUs - Time from now to the opening of the last receive window.
+******************************************************************************/
+void PDS_HoldFor(uint32_t timeUs)
+{
+#if (ENABLE_PDS == 1)
+	uint64_t holdEndTime = SwTimerGetTime() + timeUs + MS_TO_US(PDS_RX_HOLD_GUARD_MS);
+
+	if (holdEndTime > pdsHoldEndTime)
+	{
+		pdsHoldEndTime = holdEndTime;
+	}
+#else
+	(void)timeUs;
+#endif
+}
+
+/**************************************************************************//**
+\brief	Writes all the pending store and delete marks to NVM before returning,
+		instead of at the end of the commit window, after the queued journal
+		entries. To be called before a reset. The receive window hold is not
+		observed.
+
+\param[out] status - PDS_OK, or the error of the first row write that failed.
+******************************************************************************/
+PdsStatus_t PDS_Flush(void)
+{
+	PdsStatus_t status = PDS_OK;
+#if (ENABLE_PDS == 1)
+	if (false == pdsUnInitFlag)
+	{
+		if (isCommitTimerCreated)
+		{
+			/* Closes the commit window or the hold */
+			SwTimerStop(pdsCommitTimerId);
+		}
+		status = pdsFlush();
+	}
+#endif
+	return status;
+}
+
+/**************************************************************************//**
+\brief Reads the row write statistics.
+
+\param[out] stats - The statistics, all zero when PDS_STATS is 0.
+******************************************************************************/
+void PDS_GetWriteStats(PdsWriteStats_t *stats)
+{
+#if (ENABLE_PDS == 1) && (PDS_STATS == 1)
+	memcpy(stats, &pdsWriteStats, sizeof(PdsWriteStats_t));
+#else
+	memset(stats, 0, sizeof(PdsWriteStats_t));
+#endif
+}
+
+#if (ENABLE_PDS == 1)
+/**************************************************************************//**
+\brief	Opens the commit window for the marks just set, unless one is already
+		open. The dirty files are written once when the window closes.
+******************************************************************************/
+static void pdsScheduleCommit(void)
+{
+#if (PDS_COMMIT_WINDOW_MS > 0)
+	if (isCommitTimerCreated)
+	{
+		if (SwTimerIsRunning(pdsCommitTimerId))
+		{
+			return;
+		}
+		/* The window only bounds how long the data stays in RAM, so the
+		 * timer may share the wakeup of another timer */
+		if (LORAWAN_SUCCESS == SwTimerStartWithSlack(pdsCommitTimerId, MS_TO_US(PDS_COMMIT_WINDOW_MS), SW_TIMEOUT_RELATIVE, MS_TO_US(PDS_COMMIT_WINDOW_MS), (void *)pdsCommitWindowCallback, NULL))
+		{
+			return;
+		}
+	}
+#endif
+	pdsPostTask(PDS_STORE_DELETE_TASK_ID);
+}
+
+/**************************************************************************//**
+\brief	Commit window or hold expiry, writes the dirty files.
+******************************************************************************/
+static void pdsCommitWindowCallback(void *param)
+{
+	pdsPostTask(PDS_STORE_DELETE_TASK_ID);
+#if (PDS_JOURNAL == 1)
+	/* The journal writes wait for the end of the hold too */
+	pdsPostTask(PDS_JOURNAL_TASK_ID);
+#endif
+	(void)param;
+}
+
+/**************************************************************************//**
+\brief Checks if the PDS task must keep off the flash, see PDS_HoldFor.
+       The task is posted again when the hold is over.
+
+\param[out] - return true or false
+******************************************************************************/
+bool pdsIsHeld(void)
+{
+	uint64_t now = SwTimerGetTime();
+
+	if ((false == isCommitTimerCreated) || (now >= pdsHoldEndTime))
+	{
+		return false;
+	}
+	/* The hold replaces a commit window still open */
+	SwTimerStop(pdsCommitTimerId);
+	return (LORAWAN_SUCCESS == SwTimerStart(pdsCommitTimerId, (uint32_t)(pdsHoldEndTime - now), SW_TIMEOUT_RELATIVE, (void *)pdsCommitWindowCallback, NULL));
+}
+#if (PDS_JOURNAL == 1)
+/**************************************************************************//**
+\brief	Finds the journal counter id of an item.
+
+\param[in] pdsFileItemIdx - The file id of the item.
+\param[in] item - The item id of the item in PDS.
+\param[out] uint8_t - The counter id, PDS_JOURNAL_MAX_COUNTERS if the item
+		is not journaled.
+******************************************************************************/
+static uint8_t pdsJournalCounterId(PdsFileItemIdx_t pdsFileItemIdx, uint8_t item)
+{
+	uint16_t fileItem = ((uint16_t)pdsFileItemIdx << 8) | item;
+
+	for (uint8_t counterId = 0; counterId < numJournalItems; counterId++)
+	{
+		if (fileItem == journalItems[counterId])
+		{
+			return counterId;
+		}
+	}
+	return PDS_JOURNAL_MAX_COUNTERS;
+}
+
+/**************************************************************************//**
+\brief	Queues the RAM value of a journaled item for the journal.
+
+\param[in] pdsFileItemIdx - The file id of the item.
+\param[in] item - The item id of the item in PDS.
+\param[out] status - PDS_NOT_FOUND if the item is not journaled, else the
+		status of the journal write.
+******************************************************************************/
+static PdsStatus_t pdsJournalStore(PdsFileItemIdx_t pdsFileItemIdx, uint8_t item)
+{
+	uint8_t counterId = pdsJournalCounterId(pdsFileItemIdx, item);
+	uint32_t value = 0;
+
+	if (PDS_JOURNAL_MAX_COUNTERS <= counterId)
+	{
+		return PDS_NOT_FOUND;
+	}
+	memcpy((void *)&value, (void *)(fileMarks[pdsFileItemIdx].itemListAddr[item].ramAddress), fileMarks[pdsFileItemIdx].itemListAddr[item].size);
+	return pdsJournalWrite(counterId, value);
+}
+
+/**************************************************************************//**
+\brief	Stores the item of a counter in its file row, after its journal
+		append failed.
+
+\param[in] 	counterId - The journal id of the counter.
+******************************************************************************/
+void pdsJournalWriteFailed(uint8_t counterId)
+{
+	PdsFileItemIdx_t pdsFileItemIdx = (PdsFileItemIdx_t)(journalItems[counterId] >> 8);
+
+	if ((counterId < numJournalItems) && (false == pdsUnInitFlag))
+	{
+		*((fileMarks[pdsFileItemIdx].fileMarkListAddr) + (journalItems[counterId] & 0x00FF)) = PDS_OP_STORE;
+		isFileSet[pdsFileItemIdx] = true;
+#if (PDS_STATS == 1)
+		pdsWriteStats.marks++;
+#endif
+		pdsScheduleCommit();
+	}
+}
+
+/**************************************************************************//**
+\brief	Overrides the journaled items of a restored file with their last
+		journal value.
+
+\param[in] pdsFileItemIdx - The file id.
+******************************************************************************/
+static void pdsJournalRestoreFile(PdsFileItemIdx_t pdsFileItemIdx)
+{
+	uint32_t value;
+
+	for (uint8_t counterId = 0; counterId < numJournalItems; counterId++)
+	{
+		if (((journalItems[counterId] >> 8) == pdsFileItemIdx) && pdsJournalRead(counterId, &value))
+		{
+			ItemMap_t *itemInfo = fileMarks[pdsFileItemIdx].itemListAddr + (journalItems[counterId] & 0x00FF);
+			memcpy((void *)(itemInfo->ramAddress), (void *)&value, itemInfo->size);
+		}
+	}
+}
+#endif /* #if (PDS_JOURNAL == 1) */
+#endif /* #if (ENABLE_PDS == 1) */
+
+/* eof pds_interface.c */
@@ -43,6 +43,7 @@
 #include "pds_common.h"
 #include "pds_task_handler.h"
 #include "pds_wl.h"
+#include "system_crc.h"
 
 
 //#define PDS_FLASH_START_ADDRESS        (0x003E000UL)
@@ -50,12 +51,24 @@
 /************************************************************************/
 /*  Static variables                                                    */
 /************************************************************************/
+/* Set while an erase issued by pdsNvmEraseStart runs with the cache off */
+static bool isCacheDisabled = false;
+
+/* CRC32 of every nibble value, reflected polynome 0xEDB88320 as in the DSU */
+static const uint32_t crc32NibbleTable[16] =
+{
+	0x00000000UL, 0x1db71064UL, 0x3b6e20c8UL, 0x26d930acUL,
+	0x76dc4190UL, 0x6b6b51f4UL, 0x4db26158UL, 0x5005713cUL,
+	0xedb88320UL, 0xf00f9344UL, 0xd6d6a3e8UL, 0xcb61b38cUL,
+	0x9b64c2b0UL, 0x86d3d2d4UL, 0xa00ae278UL, 0xbdbdf21cUL
+};
 
 /******************************************************************************
                    Static prototype section
 ******************************************************************************/
 static uint16_t calculate_crc(uint16_t length, uint8_t *data);
-static uint16_t Crc16Ccitt(uint16_t initValue, uint8_t byte);
+static uint16_t calculate_crc32(uint16_t length, uint8_t *data);
+static uint32_t Crc32Update(uint32_t crc, uint16_t length, uint8_t *data);
 static uint32_t nvmLogicalRowToPhysicalAddr(uint16_t logicalRow);
 
 /******************************************************************************
@@ -86,39 +99,117 @@ PdsStatus_t pdsNvmInit(void)
 	{
 		return PDS_NOT_ENOUGH_MEMORY;
 	}
+
+#if (PDS_HW_CRC == 1)
+	/* The DSU is write protected out of reset */
+	PAC->WRCTRL.reg = PAC_WRCTRL_PERID(ID_DSU) | PAC_WRCTRL_KEY_CLR;
+#endif
 	
 	return status;
 }
 
 /**************************************************************************//**
-\brief	This function will calculate the crc of the buffer contents and writes
-		the buffer contents to nvm. It will also read the same content to verify
-		if its written properly.
+\brief	Fills the NVM header of a buffer with the version, size and crc of
+		its contents before the buffer is written to a row.
 
-\param[in] 	pdsFileItemIdx - The file id to be written.
 \param[in] 	buffer - The buffer containing data to be written.
 \param[in] 	size - The size of the data in the buffer.
-\param[out] status - The return status of the function's operation of type PdsStatus_t.
 ******************************************************************************/
-PdsStatus_t pdsNvmWrite(uint16_t rowId, PdsMem_t *buffer, uint16_t size)
+void pdsNvmSetHeader(PdsMem_t *buffer, uint16_t size)
 {
-	PdsStatus_t status = PDS_OK;
 	buffer->NVM_Struct.pdsNvmHeader.version = PDS_NVM_VERSION;
 	buffer->NVM_Struct.pdsNvmHeader.size = size;
+#if (PDS_HW_CRC == 1)
+	buffer->NVM_Struct.pdsNvmHeader.crc = calculate_crc32(buffer->NVM_Struct.pdsNvmHeader.size, (uint8_t *)(&(buffer->NVM_Struct.pdsNvmData)));
+#else
 	buffer->NVM_Struct.pdsNvmHeader.crc = calculate_crc(buffer->NVM_Struct.pdsNvmHeader.size, (uint8_t *)(&(buffer->NVM_Struct.pdsNvmData)));
-	//buffer->NVM_Struct.pdsNvmHeader.size = size;
-	size += sizeof(PdsNvmHeader_t);
+#endif
+}
+
+/**************************************************************************//**
+\brief	Issues the erase of a row and returns without waiting for it.
+		The cache is off until the erase is over, so that no line of the
+		row is read back from it.
+
+\param[in] 	rowId - The rowId to be erased.
+\param[out] status - PDS_BUSY if the NVM controller is busy, PDS_OK once
+		the erase is issued.
+******************************************************************************/
+PdsStatus_t pdsNvmEraseStart(uint16_t rowId)
+{
+	Nvmctrl *const nvm_module = NVMCTRL;
 	uint32_t addr = nvmLogicalRowToPhysicalAddr(rowId);
-	status_code_t statusCode;
 
-	statusCode = nvm_write(INT_FLASH, addr, (uint8_t *const)buffer, size);
-	if (STATUS_OK != (status_code_genare_t) statusCode)
+	if (!nvm_is_ready())
+	{
+		return PDS_BUSY;
+	}
+
+	nvm_module->STATUS.reg = NVMCTRL_STATUS_MASK;
+	/* The address is given in 16-bit words */
+	nvm_module->ADDR.reg = addr / 2;
+	if (!nvm_module->CTRLB.bit.CACHEDIS)
+	{
+		nvm_module->CTRLB.bit.CACHEDIS = 1;
+		nvm_module->CTRLB.reg;
+		isCacheDisabled = true;
+	}
+	nvm_module->CTRLA.reg = NVM_COMMAND_RWWEE_ERASE_ROW | NVMCTRL_CTRLA_CMDEX_KEY;
+
+	return PDS_OK;
+}
+
+/**************************************************************************//**
+\brief	Issues the write of one page of an erased row and returns without
+		waiting for it. The page is written by the automatic page write once
+		its last word is loaded.
+
+\param[in] 	rowId - The row to be written.
+\param[in] 	page - The page of the row.
+\param[in] 	data - The page contents, EEPROM_PAGE_SIZE bytes.
+\param[out] status - PDS_BUSY if the NVM controller is busy, PDS_OK once
+		the write is issued.
+******************************************************************************/
+PdsStatus_t pdsNvmWritePageStart(uint16_t rowId, uint8_t page, uint8_t *data)
+{
+	uint32_t addr = nvmLogicalRowToPhysicalAddr(rowId) + ((uint32_t)page * EEPROM_PAGE_SIZE);
+	enum status_code statusCode = nvm_write_buffer(addr, data, EEPROM_PAGE_SIZE);
+
+	if (STATUS_BUSY == statusCode)
+	{
+		return PDS_BUSY;
+	}
+	if (STATUS_OK != statusCode)
 	{
 		return PDS_ERROR;
 	}
-	status = pdsNvmRead(rowId, (PdsMem_t *const)buffer, size);
-	
-	return status;
+	return PDS_OK;
+}
+
+/**************************************************************************//**
+\brief	Checks if the NVM controller has finished the last command.
+
+\param[out] status - PDS_BUSY while the command runs, then PDS_ERROR if it
+		failed or PDS_OK.
+******************************************************************************/
+PdsStatus_t pdsNvmCheckReady(void)
+{
+	Nvmctrl *const nvm_module = NVMCTRL;
+
+	if (!nvm_is_ready())
+	{
+		return PDS_BUSY;
+	}
+	if (isCacheDisabled)
+	{
+		nvm_module->CTRLB.bit.CACHEDIS = 0;
+		isCacheDisabled = false;
+	}
+	if (nvm_module->STATUS.reg & NVM_ERRORS_MASK)
+	{
+		return PDS_ERROR;
+	}
+	return PDS_OK;
 }
 
 /**************************************************************************//**
@@ -156,9 +247,21 @@ PdsStatus_t pdsNvmRead(uint16_t rowId, PdsMem_t *buffer, uint16_t size)
 	{
 		return PDS_ERROR;
 	}
-	crc = buffer->NVM_Struct.pdsNvmHeader.crc;
+	/* The rows keep the CRC of the version they were written with until
+	 * their file is stored again */
+	switch (buffer->NVM_Struct.pdsNvmHeader.version)
+	{
+		case PDS_NVM_VERSION_CRC16:
+			crc = calculate_crc(buffer->NVM_Struct.pdsNvmHeader.size, (uint8_t *)&(buffer->NVM_Struct.pdsNvmData));
+			break;
+		case PDS_NVM_VERSION_CRC32:
+			crc = calculate_crc32(buffer->NVM_Struct.pdsNvmHeader.size, (uint8_t *)&(buffer->NVM_Struct.pdsNvmData));
+			break;
+		default:
+			return PDS_CRC_ERROR;
+	}
 	
-	if (crc != calculate_crc(buffer->NVM_Struct.pdsNvmHeader.size, (uint8_t *)&(buffer->NVM_Struct.pdsNvmData))) 
+	if (crc != buffer->NVM_Struct.pdsNvmHeader.crc) 
 	{
 		return PDS_CRC_ERROR;
 	}
@@ -188,6 +291,85 @@ PdsStatus_t pdsNvmErase(uint16_t rowId)
 	return status;
 }
 
+/**************************************************************************//**
+\brief	Issues the program of bytes of an erased part of a row, without
+		erasing the row and without CRC, and returns without waiting for
+		it. Bytes to leave untouched must be 0xFF in the buffer, as
+		programming cannot set bits back to 1.
+
+\param[in] 	rowId - The row to be programmed.
+\param[in] 	offset - The offset of the data in the row.
+\param[in] 	buffer - The data to be programmed.
+\param[in] 	size - The size of the data, not crossing a page boundary.
+\param[out] status - PDS_BUSY if the NVM controller is busy, PDS_OK once
+		the program is issued.
+******************************************************************************/
+PdsStatus_t pdsNvmProgramStart(uint16_t rowId, uint16_t offset, uint8_t *buffer, uint16_t size)
+{
+	uint8_t page[EEPROM_PAGE_SIZE];
+	uint16_t pageOffset = offset % EEPROM_PAGE_SIZE;
+	uint32_t addr = nvmLogicalRowToPhysicalAddr(rowId) + (offset - pageOffset);
+	enum status_code statusCode;
+
+	if ((pageOffset + size) > EEPROM_PAGE_SIZE)
+	{
+		return PDS_ERROR;
+	}
+
+	/* The page buffer is written from the start of the page, 0xFF leaves
+	 * the bytes before the data as they are */
+	memset(page, UCHAR_MAX, pageOffset);
+	memcpy(&page[pageOffset], buffer, size);
+	statusCode = nvm_write_buffer(addr, page, pageOffset + size);
+	if (STATUS_BUSY == statusCode)
+	{
+		return PDS_BUSY;
+	}
+	if (STATUS_OK != statusCode)
+	{
+		return PDS_ERROR;
+	}
+	return PDS_OK;
+}
+
+/**************************************************************************//**
+\brief	Reads bytes of a row without CRC check.
+
+\param[in] 	rowId - The row to be read.
+\param[in] 	offset - The offset of the data in the row.
+\param[in] 	buffer - The buffer for the data read.
+\param[in] 	size - The size of the data.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsNvmReadRaw(uint16_t rowId, uint16_t offset, uint8_t *buffer, uint16_t size)
+{
+	uint32_t addr = nvmLogicalRowToPhysicalAddr(rowId) + offset;
+	status_code_genare_t statusCode;
+
+	do
+	{
+		statusCode = nvm_read(INT_FLASH, addr, buffer, size);
+	} while (statusCode == STATUS_BUSY);
+
+	if (STATUS_OK != statusCode)
+	{
+		return PDS_ERROR;
+	}
+	return PDS_OK;
+}
+
+/**************************************************************************//**
+\brief	Calculates the CRC used by the PDS headers.
+
+\param[in] 	length - The amount of data for which CRC is to be calculated.
+\param[in] 	data - The data.
+\param[out] uint16_t - The calculated 16 bit CRC.
+******************************************************************************/
+uint16_t pdsNvmCrc(uint16_t length, uint8_t *data)
+{
+	return calculate_crc(length, data);
+}
+
 /**************************************************************************//**
 \brief	Erases all the contents of NVM of all rows.
 
@@ -210,36 +392,81 @@ PdsStatus_t pdsNvmEraseAll(void)
 }
 
 /**************************************************************************//**
-\brief	Calculates the CRC in CCITT polynome.
+\brief	Calculates the CRC16 CCITT of the PDS headers.
 
-\param[in] 	initValue - The rowId to be erased.
-\param[in] 	byte - The rowId to be erased.
+\param[in] 	length - The amount of data for which CRC is to be calculated.
+\param[in] 	data - The data.
 \param[out] uint16_t - The calculated 16 bit CRC.
 ******************************************************************************/
-uint16_t Crc16Ccitt(uint16_t initValue, uint8_t byte)
+static uint16_t calculate_crc(uint16_t length, uint8_t *data)
 {
-  byte ^= initValue & 0xffU;
-  byte ^= byte << 4U;
-
-  return ((((uint16_t)byte << 8) | ((initValue & 0xff00U) >> 8))
-          ^ (uint8_t)(byte >> 4) ^ ((uint16_t)byte << 3));
+  return SYSTEM_Crc16(SYSTEM_CRC16_INIT_PDS, data, length);
 }
 
 /**************************************************************************//**
-\brief	Calculates the CRC.
+\brief	Continues a CRC32 in software, one nibble at a time.
 
+\param[in] 	crc - The CRC of the previous data.
 \param[in] 	length - The amount of data for which CRC is to be calculated.
 \param[in] 	data - The data.
-\param[out] uint16_t - The calculated 16 bit CRC.
+\param[out] uint32_t - The updated CRC.
 ******************************************************************************/
-static uint16_t calculate_crc(uint16_t length, uint8_t *data)
+static uint32_t Crc32Update(uint32_t crc, uint16_t length, uint8_t *data)
 {
-  uint16_t eeprom_crc = 0U;
   for (uint16_t i = 0; i < length; i++)
   {
-    eeprom_crc = Crc16Ccitt(eeprom_crc, data[i]);
+    crc ^= data[i];
+    crc = (crc >> 4) ^ crc32NibbleTable[crc & 0x0fU];
+    crc = (crc >> 4) ^ crc32NibbleTable[crc & 0x0fU];
+  }
+  return crc;
+}
+
+/**************************************************************************//**
+\brief	Calculates the CRC32 of the data, folded to 16 bits for the header.
+		The word aligned part is computed by the DSU when PDS_HW_CRC is set,
+		the bytes around it in software.
+
+\param[in] 	length - The amount of data for which CRC is to be calculated.
+\param[in] 	data - The data.
+\param[out] uint16_t - The folded 32 bit CRC.
+******************************************************************************/
+static uint16_t calculate_crc32(uint16_t length, uint8_t *data)
+{
+  uint32_t crc = UINT32_MAX;
+#if (PDS_HW_CRC == 1)
+  uint16_t head = (uint16_t)((4U - ((uint32_t)data & 3U)) & 3U);
+  uint16_t words;
+
+  if (head > length)
+  {
+    head = length;
   }
-  return eeprom_crc;
+  crc = Crc32Update(crc, head, data);
+  data += head;
+  length -= head;
+  words = length >> 2;
+
+  if (words)
+  {
+    DSU->STATUSA.reg = DSU_STATUSA_DONE | DSU_STATUSA_BERR;
+    DSU->ADDR.reg = DSU_ADDR_ADDR((uint32_t)data >> 2);
+    DSU->LENGTH.reg = DSU_LENGTH_LENGTH(words);
+    DSU->DATA.reg = crc;
+    DSU->CTRL.reg = DSU_CTRL_CRC;
+    while (!(DSU->STATUSA.reg & DSU_STATUSA_DONE))
+    {
+    }
+    if (!(DSU->STATUSA.reg & DSU_STATUSA_BERR))
+    {
+      crc = DSU->DATA.reg;
+      data += (words << 2);
+      length -= (words << 2);
+    }
+  }
+#endif
+  crc = ~Crc32Update(crc, length, data);
+  return (uint16_t)(crc ^ (crc >> 16));
 }
 
 /**************************************************************************//**
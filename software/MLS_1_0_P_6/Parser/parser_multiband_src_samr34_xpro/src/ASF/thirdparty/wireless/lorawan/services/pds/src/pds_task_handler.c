@@ -45,6 +45,7 @@
 #include "pds_common.h"
 #include "pds_task_handler.h"
 #include "pds_wl.h"
+#include "pds_journal.h"
 #include "atomic.h"
 #include <stdint.h>
 
@@ -57,18 +58,36 @@
 ******************************************************************************/
 static volatile uint8_t pdsTaskFlags = 0x0000u;
 
+#if (ENABLE_PDS == 1)
+/* Row contents of the file being written, kept until the write is over */
+static PdsMem_t pdsWriteBuffer;
+/* File of the row write in progress or last started */
+static PdsFileItemIdx_t pdsWriteFileId;
+/* Failed row writes of pdsWriteFileId retried so far */
+static uint8_t pdsWriteRetries;
+#endif
+
 /************************************************************************/
 /*  Extern variables                                                    */
 /************************************************************************/
 extern bool isFileSet[];
 extern PdsFileMarks_t fileMarks[];
+#if (ENABLE_PDS == 1) && (PDS_STATS == 1)
+extern PdsWriteStats_t pdsWriteStats;
+#endif
 
 /******************************************************************************
                    Prototypes section
 ******************************************************************************/
 #if (ENABLE_PDS == 1)
 static SYSTEM_TaskStatus_t pdsStoreDeleteHandler(void);
+static SYSTEM_TaskStatus_t pdsJournalHandler(void);
 static PdsStatus_t pdsStoreDelete(PdsFileItemIdx_t pdsFileItemIdx, uint8_t *buffer);
+static bool pdsIsAnyFileSet(void);
+static void pdsWriteDone(PdsStatus_t status);
+static PdsStatus_t pdsWriteFinish(void);
+static PdsStatus_t pdsWriteFile(PdsFileItemIdx_t pdsFileItemIdx);
+static void pdsClearMarks(PdsFileItemIdx_t pdsFileItemIdx);
 #endif
 
 /**************************************************************************//**
@@ -78,7 +97,8 @@ static PdsStatus_t pdsStoreDelete(PdsFileItemIdx_t pdsFileItemIdx, uint8_t *buff
 static SYSTEM_TaskStatus_t (*pdsTaskHandlers[PDS_TASKS_COUNT])(void) = {
 	
     /* In the order of descending priority */
-    pdsStoreDeleteHandler
+    pdsStoreDeleteHandler,
+    pdsJournalHandler
 };
 #endif
 
@@ -118,27 +138,23 @@ void pdsClearTask(PdsTaskIds_t id)
 SYSTEM_TaskStatus_t PDS_TaskHandler(void)
 {
 #if (ENABLE_PDS == 1)	
+    uint8_t pendingTasks = pdsTaskFlags & ((1 << PDS_TASKS_COUNT) - 1);
+    uint8_t taskId;
 
-    if (pdsTaskFlags)
+    if (pendingTasks)
     {
-        for (uint16_t taskId = 0; taskId < PDS_TASKS_COUNT; taskId++)
+        /* Highest priority pending task */
+        taskId = SYSTEM_GetFirstTaskId(pendingTasks);
+
+        ATOMIC_SECTION_ENTER
+        pdsTaskFlags &= ~(1 << taskId);
+        ATOMIC_SECTION_EXIT
+
+        pdsTaskHandlers[taskId]();
+
+        if (pdsTaskFlags)
         {
-            if ((1 << taskId) & (pdsTaskFlags))
-            {
-
-                ATOMIC_SECTION_ENTER
-                pdsTaskFlags &= ~(1 << taskId);
-                ATOMIC_SECTION_EXIT
-
-                pdsTaskHandlers[taskId]();
-
-				if (pdsTaskFlags)
-                {
-                    SYSTEM_PostTask(PDS_TASK_ID);
-                }
-                
-                break;
-            }
+            SYSTEM_PostTask(PDS_TASK_ID);
         }
     }
 #endif
@@ -148,50 +164,265 @@ SYSTEM_TaskStatus_t PDS_TaskHandler(void)
 #if (ENABLE_PDS == 1)
 /**************************************************************************//**
 \brief	This function checks if an operation is pending for a file and will
-		initiate store/delete operation.
+		initiate store/delete operation. All the marks of a file are written
+		in one row write, one file at a time. The handler only issues the next
+		flash command of the row write and returns, it runs again on the next
+		pass until the write is over.
 
 \param[out] status - The return status of the function's operation.
 ******************************************************************************/
 static SYSTEM_TaskStatus_t pdsStoreDeleteHandler(void)
 {
-	PdsStatus_t status = SYSTEM_TASK_SUCCESS;
-
+	PdsStatus_t status = PDS_OK;
 	PdsFileItemIdx_t fileId = PDS_FILE_MAC_01_IDX;
-	PdsMem_t buffer;
 
-	memset(&buffer, 0, sizeof(PdsMem_t));
+	/* No flash work until the receive windows have opened, the hold
+	 * timer posts the task again */
+	if (pdsIsHeld())
+	{
+		return SYSTEM_TASK_SUCCESS;
+	}
+
+	if (pdsWlIsWriting())
+	{
+		status = pdsWlWriteResume();
+		if (PDS_BUSY == status)
+		{
+			/* Poll the NVM controller on the next pass */
+			pdsPostTask(PDS_STORE_DELETE_TASK_ID);
+			return SYSTEM_TASK_SUCCESS;
+		}
+		pdsWriteDone(status);
+	}
+
 	for (; fileId < PDS_MAX_FILE_IDX; fileId++)
 	{
 		if (true == isFileSet[fileId])
 		{
-			status = pdsStoreDelete(fileId, (uint8_t *)&(buffer));
-			if (status != PDS_OK)
+			status = pdsWriteFile(fileId);
+			if (PDS_BUSY != status)
 			{
-				// assert;
+				pdsWriteDone(status);
 			}
-			isFileSet[fileId] = false;
-			fileId++;
 			break;
 		}
 	}
-	for (; fileId < PDS_MAX_FILE_IDX; fileId++)
+
+	if (pdsWlIsWriting() || pdsIsAnyFileSet())
 	{
-		if (isFileSet[fileId])
+		pdsPostTask(PDS_STORE_DELETE_TASK_ID);
+	}
+
+	return SYSTEM_TASK_SUCCESS;
+}
+
+/**************************************************************************//**
+\brief	Takes the queued counter journal writes one step further. The
+		handler only runs when no row write is in progress, as the row
+		writes have the higher priority and post their task until they
+		are over, so that the two never share the NVM controller.
+
+\param[out] status - The return status of the function's operation.
+******************************************************************************/
+static SYSTEM_TaskStatus_t pdsJournalHandler(void)
+{
+#if (PDS_JOURNAL == 1)
+	/* Same hold as the row writes, the hold timer posts the task again */
+	if (pdsIsHeld())
+	{
+		return SYSTEM_TASK_SUCCESS;
+	}
+
+	if (PDS_BUSY == pdsJournalResume())
+	{
+		pdsPostTask(PDS_JOURNAL_TASK_ID);
+	}
+#endif
+	return SYSTEM_TASK_SUCCESS;
+}
+
+/**************************************************************************//**
+\brief	Writes the queued journal entries and the marks of all the dirty
+		files now, one row write after the other, without waiting for the
+		commit window or the hold.
+
+\param[out] status - PDS_OK, or the error of the first file that could not
+		be written within its retries.
+******************************************************************************/
+PdsStatus_t pdsFlush(void)
+{
+	PdsStatus_t result = PDS_OK;
+	PdsStatus_t status;
+
+	/* The row write in progress owns the write buffer */
+	if (pdsWlIsWriting())
+	{
+		status = pdsWriteFinish();
+		if ((PDS_OK != status) && (false == isFileSet[pdsWriteFileId]))
 		{
-			pdsPostTask(PDS_STORE_DELETE_TASK_ID);
-			break;
+			result = status;
 		}
 	}
 
+#if (PDS_JOURNAL == 1)
+	/* Before the files, which take the counters the journal gives up */
+	while (PDS_BUSY == pdsJournalResume())
+	{
+	}
+	pdsClearTask(PDS_JOURNAL_TASK_ID);
+#endif
+
+	/* A failed write makes its file dirty again until its retries are used */
+	for (PdsFileItemIdx_t fileId = PDS_FILE_MAC_01_IDX; fileId < PDS_MAX_FILE_IDX; )
+	{
+		if (true == isFileSet[fileId])
+		{
+			status = pdsWriteFile(fileId);
+			if (PDS_BUSY == status)
+			{
+				status = pdsWriteFinish();
+			}
+			else
+			{
+				pdsWriteDone(status);
+			}
+			/* Only a write left without a retry fails the flush */
+			if ((PDS_OK != status) && (false == isFileSet[fileId]) && (PDS_OK == result))
+			{
+				result = status;
+			}
+		}
+		else
+		{
+			fileId++;
+		}
+	}
+
+	/* Nothing is left for a pass posted before */
+	pdsClearTask(PDS_STORE_DELETE_TASK_ID);
+
+	return result;
+}
+
+/**************************************************************************//**
+\brief	Ends a row write of pdsWriteFileId, or a write that could not be
+		started. The marks of the file are cleared once written, unless
+		new marks came in meanwhile. A failed write makes the file dirty
+		again, up to PDS_WRITE_RETRIES times in a row; after that the
+		marks are kept for the next store or delete of the file.
+
+\param[in] status - The result of the row write.
+******************************************************************************/
+static void pdsWriteDone(PdsStatus_t status)
+{
+	if (PDS_OK == status)
+	{
+		pdsWriteRetries = 0;
+		if (false == isFileSet[pdsWriteFileId])
+		{
+			pdsClearMarks(pdsWriteFileId);
+		}
+	}
+	else if (pdsWriteRetries < PDS_WRITE_RETRIES)
+	{
+		pdsWriteRetries++;
+		isFileSet[pdsWriteFileId] = true;
+	}
+	else
+	{
+		pdsWriteRetries = 0;
+	}
+
+#if (PDS_STATS == 1)
+	if (PDS_OK == status)
+	{
+		pdsWriteStats.rowsWritten++;
+		pdsWriteStats.rowsSinceUplink++;
+	}
+	else
+	{
+		pdsWriteStats.writeFailures++;
+	}
+	if (false == pdsIsAnyFileSet())
+	{
+		pdsWriteStats.commits++;
+	}
+#endif
+}
+
+/**************************************************************************//**
+\brief	Starts the row write of a dirty file.
+
+\param[in] pdsFileItemIdx - The file to be written.
+\param[out] status - PDS_BUSY once the row write is started, or the error
+		that prevented it.
+******************************************************************************/
+static PdsStatus_t pdsWriteFile(PdsFileItemIdx_t pdsFileItemIdx)
+{
+	/* Marks set from now on make the file dirty again */
+	isFileSet[pdsFileItemIdx] = false;
+	pdsWriteFileId = pdsFileItemIdx;
+
+	return pdsStoreDelete(pdsFileItemIdx, (uint8_t *)&(pdsWriteBuffer));
+}
+
+/**************************************************************************//**
+\brief	Clears the store and delete marks of a file once they are written.
+
+\param[in] pdsFileItemIdx - The file written.
+******************************************************************************/
+static void pdsClearMarks(PdsFileItemIdx_t pdsFileItemIdx)
+{
+	for (uint8_t itemIdx = 0; itemIdx < fileMarks[pdsFileItemIdx].numItems; itemIdx++)
+	{
+		*(fileMarks[pdsFileItemIdx].fileMarkListAddr + itemIdx) = PDS_OP_NONE;
+	}
+}
+
+/**************************************************************************//**
+\brief	Waits for the row write in progress to be over.
+
+\param[out] status - The result of the row write.
+******************************************************************************/
+static PdsStatus_t pdsWriteFinish(void)
+{
+	PdsStatus_t status;
+
+	do
+	{
+		status = pdsWlWriteResume();
+	} while (PDS_BUSY == status);
+	pdsWriteDone(status);
+
 	return status;
 }
 
 /**************************************************************************//**
-\brief This function stores and deletes the items in a file based on file marks set.
+\brief	Checks if a file has marks not yet written.
+
+\param[out] - return true or false
+******************************************************************************/
+static bool pdsIsAnyFileSet(void)
+{
+	for (PdsFileItemIdx_t fileId = PDS_FILE_MAC_01_IDX; fileId < PDS_MAX_FILE_IDX; fileId++)
+	{
+		if (isFileSet[fileId])
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**************************************************************************//**
+\brief This function stores and deletes the items in a file based on file marks set
+		and starts the row write of the file. The marks stay set until the
+		write is over, so that a failed write can be done again.
 
 \param[in] pdsFileItemIdx - The file id to look for.
 \param[in] buffer - The buffer to be used for reading and writing a file.
-\param[out] status - The return status of the function's operation of type PdsStatus_t.
+\param[out] status - PDS_BUSY once the row write is started, or the error
+		that prevented it.
 ******************************************************************************/
 static PdsStatus_t pdsStoreDelete(PdsFileItemIdx_t pdsFileItemIdx, uint8_t *buffer)
 {
@@ -202,6 +433,7 @@ static PdsStatus_t pdsStoreDelete(PdsFileItemIdx_t pdsFileItemIdx, uint8_t *buff
 	ItemHeader_t itemHeader;
 	uint16_t size;
 
+	memset(buffer, 0, sizeof(PdsMem_t));
 	memcpy((void *)&itemInfo, (void *)(fileMarks[pdsFileItemIdx].itemListAddr + (fileMarks[pdsFileItemIdx].numItems - 1)), sizeof(ItemMap_t));
 	size = itemInfo.itemOffset + itemInfo.size + sizeof(ItemHeader_t);
 	status = pdsWlRead(pdsFileItemIdx, (PdsMem_t *)buffer, size);
@@ -223,7 +455,6 @@ static PdsStatus_t pdsStoreDelete(PdsFileItemIdx_t pdsFileItemIdx, uint8_t *buff
 
 		if (PDS_OP_STORE == *(fileMarks[pdsFileItemIdx].fileMarkListAddr + itemIdx))
 		{
-			*(fileMarks[pdsFileItemIdx].fileMarkListAddr + itemIdx) = PDS_OP_NONE;
 			itemHeader.size = itemInfo.size;
 			itemHeader.itemId = itemInfo.itemId;
 			itemHeader.delete = false;
@@ -233,7 +464,6 @@ static PdsStatus_t pdsStoreDelete(PdsFileItemIdx_t pdsFileItemIdx, uint8_t *buff
 		}
 		else if (PDS_OP_DELETE == *(fileMarks[pdsFileItemIdx].fileMarkListAddr + itemIdx))
 		{
-			*(fileMarks[pdsFileItemIdx].fileMarkListAddr + itemIdx) = PDS_OP_NONE;
 			itemHeader.size = itemInfo.size;
 			itemHeader.itemId = itemInfo.itemId;
 			itemHeader.delete = true;
@@ -243,7 +473,7 @@ static PdsStatus_t pdsStoreDelete(PdsFileItemIdx_t pdsFileItemIdx, uint8_t *buff
 
 	memcpy((void *)&itemInfo, (void *)(fileMarks[pdsFileItemIdx].itemListAddr + fileMarks[pdsFileItemIdx].numItems), sizeof(ItemMap_t));
 	size = itemInfo.itemOffset + itemInfo.size + sizeof(ItemHeader_t);
-	status = pdsWlWrite(pdsFileItemIdx, (PdsMem_t *)buffer, PDS_WL_DATA_SIZE);
+	status = pdsWlWriteStart(pdsFileItemIdx, (PdsMem_t *)buffer, PDS_WL_DATA_SIZE);
 
 	return status;
 }
@@ -51,9 +51,11 @@
 static uint8_t                      txBufferLen;
 static uint8_t                      *transmitBufferPtr = NULL;
 static uint64_t                     timeOnAir;
+static uint64_t                     txDoneTime;
 static uint16_t                     rxWindowSize;
 
 static int16_t                      instRSSI;
+static bool                         lbtChannelClear = false;
 
 /************************************************************************/
 /*  Global variables                                                    */
@@ -67,9 +69,12 @@ uint8_t radioBuffer[RADIO_BUFFER_SIZE];
 /* Static Fuctions                                                      */
 /************************************************************************/
 static void Radio_ReadPktRssi(void);
-static bool Radio_IsChannelFree(void);
+static void Radio_StartChannelScan(void);
+static void Radio_ChannelScan(void);
+static void Radio_RxEntropySample(void);
 static void Radio_EnableInterruptLines(void);
 static void Radio_DisableInterruptLines(void);
+static void Radio_TxFrameWritten(void);
 
 /************************************************************************/
 /* Implementations                                                      */
@@ -265,6 +270,11 @@ void RADIO_InitDefaultAttributes(void)
         {
 			retVal = SwTimerCreate(&radioConfiguration.watchdogTimerId);
 		}
+
+        if (LORAWAN_SUCCESS == retVal)
+        {
+			retVal = SwTimerCreate(&radioConfiguration.modeReadyTimerId);
+		}
 /*#ifdef LBT*/
         if (LORAWAN_SUCCESS == retVal)
         {
@@ -289,6 +299,7 @@ void RADIO_InitDefaultAttributes(void)
         SwTimerStop(radioConfiguration.timeOnAirTimerId);
         SwTimerStop(radioConfiguration.fskRxWindowTimerId);
         SwTimerStop(radioConfiguration.watchdogTimerId);
+        SwTimerStop(radioConfiguration.modeReadyTimerId);
 /*#ifdef LBT*/
 		SwTimerStop(radioConfiguration.lbt.lbtScanTimerId);
 /*#endif*/ // LBT
@@ -382,6 +393,7 @@ RadioError_t RADIO_Transmit(RadioTransmitParam_t *param)
 	/*#endif*/ // LBT
 	{
 		RadioSetState(RADIO_STATE_TX);
+		lbtChannelClear = false;
 		radioPostTask(RADIO_TX_TASK_ID);
 	}
 
@@ -527,26 +539,14 @@ SYSTEM_TaskStatus_t RADIO_TxHandler(void)
 	
 	if (true == radioConfiguration.lbt.params.lbtTransmitOn)
 	{
-		if (Radio_IsChannelFree() == false)
+		// The task is posted again by Radio_ChannelScan once the channel
+		// is found free
+		if (false == lbtChannelClear)
 		{
-			// Turning off the RF switch now.
-			Radio_DisableRfControl(RADIO_RFCTRL_RX);
-			//Powering Off the Oscillator after putting TRX to sleep
-			Radio_ResetClockInput();
-			
-			RadioCallbackParam_t RadioCallbackParam;
-			RadioCallbackParam.status = ERR_CHANNEL_BUSY;
-			RadioSetState(RADIO_STATE_IDLE);
-			if (1 == radioCallbackMask.BitMask.radioTxDoneCallback)
-			{
-				if (radioConfiguration.radioCallback)
-				{
-					radioConfiguration.radioCallback(RADIO_TX_DONE_CALLBACK, (void *) &(RadioCallbackParam));
-					return SYSTEM_TASK_SUCCESS;
-
-				}
-			}
-		}		
+			Radio_StartChannelScan();
+			return SYSTEM_TASK_SUCCESS;
+		}
+		lbtChannelClear = false;
 	}
 	
 	// Turn on the RF switch.
@@ -572,8 +572,11 @@ SYSTEM_TaskStatus_t RADIO_TxHandler(void)
 		RADIO_RegisterWrite(REG_DIOMAPPING2, 0x00);
 
 		Radio_WriteMode(MODE_STANDBY, radioConfiguration.modulation, 1);
-		RADIO_FrameWrite(REG_FIFO_ADDRESS, transmitBufferPtr, txBufferLen);
 
+		// The frame is shifted by the DMAC, RADIO_TxStartHandler keys the
+		// transmission once it is in the FIFO
+		RADIO_FrameWriteAsync(REG_FIFO_ADDRESS, transmitBufferPtr, txBufferLen, Radio_TxFrameWritten);
+		return SYSTEM_TASK_SUCCESS;
 	} 
 	else // if (MODULATION_FSK == radioConfiguration.modulation)
 	{
@@ -604,6 +607,24 @@ SYSTEM_TaskStatus_t RADIO_TxHandler(void)
                 & REG_DIOMAPPING2_DIO_BITMASK));
 	}
 
+	return RADIO_TxStartHandler();
+}
+
+/*********************************************************************//**
+\brief	This function starts the transmission of the frame written into
+		the FIFO.
+
+\param 	- none
+\return	- returns the success or failure of a task
+*************************************************************************/
+SYSTEM_TaskStatus_t RADIO_TxStartHandler(void)
+{
+	// The transmission may have been given up while the frame was written
+	if (RADIO_STATE_TX != RADIO_GetState())
+	{
+		return SYSTEM_TASK_SUCCESS;
+	}
+
 	/****************************************************************************/
 	/*  Non blocking switch. We don't really care when it starts transmitting.  */
 	/*	If accurate timing of the time on air is required, the simplest way to	*/
@@ -625,6 +646,18 @@ SYSTEM_TaskStatus_t RADIO_TxHandler(void)
 	return SYSTEM_TASK_SUCCESS;
 }
 
+/*********************************************************************//**
+\brief	This function is called by the hal when the frame is in the FIFO,
+		from the DMAC interrupt.
+
+\param 	- none
+\return	- none
+*************************************************************************/
+static void Radio_TxFrameWritten(void)
+{
+	radioPostTask(RADIO_TX_START_TASK_ID);
+}
+
 /*********************************************************************//**
 \brief	This function receives the data and stores it in the buffer
 		pointer space by doing a task post to the RADIO_RxHandler.
@@ -691,16 +724,24 @@ SYSTEM_TaskStatus_t RADIO_RxHandler(void)
     }
 
     // Will use non blocking switches to RadioSetMode. We don't really care
-    // when it starts receiving.
+    // when it starts receiving. In LoRa the wideband RSSI is sampled for
+    // the random generator once the receiver is up.
     if (0 == rxWindowSize)
     {
-        Radio_WriteMode(MODE_RXCONT, radioConfiguration.modulation, 0);
+        if (MODULATION_LORA == radioConfiguration.modulation)
+        {
+            Radio_WriteModeAsync(MODE_RXCONT, MODULATION_LORA, Radio_RxEntropySample);
+        }
+        else
+        {
+            Radio_WriteMode(MODE_RXCONT, radioConfiguration.modulation, 0);
+        }
     }
     else
     {
         if (MODULATION_LORA == radioConfiguration.modulation)
         {
-            Radio_WriteMode(MODE_RXSINGLE, MODULATION_LORA, 0);
+            Radio_WriteModeAsync(MODE_RXSINGLE, MODULATION_LORA, Radio_RxEntropySample);
         }
         else
         {
@@ -731,6 +772,7 @@ SYSTEM_TaskStatus_t RADIO_TxDoneHandler(void)
         radioEvents.TxWatchdogTimoutEvent = 0;
         Radio_WriteMode(MODE_STANDBY, radioConfiguration.modulation, 1);
         RadioCallbackParam.TX.timeOnAir = radioConfiguration.watchdogTimerTimeout;
+        RadioCallbackParam.TX.txDoneTime = SwTimerGetTime();
 		RadioCallbackParam.status = ERR_NONE;
         Radio_WriteMode(MODE_SLEEP, radioConfiguration.modulation, 0);
 		RadioSetState(RADIO_STATE_IDLE);
@@ -751,6 +793,7 @@ SYSTEM_TaskStatus_t RADIO_TxDoneHandler(void)
         radioEvents.LoraTxDoneEvent = 0;
         radioEvents.FskTxDoneEvent = 0;
         RadioCallbackParam.TX.timeOnAir = (uint32_t) timeOnAir;
+        RadioCallbackParam.TX.txDoneTime = txDoneTime;
 		RadioCallbackParam.status = ERR_NONE;
         Radio_WriteMode(MODE_SLEEP, radioConfiguration.modulation, 0);
 		//Powering Off the Oscillator after putting TRX to sleep
@@ -959,6 +1002,8 @@ void RADIO_FSKSyncAddr(void)
 		//Clear the FSK length and index variables
 		radioConfiguration.dataBufferLen = 0;
 		radioConfiguration.fskPayloadIndex = 0;
+		// The receiver is still on, the RSSI is live
+		Radio_HarvestEntropy(RADIO_RegisterRead(REG_FSK_RSSIVALUE));
 	}
 	cpu_irq_leave_critical();
 }
@@ -1065,7 +1110,8 @@ void RADIO_TxDone(void)
         radioEvents.LoraTxDoneEvent = 1;
         radioPostTask(RADIO_TX_DONE_TASK_ID);
        
-        timeOnAir = US_TO_MS(SwTimerGetTime() - timeOnAir);
+        txDoneTime = SwTimerGetTime();
+        timeOnAir = US_TO_MS(txDoneTime - timeOnAir);
     }
 }
 
@@ -1091,7 +1137,8 @@ void RADIO_FSKPacketSent(void)
 		
         if ((RADIO_GetState() == RADIO_STATE_TX) || (0 == radioEvents.RxWatchdogTimoutEvent))
         {
-			timeOnAir =  US_TO_MS(SwTimerGetTime() - timeOnAir);
+			txDoneTime = SwTimerGetTime();
+			timeOnAir =  US_TO_MS(txDoneTime - timeOnAir);
 			radioPostTask(RADIO_TX_DONE_TASK_ID);
             radioEvents.FskTxDoneEvent = 1;
         }
@@ -1357,20 +1404,17 @@ static void Radio_ReadPktRssi(void)
 }
 
 /*********************************************************************//**
-\brief	This function checks whether the configured channel is free 
-		by reading the RSSI at a particular frequency and comparing 
-		that with lbtThreshold
+\brief	This function starts the scan of the configured channel before
+		a transmission. The radio is switched to FSK receive without
+		waiting, Radio_ChannelScan samples the RSSI once it is ready.
 *************************************************************************/
-static bool Radio_IsChannelFree(void)
+static void Radio_StartChannelScan(void)
 {
 	uint16_t lbtScanPeriod = radioConfiguration.lbt.params.lbtScanPeriod;
 	
 	//50uS for reading a single RSSI sample
 	radioConfiguration.lbt.params.lbtNumOfSamples = MS_TO_US(lbtScanPeriod) / 50;
 
-	//Power on the Oscillator before putting the radio to receive state
-	Radio_SetClockInput();
-	
 	// Turn on the RF switch.
 	Radio_EnableRfControl(RADIO_RFCTRL_RX);
 
@@ -1386,9 +1430,27 @@ static bool Radio_IsChannelFree(void)
 	/* Write Bandwidth as 200KHz to read RSSI throughout channel bandwidth */
 	RADIO_RegisterWrite(REG_FSK_RXBW, FSKBW_200_0KHZ);
 	
-	/* Put radio to RX Continuous mode */
-	Radio_WriteMode(MODE_RXCONT, MODULATION_FSK, BLOCKING_REQ);
-	
+	/* Put radio to RX Continuous mode, the scan resumes on ModeReady */
+	Radio_WriteModeAsync(MODE_RXCONT, MODULATION_FSK, Radio_ChannelScan);
+}
+
+/*********************************************************************//**
+\brief	This function checks whether the configured channel is free 
+		by reading the RSSI at a particular frequency and comparing 
+		that with lbtThreshold. The transmission goes on if it is,
+		else it is reported as ERR_CHANNEL_BUSY.
+*************************************************************************/
+static void Radio_ChannelScan(void)
+{
+	bool channelFree = true;
+
+	// The transmission may have been given up while the radio was switched
+	if (RADIO_STATE_TX != RADIO_GetState())
+	{
+		Radio_EnableInterruptLines();
+		return;
+	}
+
 	/* Check the channel freeness for lbtScanPeriod */
 	for(uint8_t i = 0; i < radioConfiguration.lbt.params.lbtNumOfSamples; i++) 
 	{
@@ -1398,14 +1460,48 @@ static bool Radio_IsChannelFree(void)
 		 /* Inform the upper layer immediately if Inst RSSI is greater than RSSI Threshold*/
 		 if (instRSSI > radioConfiguration.lbt.params.lbtThreshold)
 		 {
-			 /* Enable all the interrupt lines back */
-			 Radio_EnableInterruptLines();
-			 return false;
+			 channelFree = false;
+			 break;
 		 }
 	}
 	/* Enable all the interrupt lines back */
 	Radio_EnableInterruptLines();
-	return true;	
+
+	if (channelFree)
+	{
+		lbtChannelClear = true;
+		radioPostTask(RADIO_TX_TASK_ID);
+		return;
+	}
+
+	// Turning off the RF switch now.
+	Radio_DisableRfControl(RADIO_RFCTRL_RX);
+	//Powering Off the Oscillator after putting TRX to sleep
+	Radio_ResetClockInput();
+	
+	RadioCallbackParam_t RadioCallbackParam;
+	RadioCallbackParam.status = ERR_CHANNEL_BUSY;
+	RadioSetState(RADIO_STATE_IDLE);
+	if (1 == radioCallbackMask.BitMask.radioTxDoneCallback)
+	{
+		if (radioConfiguration.radioCallback)
+		{
+			radioConfiguration.radioCallback(RADIO_TX_DONE_CALLBACK, (void *) &(RadioCallbackParam));
+		}
+	}
+}
+
+/*********************************************************************//**
+\brief	This function adds the wideband RSSI to the entropy pool once a
+		LoRa receive window is open, if the window has not ended yet.
+*************************************************************************/
+static void Radio_RxEntropySample(void)
+{
+	if ((RADIO_STATE_RX == RADIO_GetState()) &&
+		(0 == radioEvents.LoraRxDoneEvent) && (0 == radioEvents.LoraRxTimoutEvent))
+	{
+		Radio_HarvestEntropy(RADIO_RegisterRead(REG_LORA_RSSIWIDEBAND));
+	}
 }
 
 /*********************************************************************//**
@@ -104,6 +104,29 @@ extern "C" {
 #ifndef RSSI_LF_OFFSET
 #define RSSI_LF_OFFSET				-164
 #endif
+// Longest wait for ModeReady in a blocking mode switch
+#ifndef RADIO_MODE_READY_TIMEOUT_US
+#define RADIO_MODE_READY_TIMEOUT_US	1000
+#endif
+// Interval between two reads of ModeReady
+#define RADIO_MODE_READY_POLL_US	10
+// Interval between two reads of ModeReady in Radio_WriteModeAsync, from the
+// timer task. Not below SWTIMER_MIN_TIMEOUT
+#define RADIO_MODE_READY_TIMER_US	300
+// Harvested RSSI samples counted as one bit of entropy. Close samples are
+// correlated and a received frame drives the RSSI, so only a share counts.
+#ifndef RADIO_ENTROPY_SAMPLES_PER_BIT
+#define RADIO_ENTROPY_SAMPLES_PER_BIT	4
+#endif
+// Bits of entropy harvested that reseed the random generator
+#ifndef RADIO_ENTROPY_RESEED_BITS
+#define RADIO_ENTROPY_RESEED_BITS	128
+#endif
+// Bits of entropy harvested that reseed the random generator the first
+// time. The cold seed is a single RADIO_ReadRandom, 16 samples in 16 ms.
+#ifndef RADIO_ENTROPY_SEED_BITS
+#define RADIO_ENTROPY_SEED_BITS		32
+#endif
 
 /************************************************************************/
 /* Types                                                                */
@@ -126,13 +149,25 @@ extern RadioConfiguration_t radioConfiguration;
 RadioError_t Radio_ReadLoraRssi(int16_t *rssi);
 
 /*********************************************************************//**
-\brief This function reads the RSSI value for FSK.
+\brief This function reads the RSSI value for FSK. The LBT scans call it
+		with the receiver on, so the value is harvested as entropy.
 
 \param rssi	- The RSSI measured in the channel.
 \return		- ERR_NONE. Other types are not used now.
 *************************************************************************/
 RadioError_t Radio_ReadFSKRssi(int16_t *rssi);
 
+/*********************************************************************//**
+\brief This function adds a noisy radio measurement to the entropy pool
+		of the random generator. It must only be called while the receiver
+		samples the channel, it can be called from interrupt context.
+
+\param sample	- The raw register value, RADIO_ENTROPY_SAMPLES_PER_BIT
+				  LSBs are counted as one bit.
+\return			- none.
+*************************************************************************/
+void Radio_HarvestEntropy(uint8_t sample);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -43,7 +43,12 @@
 /* ! \name Configuration for SAML21, SAMR34 */
 /* ! @{ */
 #if (SAML21 || SAMR30 || SAMR34)
+/* TC0 runs in 32-bit mode, TC1 is its slave and cannot be used alone */
 #define TIMER      (TC0)
+
+/* 16 MHz GCLK divided by 16 gives the 1 MHz software timer tick */
+#define SWTIMER_GCLK_GENERATOR     GCLK_GENERATOR_2
+#define SWTIMER_TC_PRESCALER       TC_CLOCK_PRESCALER_DIV16
 #endif
 /* ! @} */
 
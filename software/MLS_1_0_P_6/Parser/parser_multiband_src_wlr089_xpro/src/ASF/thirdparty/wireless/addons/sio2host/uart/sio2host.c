@@ -40,6 +40,16 @@
 
 /* === MACROS ============================================================== */
 
+#define SERIAL_RX_BUF_MASK_HOST    (SERIAL_RX_BUF_SIZE_HOST - 1)
+
+#if (SERIAL_RX_BUF_SIZE_HOST & SERIAL_RX_BUF_MASK_HOST)
+#error "SERIAL_RX_BUF_SIZE_HOST must be a power of two"
+#endif
+
+/* Receive positions following a silence that can wait for the reader */
+#define SERIAL_RX_GAP_MARKS        4
+#define SERIAL_RX_GAP_MARKS_MASK   (SERIAL_RX_GAP_MARKS - 1)
+
 /* === PROTOTYPES ========================================================== */
 
 /* === GLOBALS ========================================================== */
@@ -61,26 +71,122 @@ static usart_serial_options_t usart_serial_options = {
 static uint8_t serial_rx_buf[SERIAL_RX_BUF_SIZE_HOST];
 
 /**
- * Receive buffer head
+ * Receive buffer head, oldest unread byte
+ */
+static volatile uint16_t serial_rx_buf_head;
+
+/**
+ * Receive buffer tail, written by the receive interrupt only
+ */
+static volatile uint16_t serial_rx_buf_tail;
+
+/**
+ * Set by the receive interrupt at the end of a burst: a line feed was
+ * received or the buffer is half full
  */
-static uint8_t serial_rx_buf_head;
+static volatile bool serial_rx_burst_end;
 
 /**
- * Receive buffer tail
+ * Number of bytes dropped because the receive buffer was full
  */
-static uint8_t serial_rx_buf_tail;
+static volatile uint16_t serial_rx_overflow_count;
 
 /**
- * Number of bytes in receive buffer
+ * Set when every received byte ends a burst, for framed data without line
+ * feeds
  */
-static uint8_t serial_rx_count;
+static volatile bool serial_rx_wake_every_byte;
+
+/**
+ * Clock read by the receive interrupt when gaps are marked, NULL otherwise
+ */
+static volatile sio2host_clock_t serial_rx_clock;
+
+/**
+ * Silence that marks the next byte, in microseconds
+ */
+static uint32_t serial_rx_gap_us;
+
+/**
+ * Time the previous byte was received, read by the receive interrupt only
+ */
+static uint64_t serial_rx_last_time;
+
+/**
+ * Receive buffer positions of the bytes that follow a silence. The
+ * interrupt moves the tail, the reader the head, as for the buffer.
+ */
+static uint16_t serial_rx_gap_pos[SERIAL_RX_GAP_MARKS];
+static volatile uint8_t serial_rx_gap_head;
+static volatile uint8_t serial_rx_gap_tail;
+
+#if SAMD || SAMR21 || SAML21 || SAMR30 || SAMR34 || SAMR35 || (WLR089)
+/**
+ * Transmit buffer
+ * Filled by sio2host_tx and drained by the data register empty interrupt
+ */
+static uint8_t serial_tx_buf[SERIAL_TX_BUF_SIZE_HOST];
+
+/**
+ * Transmit buffer head, next byte to be sent by the interrupt
+ */
+static volatile uint16_t serial_tx_buf_head;
+
+/**
+ * Transmit buffer tail, next free position
+ */
+static volatile uint16_t serial_tx_buf_tail;
+
+/**
+ * Set when data was queued since the last flush
+ */
+static bool serial_tx_pending;
+#endif
 
 /* === IMPLEMENTATION ====================================================== */
 
+#if SAMD || SAMR21 || SAML21 || SAMR30 || SAMR34 || SAMR35 || (WLR089)
+/**
+ * \brief Checks if the data register empty interrupt can preempt the caller,
+ * which is not the case with interrupts masked or from an interrupt handler
+ */
+static inline bool sio2host_tx_irq_blocked(void)
+{
+	return (0 != __get_PRIMASK()) || (0 != __get_IPSR());
+}
+
+/**
+ * \brief Sends the oldest queued byte by polling, in place of the data
+ * register empty interrupt
+ */
+static void sio2host_tx_poll_byte(void)
+{
+	uint16_t head;
+
+	cpu_irq_enter_critical();
+	head = serial_tx_buf_head;
+	if (head != serial_tx_buf_tail) {
+		while (!(USART_HOST->USART.INTFLAG.reg &
+				SERCOM_USART_INTFLAG_DRE)) {
+		}
+		USART_HOST->USART.DATA.reg = serial_tx_buf[head];
+		head++;
+		if (SERIAL_TX_BUF_SIZE_HOST == head) {
+			head = 0;
+		}
+		serial_tx_buf_head = head;
+	}
+	cpu_irq_leave_critical();
+}
+#endif
+
 void sio2host_init(void)
 {
 #if SAMD || SAMR21 || SAML21 || SAMR30 || SAMR34 || SAMR35  || (WLR089)
 	struct usart_config host_uart_config;
+	serial_tx_buf_head = 0;
+	serial_tx_buf_tail = 0;
+	serial_tx_pending = false;
 	/* Configure USART for unit test output */
 	usart_get_config_defaults(&host_uart_config);
 	host_uart_config.mux_setting = HOST_SERCOM_MUX_SETTING;
@@ -103,6 +209,8 @@ void sio2host_init(void)
 void sio2host_deinit(void)
 {
 #if SAMD || SAMR21 || SAML21 || SAMR30 || SAMR34 || SAMR35 || (WLR089)	
+		/* Do not cut the replies still queued for transmission */
+		sio2host_tx_flush();
 		usart_disable(&host_uart_module);
 	
 		/* Disable transceivers */
@@ -110,20 +218,72 @@ void sio2host_deinit(void)
 		usart_disable_transceiver(&host_uart_module, USART_TRANSCEIVER_RX);
 #endif	
 }
+#if SAMD || SAMR21 || SAML21 || SAMR30 || SAMR34 || SAMR35 || (WLR089)
 uint8_t sio2host_tx(uint8_t *data, uint8_t length)
 {
-#if SAMD || SAMR21 || SAML21 || SAMR30 || SAMR34 || SAMR35 || (WLR089)
-	status_code_genare_t status;
+	uint16_t tail = serial_tx_buf_tail;
+	uint16_t next_tail;
+	uint8_t remaining = length;
+
+	while (remaining > 0) {
+		next_tail = tail + 1;
+		if (SERIAL_TX_BUF_SIZE_HOST == next_tail) {
+			next_tail = 0;
+		}
+
+		/*
+		 * Buffer full: wait for the interrupt to make room. This only
+		 * happens when replies are produced faster than the wire rate.
+		 * When the interrupt cannot run, make room by polling instead
+		 * of waiting forever.
+		 */
+		while (next_tail == serial_tx_buf_head) {
+			if (sio2host_tx_irq_blocked()) {
+				sio2host_tx_poll_byte();
+			} else {
+				USART_HOST->USART.INTENSET.reg = SERCOM_USART_INTFLAG_DRE;
+			}
+		}
+
+		serial_tx_buf[tail] = *data++;
+		tail = next_tail;
+		serial_tx_buf_tail = tail;
+		remaining--;
+	}
+
+	/* Let the data register empty interrupt send the queued bytes */
+	serial_tx_pending = true;
+	USART_HOST->USART.INTENSET.reg = SERCOM_USART_INTFLAG_DRE;
+
+	return length;
+}
+
+void sio2host_tx_flush(void)
+{
+	if (!serial_tx_pending) {
+		return;
+	}
+
+	/* Wait until the buffer is drained and the last byte left the shifter */
+	while (serial_tx_buf_head != serial_tx_buf_tail) {
+		if (sio2host_tx_irq_blocked()) {
+			sio2host_tx_poll_byte();
+		}
+	}
+	if (USART_HOST->USART.CTRLA.reg & SERCOM_USART_CTRLA_ENABLE) {
+		while (!(USART_HOST->USART.INTFLAG.reg &
+				SERCOM_USART_INTFLAG_TXC)) {
+		}
+	}
+	serial_tx_pending = false;
+}
 #else
+uint8_t sio2host_tx(uint8_t *data, uint8_t length)
+{
 	status_code_t status;
-#endif /*SAMD || SAMR21 || SAML21 */
 
 	do {
-#if SAMD || SAMR21 || SAML21 || SAMR30 || SAMR34 || SAMR35 || (WLR089)
-		status
-			= usart_serial_write_packet(&host_uart_module,
-				(const uint8_t *)data, length);
-#elif SAM4S || SAM4E
+#if SAM4S || SAM4E
         status = usart_serial_write_packet((Usart *)USART_HOST,
 				(const uint8_t *)data,
 				length);
@@ -136,76 +296,108 @@ uint8_t sio2host_tx(uint8_t *data, uint8_t length)
 	return length;
 }
 
+void sio2host_tx_flush(void)
+{
+}
+#endif
+
 uint8_t sio2host_rx(uint8_t *data, uint8_t max_length)
 {
 	uint8_t data_received = 0;
-	if(serial_rx_buf_tail >= serial_rx_buf_head)
-	{
-		serial_rx_count = serial_rx_buf_tail - serial_rx_buf_head;
+	uint16_t head = serial_rx_buf_head;
+	uint16_t tail = serial_rx_buf_tail;
+
+	/*
+	 * The interrupt never overwrites unread data, the number of bytes
+	 * available is simply the distance between head and tail.
+	 */
+	while ((head != tail) && (data_received < max_length)) {
+		*data++ = serial_rx_buf[head];
+		head = (head + 1) & SERIAL_RX_BUF_MASK_HOST;
+		data_received++;
 	}
-	else
-	{
-		serial_rx_count = serial_rx_buf_tail + (SERIAL_RX_BUF_SIZE_HOST - serial_rx_buf_head);
+	serial_rx_buf_head = head;
+
+	return data_received;
+}
+
+uint16_t sio2host_rx_peek(uint8_t **data)
+{
+	uint16_t head = serial_rx_buf_head;
+	uint16_t tail = serial_rx_buf_tail;
+	uint8_t gap = serial_rx_gap_head;
+
+	*data = &serial_rx_buf[head];
+
+	/* Stop at the next byte that follows a silence, so that the reader
+	 * sees it through sio2host_rx_gap before taking it */
+	if ((gap != serial_rx_gap_tail) && (serial_rx_gap_pos[gap] == head)) {
+		gap = (gap + 1) & SERIAL_RX_GAP_MARKS_MASK;
 	}
-	
-	if (0 == serial_rx_count) {
-		return 0;
+	if ((gap != serial_rx_gap_tail) &&
+			(((serial_rx_gap_pos[gap] - head) & SERIAL_RX_BUF_MASK_HOST) <=
+			((tail - head) & SERIAL_RX_BUF_MASK_HOST))) {
+		tail = serial_rx_gap_pos[gap];
 	}
 
-	if (SERIAL_RX_BUF_SIZE_HOST <= serial_rx_count) {
-		/*
-		 * Bytes between head and tail are overwritten by new data.
-		 * The oldest data in buffer is the one to which the tail is
-		 * pointing. So reading operation should start from the tail.
-		 */
-		serial_rx_buf_head = serial_rx_buf_tail;
+	/* Only the span up to the end of the buffer is contiguous; the rest is
+	 * returned by the next call once this span has been released. */
+	if (tail >= head) {
+		return tail - head;
+	}
+	return SERIAL_RX_BUF_SIZE_HOST - head;
+}
 
-		/*
-		 * This is a buffer overflow case. But still only the number of
-		 * bytes equivalent to
-		 * full buffer size are useful.
-		 */
-		serial_rx_count = SERIAL_RX_BUF_SIZE_HOST;
-
-		/* Bytes received is more than or equal to buffer. */
-		if (SERIAL_RX_BUF_SIZE_HOST <= max_length) {
-			/*
-			 * Requested receive length (max_length) is more than
-			 * the
-			 * max size of receive buffer, but at max the full
-			 * buffer can be read.
-			 */
-			max_length = SERIAL_RX_BUF_SIZE_HOST;
-		}
-	} else {
-		/* Bytes received is less than receive buffer maximum length. */
-		if (max_length > serial_rx_count) {
-			/*
-			 * Requested receive length (max_length) is more than
-			 * the data
-			 * present in receive buffer. Hence only the number of
-			 * bytes
-			 * present in receive buffer are read.
-			 */
-			max_length = serial_rx_count;
-		}
+void sio2host_rx_release(uint16_t length)
+{
+	serial_rx_buf_head = (serial_rx_buf_head + length) &
+			SERIAL_RX_BUF_MASK_HOST;
+}
+
+bool sio2host_rx_burst_ended(void)
+{
+	if (!serial_rx_burst_end) {
+		return false;
 	}
 
-	data_received = max_length;
-	while (max_length > 0) {
-		/* Start to copy from head. */
-		*data = serial_rx_buf[serial_rx_buf_head];
-		data++;
-		max_length--;
-		if ((SERIAL_RX_BUF_SIZE_HOST - 1) == serial_rx_buf_head) {
-			serial_rx_buf_head = 0;
-		}
-		else
-		{
-			serial_rx_buf_head++;
-		}
+	serial_rx_burst_end = false;
+	return true;
+}
+
+bool sio2host_rx_burst_pending(void)
+{
+	return serial_rx_burst_end;
+}
+
+void sio2host_rx_wake_every_byte(bool enable)
+{
+	serial_rx_wake_every_byte = enable;
+}
+
+void sio2host_rx_mark_gaps(sio2host_clock_t clock, uint32_t gap_us)
+{
+	serial_rx_clock = NULL;
+	serial_rx_gap_us = gap_us;
+	serial_rx_gap_head = serial_rx_gap_tail;
+	serial_rx_clock = clock;
+}
+
+bool sio2host_rx_gap(void)
+{
+	uint8_t gap = serial_rx_gap_head;
+
+	if ((gap == serial_rx_gap_tail) ||
+			(serial_rx_gap_pos[gap] != serial_rx_buf_head)) {
+		return false;
 	}
-	return data_received;
+
+	serial_rx_gap_head = (gap + 1) & SERIAL_RX_GAP_MARKS_MASK;
+	return true;
+}
+
+uint16_t sio2host_rx_overflow_count(void)
+{
+	return serial_rx_overflow_count;
 }
 
 uint8_t sio2host_getchar(void)
@@ -240,35 +432,90 @@ USART_HOST_ISR_VECT()
 {
 	uint8_t temp;
 #if SAMD || SAMR21 || SAML21 || SAMR30 || SAMR34 || SAMR35 || WLR089
-	usart_serial_read_packet(&host_uart_module, &temp, 1);
+	uint8_t int_flags = USART_HOST->USART.INTFLAG.reg &
+			USART_HOST->USART.INTENSET.reg;
+
+	if (int_flags & SERCOM_USART_INTFLAG_DRE) {
+		uint16_t head = serial_tx_buf_head;
+
+		if (head == serial_tx_buf_tail) {
+			/* Nothing left to send */
+			USART_HOST->USART.INTENCLR.reg = SERCOM_USART_INTFLAG_DRE;
+		} else {
+			USART_HOST->USART.DATA.reg = serial_tx_buf[head];
+			head++;
+			if (SERIAL_TX_BUF_SIZE_HOST == head) {
+				head = 0;
+			}
+			serial_tx_buf_head = head;
+		}
+	}
+
+	if (!(int_flags & SERCOM_USART_INTFLAG_RXC)) {
+		return;
+	}
+
+	/* Reading the data register clears RXC, no need to go through the driver */
+	temp = (uint8_t)USART_HOST->USART.DATA.reg;
 #elif SAM4E || SAM4S
 	usart_serial_read_packet((Usart *)USART_HOST, &temp, 1);
 #else
     usart_serial_read_packet(USART_HOST, &temp, 1);
 #endif
 
-	/* Introducing critical section to avoid buffer corruption. */
-	cpu_irq_disable();
+	/*
+	 * The main loop only moves the head, the interrupt only moves the
+	 * tail, so no critical section is needed. When the buffer is full
+	 * the new byte is dropped and counted instead of overwriting data
+	 * that has not been read yet.
+	 */
+	uint16_t tail = serial_rx_buf_tail;
+	uint16_t next_tail = (tail + 1) & SERIAL_RX_BUF_MASK_HOST;
+
+	if (next_tail == serial_rx_buf_head) {
+		serial_rx_overflow_count++;
+		serial_rx_burst_end = true;
+		return;
+	}
 
-	/* The number of data in the receive buffer is incremented and the
-	 * buffer is updated. */
+	/* Time the byte now rather than when it is read, the reader may be
+	 * kept away for longer than the silence it has to detect */
+	sio2host_clock_t clock = serial_rx_clock;
 
-	serial_rx_buf[serial_rx_buf_tail] = temp;
+	if (NULL != clock) {
+		uint64_t now = clock();
 
-	if ((SERIAL_RX_BUF_SIZE_HOST - 1) == serial_rx_buf_tail) {
-		/* Reached the end of buffer, revert back to beginning of
-		 * buffer. */
-		serial_rx_buf_tail = 0x00;
-	} else {
-		serial_rx_buf_tail++;
+		if ((now - serial_rx_last_time) > serial_rx_gap_us) {
+			uint8_t gap_tail = serial_rx_gap_tail;
+			uint8_t gap_next = (gap_tail + 1) & SERIAL_RX_GAP_MARKS_MASK;
+
+			/* Marks full: the newest one moves here, so the frame
+			 * being received still starts clean */
+			if (gap_next == serial_rx_gap_head) {
+				gap_next = gap_tail;
+				gap_tail = (gap_tail - 1) & SERIAL_RX_GAP_MARKS_MASK;
+			}
+			serial_rx_gap_pos[gap_tail] = tail;
+			serial_rx_gap_tail = gap_next;
+		}
+		serial_rx_last_time = now;
 	}
 
-	cpu_irq_enable();
+	serial_rx_buf[tail] = temp;
+	serial_rx_buf_tail = next_tail;
+
+	/* Wake the reader once per line or when the buffer fills up */
+	if (serial_rx_wake_every_byte || ('\n' == temp) ||
+			(((next_tail - serial_rx_buf_head) &
+			SERIAL_RX_BUF_MASK_HOST) >= (SERIAL_RX_BUF_SIZE_HOST / 2))) {
+		serial_rx_burst_end = true;
+	}
 }
 
 void sio2host_disable(void)
 {
 #if SAMD || SAMR21 || SAML21 || SAMR30 || SAMR34 || SAMR35 || (WLR089) 
+	sio2host_tx_flush();
 	usart_disable(&host_uart_module);
 #endif
 }
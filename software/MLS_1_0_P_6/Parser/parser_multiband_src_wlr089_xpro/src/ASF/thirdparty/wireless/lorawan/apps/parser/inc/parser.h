@@ -78,6 +78,8 @@ void Parser_GetSwVersion(char* pBuffData);
 uint8_t Parser_GetConfiguredJoinParameters(void);
 void Parser_SetConfiguredJoinParameters(uint8_t val);
 void parser_serial_data_handler(void);
+void Parser_LoraEvtProcess(void);
+uint16_t Parser_LoraEvtOverflowCount(void);
 
 
 #endif /* _PARSER_H */
\ No newline at end of file
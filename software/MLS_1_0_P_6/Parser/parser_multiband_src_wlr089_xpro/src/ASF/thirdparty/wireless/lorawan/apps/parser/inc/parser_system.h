@@ -40,14 +40,41 @@
 
 
 #include "parser_private.h"
+#include "system_task_manager.h"
+#include "sw_timer.h"
+#if (ENABLE_PDS == 1)
+#include "pds_interface.h"
+#endif
+#include "radio_driver_hal.h"
 
 void Parser_SystemGetVer(parserCmdInfo_t* pParserCmdInfo);
 void Parser_SystemReboot(parserCmdInfo_t* pParserCmdInfo);
 #ifdef CONF_PMM_ENABLE
 void Parser_SystemSleep(parserCmdInfo_t* pParserCmdInfo);
+void Parser_SystemSetIdle(parserCmdInfo_t* pParserCmdInfo);
+void Parser_SystemGetIdle(parserCmdInfo_t* pParserCmdInfo);
+void Parser_SystemGetIdleRatio(parserCmdInfo_t* pParserCmdInfo);
+void Parser_SystemIdle(void);
 #endif /* #ifdef CONF_PMM_ENABLE */
 void configure_extint(void);
 void configure_eic_callback(void);
 void Parser_SystemFactReset(parserCmdInfo_t* pParserCmdInfo);
+void Parser_SystemSetProtocol(parserCmdInfo_t* pParserCmdInfo);
+#if (SYSTEM_TASK_STATS == 1)
+void Parser_SystemGetTaskStats(parserCmdInfo_t* pParserCmdInfo);
+void Parser_SystemSetTaskStats(parserCmdInfo_t* pParserCmdInfo);
+#endif
+void Parser_SystemGetTimerWakeups(parserCmdInfo_t* pParserCmdInfo);
+void Parser_SystemGetHostStats(parserCmdInfo_t* pParserCmdInfo);
+#if (SWTIMER_STATS == 1)
+void Parser_SystemGetTimerStats(parserCmdInfo_t* pParserCmdInfo);
+void Parser_SystemGetTimerLateness(parserCmdInfo_t* pParserCmdInfo);
+#endif
+#if (ENABLE_PDS == 1) && (PDS_STATS == 1)
+void Parser_SystemGetPdsStats(parserCmdInfo_t* pParserCmdInfo);
+#endif
+#if (RADIO_SPI_STATS == 1)
+void Parser_SystemGetRadioSpiStats(parserCmdInfo_t* pParserCmdInfo);
+#endif
 
 #endif /* _PARSER_SYSTEM_H */
\ No newline at end of file
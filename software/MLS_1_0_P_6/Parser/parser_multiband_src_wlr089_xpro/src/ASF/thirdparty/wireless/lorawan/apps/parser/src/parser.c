@@ -57,23 +57,13 @@
 #define HW_STR			   "USER BOARD"
 #endif
 
-typedef struct parserRxCmd_tag
-{
-    char cmd[PARSER_DEF_CMD_MAX_LEN];
-    uint16_t wordLen[PARSER_DEF_CMD_MAX_IDX];
-    uint16_t wordStartPos[PARSER_DEF_CMD_MAX_IDX];
-    uint8_t bCmdStatus;
-    uint8_t crtWordIdx;
-    uint16_t crtCmdPos;
-    uint16_t crtWordPos;
-}parserRxCmd_t;
-
-static uint8_t Parser_ProcessCmd(const parserCmdEntry_t* pParserCmd, uint8_t nbParserCmd, uint8_t rxCmdIdx,
-                                 uint8_t* pSavedCmdIdx);
+static uint8_t Parser_ProcessCmd(const parserRxCmd_t* pRxCmd, const parserCmdEntry_t* pParserCmd,
+                                 uint8_t nbParserCmd, uint8_t rxCmdIdx, uint8_t* pSavedCmdIdx);
+static bool Parser_RxDrain(void);
+static const parserCmdEntry_t* Parser_FindCmd(const parserCmdEntry_t* pParserCmd, uint8_t nbParserCmd,
+                                              const char* pWord, uint8_t* pCmdIdx);
 
 
-extern volatile parserRxCmd_t mRxParserCmd;
-
 static const char* gapParserStatus[] =
 {
     "ok",
@@ -85,15 +75,46 @@ char aParserData[PARSER_MAX_DATA_LEN];
 
 void parser_serial_data_handler(void)
 {
-    int rxChar;
-   /* verify if there was any character received*/
-    if((-1) != (rxChar = sio2host_getchar_nowait()))
+   /* verify if a burst of characters (a whole line, or any byte in binary mode) was received */
+    if(sio2host_rx_burst_ended() && Parser_RxDrain())
     {
-        Parser_RxAddChar( (uint8_t)rxChar );
         SYSTEM_PostTask(APP_TASK_ID);
     }
 }
 
+/* Feeds the received bytes to the tokenizer straight from the sio2host buffer.
+ * Stops when there is no data left or the command queue is full. */
+static bool Parser_RxDrain(void)
+{
+    uint8_t* pRxData;
+    uint16_t rxLen;
+    uint16_t consumed;
+    bool bDataConsumed = false;
+
+    while(true)
+    {
+        /* Spans never cross a silence, which only binary frames care about */
+        if(sio2host_rx_gap())
+        {
+            Parser_RxDropFrame();
+        }
+        rxLen = sio2host_rx_peek(&pRxData);
+        if(rxLen == 0U)
+        {
+            break;
+        }
+        consumed = Parser_RxAddChunk(pRxData, rxLen);
+        if(consumed == 0U)
+        {
+            break;
+        }
+        sio2host_rx_release(consumed);
+        bDataConsumed = true;
+    }
+
+    return bDataConsumed;
+}
+
 void Parser_Init(void)
 {
     Parser_RxClearBuffer();
@@ -112,29 +133,27 @@ void Parser_Main (void)
     const parserCmdEntry_t* pStartCmd = gpParserStartCmd;
     uint8_t crtWordIdx;
     uint8_t savedCmdIdx;
-    parserCmdEntry_t tempCmd;
+    const parserCmdEntry_t* pTempCmd;
+    parserRxCmd_t* pRxCmd;
 
     /* verify if there was any character received */
-    int rxChar;
-    while((-1) != (rxChar = sio2host_getchar_nowait()))
-    {
-        Parser_RxAddChar( (uint8_t)rxChar );
-    }
+    (void)Parser_RxDrain();
 
-    /* Verify if an entire command is received */
-    if(mRxParserCmd.bCmdStatus)
+    /* Execute the oldest command line waiting in the queue */
+    pRxCmd = Parser_RxGetCmd();
+    if(pRxCmd != NULL)
     {
-        cmdTotalNb = mRxParserCmd.crtWordIdx + 1;
+        cmdTotalNb = pRxCmd->crtWordIdx + 1;
         crtWordIdx = 0;
 
         while(cmdTotalNb)
         {
-            if(Parser_ProcessCmd(pStartCmd, startCmdSize, crtWordIdx, &savedCmdIdx))
+            if(Parser_ProcessCmd(pRxCmd, pStartCmd, startCmdSize, crtWordIdx, &savedCmdIdx))
             {
                 /* Further processing is needed, continue with group commands */
-                tempCmd = *(pStartCmd + savedCmdIdx);
-                startCmdSize = tempCmd.nextParserCmdSize;
-                pStartCmd = tempCmd.pNextParserCmd;
+                pTempCmd = pStartCmd + savedCmdIdx;
+                startCmdSize = pTempCmd->nextParserCmdSize;
+                pStartCmd = pTempCmd->pNextParserCmd;
 
                 /* Process the next command */
                 crtWordIdx ++;
@@ -147,7 +166,14 @@ void Parser_Main (void)
             }
         }
 
-        Parser_RxClearBuffer();
+        Parser_RxReleaseCmd();
+
+        /* Let the other tasks run before the next queued line is executed */
+        (void)Parser_RxDrain();
+        if(Parser_RxGetCmd() != NULL)
+        {
+            SYSTEM_PostTask(APP_TASK_ID);
+        }
     }
 
 }
@@ -167,82 +193,82 @@ void Parser_GetSwVersion(char* pBuffData)
     pBuffData[sizeof(HW_STR) + sizeof(VER_STR) + sizeof(__DATE__) + sizeof(__TIME__)] = '\0';
 }
 
-static uint8_t Parser_ProcessCmd(const parserCmdEntry_t* pParserCmd, uint8_t nbParserCmd, uint8_t rxCmdIdx,
-                                 uint8_t* pSavedCmdIdx)
+static uint8_t Parser_ProcessCmd(const parserRxCmd_t* pRxCmd, const parserCmdEntry_t* pParserCmd,
+                                 uint8_t nbParserCmd, uint8_t rxCmdIdx, uint8_t* pSavedCmdIdx)
 {
     uint8_t cmdCtr;
     uint8_t retValue = 0x00U; /* Consider returning error by default */
     parserCmdInfo_t parserCmdInfo;
-    parserCmdEntry_t parserCmdEntry;
+    const parserCmdEntry_t* pParserCmdEntry;
 
     parserCmdInfo.pReplyCmd = (char*)gapParserStatus[INVALID_PARAM_IDX]; /* Reply with error by default */;
 
     /* Validate and find the group command */
-    for(cmdCtr = 0; cmdCtr < nbParserCmd; cmdCtr ++)
-    {
-        parserCmdEntry = *(pParserCmd + cmdCtr);
-        if(strcmp(parserCmdEntry.pCommand, (char*)&mRxParserCmd.cmd[mRxParserCmd.wordStartPos[rxCmdIdx]]) == 0U)
-        {
-            /* Command found */
-            break;
-        }
-    }
+    pParserCmdEntry = Parser_FindCmd(pParserCmd, nbParserCmd,
+                                     (const char*)&pRxCmd->cmd[pRxCmd->wordStartPos[rxCmdIdx]], &cmdCtr);
 
-    if(cmdCtr < nbParserCmd)
+    if(pParserCmdEntry != NULL)
     {
-        if(parserCmdEntry.pNextParserCmd == NULL)
+        if(pParserCmdEntry->pNextParserCmd == NULL)
         {
             /* No other commands, just execute the callback */
-            if(parserCmdEntry.pActionCbFct)
+            if(pParserCmdEntry->pActionCbFct)
             {
-                if((mRxParserCmd.crtWordIdx - rxCmdIdx) == parserCmdEntry.flags)
+                if((pRxCmd->crtWordIdx - rxCmdIdx) == pParserCmdEntry->flags)
                 {
                     uint8_t iCtr = rxCmdIdx + 1;
                     bool bInvalidParam = false;
-                    if(parserCmdEntry.flags > 0)
+                    if(pParserCmdEntry->flags > 0)
                     {
                         do
                         {
                             //Make sure that the parameters are not empty
-                            if(mRxParserCmd.wordLen[iCtr ++] == 0)
+                            if(pRxCmd->wordLen[iCtr ++] == 0)
                             {
                                 bInvalidParam = true;
                                 break;
                             }
-                        }while(iCtr <= mRxParserCmd.crtWordIdx);
+                        }while(iCtr <= pRxCmd->crtWordIdx);
                     }
 
                     if(bInvalidParam == false)
                     {
                         memset(&parserCmdInfo, 0, sizeof(parserCmdInfo_t));
 
-                        if((rxCmdIdx + 1U < PARSER_DEF_CMD_MAX_IDX) && (mRxParserCmd.wordLen[rxCmdIdx + 1U] > 0U))
+                        if((rxCmdIdx + 1U < PARSER_DEF_CMD_MAX_IDX) && (pRxCmd->wordLen[rxCmdIdx + 1U] > 0U))
                         {
-                            parserCmdInfo.pParam1 = (char*)(&mRxParserCmd.cmd[mRxParserCmd.wordStartPos[rxCmdIdx + 1]]);
+                            parserCmdInfo.pParam1 = (char*)(&pRxCmd->cmd[pRxCmd->wordStartPos[rxCmdIdx + 1]]);
                         }
 
-                        if((rxCmdIdx + 2U < PARSER_DEF_CMD_MAX_IDX) && (mRxParserCmd.wordLen[rxCmdIdx + 2U] > 0U))
+                        if((rxCmdIdx + 2U < PARSER_DEF_CMD_MAX_IDX) && (pRxCmd->wordLen[rxCmdIdx + 2U] > 0U))
                         {
-                            parserCmdInfo.pParam2 = (char*)(&mRxParserCmd.cmd[mRxParserCmd.wordStartPos[rxCmdIdx + 2]]);
+                            parserCmdInfo.pParam2 = (char*)(&pRxCmd->cmd[pRxCmd->wordStartPos[rxCmdIdx + 2]]);
                         }
 
-                        if((rxCmdIdx + 3U < PARSER_DEF_CMD_MAX_IDX) && (mRxParserCmd.wordLen[rxCmdIdx + 3U] > 0U))
+                        if((rxCmdIdx + 3U < PARSER_DEF_CMD_MAX_IDX) && (pRxCmd->wordLen[rxCmdIdx + 3U] > 0U))
                         {
-                            parserCmdInfo.pParam3 = (char*)(&mRxParserCmd.cmd[mRxParserCmd.wordStartPos[rxCmdIdx + 3]]);
+                            parserCmdInfo.pParam3 = (char*)(&pRxCmd->cmd[pRxCmd->wordStartPos[rxCmdIdx + 3]]);
                         }
 
-                        if((rxCmdIdx + 4U < PARSER_DEF_CMD_MAX_IDX) && (mRxParserCmd.wordLen[rxCmdIdx + 4U] > 0U))
+                        if((rxCmdIdx + 4U < PARSER_DEF_CMD_MAX_IDX) && (pRxCmd->wordLen[rxCmdIdx + 4U] > 0U))
                         {
-                            parserCmdInfo.pParam4 = (char*)(&mRxParserCmd.cmd[mRxParserCmd.wordStartPos[rxCmdIdx + 4]]);
+                            parserCmdInfo.pParam4 = (char*)(&pRxCmd->cmd[pRxCmd->wordStartPos[rxCmdIdx + 4]]);
                         }
 
-                        if((rxCmdIdx + 5U < PARSER_DEF_CMD_MAX_IDX) && (mRxParserCmd.wordLen[rxCmdIdx + 5U] > 0U))
+                        if((rxCmdIdx + 5U < PARSER_DEF_CMD_MAX_IDX) && (pRxCmd->wordLen[rxCmdIdx + 5U] > 0U))
                         {
-                            parserCmdInfo.pParam5 = (char*)(&mRxParserCmd.cmd[mRxParserCmd.wordStartPos[rxCmdIdx + 5]]);
+                            parserCmdInfo.pParam5 = (char*)(&pRxCmd->cmd[pRxCmd->wordStartPos[rxCmdIdx + 5]]);
+                        }
+
+                        if(pRxCmd->binDataLen > 0U)
+                        {
+                            /* Raw last parameter of a binary frame */
+                            parserCmdInfo.pBinData = (uint8_t*)(&pRxCmd->cmd[pRxCmd->binDataPos]);
+                            parserCmdInfo.binDataLen = pRxCmd->binDataLen;
                         }
 
                         /* Execute callback */
-                        parserCmdEntry.pActionCbFct(&parserCmdInfo);
+                        pParserCmdEntry->pActionCbFct(&parserCmdInfo);
                     }
                 }
             }
@@ -265,3 +291,36 @@ static uint8_t Parser_ProcessCmd(const parserCmdEntry_t* pParserCmd, uint8_t nbP
     return retValue;
 }
 
+/* Binary search of pWord in a command table sorted in strcmp() order.
+ * Returns the matching entry (and its index in pCmdIdx) or NULL if not found. */
+static const parserCmdEntry_t* Parser_FindCmd(const parserCmdEntry_t* pParserCmd, uint8_t nbParserCmd,
+                                              const char* pWord, uint8_t* pCmdIdx)
+{
+    uint8_t low = 0U;
+    uint8_t high = nbParserCmd;
+    uint8_t mid;
+    int cmpResult;
+
+    while(low < high)
+    {
+        mid = (uint8_t)((low + high) >> 1);
+        cmpResult = strcmp(pWord, pParserCmd[mid].pCommand);
+
+        if(cmpResult == 0)
+        {
+            /* Command found */
+            *pCmdIdx = mid;
+            return &pParserCmd[mid];
+        }
+        else if(cmpResult < 0)
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1U;
+        }
+    }
+
+    return NULL;
+}
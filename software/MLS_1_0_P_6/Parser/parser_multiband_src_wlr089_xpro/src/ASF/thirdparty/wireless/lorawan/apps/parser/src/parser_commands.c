@@ -40,21 +40,26 @@
 #include "parser_lorawan.h"
 #include "parser_system.h"
 
+/*
+ * Every command table below must be kept sorted in strcmp() (byte) order,
+ * uppercase letters sorting before lowercase ones. Parser_ProcessCmd resolves
+ * each word of a command line with a binary search over these tables, so an
+ * entry placed out of order will never be matched.
+ */
 
 static const parserCmdEntry_t maParserLoraSetChCmd[] =
 {
+    {"drrange",       NULL,  Parser_LoraSetDatarateRange,    0,  3},
     {"freq",         NULL,   Parser_LoraSetChannelFreq,      0,  2},
     {"status",       NULL,   Parser_LoraSetChannelStatus,    0,  2},
-    {"drrange",       NULL,  Parser_LoraSetDatarateRange,    0,  3},
-
 };
 #define mParserLoraSetChCmdSize (sizeof(maParserLoraSetChCmd) / sizeof(maParserLoraSetChCmd[0]))
 
 static const parserCmdEntry_t maParserLoraGetChCmd[] =
 {
+    {"drrange",       NULL,  Parser_LoraGetDatarateRange,    0,  1},
     {"freq",         NULL,   Parser_LoraGetChannelFreq,      0,  1},
     {"status",       NULL,   Parser_LoraGetChannelStatus,    0,  1},
-    {"drrange",       NULL,  Parser_LoraGetDatarateRange,    0,  1},
 };
 #define mParserLoraGetChCmdSize (sizeof(maParserLoraGetChCmd) / sizeof(maParserLoraGetChCmd[0]))
 
@@ -72,144 +77,169 @@ static const parserCmdEntry_t maParserLoraGetSubBandCmd[] =
 
 static const parserCmdEntry_t maParserLoraSetCmd[] =
 {
-    {"dr",         NULL,   Parser_LoraSetCrtDataRate,      0,  1},
     {"adr",        NULL,   Parser_LoraSetAdr,              0,  1},
+    {"aggdcycle",         NULL,   Parser_LoraSetAggregatedDutyCycle,      0,  1},
+    {"appkey",          NULL,   Parser_LoraSetAppKey,       0,  1},
+    {"appskey",         NULL,   Parser_LoraSetAppSKey,      0,  1},
+    {"ar",         NULL,   Parser_LoraSetAutoReply,      0,  1},
+    {"bat",         NULL,   Parser_LoraSetBatLevel,      0,  1},
+    {"ch",     maParserLoraSetChCmd,  NULL,              mParserLoraSetChCmdSize,  0},
+    {"cryptodevenabled",         NULL,   Parser_LoraSetCryptoDevEnabled,      0,  1},
     {"devaddr",         NULL,   Parser_LoraSetDevAddr,      0,  1},
     {"deveui",          NULL,   Parser_LoraSetDevEui,       0,  1},
+    {"dnctr",         NULL,   Parser_LoraSetDownlinkCounter,      0,  1},
+    {"dr",         NULL,   Parser_LoraSetCrtDataRate,      0,  1},
+    {"edclass",       NULL, Parser_LoraSetClass,                  0,  1},
+    {"jntype",  NULL, Parser_LoraSetJoinNonceType, 0, 1},
+    {"joinbackoffenable",  NULL, Parser_LoraSetJoinBackoff,            0,  1},
     {"joineui",          NULL,   Parser_LoraSetJoinEui,       0,  1},
+    {"lbt",         NULL,   Parser_LoraSetLbt,      0,  5},
+    {"linkchk",   NULL,              Parser_LoraLinkCheck,   0,                 1},
+    {"maxFcntPdsUpdtVal",  NULL, Parser_LoraSetMaxFcntPdsUpdtVal,            0,  1},
+    {"mcastappskey",  NULL, Parser_LoraSetMcastAppsKey,           0,  2},
+    {"mcastdevaddr",  NULL, Parser_LoraSetMcastDevAddr,           0,  2},
+    {"mcastdr",     NULL, Parser_LoraSetMcastDr,                 0,  2},
+    {"mcastenable",   NULL, Parser_LoraSetMcast,                  0,  2},
+    {"mcastfreq",     NULL, Parser_LoraSetMcastFreq,              0,  2},
+    {"mcastnwkskey",  NULL, Parser_LoraSetMcastNwksKey,           0,  2},
     {"nwkskey",         NULL,   Parser_LoraSetNwkSKey,      0,  1},
-    {"appskey",         NULL,   Parser_LoraSetAppSKey,      0,  1},
-    {"appkey",          NULL,   Parser_LoraSetAppKey,       0,  1},
     {"pwridx",         NULL,   Parser_LoraSetTxPower,      0,  1},
-    {"ch",     maParserLoraSetChCmd,  NULL,              mParserLoraSetChCmdSize,  0},
-    {"rx2",         NULL,   Parser_LoraSetRx2WindowParams,      0,  2},
-    {"bat",         NULL,   Parser_LoraSetBatLevel,      0,  1},
+    {"reps",         NULL,   Parser_LoraSetRepsNb,      0,  1},
     {"retx",         NULL,   Parser_LoraSetReTxNb,      0,  1},
-	{"reps",         NULL,   Parser_LoraSetRepsNb,      0,  1},
-    {"ar",         NULL,   Parser_LoraSetAutoReply,      0,  1},
+    {"rx2",         NULL,   Parser_LoraSetRx2WindowParams,      0,  2},
     {"rxdelay1",         NULL,   Parser_LoraSetRxDelay1,      0,  1},
-    {"linkchk",   NULL,              Parser_LoraLinkCheck,   0,                 1},
+    {"subband", maParserLoraSetSubBandCmd, NULL, mParserLoraSetSubBandCmdSize, 0},
     {"sync",   NULL,              Parser_LoraSetSyncWord,   0,                 1},
     {"upctr",         NULL,   Parser_LoraSetUplinkCounter,      0,  1},
-    {"dnctr",         NULL,   Parser_LoraSetDownlinkCounter,      0,  1},
-	{"lbt",         NULL,   Parser_LoraSetLbt,      0,  5},
-	{"edclass",       NULL, Parser_LoraSetClass,                  0,  1},
-	{"mcastenable",   NULL, Parser_LoraSetMcast,                  0,  2},
-	{"mcastdevaddr",  NULL, Parser_LoraSetMcastDevAddr,           0,  2},
-	{"mcastnwkskey",  NULL, Parser_LoraSetMcastNwksKey,           0,  2},
-	{"mcastappskey",  NULL, Parser_LoraSetMcastAppsKey,           0,  2},
-	{"mcastfreq",     NULL, Parser_LoraSetMcastFreq,              0,  2},
-	{"mcastdr",     NULL, Parser_LoraSetMcastDr,                 0,  2},
-	{"aggdcycle",         NULL,   Parser_LoraSetAggregatedDutyCycle,      0,  1},
-	{"cryptodevenabled",         NULL,   Parser_LoraSetCryptoDevEnabled,      0,  1},
-
-    //#
-    {"subband", maParserLoraSetSubBandCmd, NULL, mParserLoraSetSubBandCmdSize, 0},
-	{"joinbackoffenable",  NULL, Parser_LoraSetJoinBackoff,            0,  1},
-    {"jntype",  NULL, Parser_LoraSetJoinNonceType, 0, 1},
-	{"maxFcntPdsUpdtVal",  NULL, Parser_LoraSetMaxFcntPdsUpdtVal,            0,  1}
-
 };
 #define mParserLoraSetCmdSize (sizeof(maParserLoraSetCmd) / sizeof(maParserLoraSetCmd[0]))
 
 static const parserCmdEntry_t maParserLoraGetCmd[] =
 {
-    {"dr",         NULL,   Parser_LoraGetCrtDataRate,      0,  0},
     {"adr",        NULL,   Parser_LoraGetAdr,              0,  0},
+    {"aggdcycle",         NULL,   Parser_LoraGetAggregatedDutyCycle,      0,  0},
+    {"ar",         NULL,   Parser_LoraGetAutoReply,      0,  0},
+    {"band",         NULL,   Parser_LoraGetIsm,      0,  0},
+    {"ch",     maParserLoraGetChCmd,  NULL,              mParserLoraGetChCmdSize,  0},
+    {"cnfretrycnt", NULL, Parser_LoraGetMacCnfRetryCnt, 0,0},
     {"devaddr",         NULL,   Parser_LoraGetDevAddr,      0,  0},
     {"deveui",          NULL,   Parser_LoraGetDevEui,       0,  0},
+    {"dnctr",         NULL,   Parser_LoraGetDownlinkCounter,      0,  0},
+    {"dr",         NULL,   Parser_LoraGetCrtDataRate,      0,  0},
+    {"dutycycletime", NULL, Parser_LoraGetMacPendingDutyCycle, 0,0},
+    {"edclass",       NULL,   Parser_LoraGetClass,                0,  0},
+    {"edclasssupported", NULL, Parser_LoraGetSupportedEdClass,    0,  0},
+    {"gwnb",         NULL,   Parser_LoraGetLinkCheckGwCnt,      0,  0},
+    {"isdlack", NULL, Parser_LoraGetMacDlAckReqd, 0,0},
+    {"isfpending", NULL, Parser_LoraGetIsFpending, 0,0},
+    {"jntype",  NULL, Parser_LoraGetJoinNonceType, 0, 0},
+    {"joinbackoffenable",  NULL, Parser_LoraGetJoinBackoff,          0,0},
+    {"joindutycycletime", NULL, Parser_LoraGetJoindutycycleremaining,0,0},
     {"joineui",          NULL,   Parser_LoraGetJoinEui,       0,  0},
-    {"ch",     maParserLoraGetChCmd,  NULL,              mParserLoraGetChCmdSize,  0},
+    {"lastchid", NULL, Parser_LoraGetMacLastChId, 0,0},
+    {"lbt",         NULL,   Parser_LoraGetLbt,      0,  0},
+    {"mcastdevaddr",  NULL,   Parser_LoraGetMcastDevAddr,         0,  1},
+    {"mcastdnctr",    NULL,   Parser_LoraGetMcastDownCounter,     0,  1},
+    {"mcastdr",     NULL, Parser_LoraGetMcastDr,                 0,  1},
+    {"mcastenable",   NULL,   Parser_LoraGetMcast,                0,  1},
+    {"mcastfreq",     NULL, Parser_LoraGetMcastFreq,              0,  1},
+    {"mrgn",         NULL,   Parser_LoraGetLinkCheckMargin,      0,  0},
+    {"nxtPayloadSize", NULL, Parser_LoraGetMacNextPayloadSize, 0,0},
+    {"pktrssi", NULL, Parser_LoraGetMacLastPacketRssi, 0,0},
     {"pwridx",         NULL,   Parser_LoraGetTxPower,      0,  0},
-    {"rx2",         NULL,   Parser_LoraGetRx2WindowParams,      0,  0},
-    {"aggdcycle",         NULL,   Parser_LoraGetAggregatedDutyCycle,      0,  0},
-    {"status",         NULL,   Parser_LoraGetMacStatus,      0,  0},
+    {"reps",         NULL,   Parser_LoraGetRepsNb,      0,  0},
     {"retx",         NULL,   Parser_LoraGetReTxNb,      0,  0},
-	{"reps",         NULL,   Parser_LoraGetRepsNb,      0,  0},
-    {"mrgn",         NULL,   Parser_LoraGetLinkCheckMargin,      0,  0},
-    {"gwnb",         NULL,   Parser_LoraGetLinkCheckGwCnt,      0,  0},
-    {"ar",         NULL,   Parser_LoraGetAutoReply,      0,  0},
+    {"rx2",         NULL,   Parser_LoraGetRx2WindowParams,      0,  0},
     {"rxdelay1",         NULL,   Parser_LoraGetRxDelay1,      0,  0},
     {"rxdelay2",         NULL,   Parser_LoraGetRxDelay2,      0,  0},
-    {"band",         NULL,   Parser_LoraGetIsm,      0,  0},
+    {"status",         NULL,   Parser_LoraGetMacStatus,      0,  0},
+    {"subband", maParserLoraGetSubBandCmd, NULL, mParserLoraGetSubBandCmdSize, 0},
     {"sync",         NULL,   Parser_LoraGetSyncWord,      0,  0},
+    {"uncnfretrycnt", NULL, Parser_LoraGetMacUncnfRetryCnt, 0,0},
     {"upctr",         NULL,   Parser_LoraGetUplinkCounter,      0,  0},
-    {"dnctr",         NULL,   Parser_LoraGetDownlinkCounter,      0,  0},
-	{"lbt",         NULL,   Parser_LoraGetLbt,      0,  0},
-	{"edclass",       NULL,   Parser_LoraGetClass,                0,  0},
-	{"edclasssupported", NULL, Parser_LoraGetSupportedEdClass,    0,  0},
-	{"mcastenable",   NULL,   Parser_LoraGetMcast,                0,  1},
-	{"mcastdnctr",    NULL,   Parser_LoraGetMcastDownCounter,     0,  1},
-	{"mcastdevaddr",  NULL,   Parser_LoraGetMcastDevAddr,         0,  1},
-	{"mcastfreq",     NULL, Parser_LoraGetMcastFreq,              0,  1},
-	{"mcastdr",     NULL, Parser_LoraGetMcastDr,                 0,  1},
-    //#
-    {"subband", maParserLoraGetSubBandCmd, NULL, mParserLoraGetSubBandCmdSize, 0},
-	{"pktrssi", NULL, Parser_LoraGetMacLastPacketRssi, 0,0},
-	{"isfpending", NULL, Parser_LoraGetIsFpending, 0,0},
-	{"isdlack", NULL, Parser_LoraGetMacDlAckReqd, 0,0},
-	{"lastchid", NULL, Parser_LoraGetMacLastChId, 0,0},
-	{"dutycycletime", NULL, Parser_LoraGetMacPendingDutyCycle, 0,0},
-	{"cnfretrycnt", NULL, Parser_LoraGetMacCnfRetryCnt, 0,0},
-	{"uncnfretrycnt", NULL, Parser_LoraGetMacUncnfRetryCnt, 0,0},
-	{"nxtPayloadSize", NULL, Parser_LoraGetMacNextPayloadSize, 0,0},
-	{"joindutycycletime", NULL, Parser_LoraGetJoindutycycleremaining,0,0},
-    {"jntype",  NULL, Parser_LoraGetJoinNonceType, 0, 0},
-	{"joinbackoffenable",  NULL, Parser_LoraGetJoinBackoff,          0,0}
-    
 };
 #define mParserLoraGetCmdSize (sizeof(maParserLoraGetCmd) / sizeof(maParserLoraGetCmd[0]))
 
 const parserCmdEntry_t maParserLoraCmd[] =
 {
-    {"reset",   NULL,                Parser_LoraReset,   0,                      1},
-    {"join",    NULL,                Parser_LoraJoin,   0,                      1},
-    {"tx",    NULL,                Parser_LoraSend,   0,                      3},
-    {"set",     maParserLoraSetCmd,  NULL,              mParserLoraSetCmdSize,  0},
+    {"forceENABLE",   NULL,          Parser_LoraForceEnable,   0,               0},
     {"get",     maParserLoraGetCmd,  NULL,              mParserLoraGetCmdSize,  0},
+    {"join",    NULL,                Parser_LoraJoin,   0,                      1},
     {"pause",    NULL,               Parser_LoraPause,  0,                      0},
+    {"reset",   NULL,                Parser_LoraReset,   0,                      1},
     {"resume",    NULL,              Parser_LoraResume, 0,                      0},
     {"save",   NULL,                 Parser_LoraSave,   0,                      0},
-    {"forceENABLE",   NULL,          Parser_LoraForceEnable,   0,               0},
+    {"set",     maParserLoraSetCmd,  NULL,              mParserLoraSetCmdSize,  0},
+    {"tx",    NULL,                Parser_LoraSend,   0,                      3},
 };
 
 #define mParserLoraCmdSize  (sizeof(maParserLoraCmd) / sizeof(maParserLoraCmd[0]))
 
-#ifdef PARSER_SYS_TEST_SUPPORTED
 static const parserCmdEntry_t maParserSysSetCmd[] =
 {
+#ifdef CONF_PMM_ENABLE
+    {"idle",        NULL,   Parser_SystemSetIdle,     0,  1},
+#endif /* CONF_PMM_ENABLE */
+#ifdef PARSER_SYS_TEST_SUPPORTED
     {"nvm",         NULL,   Parser_SystemSetNvm,      0,  2},
-    {"pinmode",     NULL,   Parser_SystemSetPinMode,  0,  2},
     {"pindig",      NULL,   Parser_SystemSetPinDig,   0,  2},
+    {"pinmode",     NULL,   Parser_SystemSetPinMode,  0,  2},
+#endif
+    {"protocol",    NULL,   Parser_SystemSetProtocol, 0,  1},
+#if (SYSTEM_TASK_STATS == 1)
+    {"taskstats",   NULL,   Parser_SystemSetTaskStats, 0,  1},
+#endif
 };
 #define mParserSysSetCmdSize (sizeof(maParserSysSetCmd) / sizeof(maParserSysSetCmd[0]))
-#endif
 static const parserCmdEntry_t maParserSysGetCmd[] =
 {
-	
-    {"ver",         NULL,   Parser_SystemGetVer,      0,  0},
-#ifdef PARSER_SYS_TEST_SUPPORTED		
-
-	{"nvm",         NULL,   Parser_SystemGetNvm,      0,  1},
-    {"vdd",         NULL,   Parser_SystemGetBattery,      0,  0},
+    {"hoststats",   NULL,   Parser_SystemGetHostStats,  0,  0},
+#ifdef PARSER_SYS_TEST_SUPPORTED
     {"hweui",       NULL,   Parser_SystemGetHwEui,      0,  0},
-    {"pindig",      NULL,   Parser_SystemGetPinDig,   0,  1},
+#endif
+#ifdef CONF_PMM_ENABLE
+    {"idle",        NULL,   Parser_SystemGetIdle,       0,  0},
+    {"idleratio",   NULL,   Parser_SystemGetIdleRatio,  0,  0},
+#endif /* CONF_PMM_ENABLE */
+#ifdef PARSER_SYS_TEST_SUPPORTED
+    {"nvm",         NULL,   Parser_SystemGetNvm,      0,  1},
+#endif
+#if (ENABLE_PDS == 1) && (PDS_STATS == 1)
+    {"pdsstats",    NULL,   Parser_SystemGetPdsStats,   0,  0},
+#endif
+#ifdef PARSER_SYS_TEST_SUPPORTED
     {"pinana",      NULL,   Parser_SystemGetPinAnalog,   0,  1},
-#endif		
+    {"pindig",      NULL,   Parser_SystemGetPinDig,   0,  1},
+#endif
+#if (RADIO_SPI_STATS == 1)
+    {"radiospi",    NULL,   Parser_SystemGetRadioSpiStats, 0, 0},
+#endif
+#if (SYSTEM_TASK_STATS == 1)
+    {"taskstats",   NULL,   Parser_SystemGetTaskStats,  0,  0},
+#endif
+#if (SWTIMER_STATS == 1)
+    {"timerlateness", NULL, Parser_SystemGetTimerLateness, 0, 1},
+    {"timerstats",  NULL,   Parser_SystemGetTimerStats,  0,  0},
+#endif
+    {"timerwakeups", NULL,  Parser_SystemGetTimerWakeups, 0,  0},
+#ifdef PARSER_SYS_TEST_SUPPORTED
+    {"vdd",         NULL,   Parser_SystemGetBattery,      0,  0},
+#endif
+    {"ver",         NULL,   Parser_SystemGetVer,      0,  0},
 };
 #define mParserSysGetCmdSize (sizeof(maParserSysGetCmd) / sizeof(maParserSysGetCmd[0]))
 
 const parserCmdEntry_t maParserSysCmd[] =
 {
-#ifdef PARSER_SYS_TEST_SUPPORTED	
+#ifdef PARSER_SYS_TEST_SUPPORTED
     {"eraseFW",    NULL,               Parser_SystemBootload, 0,                      0},
-    {"set",     maParserSysSetCmd,  NULL,              mParserSysSetCmdSize,  0},
-#endif		
+#endif
     {"factoryRESET", NULL,               Parser_SystemFactReset,  0,    0},
-	{"reset",    NULL,               Parser_SystemReboot, 0,                      0},
     {"get",     maParserSysGetCmd,  NULL,              mParserSysGetCmdSize,  0},
+    {"reset",    NULL,               Parser_SystemReboot, 0,                      0},
+    {"set",     maParserSysSetCmd,  NULL,              mParserSysSetCmdSize,  0},
 #ifdef CONF_PMM_ENABLE
-	{"sleep",    NULL,                Parser_SystemSleep,  0,                      2},
+    {"sleep",    NULL,                Parser_SystemSleep,  0,                      2},
 #endif /* CONF_PMM_ENABLE */
 };
 
@@ -227,3 +257,125 @@ const parserCmdEntry_t maParserBaseCmd[] =
 
 const parserCmdEntry_t* gpParserStartCmd = &maParserBaseCmd[0];
 const uint8_t gParserStartCmdSize = mParserBaseCmdSize;
+
+/* Binary protocol opcodes, one per command that has a handler. The high byte
+ * is the group: 0x01 mac, 0x02 mac set, 0x03 mac get, 0x04 sys, 0x05 sys set,
+ * 0x06 sys get. An opcode never changes once assigned, whatever the build
+ * options: new commands take the next free value of their group and commands
+ * compiled out of the tables above keep theirs. Sorted by opcode. */
+const parserBinOpcode_t gaParserBinOpcode[] =
+{
+    {0x0101U, "mac forceENABLE"},
+    {0x0102U, "mac join"},
+    {0x0103U, "mac pause"},
+    {0x0104U, "mac reset"},
+    {0x0105U, "mac resume"},
+    {0x0106U, "mac save"},
+    {0x0107U, "mac tx"},
+    {0x0201U, "mac set adr"},
+    {0x0202U, "mac set aggdcycle"},
+    {0x0203U, "mac set appkey"},
+    {0x0204U, "mac set appskey"},
+    {0x0205U, "mac set ar"},
+    {0x0206U, "mac set bat"},
+    {0x0207U, "mac set ch drrange"},
+    {0x0208U, "mac set ch freq"},
+    {0x0209U, "mac set ch status"},
+    {0x020AU, "mac set cryptodevenabled"},
+    {0x020BU, "mac set devaddr"},
+    {0x020CU, "mac set deveui"},
+    {0x020DU, "mac set dnctr"},
+    {0x020EU, "mac set dr"},
+    {0x020FU, "mac set edclass"},
+    {0x0210U, "mac set jntype"},
+    {0x0211U, "mac set joinbackoffenable"},
+    {0x0212U, "mac set joineui"},
+    {0x0213U, "mac set lbt"},
+    {0x0214U, "mac set linkchk"},
+    {0x0215U, "mac set maxFcntPdsUpdtVal"},
+    {0x0216U, "mac set mcastappskey"},
+    {0x0217U, "mac set mcastdevaddr"},
+    {0x0218U, "mac set mcastdr"},
+    {0x0219U, "mac set mcastenable"},
+    {0x021AU, "mac set mcastfreq"},
+    {0x021BU, "mac set mcastnwkskey"},
+    {0x021CU, "mac set nwkskey"},
+    {0x021DU, "mac set pwridx"},
+    {0x021EU, "mac set reps"},
+    {0x021FU, "mac set retx"},
+    {0x0220U, "mac set rx2"},
+    {0x0221U, "mac set rxdelay1"},
+    {0x0222U, "mac set subband status"},
+    {0x0223U, "mac set sync"},
+    {0x0224U, "mac set upctr"},
+    {0x0301U, "mac get adr"},
+    {0x0302U, "mac get aggdcycle"},
+    {0x0303U, "mac get ar"},
+    {0x0304U, "mac get band"},
+    {0x0305U, "mac get ch drrange"},
+    {0x0306U, "mac get ch freq"},
+    {0x0307U, "mac get ch status"},
+    {0x0308U, "mac get cnfretrycnt"},
+    {0x0309U, "mac get devaddr"},
+    {0x030AU, "mac get deveui"},
+    {0x030BU, "mac get dnctr"},
+    {0x030CU, "mac get dr"},
+    {0x030DU, "mac get dutycycletime"},
+    {0x030EU, "mac get edclass"},
+    {0x030FU, "mac get edclasssupported"},
+    {0x0310U, "mac get gwnb"},
+    {0x0311U, "mac get isdlack"},
+    {0x0312U, "mac get isfpending"},
+    {0x0313U, "mac get jntype"},
+    {0x0314U, "mac get joinbackoffenable"},
+    {0x0315U, "mac get joindutycycletime"},
+    {0x0316U, "mac get joineui"},
+    {0x0317U, "mac get lastchid"},
+    {0x0318U, "mac get lbt"},
+    {0x0319U, "mac get mcastdevaddr"},
+    {0x031AU, "mac get mcastdnctr"},
+    {0x031BU, "mac get mcastdr"},
+    {0x031CU, "mac get mcastenable"},
+    {0x031DU, "mac get mcastfreq"},
+    {0x031EU, "mac get mrgn"},
+    {0x031FU, "mac get nxtPayloadSize"},
+    {0x0320U, "mac get pktrssi"},
+    {0x0321U, "mac get pwridx"},
+    {0x0322U, "mac get reps"},
+    {0x0323U, "mac get retx"},
+    {0x0324U, "mac get rx2"},
+    {0x0325U, "mac get rxdelay1"},
+    {0x0326U, "mac get rxdelay2"},
+    {0x0327U, "mac get status"},
+    {0x0328U, "mac get subband status"},
+    {0x0329U, "mac get sync"},
+    {0x032AU, "mac get uncnfretrycnt"},
+    {0x032BU, "mac get upctr"},
+    {0x0401U, "sys eraseFW"},
+    {0x0402U, "sys factoryRESET"},
+    {0x0403U, "sys reset"},
+    {0x0404U, "sys sleep"},
+    {0x0501U, "sys set idle"},
+    {0x0502U, "sys set nvm"},
+    {0x0503U, "sys set pindig"},
+    {0x0504U, "sys set pinmode"},
+    {0x0505U, "sys set protocol"},
+    {0x0506U, "sys set taskstats"},
+    {0x0601U, "sys get hoststats"},
+    {0x0602U, "sys get hweui"},
+    {0x0603U, "sys get idle"},
+    {0x0604U, "sys get idleratio"},
+    {0x0605U, "sys get nvm"},
+    {0x0606U, "sys get pdsstats"},
+    {0x0607U, "sys get pinana"},
+    {0x0608U, "sys get pindig"},
+    {0x0609U, "sys get radiospi"},
+    {0x060AU, "sys get taskstats"},
+    {0x060BU, "sys get timerlateness"},
+    {0x060CU, "sys get timerstats"},
+    {0x060DU, "sys get timerwakeups"},
+    {0x060EU, "sys get vdd"},
+    {0x060FU, "sys get ver"},
+};
+
+const uint16_t gParserBinOpcodeSize = sizeof(gaParserBinOpcode) / sizeof(gaParserBinOpcode[0]);
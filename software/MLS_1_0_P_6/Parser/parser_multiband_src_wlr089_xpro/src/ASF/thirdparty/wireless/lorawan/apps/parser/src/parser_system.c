@@ -43,6 +43,7 @@
 #include "parser_tsp.h"
 #include "system_low_power.h"
 #include "sys.h"
+#include "conf_sw_timer.h"
 #include "sw_timer.h"
 #ifdef CONF_PMM_ENABLE
 #include "pmm.h"
@@ -64,7 +65,6 @@
 #define OFF_STR_IDX            2U
 
 static bool SleepEnabled = false;
-#ifdef CONF_PMM_ENABLE
 static const char* gapParserSysStatus[] =
 {
    "ok",
@@ -72,16 +72,49 @@ static const char* gapParserSysStatus[] =
    "err"
 };
 
+static const char* gapParseProtocol[] =
+{
+	"ascii",
+	"bin"
+};
+
+#if (SYSTEM_TASK_STATS == 1)
+/* In the order of the SYSTEM_Task_t bits */
+static const char* gapParseTaskName[SYSTEM_TASK_ID_COUNT] =
+{
+	"timer",
+	"radio",
+	"lorawan",
+	"pds",
+	"app"
+};
+#endif
+
+#ifdef CONF_PMM_ENABLE
+
 static const char* gapParseSleepMode[] =
 {
 	"standby",
 	"backup",
 };
+
+static const char* gapParseOnOff[] =
+{
+	"off",
+	"on"
+};
+
 static void parserSleepCallback(uint32_t sleptDuration);
 static void app_resources_uninit(void);
 
 bool deviceResetsForWakeup = false;
 
+/* Automatic IDLE of the main loop, "sys set idle <on|off>" */
+static bool IdleEnabled = true;
+/* Time asleep since IdleStartTimeUs, reported by "sys get idleratio" */
+static uint64_t IdleStartTimeUs;
+static uint64_t IdleSleptTimeUs;
+
 #endif /* #ifdef CONF_PMM_ENABLE */
 
 static void extint_callback(void);
@@ -96,10 +129,249 @@ void Parser_SystemGetVer(parserCmdInfo_t* pParserCmdInfo)
 
 void Parser_SystemReboot(parserCmdInfo_t* pParserCmdInfo)
 {
+	// The marks of the open commit window would be lost
+#if (ENABLE_PDS == 1)
+	PDS_Flush();
+#endif
 	// Go for reboot, no reply necessary
+	sio2host_tx_flush();
 	NVIC_SystemReset();
 }
 
+void Parser_SystemSetProtocol(parserCmdInfo_t* pParserCmdInfo)
+{
+	/** Refer gapParseProtocol[] array indices
+	*         [0] --> "ascii"
+	*         [1] --> "bin"
+	*/
+	uint8_t protocol = Validate_Str1Str2AsciiValue(pParserCmdInfo->pParam1, gapParseProtocol[0], gapParseProtocol[1]);
+
+	if(protocol > 1U)
+	{
+		pParserCmdInfo->pReplyCmd = (char *) gapParserSysStatus[INVALID_PARAM_IDX];
+		return;
+	}
+
+	/* Acknowledge with the protocol the request came in, then switch */
+	Parser_TxAddReply((char *) gapParserSysStatus[OK_STATUS_IDX], strlen(gapParserSysStatus[OK_STATUS_IDX]));
+	Parser_SetProtocol((parserProtocol_t)protocol);
+	pParserCmdInfo->pReplyCmd = NULL;
+}
+
+#if (SYSTEM_TASK_STATS == 1)
+void Parser_SystemGetTaskStats(parserCmdInfo_t* pParserCmdInfo)
+{
+	/* For each task: <name> <runs> <total ms> <max us> <avg latency us> <max latency us> */
+	SYSTEM_TaskStats_t taskStats;
+	uint16_t dataLen = 0;
+	uint32_t avgLatency;
+
+	for(uint8_t taskIdx = 0; taskIdx < SYSTEM_TASK_ID_COUNT; taskIdx++)
+	{
+		SYSTEM_GetTaskStats(taskIdx, &taskStats);
+		avgLatency = (taskStats.runCount > 0) ? (uint32_t)(taskStats.totalLatency / taskStats.runCount) : 0;
+
+		if(dataLen > 0)
+		{
+			aParserData[dataLen ++] = ' ';
+		}
+		strcpy(&aParserData[dataLen], gapParseTaskName[taskIdx]);
+		dataLen = strlen(aParserData);
+		aParserData[dataLen ++] = ' ';
+		ultoa(&aParserData[dataLen], taskStats.runCount, 10U);
+		dataLen = strlen(aParserData);
+		aParserData[dataLen ++] = ' ';
+		ultoa(&aParserData[dataLen], (uint32_t)(taskStats.totalRunTime / 1000U), 10U);
+		dataLen = strlen(aParserData);
+		aParserData[dataLen ++] = ' ';
+		ultoa(&aParserData[dataLen], taskStats.maxRunTime, 10U);
+		dataLen = strlen(aParserData);
+		aParserData[dataLen ++] = ' ';
+		ultoa(&aParserData[dataLen], avgLatency, 10U);
+		dataLen = strlen(aParserData);
+		aParserData[dataLen ++] = ' ';
+		ultoa(&aParserData[dataLen], taskStats.maxLatency, 10U);
+		dataLen = strlen(aParserData);
+	}
+
+	pParserCmdInfo->pReplyCmd = aParserData;
+}
+
+void Parser_SystemSetTaskStats(parserCmdInfo_t* pParserCmdInfo)
+{
+	/* "reset" is the only action, so that a measurement can start at a known point */
+	if(0 == stricmp(pParserCmdInfo->pParam1, "reset"))
+	{
+		SYSTEM_ResetTaskStats();
+		pParserCmdInfo->pReplyCmd = (char *) gapParserSysStatus[OK_STATUS_IDX];
+	}
+	else
+	{
+		pParserCmdInfo->pReplyCmd = (char *) gapParserSysStatus[INVALID_PARAM_IDX];
+	}
+}
+#endif
+
+void Parser_SystemGetTimerWakeups(parserCmdInfo_t* pParserCmdInfo)
+{
+	/* <timer wakeups> <expiries that shared the wakeup of another timer> */
+	uint32_t wakeups;
+	uint32_t wakeupsSaved;
+	uint16_t dataLen;
+
+	SwTimerGetWakeupStats(&wakeups, &wakeupsSaved);
+
+	ultoa(aParserData, wakeups, 10U);
+	dataLen = strlen(aParserData);
+	aParserData[dataLen ++] = ' ';
+	ultoa(&aParserData[dataLen], wakeupsSaved, 10U);
+
+	pParserCmdInfo->pReplyCmd = aParserData;
+}
+
+void Parser_SystemGetHostStats(parserCmdInfo_t* pParserCmdInfo)
+{
+	/* <received bytes dropped on a full receive buffer> <notifications lost on a full queue> */
+	uint16_t dataLen;
+
+	ultoa(aParserData, sio2host_rx_overflow_count(), 10U);
+	dataLen = strlen(aParserData);
+	aParserData[dataLen ++] = ' ';
+#if (RF_ONLY_MODE == 0)
+	ultoa(&aParserData[dataLen], Parser_LoraEvtOverflowCount(), 10U);
+#else
+	ultoa(&aParserData[dataLen], 0U, 10U);
+#endif
+
+	pParserCmdInfo->pReplyCmd = aParserData;
+}
+
+#if (SWTIMER_STATS == 1)
+void Parser_SystemGetTimerStats(parserCmdInfo_t* pParserCmdInfo)
+{
+	/* <lateness histogram bins> then for RX1 and RX2: <opened> <avg error us> <max error us> */
+	uint32_t histogram[SWTIMER_LATENESS_BINS];
+	LorawanRxWindowStats_t rxWindowStats;
+	uint16_t dataLen = 0;
+
+	SwTimerGetLatenessHistogram(histogram);
+	for(uint8_t binIdx = 0; binIdx < SWTIMER_LATENESS_BINS; binIdx++)
+	{
+		if(dataLen > 0)
+		{
+			aParserData[dataLen ++] = ' ';
+		}
+		ultoa(&aParserData[dataLen], histogram[binIdx], 10U);
+		dataLen = strlen(aParserData);
+	}
+
+	for(uint8_t window = 0; window < 2; window++)
+	{
+		LORAWAN_GetRxWindowStats(window, &rxWindowStats);
+
+		aParserData[dataLen ++] = ' ';
+		ultoa(&aParserData[dataLen], rxWindowStats.openCount, 10U);
+		dataLen = strlen(aParserData);
+		aParserData[dataLen ++] = ' ';
+		itoa((rxWindowStats.openCount > 0) ? (int32_t)(rxWindowStats.totalError / rxWindowStats.openCount) : 0, &aParserData[dataLen], 10U);
+		dataLen = strlen(aParserData);
+		aParserData[dataLen ++] = ' ';
+		itoa(rxWindowStats.maxError, &aParserData[dataLen], 10U);
+		dataLen = strlen(aParserData);
+	}
+
+	pParserCmdInfo->pReplyCmd = aParserData;
+}
+
+void Parser_SystemGetTimerLateness(parserCmdInfo_t* pParserCmdInfo)
+{
+	/* <callbacks> <avg lateness us> <max lateness us> of one timer id */
+	SwTimerStats_t timerStats;
+	uint8_t timerId;
+	uint16_t dataLen;
+
+	if((!Validate_Uint8DecAsciiValue(pParserCmdInfo->pParam1, &timerId)) || (timerId >= TOTAL_NUMBER_OF_SW_TIMERS))
+	{
+		pParserCmdInfo->pReplyCmd = (char *) gapParserSysStatus[INVALID_PARAM_IDX];
+		return;
+	}
+
+	SwTimerGetStats(timerId, &timerStats);
+
+	ultoa(aParserData, timerStats.expiryCount, 10U);
+	dataLen = strlen(aParserData);
+	aParserData[dataLen ++] = ' ';
+	ultoa(&aParserData[dataLen], (timerStats.expiryCount > 0) ? (uint32_t)(timerStats.totalLateness / timerStats.expiryCount) : 0, 10U);
+	dataLen = strlen(aParserData);
+	aParserData[dataLen ++] = ' ';
+	ultoa(&aParserData[dataLen], timerStats.maxLateness, 10U);
+
+	pParserCmdInfo->pReplyCmd = aParserData;
+}
+#endif /* #if (SWTIMER_STATS == 1) */
+
+#if (ENABLE_PDS == 1) && (PDS_STATS == 1)
+void Parser_SystemGetPdsStats(parserCmdInfo_t* pParserCmdInfo)
+{
+	/* <marks> <commits> <rows written> <journal writes> <uplinks> <rows last uplink> <max rows per uplink> <init us> <restore us> <write failures> */
+	PdsWriteStats_t pdsStats;
+	uint32_t values[10];
+	uint16_t dataLen = 0;
+
+	PDS_GetWriteStats(&pdsStats);
+	values[0] = pdsStats.marks;
+	values[1] = pdsStats.commits;
+	values[2] = pdsStats.rowsWritten;
+	values[3] = pdsStats.journalWrites;
+	values[4] = pdsStats.uplinks;
+	values[5] = pdsStats.lastUplinkRows;
+	values[6] = pdsStats.maxUplinkRows;
+	values[7] = pdsStats.initTimeUs;
+	values[8] = pdsStats.restoreTimeUs;
+	values[9] = pdsStats.writeFailures;
+
+	for(uint8_t valueIdx = 0; valueIdx < (sizeof(values) / sizeof(values[0])); valueIdx++)
+	{
+		if(dataLen > 0)
+		{
+			aParserData[dataLen ++] = ' ';
+		}
+		ultoa(&aParserData[dataLen], values[valueIdx], 10U);
+		dataLen = strlen(aParserData);
+	}
+
+	pParserCmdInfo->pReplyCmd = aParserData;
+}
+#endif
+
+#if (RADIO_SPI_STATS == 1)
+void Parser_SystemGetRadioSpiStats(parserCmdInfo_t* pParserCmdInfo)
+{
+	/* <transactions> <saved> <saved last cycle> <shadow mismatches> */
+	RadioSpiStats_t spiStats;
+	uint32_t values[4];
+	uint16_t dataLen = 0;
+
+	RADIO_GetSpiStats(&spiStats);
+	values[0] = spiStats.transactions;
+	values[1] = spiStats.saved;
+	values[2] = spiStats.lastCycleSaved;
+	values[3] = spiStats.mismatches;
+
+	for(uint8_t valueIdx = 0; valueIdx < (sizeof(values) / sizeof(values[0])); valueIdx++)
+	{
+		if(dataLen > 0)
+		{
+			aParserData[dataLen ++] = ' ';
+		}
+		ultoa(&aParserData[dataLen], values[valueIdx], 10U);
+		dataLen = strlen(aParserData);
+	}
+
+	pParserCmdInfo->pReplyCmd = aParserData;
+}
+#endif
+
 void Parser_SystemFactReset(parserCmdInfo_t* pParserCmdInfo)
 {
 	// Call PDS Delete All API to clear NVM Memory.
@@ -107,6 +379,7 @@ void Parser_SystemFactReset(parserCmdInfo_t* pParserCmdInfo)
 	PDS_DeleteAll();
 #endif	
 	// Go for reboot, no reply necessary
+	sio2host_tx_flush();
 	NVIC_SystemReset();
 }
 
@@ -168,6 +441,75 @@ void Parser_SystemSleep (parserCmdInfo_t* pParserCmdInfo)
         }
     }
 }
+
+void Parser_SystemSetIdle(parserCmdInfo_t* pParserCmdInfo)
+{
+	uint8_t validationVal = Validate_OnOffAsciiValue(pParserCmdInfo->pParam1);
+
+	if(validationVal < 2U)
+	{
+		IdleEnabled = (1U == validationVal);
+		IdleStartTimeUs = SwTimerGetTime();
+		IdleSleptTimeUs = 0;
+		pParserCmdInfo->pReplyCmd = (char *) gapParserSysStatus[OK_STATUS_IDX];
+	}
+	else
+	{
+		pParserCmdInfo->pReplyCmd = (char *) gapParserSysStatus[INVALID_PARAM_IDX];
+	}
+}
+
+void Parser_SystemGetIdle(parserCmdInfo_t* pParserCmdInfo)
+{
+	pParserCmdInfo->pReplyCmd = (char *) gapParseOnOff[IdleEnabled];
+}
+
+void Parser_SystemGetIdleRatio(parserCmdInfo_t* pParserCmdInfo)
+{
+	uint64_t elapsedTimeUs = SwTimerGetTime() - IdleStartTimeUs;
+	uint32_t idleRatio = 0;
+
+	/* Per mille of the time spent asleep, IDLE and "sys sleep" included */
+	if(elapsedTimeUs > 0)
+	{
+		idleRatio = (uint32_t)((IdleSleptTimeUs * 1000U) / elapsedTimeUs);
+	}
+
+	itoa(idleRatio, aParserData, 10U);
+	pParserCmdInfo->pReplyCmd = aParserData;
+}
+
+/*********************************************************************//**
+\brief	Puts the core in IDLE when no task is pending, called from the main
+        loop. Any interrupt (host UART, system timer, radio) wakes it up.
+        STANDBY is left to "sys sleep": the host UART does not run in it.
+*************************************************************************/
+void Parser_SystemIdle(void)
+{
+	uint64_t sleepStartUs;
+
+	if((!IdleEnabled) || SleepEnabled)
+	{
+		return;
+	}
+
+	sleepStartUs = SwTimerGetTime();
+
+	/* An interrupt raised between the checks and WFI stays pending
+	   and ends the sleep at once */
+	__disable_irq();
+	if(SYSTEM_ReadyToSleep() && (!sio2host_rx_burst_pending()) &&
+	   (0U != SwTimerNextExpiryDuration()))
+	{
+		HAL_Sleep(SLEEP_MODE_IDLE);
+		__enable_irq();
+		IdleSleptTimeUs += SwTimerGetTime() - sleepStartUs;
+	}
+	else
+	{
+		__enable_irq();
+	}
+}
 #endif /* #ifdef CONF_PMM_ENABLE */
 
 
@@ -230,6 +572,7 @@ static void parserSleepCallback(uint32_t sleptDuration)
 {
 	HAL_Radio_resources_init();
 	sio2host_init();
+	IdleSleptTimeUs += (uint64_t)sleptDuration * 1000U;
 	printf("\nsleep_ok %ld ms\n\r", sleptDuration);
 }
 
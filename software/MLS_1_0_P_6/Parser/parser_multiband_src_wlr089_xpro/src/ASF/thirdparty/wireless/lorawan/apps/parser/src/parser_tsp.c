@@ -43,22 +43,25 @@
 #endif
 #include "parser_private.h"
 #include "parser_utils.h"
+#include "parser_commands.h"
 #include "sio2host.h"
+#include "sw_timer.h"
+#include "system_crc.h"
 
-typedef struct parserRxCmd_tag
-{
-    char cmd[PARSER_DEF_CMD_MAX_LEN];
-    uint16_t wordLen[PARSER_DEF_CMD_MAX_IDX];
-    uint16_t wordStartPos[PARSER_DEF_CMD_MAX_IDX];
-    uint8_t bCmdStatus;
-    uint8_t crtWordIdx;
-    uint16_t crtCmdPos;
-    uint16_t crtWordPos;
-}parserRxCmd_t;
-
-volatile parserRxCmd_t mRxParserCmd;
+/* Ring of received command lines. The line under construction is the one
+ * following the mRxCmdQueueCount complete lines starting at mRxCmdQueueHead. */
+static parserRxCmd_t maRxParserCmdQueue[PARSER_RX_CMD_QUEUE_SIZE];
+static uint8_t mRxCmdQueueHead;
+static uint8_t mRxCmdQueueCount;
 static const char* gpParserLineDelim = {PARSER_END_LINE_DELIM_STRING};
 
+static parserProtocol_t mParserProtocol = PARSER_PROTOCOL_ASCII;
+
+/* Binary frame being received: header, body and CRC are stored back to back */
+static uint8_t maRxFrame[PARSER_BIN_FRAME_HDR_LEN + PARSER_BIN_FRAME_MAX_BODY_LEN + PARSER_BIN_FRAME_CRC_LEN];
+static uint16_t mRxFramePos;
+static uint16_t mRxFrameLen;
+
 static const char* gapParserTspStatus[] =
 {
     "ok",
@@ -66,125 +69,490 @@ static const char* gapParserTspStatus[] =
     "err"
 };
 
+static void Parser_RxClearLine(parserRxCmd_t* pRxCmd);
+static parserRxCmd_t* Parser_RxCrtLine(void);
+static uint16_t Parser_RxAddFrameChunk(const uint8_t* pData, uint16_t dataLen);
+static bool Parser_RxDecodeFrame(parserRxCmd_t* pRxCmd, const uint8_t* pBody, uint16_t bodyLen);
+static bool Parser_RxAddWord(parserRxCmd_t* pRxCmd, const uint8_t* pWord, uint16_t wordLen);
+static const char* Parser_RxFindOpcode(uint16_t opcode);
+
+static void Parser_RxClearLine(parserRxCmd_t* pRxCmd)
+{
+    pRxCmd->crtWordIdx = 0;
+    pRxCmd->crtCmdPos = 0;
+    pRxCmd->crtWordPos = 0;
+    pRxCmd->binDataPos = 0;
+    pRxCmd->binDataLen = 0;
+
+    memset(pRxCmd->wordLen, 0, sizeof(pRxCmd->wordLen));
+    memset(pRxCmd->wordStartPos, 0, sizeof(pRxCmd->wordStartPos));
+}
+
+static parserRxCmd_t* Parser_RxCrtLine(void)
+{
+    uint8_t idx = mRxCmdQueueHead + mRxCmdQueueCount;
+
+    if(idx >= PARSER_RX_CMD_QUEUE_SIZE)
+    {
+        idx -= PARSER_RX_CMD_QUEUE_SIZE;
+    }
+
+    return &maRxParserCmdQueue[idx];
+}
+
 void Parser_RxClearBuffer(void)
 {
-    mRxParserCmd.bCmdStatus = 0;
-    mRxParserCmd.crtWordIdx = 0;
-    mRxParserCmd.crtCmdPos = 0;
-    mRxParserCmd.crtWordPos = 0;
-    
-    memset((_PTR)mRxParserCmd.wordLen, 0, PARSER_DEF_CMD_MAX_IDX << 1);
-    memset((_PTR)mRxParserCmd.wordStartPos, 0, PARSER_DEF_CMD_MAX_IDX << 1);
+    mRxCmdQueueHead = 0;
+    mRxCmdQueueCount = 0;
+
+    Parser_RxClearLine(Parser_RxCrtLine());
+}
+
+parserRxCmd_t* Parser_RxGetCmd(void)
+{
+    if(mRxCmdQueueCount == 0U)
+    {
+        return NULL;
+    }
+
+    return &maRxParserCmdQueue[mRxCmdQueueHead];
+}
+
+void Parser_RxReleaseCmd(void)
+{
+    bool bQueueWasFull = (mRxCmdQueueCount == PARSER_RX_CMD_QUEUE_SIZE);
+
+    if(mRxCmdQueueCount == 0U)
+    {
+        return;
+    }
+
+    mRxCmdQueueHead ++;
+    if(mRxCmdQueueHead >= PARSER_RX_CMD_QUEUE_SIZE)
+    {
+        mRxCmdQueueHead = 0;
+    }
+    mRxCmdQueueCount --;
+
+    if(bQueueWasFull)
+    {
+        /* The released slot becomes the line under construction */
+        Parser_RxClearLine(Parser_RxCrtLine());
+    }
 }
 
 void Parser_RxAddChar(uint8_t rxChar)
 {
+    (void)Parser_RxAddChunk(&rxChar, 1U);
+}
+
+uint16_t Parser_RxAddChunk(const uint8_t* pData, uint16_t dataLen)
+{
+    uint16_t consumed = 0U;
     uint8_t retStatus = STATUS_DONE;
-    bool bIsEndLine = false;
-    uint8_t iCount;
-    
-    // Process special character: '\b'
-    if(rxChar == '\b')
-    {
-        /* process delete character '\b' */
-        if(mRxParserCmd.crtCmdPos > 0U)
-        {
-            // Check for ' '. This was previously replaced with '\0'
-            //mRxParserCmd.crtCmdPos always indicates the first free position
-            if(mRxParserCmd.cmd[mRxParserCmd.crtCmdPos - 1] == '\0')
+    uint8_t rxChar;
+    parserRxCmd_t* pRxCmd;
+    uint16_t crtCmdPos;
+    uint16_t crtWordPos;
+    uint8_t crtWordIdx;
+    char* pCmd;
+
+    /* All the slots hold lines waiting to be executed, leave the data where it is */
+    if(mRxCmdQueueCount >= PARSER_RX_CMD_QUEUE_SIZE)
+    {
+        return 0U;
+    }
+
+    if(mParserProtocol == PARSER_PROTOCOL_BIN)
+    {
+        return Parser_RxAddFrameChunk(pData, dataLen);
+    }
+
+    /* Work on local copies of the line state; they are written back once per chunk */
+    pRxCmd = Parser_RxCrtLine();
+    crtCmdPos = pRxCmd->crtCmdPos;
+    crtWordPos = pRxCmd->crtWordPos;
+    crtWordIdx = pRxCmd->crtWordIdx;
+    pCmd = pRxCmd->cmd;
+
+    while(consumed < dataLen)
+    {
+        rxChar = pData[consumed ++];
+
+        // Process special character: '\b'
+        if(rxChar == '\b')
+        {
+            /* process delete character '\b' */
+            if(crtCmdPos > 0U)
             {
-                mRxParserCmd.crtWordIdx --;
-                mRxParserCmd.crtWordPos = mRxParserCmd.wordLen[mRxParserCmd.crtWordIdx];
-                mRxParserCmd.wordLen[mRxParserCmd.crtWordIdx] = 0U;
-                mRxParserCmd.wordStartPos[mRxParserCmd.crtWordIdx] = 0U;
+                // Check for ' '. This was previously replaced with '\0'
+                //crtCmdPos always indicates the first free position
+                if(pCmd[crtCmdPos - 1] == '\0')
+                {
+                    crtWordIdx --;
+                    crtWordPos = pRxCmd->wordLen[crtWordIdx];
+                    pRxCmd->wordLen[crtWordIdx] = 0U;
+                    pRxCmd->wordStartPos[crtWordIdx] = 0U;
+                }
+                else
+                {
+                    crtWordPos --;
+                }
+
+                crtCmdPos --;
             }
-            else
+            continue;
+        }
+
+        // Regular command
+        if(crtCmdPos >= PARSER_DEF_CMD_MAX_LEN - 1)
+        {
+            retStatus = STATUS_ERROR;
+            break;
+        }
+
+        if(rxChar == ' ')
+        {
+            if(crtWordIdx >= PARSER_DEF_CMD_MAX_IDX - 1)
             {
-                mRxParserCmd.crtWordPos --;
+                retStatus = STATUS_ERROR;
+                break;
             }
 
-            mRxParserCmd.crtCmdPos --;
+            /* Command separator received, replace ' ' with \0 */
+            pCmd[crtCmdPos ++] = '\0';
+
+            /* Save the length and the start position of the word just ended */
+            pRxCmd->wordLen[crtWordIdx] = crtWordPos;
+            pRxCmd->wordStartPos[crtWordIdx] = crtCmdPos - crtWordPos - 1;
+
+            /* Prepare to receive next word */
+            crtWordIdx ++;
+            crtWordPos = 0;
+            continue;
         }
 
-        return;
-    }
+        /* Save the character */
+        pCmd[crtCmdPos ++] = rxChar;
+        crtWordPos ++;
 
-    // Regular command
-    if(mRxParserCmd.crtCmdPos < PARSER_DEF_CMD_MAX_LEN - 1)
-    {
-        if(rxChar == ' ')
+        /* The delimiter tail is compared only when its last character arrives */
+        if((rxChar == (uint8_t)PARSER_END_LINE_DELIM_STRING[PARSER_END_LINE_DELIM_LEN - 1]) &&
+           (crtCmdPos >= PARSER_END_LINE_DELIM_LEN) &&
+           (memcmp(&pCmd[crtCmdPos - PARSER_END_LINE_DELIM_LEN], PARSER_END_LINE_DELIM_STRING, PARSER_END_LINE_DELIM_LEN) == 0))
         {
-            if(mRxParserCmd.crtWordIdx < PARSER_DEF_CMD_MAX_IDX - 1)
+            /* Entire command received */
+
+            /* Replace new line with \0 */
+            pCmd[crtCmdPos - PARSER_END_LINE_DELIM_LEN] = '\0';
+
+            pRxCmd->wordLen[crtWordIdx] = crtWordPos - PARSER_END_LINE_DELIM_LEN;
+            pRxCmd->wordStartPos[crtWordIdx] = crtCmdPos - crtWordPos;
+            pRxCmd->crtWordIdx = crtWordIdx;
+            pRxCmd->crtCmdPos = crtCmdPos;
+            pRxCmd->crtWordPos = crtWordPos;
+
+            /* Queue the line for execution */
+            mRxCmdQueueCount ++;
+            if(mRxCmdQueueCount >= PARSER_RX_CMD_QUEUE_SIZE)
             {
-                /* Command separator received */
+                return consumed;
+            }
+
+            /* Continue with the next line in the following slot */
+            pRxCmd = Parser_RxCrtLine();
+            Parser_RxClearLine(pRxCmd);
+            crtCmdPos = 0;
+            crtWordPos = 0;
+            crtWordIdx = 0;
+            pCmd = pRxCmd->cmd;
+        }
+    }
+
+    if(STATUS_ERROR == retStatus)
+    {
+        Parser_RxClearLine(pRxCmd);
+        /* Send reply code */
+        Parser_TxAddReply((char*)gapParserTspStatus[ERR_STATUS_IDX], strlen(gapParserTspStatus[ERR_STATUS_IDX]));
+    }
+    else
+    {
+        pRxCmd->crtCmdPos = crtCmdPos;
+        pRxCmd->crtWordPos = crtWordPos;
+        pRxCmd->crtWordIdx = crtWordIdx;
+    }
 
-                /* Replace ' ' with \0 */
-                mRxParserCmd.cmd[mRxParserCmd.crtCmdPos ++] = '\0';
+    return consumed;
+}
 
-                /* Save last filled position in mRxParserCmd.wordLen[mRxParserCmd.crtWordIdx] */
-                mRxParserCmd.wordLen[mRxParserCmd.crtWordIdx] = mRxParserCmd.crtWordPos;
-                mRxParserCmd.wordStartPos[mRxParserCmd.crtWordIdx] = mRxParserCmd.crtCmdPos - mRxParserCmd.crtWordPos - 1;
+static uint16_t Parser_RxAddFrameChunk(const uint8_t* pData, uint16_t dataLen)
+{
+    uint16_t consumed = 0U;
+    uint16_t copyLen;
+    uint16_t crc;
+    parserRxCmd_t* pRxCmd;
+    const uint8_t* pBody;
 
-                /* Prepare to receive next word */
-                mRxParserCmd.crtWordIdx ++;
-                mRxParserCmd.crtWordPos = 0;
+    while(consumed < dataLen)
+    {
+        if(mRxFramePos == 0U)
+        {
+            /* Resynchronize on the start of frame byte */
+            if(pData[consumed ++] == PARSER_BIN_FRAME_SOF)
+            {
+                maRxFrame[mRxFramePos ++] = PARSER_BIN_FRAME_SOF;
             }
-            else
+            continue;
+        }
+
+        if(mRxFramePos < PARSER_BIN_FRAME_HDR_LEN)
+        {
+            maRxFrame[mRxFramePos ++] = pData[consumed ++];
+            if(mRxFramePos == PARSER_BIN_FRAME_HDR_LEN)
             {
-                retStatus = STATUS_ERROR;
+                mRxFrameLen = (uint16_t)maRxFrame[1] | ((uint16_t)maRxFrame[2] << 8);
+                if((mRxFrameLen == 0U) || (mRxFrameLen > PARSER_BIN_FRAME_MAX_BODY_LEN))
+                {
+                    mRxFramePos = 0;
+                    Parser_TxAddReply((char*)gapParserTspStatus[ERR_STATUS_IDX], strlen(gapParserTspStatus[ERR_STATUS_IDX]));
+                }
             }
+            continue;
         }
-        else
+
+        /* Body and CRC are copied in one go */
+        copyLen = PARSER_BIN_FRAME_HDR_LEN + mRxFrameLen + PARSER_BIN_FRAME_CRC_LEN - mRxFramePos;
+        if(copyLen > dataLen - consumed)
         {
-            /* Save the character */
-            mRxParserCmd.cmd[mRxParserCmd.crtCmdPos ++] = rxChar;
-            mRxParserCmd.crtWordPos ++;
+            copyLen = dataLen - consumed;
+        }
+        memcpy(&maRxFrame[mRxFramePos], &pData[consumed], copyLen);
+        mRxFramePos += copyLen;
+        consumed += copyLen;
 
-            if(mRxParserCmd.crtCmdPos >= strlen(gpParserLineDelim))
-            {
-                bIsEndLine = true;
+        if(mRxFramePos == PARSER_BIN_FRAME_HDR_LEN + mRxFrameLen + PARSER_BIN_FRAME_CRC_LEN)
+        {
+            /* Entire frame received */
+            mRxFramePos = 0;
+            pBody = &maRxFrame[PARSER_BIN_FRAME_HDR_LEN];
+            crc = (uint16_t)pBody[mRxFrameLen] | ((uint16_t)pBody[mRxFrameLen + 1] << 8);
+            pRxCmd = Parser_RxCrtLine();
 
-                for(iCount = strlen(gpParserLineDelim); (iCount > 0U) && bIsEndLine; iCount --)
+            if((crc == SYSTEM_Crc16(SYSTEM_CRC16_INIT_FRAME, pBody, mRxFrameLen)) &&
+               Parser_RxDecodeFrame(pRxCmd, pBody, mRxFrameLen))
+            {
+                /* Queue the command for execution */
+                mRxCmdQueueCount ++;
+                if(mRxCmdQueueCount >= PARSER_RX_CMD_QUEUE_SIZE)
                 {
-					
-                    if(mRxParserCmd.cmd[mRxParserCmd.crtCmdPos - iCount] != gpParserLineDelim[strlen(gpParserLineDelim) - iCount])
-                    {
-                        bIsEndLine = false;
-                    }
-					//printf("Comp %d ",bIsEndLine);
+                    break;
                 }
+                Parser_RxClearLine(Parser_RxCrtLine());
             }
-            if(bIsEndLine)
+            else
             {
-                /* Entire command received */
+                Parser_RxClearLine(pRxCmd);
+                Parser_TxAddReply((char*)gapParserTspStatus[ERR_STATUS_IDX], strlen(gapParserTspStatus[ERR_STATUS_IDX]));
+            }
+        }
+    }
 
-                /* Replace new line with \0 */
-                mRxParserCmd.cmd[mRxParserCmd.crtCmdPos - strlen(gpParserLineDelim)] = '\0';
+    return consumed;
+}
 
-                mRxParserCmd.wordLen[mRxParserCmd.crtWordIdx] = mRxParserCmd.crtWordPos - strlen(gpParserLineDelim);
-                mRxParserCmd.wordStartPos[mRxParserCmd.crtWordIdx] = mRxParserCmd.crtCmdPos - mRxParserCmd.crtWordPos;
+/* Turns a binary frame body into the same word list the ASCII tokenizer builds,
+ * so both protocols share the command tables and handlers. */
+static bool Parser_RxDecodeFrame(parserRxCmd_t* pRxCmd, const uint8_t* pBody, uint16_t bodyLen)
+{
+    const char* pCommand;
+    uint16_t wordLen;
+    uint8_t flags;
+    uint8_t paramsNb;
+    uint8_t paramLen;
+    uint16_t pos = 3U;
 
-                mRxParserCmd.bCmdStatus = 1;
-            }
+    if(bodyLen < 4U)
+    {
+        return false;
+    }
+
+    flags = pBody[0];
+    pCommand = Parser_RxFindOpcode((uint16_t)pBody[1] | ((uint16_t)pBody[2] << 8));
+    if(pCommand == NULL)
+    {
+        return false;
+    }
+
+    /* Split the command keywords; the handler is then found by name as in ASCII mode */
+    while(*pCommand != '\0')
+    {
+        wordLen = 0U;
+        while((pCommand[wordLen] != ' ') && (pCommand[wordLen] != '\0'))
+        {
+            wordLen ++;
+        }
+        if(!Parser_RxAddWord(pRxCmd, (const uint8_t*)pCommand, wordLen))
+        {
+            return false;
+        }
+        pCommand += wordLen;
+        if(*pCommand == ' ')
+        {
+            pCommand ++;
         }
     }
-    else
+
+    paramsNb = pBody[pos ++];
+    while(paramsNb --)
     {
-        retStatus = STATUS_ERROR;
+        if(pos >= bodyLen)
+        {
+            return false;
+        }
+        paramLen = pBody[pos ++];
+        if((paramLen == 0U) || (pos + paramLen > bodyLen))
+        {
+            return false;
+        }
+        if((paramsNb == 0U) && (flags & PARSER_BIN_FLAG_RAW_LAST_PARAM))
+        {
+            pRxCmd->binDataPos = pRxCmd->crtCmdPos;
+            pRxCmd->binDataLen = paramLen;
+        }
+        if(!Parser_RxAddWord(pRxCmd, &pBody[pos], paramLen))
+        {
+            return false;
+        }
+        pos += paramLen;
     }
 
-    if(STATUS_ERROR == retStatus)
+    /* The last word is not followed by a separator */
+    pRxCmd->crtWordIdx --;
+
+    return (pos == bodyLen);
+}
+
+/* Binary search of the opcode table, NULL for an unknown opcode */
+static const char* Parser_RxFindOpcode(uint16_t opcode)
+{
+    uint16_t low = 0U;
+    uint16_t high = gParserBinOpcodeSize;
+    uint16_t mid;
+
+    while(low < high)
     {
-        Parser_RxClearBuffer();
-        /* Send reply code */
-        Parser_TxAddReply((char*)gapParserTspStatus[ERR_STATUS_IDX], strlen(gapParserTspStatus[ERR_STATUS_IDX]));
+        mid = (uint16_t)((low + high) >> 1);
+        if(gaParserBinOpcode[mid].opcode == opcode)
+        {
+            return gaParserBinOpcode[mid].pCommand;
+        }
+        if(gaParserBinOpcode[mid].opcode < opcode)
+        {
+            low = mid + 1U;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return NULL;
+}
+
+static bool Parser_RxAddWord(parserRxCmd_t* pRxCmd, const uint8_t* pWord, uint16_t wordLen)
+{
+    if((pRxCmd->crtWordIdx >= PARSER_DEF_CMD_MAX_IDX) ||
+       (pRxCmd->crtCmdPos + wordLen + 1U > PARSER_DEF_CMD_MAX_LEN))
+    {
+        return false;
     }
 
+    memcpy(&pRxCmd->cmd[pRxCmd->crtCmdPos], pWord, wordLen);
+    pRxCmd->wordStartPos[pRxCmd->crtWordIdx] = pRxCmd->crtCmdPos;
+    pRxCmd->wordLen[pRxCmd->crtWordIdx] = wordLen;
+    pRxCmd->crtCmdPos += wordLen;
+    pRxCmd->cmd[pRxCmd->crtCmdPos ++] = '\0';
+    pRxCmd->crtWordIdx ++;
+
+    return true;
+}
+
+/* The next byte came after a silence: the rest of the partial frame was lost,
+ * e.g. on a corrupted length. Restart on the next start of frame byte instead
+ * of taking the following frames as payload. */
+void Parser_RxDropFrame(void)
+{
+    mRxFramePos = 0;
+}
+
+void Parser_SetProtocol(parserProtocol_t protocol)
+{
+    mParserProtocol = protocol;
+
+    /* Frames have no line delimiter, hand every byte over to the decoder */
+    sio2host_rx_wake_every_byte(protocol == PARSER_PROTOCOL_BIN);
+    /* and time the bytes as they arrive, the main loop may read them much later */
+    sio2host_rx_mark_gaps((protocol == PARSER_PROTOCOL_BIN) ? SwTimerGetTime : NULL,
+                          MS_TO_US(PARSER_BIN_FRAME_TIMEOUT_MS));
+
+    /* Drop whatever was partially received with the previous protocol */
+    mRxFramePos = 0;
+    if(mRxCmdQueueCount < PARSER_RX_CMD_QUEUE_SIZE)
+    {
+        Parser_RxClearLine(Parser_RxCrtLine());
+    }
+}
+
+parserProtocol_t Parser_GetProtocol(void)
+{
+    return mParserProtocol;
+}
+
+void Parser_TxAddBinFrame(uint8_t frameType, const uint8_t* pData, uint16_t dataLen)
+{
+    uint8_t frameHdr[PARSER_BIN_FRAME_HDR_LEN + 1];
+    uint8_t frameCrc[PARSER_BIN_FRAME_CRC_LEN];
+    uint16_t bodyLen = dataLen + 1U;
+    uint16_t crc;
+    uint16_t iCtr = dataLen;
+
+    frameHdr[0] = PARSER_BIN_FRAME_SOF;
+    frameHdr[1] = (uint8_t)bodyLen;
+    frameHdr[2] = (uint8_t)(bodyLen >> 8);
+    frameHdr[3] = frameType;
+
+    crc = SYSTEM_Crc16(SYSTEM_CRC16_INIT_FRAME, &frameHdr[3], 1U);
+    crc = SYSTEM_Crc16(crc, pData, dataLen);
+    frameCrc[0] = (uint8_t)crc;
+    frameCrc[1] = (uint8_t)(crc >> 8);
+
+    sio2host_tx(frameHdr, sizeof(frameHdr));
+    while(0 != iCtr)
+    {
+        if(BYTE_VALUE_LEN >= iCtr)
+        {
+            sio2host_tx((uint8_t *)pData, (uint8_t)iCtr);
+            iCtr = 0;
+        }
+        else
+        {
+            sio2host_tx((uint8_t *)pData, BYTE_VALUE_LEN);
+            iCtr -= BYTE_VALUE_LEN;
+            pData += BYTE_VALUE_LEN;
+        }
+    }
+    sio2host_tx(frameCrc, sizeof(frameCrc));
 }
 
 void Parser_TxAddReply(char* pReplyStr, uint16_t replyStrLen)
 {
     uint16_t iCtr = replyStrLen;
+
+    if(mParserProtocol == PARSER_PROTOCOL_BIN)
+    {
+        Parser_TxAddBinFrame(PARSER_BIN_FRAME_REPLY, (const uint8_t*)pReplyStr, replyStrLen);
+        return;
+    }
 	
 	/* Check if the length of UART String is can be fit in SIO2HOST TX Buffer */
 	while(0 != iCtr)
@@ -203,6 +571,6 @@ void Parser_TxAddReply(char* pReplyStr, uint16_t replyStrLen)
 	}
 	
     /* Put the delimiter string in UART */
-	sio2host_tx((uint8_t *)gpParserLineDelim,strlen(gpParserLineDelim));
+	sio2host_tx((uint8_t *)gpParserLineDelim, PARSER_END_LINE_DELIM_LEN);
 	
 }
@@ -40,6 +40,7 @@
 #include "board.h"
 #include "spi.h"
 #include "sys.h"
+#include <string.h>
 #ifdef CONF_PMM_ENABLE
 #include "pmm.h"
 #endif
@@ -146,6 +147,41 @@ static void HAL_ResetPinOutputValue(uint8_t value);
  */
 static uint8_t HAL_SPISend(uint8_t data);
 
+/*
+ * \brief This function shifts a burst of bytes through the SPI
+ * \param[in] txBuffer Bytes to be sent, 0xFF is sent if NULL
+ * \param[out] rxBuffer Bytes received, discarded if NULL
+ * \param[in] length Number of bytes in the burst
+ */
+static void HAL_SPIBurst(const uint8_t *txBuffer, uint8_t *rxBuffer, uint8_t length);
+
+#if (RADIO_SPI_DMA == 1)
+/*
+ * \brief This function sets up the DMAC channels of the radio SPI
+ */
+static void HAL_SPIDmaInit(void);
+
+/*
+ * \brief This function starts a burst of bytes through the SPI with the DMAC,
+ * the chip select is released and the callback called at its end
+ * \param[in] txBuffer Bytes to be sent, 0xFF is sent if NULL
+ * \param[out] rxBuffer Bytes received, discarded if NULL
+ * \param[in] length Number of bytes in the burst, not 0
+ * \param[in] callback Function called at the end of the burst
+ */
+static void HAL_SPIDmaStart(const uint8_t *txBuffer, uint8_t *rxBuffer, uint8_t length, RadioSpiDoneCallback_t callback);
+
+/*
+ * \brief This function waits for the end of the DMAC burst in progress, if any
+ */
+static void HAL_SPIDmaWait(void);
+
+/*
+ * \brief This function ends the DMAC burst once both channels are done
+ */
+static void HAL_SPIDmaComplete(void);
+#endif
+
 /*
  * \brief This function is called to select a SPI slave
  */
@@ -156,12 +192,72 @@ static void HAL_SPICSAssert(void);
  */
 static void HAL_SPICSDeassert(void);
 
+/*
+ * \brief This function keeps the register shadow in line with a write
+ * \param[in] reg Radio register written
+ * \param[in] value Value written into the radio register
+ */
+static void HAL_RegisterShadowUpdate(uint8_t reg, uint8_t value);
+
+/*
+ * \brief This function reads a register from the radio
+ * \param[in] reg Radio register to be read
+ * \retval  Value read from the radio register
+ */
+static uint8_t HAL_RegisterBusRead(uint8_t reg);
+
+/*
+ * \brief This function returns the registers the radio changes by itself in the
+ * current modulation, or in both when the modulation is not known
+ */
+static const uint32_t *HAL_RegisterStatusMask(void);
+
 /***************************************** GLOBALS ***************************/
 static struct spi_module master;
 struct spi_slave_inst slave;
 static uint8_t dioStatus;	
 
+/* Last value written to each register, valid when its bit is set */
+static uint8_t regShadow[RADIO_REG_COUNT];
+static uint32_t regShadowValid[RADIO_REG_COUNT / 32];
+
+/* Register writes queued for RADIO_RegisterSequenceWrite */
+static uint8_t regStaged[RADIO_REG_COUNT];
+static uint32_t regStagedMask[RADIO_REG_COUNT / 32];
+
+/* Registers the radio changes by itself, always read and written: FIFO (0x00), OPMODE (0x01),
+ * LoRa FIFO pointer / FSK RxConfig (0x0D), IRQ flags (LoRa 0x12, FSK 0x3E, 0x3F), the
+ * read-only status, RSSI, FEI and packet registers and the self-clearing command bits
+ * (FSK 0x1A, 0x36, 0x3B) */
+static const uint32_t regStatusMaskLora[RADIO_REG_COUNT / 32] = {0x1FFD2003, 0x00001720, 0x08000004, 0xFFFEFFE1};
+static const uint32_t regStatusMaskFsk[RADIO_REG_COUNT / 32] = {0x7C022003, 0xD8400000, 0x08000004, 0xFFFEFFE1};
+static const uint32_t regStatusMaskAny[RADIO_REG_COUNT / 32] = {0x7FFF2003, 0xD8401720, 0x08000004, 0xFFFEFFE1};
+
+#if (RADIO_SPI_STATS == 1)
+static RadioSpiStats_t spiStats;
+static uint32_t spiCycleStartSaved;
+#endif
+
+#if (RADIO_SPI_DMA == 1)
+/* Descriptors of the DMAC, indexed by channel */
+COMPILER_ALIGNED(16) static DmacDescriptor spiDmaDescriptor[2];
+COMPILER_ALIGNED(16) static DmacDescriptor spiDmaWriteback[2];
+
+static volatile bool spiDmaBusy;
+static RadioSpiDoneCallback_t spiDmaCallback;
+/* Source of the bytes sent without a buffer and sink of those discarded */
+static const uint8_t spiDmaIdle = 0xFF;
+static uint8_t spiDmaDiscard;
+#endif
+
 /***************************************** MACROS *****************************/
+#define REG_OPMODE_ADDRESS        0x01
+#define REG_OPMODE_LONGRANGE      0x80
+#define REG_OPMODE_ACCESSSHARED   0x40
+
+#define REG_BIT_GET(mask, reg)    ((mask)[(reg) >> 5] & (1UL << ((reg) & 0x1F)))
+#define REG_BIT_SET(mask, reg)    ((mask)[(reg) >> 5] |= (1UL << ((reg) & 0x1F)))
+
 /*The SPI Baud rate needs to be defined in conf_board.h*/
 
 #ifndef SX_RF_SPI_BAUDRATE
@@ -169,6 +265,19 @@ static uint8_t dioStatus;
 #define SX_RF_SPI_BAUDRATE 2000000
 #endif
 
+#if (RADIO_SPI_DMA == 1)
+/* DMAC channels of the radio SPI. The receive channel takes the last byte
+ * off the wire, so its completion is the end of the burst */
+#define RADIO_SPI_DMA_RX_CH        0
+#define RADIO_SPI_DMA_TX_CH        1
+
+/* DMAC triggers of SX_RF_SPI */
+#ifndef SX_RF_SPI_DMAC_ID_RX
+#define SX_RF_SPI_DMAC_ID_RX       SERCOM4_DMAC_ID_RX
+#define SX_RF_SPI_DMAC_ID_TX       SERCOM4_DMAC_ID_TX
+#endif
+#endif
+
 /*********************************** Implementation***************************/
 
 /** 
@@ -196,6 +305,9 @@ void HAL_Radio_resources_init(void)
  */
 void HAL_RadioDeInit(void)
 {
+#if (RADIO_SPI_DMA == 1)
+	HAL_SPIDmaWait();
+#endif
 	spi_disable(&master);
 }
  
@@ -212,6 +324,9 @@ void RADIO_Reset(void)
 	//Added these two lines to make sure this pin is not left in floating state during sleep
 	HAL_ResetPinOutputValue(1);
 	HAL_ResetPinMakeOutput();
+
+	// Registers are back to their reset values
+	RADIO_RegisterCacheInvalidate();
 }
 
 /** 
@@ -220,13 +335,126 @@ void RADIO_Reset(void)
  * \param[in] value Value to be written into the radio register
  */
 void RADIO_RegisterWrite(uint8_t reg, uint8_t value)
+{
+	uint8_t txBuffer[2] = {REG_WRITE_CMD | reg, value};
+
+	HAL_SPICSAssert();
+	HAL_SPIBurst(txBuffer, NULL, sizeof(txBuffer));
+	HAL_SPICSDeassert();
+	HAL_RegisterShadowUpdate(reg, value);
+}
+
+/** 
+ * \brief This function is used to write consecutive registers in a single burst, without
+ * going through the queue of RADIO_RegisterStage, so that it can be called from an interrupt
+ * \param[in] reg First radio register to be written
+ * \param[in] values Values to be written into the radio registers
+ * \param[in] count Number of registers to be written
+ */
+void RADIO_RegisterBurstWrite(uint8_t reg, const uint8_t *values, uint8_t count)
 {
 	HAL_SPICSAssert();
 	HAL_SPISend(REG_WRITE_CMD | reg);
-	HAL_SPISend(value);
+	HAL_SPIBurst(values, NULL, count);
 	HAL_SPICSDeassert();
+
+	for (uint8_t idx = 0; idx < count; idx++)
+	{
+		HAL_RegisterShadowUpdate(reg + idx, values[idx]);
+	}
+}
+
+/** 
+ * \brief This function is used to queue a register write for RADIO_RegisterSequenceWrite,
+ * a later value for the same register replaces the queued one. The queue is not shared
+ * with the interrupts, which write with RADIO_RegisterBurstWrite
+ * \param[in] reg Radio register to be written
+ * \param[in] value Value to be written into the radio register
+ */
+void RADIO_RegisterStage(uint8_t reg, uint8_t value)
+{
+	reg &= (RADIO_REG_COUNT - 1);
+	regStaged[reg] = value;
+	REG_BIT_SET(regStagedMask, reg);
 }
 
+/** 
+ * \brief This function is used to write the queued registers in address order. Registers
+ * already holding the queued value are skipped and consecutive addresses are written
+ * in a single burst
+ */
+void RADIO_RegisterSequenceWrite(void)
+{
+	const uint32_t *statusMask = HAL_RegisterStatusMask();
+	uint8_t reg = 0;
+	uint8_t first;
+
+	while (reg < RADIO_REG_COUNT)
+	{
+		first = reg;
+		while ((reg < RADIO_REG_COUNT) && REG_BIT_GET(regStagedMask, reg) &&
+			(REG_BIT_GET(statusMask, reg) || !REG_BIT_GET(regShadowValid, reg) ||
+			(regShadow[reg] != regStaged[reg])))
+		{
+			HAL_RegisterShadowUpdate(reg, regStaged[reg]);
+			reg++;
+		}
+
+		if (reg == first)
+		{
+#if (RADIO_SPI_STATS == 1)
+			if (REG_BIT_GET(regStagedMask, reg))
+			{
+				spiStats.saved++;
+			}
+#endif
+			reg++;
+		}
+		else
+		{
+#if (RADIO_SPI_STATS == 1)
+			spiStats.saved += reg - first - 1;
+#endif
+			HAL_SPICSAssert();
+			HAL_SPISend(REG_WRITE_CMD | first);
+			HAL_SPIBurst(&regStaged[first], NULL, reg - first);
+			HAL_SPICSDeassert();
+		}
+	}
+
+	memset(regStagedMask, 0, sizeof(regStagedMask));
+}
+
+/** 
+ * \brief This function is used to forget the register values last written, so that the
+ * next sequence writes every register
+ */
+void RADIO_RegisterCacheInvalidate(void)
+{
+	memset(regShadowValid, 0, sizeof(regShadowValid));
+}
+
+#if (RADIO_SPI_STATS == 1)
+/** 
+ * \brief This function is used to get the SPI transaction accounting
+ * \param[out] stats SPI transaction accounting since reset
+ */
+void RADIO_GetSpiStats(RadioSpiStats_t *stats)
+{
+	*stats = spiStats;
+}
+
+/** 
+ * \brief This function is called at the start of each TX or RX cycle to
+ * close the count of the transactions saved in the previous one
+ */
+void RADIO_SpiStatsNewCycle(void)
+{
+	spiStats.lastCycleSaved = (uint16_t)(spiStats.saved - spiCycleStartSaved);
+	spiCycleStartSaved = spiStats.saved;
+}
+#endif
+
 /** 
  * \brief This function is used to read a byte of data from the radio register
  * \param[in] reg Radio register to be read
@@ -236,10 +464,38 @@ uint8_t RADIO_RegisterRead(uint8_t reg)
 {
 	uint8_t readValue;
 	reg &= 0x7F;    // Make sure write bit is not set
-	HAL_SPICSAssert();
-	HAL_SPISend(reg);
-	readValue = HAL_SPISend(0xFF);
-	HAL_SPICSDeassert();
+
+	if (REG_BIT_GET(HAL_RegisterStatusMask(), reg))
+	{
+		return HAL_RegisterBusRead(reg);
+	}
+
+	if (REG_BIT_GET(regShadowValid, reg))
+	{
+#if (RADIO_REG_SHADOW_CHECK == 1)
+		readValue = HAL_RegisterBusRead(reg);
+		if (readValue != regShadow[reg])
+		{
+#if (RADIO_SPI_STATS == 1)
+			spiStats.mismatches++;
+#endif
+			regShadow[reg] = readValue;
+		}
+		return readValue;
+#else
+#if (RADIO_SPI_STATS == 1)
+		spiStats.saved++;
+#endif
+		return regShadow[reg];
+#endif
+	}
+
+	readValue = HAL_RegisterBusRead(reg);
+	// The valid bits are shared with the writes made from the DIO interrupts
+	cpu_irq_enter_critical();
+	regShadow[reg] = readValue;
+	REG_BIT_SET(regShadowValid, reg);
+	cpu_irq_leave_critical();
 	return readValue;
 }
 
@@ -253,15 +509,40 @@ void RADIO_FrameWrite(uint8_t offset, uint8_t* buffer, uint8_t bufferLen)
 {
     HAL_SPICSAssert();
     HAL_SPISend(REG_WRITE_CMD | offset);
-
-    for (uint8_t i = 0; i < bufferLen; i++)
-    {
-	    HAL_SPISend(buffer[i]);
-    }
+    HAL_SPIBurst(buffer, NULL, bufferLen);
     HAL_SPICSDeassert();
 
 }
 
+/** 
+ * \brief This function is used to start writing a stream of data into the Radio Frame
+ * buffer and return before it is shifted out. The buffer must be left untouched until
+ * the callback, any other radio SPI access waits for the end of the transfer
+ * \param[in] FIFO offset to be written to
+ * \param[in] buffer Pointer to the data to be written into the frame buffer
+ * \param[in] bufferLen Length of the data to be written
+ * \param[in] callback Function called once the data is in the frame buffer
+ */
+void RADIO_FrameWriteAsync(uint8_t offset, uint8_t* buffer, uint8_t bufferLen, RadioSpiDoneCallback_t callback)
+{
+	HAL_SPICSAssert();
+	HAL_SPISend(REG_WRITE_CMD | offset);
+#if (RADIO_SPI_DMA == 1)
+	if (0 != bufferLen)
+	{
+		HAL_SPIDmaStart(buffer, NULL, bufferLen, callback);
+		return;
+	}
+#endif
+	HAL_SPIBurst(buffer, NULL, bufferLen);
+	HAL_SPICSDeassert();
+
+	if (NULL != callback)
+	{
+		callback();
+	}
+}
+
 /** 
  * \brief This function is used to  read a stream of data from the Radio Frame buffer
  * \param[in] FIFO offset to be read from
@@ -272,10 +553,7 @@ void RADIO_FrameRead(uint8_t offset, uint8_t* buffer, uint8_t bufferLen)
 {
     HAL_SPICSAssert();
     HAL_SPISend(offset);
-    for (uint8_t i = 0; i < bufferLen; i++)
-    {
-	    buffer[i] = HAL_SPISend(0xFF);
-    }
+    HAL_SPIBurst(NULL, buffer, bufferLen);
     HAL_SPICSDeassert();
 }
 
@@ -490,14 +768,16 @@ static void HAL_RadioDIO5Callback(void)
     interruptHandlerDio5();
   }
 }
+#endif
+
 /** 
- * \brief This function is used to read the status of  DIO5 pin
+ * \brief This function is used to read the status of  DIO5 pin, the pin is
+ * read even without its interrupt to know when a mode switch is over
  */
 uint8_t HAL_DIO5PinValue(void)
 {
-	return port_pin_get_input_level(DIO5_EIC_PIN);
+	return port_pin_get_input_level(DIO5_PIN);
 }
-#endif
 
 /** 
  * \brief This function is used to get the interrupt status
@@ -548,7 +828,10 @@ void HAL_RadioSpiInit(void)
 	
 	spi_init(&master, SX_RF_SPI, &config_spi_master);	
 	spi_enable(&master);
-	
+
+#if (RADIO_SPI_DMA == 1)
+	HAL_SPIDmaInit();
+#endif
 }
 
 
@@ -636,6 +919,11 @@ static void HAL_RadioIOInit(void)
 	extint_chan_set_config(DIO5_EIC_LINE, &config_extint_chan);
 	extint_register_callback(HAL_RadioDIO5Callback,DIO5_EIC_LINE,EXTINT_CALLBACK_TYPE_DETECT);
 	extint_chan_enable_callback(DIO5_EIC_LINE,EXTINT_CALLBACK_TYPE_DETECT);
+	#else
+	// DIO5 relays ModeReady, polled without interrupt
+	pin_conf.direction  = PORT_PIN_DIR_INPUT;
+	pin_conf.input_pull = PORT_PIN_PULL_NONE;
+	port_pin_set_config(DIO5_PIN, &pin_conf);
 	#endif
 }
 
@@ -682,6 +970,13 @@ static void HAL_ResetPinOutputValue(uint8_t value)
  */
 static void HAL_SPICSAssert(void)
 {
+#if (RADIO_SPI_DMA == 1)
+	/* The radio sees one transaction until the burst in flight is over */
+	HAL_SPIDmaWait();
+#endif
+#if (RADIO_SPI_STATS == 1)
+	spiStats.transactions++;
+#endif
 	spi_select_slave(&master, &slave, true);
 }
 
@@ -712,6 +1007,193 @@ static uint8_t HAL_SPISend(uint8_t data)
 	return ((uint8_t)read_val);
 }
 
+static void HAL_RegisterShadowUpdate(uint8_t reg, uint8_t value)
+{
+	reg &= (RADIO_REG_COUNT - 1);
+
+	// The DIO interrupts write registers too
+	cpu_irq_enter_critical();
+
+	// Addresses 0x0D - 0x3F are different registers in LoRa and FSK mode
+	if ((REG_OPMODE_ADDRESS == reg) && (!REG_BIT_GET(regShadowValid, reg) ||
+		((regShadow[reg] ^ value) & REG_OPMODE_LONGRANGE)))
+	{
+		regShadowValid[0] &= 0x00001FFF;
+		regShadowValid[1] = 0;
+	}
+
+	regShadow[reg] = value;
+	REG_BIT_SET(regShadowValid, reg);
+	cpu_irq_leave_critical();
+}
+
+static uint8_t HAL_RegisterBusRead(uint8_t reg)
+{
+	uint8_t txBuffer[2] = {reg, 0xFF};
+	uint8_t rxBuffer[2];
+
+	HAL_SPICSAssert();
+	HAL_SPIBurst(txBuffer, rxBuffer, sizeof(txBuffer));
+	HAL_SPICSDeassert();
+	return rxBuffer[1];
+}
+
+static const uint32_t *HAL_RegisterStatusMask(void)
+{
+	if (!REG_BIT_GET(regShadowValid, REG_OPMODE_ADDRESS) ||
+		(regShadow[REG_OPMODE_ADDRESS] & REG_OPMODE_ACCESSSHARED))
+	{
+		return regStatusMaskAny;
+	}
+
+	return (regShadow[REG_OPMODE_ADDRESS] & REG_OPMODE_LONGRANGE) ? regStatusMaskLora : regStatusMaskFsk;
+}
+
+static void HAL_SPIBurst(const uint8_t *txBuffer, uint8_t *rxBuffer, uint8_t length)
+{
+	SercomSpi *const spi_module = &(master.hw->SPI);
+	uint8_t txCount = 0;
+	uint8_t rxCount = 0;
+	uint8_t data;
+
+	/* The next byte is queued in DATA while the current one shifts out, so
+	 * the clock runs without gaps. At most two bytes are in flight, which
+	 * is what the receive buffer holds, so it cannot overflow. */
+	while (rxCount < length)
+	{
+		if ((txCount < length) && ((uint8_t)(txCount - rxCount) < 2) &&
+			(spi_module->INTFLAG.reg & SERCOM_SPI_INTFLAG_DRE))
+		{
+			spi_module->DATA.reg = (NULL == txBuffer) ? 0xFF : txBuffer[txCount];
+			txCount++;
+		}
+
+		if (spi_module->INTFLAG.reg & SERCOM_SPI_INTFLAG_RXC)
+		{
+			data = (uint8_t)spi_module->DATA.reg;
+			if (NULL != rxBuffer)
+			{
+				rxBuffer[rxCount] = data;
+			}
+			rxCount++;
+		}
+	}
+}
+
+#if (RADIO_SPI_DMA == 1)
+static void HAL_SPIDmaInit(void)
+{
+	MCLK->AHBMASK.reg |= MCLK_AHBMASK_DMAC;
+
+	DMAC->CTRL.reg &= ~DMAC_CTRL_DMAENABLE;
+	DMAC->CTRL.reg = DMAC_CTRL_SWRST;
+	while (DMAC->CTRL.reg & DMAC_CTRL_SWRST);
+
+	DMAC->BASEADDR.reg = (uint32_t)spiDmaDescriptor;
+	DMAC->WRBADDR.reg = (uint32_t)spiDmaWriteback;
+	DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN0 | DMAC_CTRL_LVLEN1;
+
+	/* The receive channel is served first, so that the receive buffer is
+	 * drained before the transmit channel queues the next byte */
+	DMAC->CHID.reg = DMAC_CHID_ID(RADIO_SPI_DMA_RX_CH);
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+	while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST);
+	DMAC->CHCTRLB.reg = DMAC_CHCTRLB_TRIGSRC(SX_RF_SPI_DMAC_ID_RX) |
+		DMAC_CHCTRLB_TRIGACT_BEAT | DMAC_CHCTRLB_LVL(1);
+	DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL | DMAC_CHINTENSET_TERR;
+
+	DMAC->CHID.reg = DMAC_CHID_ID(RADIO_SPI_DMA_TX_CH);
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+	while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST);
+	DMAC->CHCTRLB.reg = DMAC_CHCTRLB_TRIGSRC(SX_RF_SPI_DMAC_ID_TX) |
+		DMAC_CHCTRLB_TRIGACT_BEAT | DMAC_CHCTRLB_LVL(0);
+
+	spiDmaBusy = false;
+	system_interrupt_enable(SYSTEM_INTERRUPT_MODULE_DMA);
+}
+
+static void HAL_SPIDmaStart(const uint8_t *txBuffer, uint8_t *rxBuffer, uint8_t length, RadioSpiDoneCallback_t callback)
+{
+	SercomSpi *const spi_module = &(master.hw->SPI);
+	DmacDescriptor *rxDescriptor = &spiDmaDescriptor[RADIO_SPI_DMA_RX_CH];
+	DmacDescriptor *txDescriptor = &spiDmaDescriptor[RADIO_SPI_DMA_TX_CH];
+
+	/* An incremented address is the one past the last beat */
+	rxDescriptor->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE |
+		DMAC_BTCTRL_BLOCKACT_NOACT | ((NULL == rxBuffer) ? 0 : DMAC_BTCTRL_DSTINC);
+	rxDescriptor->BTCNT.reg = length;
+	rxDescriptor->SRCADDR.reg = (uint32_t)&spi_module->DATA.reg;
+	rxDescriptor->DSTADDR.reg = (NULL == rxBuffer) ? (uint32_t)&spiDmaDiscard : (uint32_t)(rxBuffer + length);
+	rxDescriptor->DESCADDR.reg = 0;
+
+	txDescriptor->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE |
+		DMAC_BTCTRL_BLOCKACT_NOACT | ((NULL == txBuffer) ? 0 : DMAC_BTCTRL_SRCINC);
+	txDescriptor->BTCNT.reg = length;
+	txDescriptor->SRCADDR.reg = (NULL == txBuffer) ? (uint32_t)&spiDmaIdle : (uint32_t)(txBuffer + length);
+	txDescriptor->DSTADDR.reg = (uint32_t)&spi_module->DATA.reg;
+	txDescriptor->DESCADDR.reg = 0;
+
+	spiDmaCallback = callback;
+	spiDmaBusy = true;
+
+	/* CHID is shared with the DMAC interrupt */
+	cpu_irq_enter_critical();
+	DMAC->CHID.reg = DMAC_CHID_ID(RADIO_SPI_DMA_RX_CH);
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+	DMAC->CHID.reg = DMAC_CHID_ID(RADIO_SPI_DMA_TX_CH);
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+	cpu_irq_leave_critical();
+}
+
+static void HAL_SPIDmaWait(void)
+{
+	/* The end is polled from the DMAC rather than left to its interrupt, so
+	 * that the wait also returns with the interrupts masked */
+	if (spiDmaBusy)
+	{
+		while (spiDmaBusy && !(DMAC->INTSTATUS.reg & (1UL << RADIO_SPI_DMA_RX_CH)));
+		HAL_SPIDmaComplete();
+	}
+}
+
+static void HAL_SPIDmaComplete(void)
+{
+	RadioSpiDoneCallback_t callback = NULL;
+
+	cpu_irq_enter_critical();
+	DMAC->CHID.reg = DMAC_CHID_ID(RADIO_SPI_DMA_RX_CH);
+	if (DMAC->CHINTFLAG.reg & (DMAC_CHINTFLAG_TCMPL | DMAC_CHINTFLAG_TERR))
+	{
+		DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL | DMAC_CHINTFLAG_TERR;
+		// After a transfer error the transmit channel may still be running
+		DMAC->CHCTRLA.reg = 0;
+		DMAC->CHID.reg = DMAC_CHID_ID(RADIO_SPI_DMA_TX_CH);
+		DMAC->CHCTRLA.reg = 0;
+
+		if (spiDmaBusy)
+		{
+			spiDmaBusy = false;
+			HAL_SPICSDeassert();
+			callback = spiDmaCallback;
+		}
+	}
+	cpu_irq_leave_critical();
+
+	if (NULL != callback)
+	{
+		callback();
+	}
+}
+
+/**
+ * \brief DMAC interrupt, raised at the end of a radio SPI burst
+ */
+void DMAC_Handler(void)
+{
+	HAL_SPIDmaComplete();
+}
+#endif
+
 /**
  * \brief This function sets the interrupt handler for given DIO interrupt
  *
@@ -598,6 +598,20 @@ typedef enum _LorawanAttributes
     JOIN_NONCE_TYPE
 } LorawanAttributes_t;
 
+/* Opening error of a receive window: time from the end of the transmission
+   to the open callback, minus the programmed receive delay */
+typedef struct _LorawanRxWindowStats
+{
+	/* Number of windows opened */
+	uint32_t openCount;
+	/* Error of the last opening in microseconds */
+	int32_t lastError;
+	/* Largest error in microseconds */
+	int32_t maxError;
+	/* Sum of the errors in microseconds */
+	int64_t totalError;
+}LorawanRxWindowStats_t;
+
 /* Structure holding Receive window2 parameters*/
 /* This can be used for setting/getting RX2_WINDOW_PARAMS attribute */
 typedef struct _ReceiveWindow2Params
@@ -845,6 +859,23 @@ StackRetStatus_t LORAWAN_GetAttr(LorawanAttributes_t attrType, void *attrInput,
 */
 void LORAWAN_SetCallbackBitmask(uint32_t evtmask);
 
+/**
+ * @Summary
+    LoRaWAN receive window timing function.
+ * @Description
+    This function returns how late the receive windows were opened, relative
+    to the end of the transmission. Available when SWTIMER_STATS is 1.
+ * @Preconditions
+    None
+ * @Param
+    window - 0 for RX1 (join accept 1 included), 1 for RX2
+    stats - pointer to the opening error accounting of the window
+ * @Returns
+    none
+ * @Example
+*/
+void LORAWAN_GetRxWindowStats(uint8_t window, LorawanRxWindowStats_t *stats);
+
 /**
  * @Summary
     This function returns the readiness of the stack for sleep
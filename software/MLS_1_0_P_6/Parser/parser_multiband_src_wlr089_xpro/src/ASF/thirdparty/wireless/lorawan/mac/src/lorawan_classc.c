@@ -255,7 +255,7 @@ void LorawanClasscRxDone(Hdr_t *hdr)
         }
         else
         {
-			SwTimerStart(loRa.classCParams.ulAckTimerId, MS_TO_US(RETRANSMIT_TIMEOUT), SW_TIMEOUT_RELATIVE, (void *)LorawanClasscUlAckTimerCallback, NULL);
+			SwTimerStartWithSlack(loRa.classCParams.ulAckTimerId, MS_TO_US(RETRANSMIT_TIMEOUT), SW_TIMEOUT_RELATIVE, RETRANSMIT_TIMER_SLACK, (void *)LorawanClasscUlAckTimerCallback, NULL);
         }
     }
 
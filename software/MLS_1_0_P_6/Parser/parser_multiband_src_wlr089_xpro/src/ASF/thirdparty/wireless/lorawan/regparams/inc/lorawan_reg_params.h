@@ -38,7 +38,13 @@
 #define JOIN_ACCEPT_DELAY2					6000UL
 #define ADR_ACK_LIMIT						64
 #define ADR_ACK_DELAY						32
-#define RETRANSMIT_TIMEOUT							1000+(rand()%2001)
+#define RETRANSMIT_TIMEOUT							1000+(RADIO_GetRandom()%2001)
+/* Lateness tolerated by the timers that need no precision, lets their
+   expiries share a wakeup. Receive window timers have no slack. */
+#define DUTY_CYCLE_TIMER_SLACK              MS_TO_US(100UL)
+#define JOIN_DUTY_CYCLE_TIMER_SLACK         MS_TO_US(1000UL)
+#define LINK_CHECK_TIMER_SLACK              MS_TO_US(1000UL)
+#define RETRANSMIT_TIMER_SLACK              MS_TO_US(100UL)
 /* Join dutycycle Prescalar for first 1hr*/
 #define JOIN_BACKOFF_PRESCALAR_1HR          100
 /*Join dutycycle prescalar for 2nd hour from start to 11th hr*/
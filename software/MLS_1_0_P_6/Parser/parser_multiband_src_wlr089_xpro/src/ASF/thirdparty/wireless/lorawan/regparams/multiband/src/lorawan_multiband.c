@@ -2638,7 +2638,7 @@ static StackRetStatus_t SearchAvailableChannel1 (uint8_t maxChannels, bool trans
 	/* Get a random number and select a channel */
 	if(0 != num)
 	{
-		randomNumber = rand() % num;
+		randomNumber = RADIO_GetRandom() % num;
 		*channelIndex = ChList[randomNumber][0];
 		chUsed[*channelIndex] = true;
 	#if (RANDOM_NW_ACQ == 1)          
@@ -2732,7 +2732,7 @@ static StackRetStatus_t select_channel_jr(uint8_t currDr, uint8_t* channelIndex)
 		/* Get a random number and select a channel */
 		if(0 != num)
 		{
-			randomNumber = rand() % num;
+			randomNumber = RADIO_GetRandom() % num;
 			*channelIndex = ChList[randomNumber][0];
 #if (RANDOM_NW_ACQ == 1)          
 			/* Update the lastUsedSB value based on the channel selected */
@@ -2834,7 +2834,7 @@ static StackRetStatus_t SearchAvailableChannel2 (uint8_t maxChannels, bool trans
 	}
 	if(0 != num)
 	{
-		randomNumber = rand() % num;
+		randomNumber = RADIO_GetRandom() % num;
 		*channelIndex = ChList[randomNumber];
 	}
 	else
@@ -3017,7 +3017,7 @@ static void DutyCycleCallback (uint8_t param)
 		}
 
         RegParams.pDutyCycleTimer->lastTimerValue = nextTimer;
-		SwTimerStart (RegParams.pDutyCycleTimer->timerId, MS_TO_US(nextTimer), SW_TIMEOUT_RELATIVE, (void *)DutyCycleCallback, NULL);
+		SwTimerStartWithSlack(RegParams.pDutyCycleTimer->timerId, MS_TO_US(nextTimer), SW_TIMEOUT_RELATIVE, DUTY_CYCLE_TIMER_SLACK, (void *)DutyCycleCallback, NULL);
         
     }
 }
@@ -3043,12 +3043,12 @@ void JoinDutyCycleCallback (uint8_t param)
 		if(RegParams.pJoinDutyCycleTimer->remainingtime>US_TO_MS(SWTIMER_MAX_TIMEOUT))
 		{
 			RegParams.pJoinDutyCycleTimer->remainingtime = RegParams.pJoinDutyCycleTimer->remainingtime-(US_TO_MS(SWTIMER_MAX_TIMEOUT));
-			SwTimerStart(RegParams.pJoinDutyCycleTimer->timerId, SWTIMER_MAX_TIMEOUT, SW_TIMEOUT_RELATIVE, (void *)JoinDutyCycleCallback, NULL);
+			SwTimerStartWithSlack(RegParams.pJoinDutyCycleTimer->timerId, SWTIMER_MAX_TIMEOUT, SW_TIMEOUT_RELATIVE, JOIN_DUTY_CYCLE_TIMER_SLACK, (void *)JoinDutyCycleCallback, NULL);
 			
 		}
 		else
 		{
-			SwTimerStart(RegParams.pJoinDutyCycleTimer->timerId, MS_TO_US(RegParams.pJoinDutyCycleTimer->remainingtime), SW_TIMEOUT_RELATIVE, (void *)JoinDutyCycleCallback, NULL);
+			SwTimerStartWithSlack(RegParams.pJoinDutyCycleTimer->timerId, MS_TO_US(RegParams.pJoinDutyCycleTimer->remainingtime), SW_TIMEOUT_RELATIVE, JOIN_DUTY_CYCLE_TIMER_SLACK, (void *)JoinDutyCycleCallback, NULL);
 			RegParams.pJoinDutyCycleTimer->remainingtime =0;
 		}
 	}
@@ -3875,7 +3875,7 @@ static StackRetStatus_t setDutyCycleTimer(LorawanRegionalAttributes_t attr, void
 		}
 		
 		RegParams.pDutyCycleTimer->lastTimerValue = nextTimer;
-		SwTimerStart (RegParams.pDutyCycleTimer->timerId, MS_TO_US(nextTimer), SW_TIMEOUT_RELATIVE, (void *)DutyCycleCallback, NULL);
+		SwTimerStartWithSlack(RegParams.pDutyCycleTimer->timerId, MS_TO_US(nextTimer), SW_TIMEOUT_RELATIVE, DUTY_CYCLE_TIMER_SLACK, (void *)DutyCycleCallback, NULL);
 	}
 	return result;
 }
@@ -3913,7 +3913,7 @@ static StackRetStatus_t setDutyCycleTimer1(LorawanRegionalAttributes_t attr, voi
 	{
 		nextTimer = RegParams.aggregatedDutyCycleTimeout;
 		RegParams.pDutyCycleTimer->lastTimerValue = nextTimer;
-		result = SwTimerStart (RegParams.pDutyCycleTimer->timerId, MS_TO_US(nextTimer), SW_TIMEOUT_RELATIVE, (void *)DutyCycleCallback1, NULL);
+		result = SwTimerStartWithSlack(RegParams.pDutyCycleTimer->timerId, MS_TO_US(nextTimer), SW_TIMEOUT_RELATIVE, DUTY_CYCLE_TIMER_SLACK, (void *)DutyCycleCallback1, NULL);
 	}
 	
 	return result;
@@ -3966,13 +3966,13 @@ static StackRetStatus_t setJoinDutyCycleTimer(LorawanRegionalAttributes_t attr,
 				if(RegParams.joinDutyCycleTimeout > US_TO_MS(SWTIMER_MAX_TIMEOUT))
 				{
 					RegParams.pJoinDutyCycleTimer->remainingtime =RegParams.joinDutyCycleTimeout - (US_TO_MS(SWTIMER_MAX_TIMEOUT)) ;
-					SwTimerStart(RegParams.pJoinDutyCycleTimer->timerId, SWTIMER_MAX_TIMEOUT, SW_TIMEOUT_RELATIVE, (void *)JoinDutyCycleCallback, NULL);
+					SwTimerStartWithSlack(RegParams.pJoinDutyCycleTimer->timerId, SWTIMER_MAX_TIMEOUT, SW_TIMEOUT_RELATIVE, JOIN_DUTY_CYCLE_TIMER_SLACK, (void *)JoinDutyCycleCallback, NULL);
 					RegParams.joinDutyCycleTimeout = RegParams.joinDutyCycleTimeout - (US_TO_MS(SWTIMER_MAX_TIMEOUT));
 				
 				}
 				else
 				{
-				SwTimerStart (RegParams.pJoinDutyCycleTimer->timerId, MS_TO_US(RegParams.joinDutyCycleTimeout), SW_TIMEOUT_RELATIVE, (void *)JoinDutyCycleCallback, NULL);
+				SwTimerStartWithSlack(RegParams.pJoinDutyCycleTimer->timerId, MS_TO_US(RegParams.joinDutyCycleTimeout), SW_TIMEOUT_RELATIVE, JOIN_DUTY_CYCLE_TIMER_SLACK, (void *)JoinDutyCycleCallback, NULL);
 				}
 			}
 			else
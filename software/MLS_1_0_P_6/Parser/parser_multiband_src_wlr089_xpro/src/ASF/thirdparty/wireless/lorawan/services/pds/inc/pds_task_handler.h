@@ -44,18 +44,21 @@
                    Includes section
 ******************************************************************************/
 #include "system_task_manager.h"
+#include "pds_interface.h"
 
 /******************************************************************************
                    Defines section
 ******************************************************************************/
-#define PDS_TASKS_COUNT               1u
+#define PDS_TASKS_COUNT               2u
 
 /******************************************************************************
                                Types section
 *******************************************************************************/
 typedef enum
 {
-  PDS_STORE_DELETE_TASK_ID = (1 << 0)
+  PDS_STORE_DELETE_TASK_ID = (1 << 0),
+  /* Queued counter journal writes, after the row writes */
+  PDS_JOURNAL_TASK_ID = (1 << 1)
 } PdsTaskIds_t;
 
 /******************************************************************************
@@ -77,6 +80,21 @@ void pdsPostTask(PdsTaskIds_t id);
 ******************************************************************************/
 void pdsClearTask(PdsTaskIds_t id);
 
+/**************************************************************************//**
+\brief Writes the marks of all the dirty files now, see PDS_Flush.
+
+\param[out] status - PDS_OK, or the error of the first row write that failed.
+******************************************************************************/
+PdsStatus_t pdsFlush(void);
+
+/**************************************************************************//**
+\brief Checks if the PDS task must keep off the flash, see PDS_HoldFor.
+       The task is posted again when the hold is over.
+
+\param[out] - return true or false
+******************************************************************************/
+bool pdsIsHeld(void);
+
 #endif  /*_PDS_DRIVER_TASKMANAGER_H*/
 
 /* eof pds_task_handler.h */
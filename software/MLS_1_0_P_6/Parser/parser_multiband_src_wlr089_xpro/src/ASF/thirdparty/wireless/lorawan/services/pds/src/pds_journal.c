@@ -0,0 +1,562 @@
+/**
+* \file  pds_journal.c
+*
+* \brief This is the Pds counter journal source file which contains Pds counter
+*        journal implimentation.
+*		
+*
+* Copyright (c) 2020 Microchip Technology Inc. and its subsidiaries. 
+*
+* \asf_license_start
+*
+* \page License
+*
+* Subject to your compliance with these terms, you may use Microchip
+* software and any derivatives exclusively with Microchip products. 
+* It is your responsibility to comply with third party license terms applicable 
+* to your use of third party software (including open source software) that 
+* may accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, 
+* WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, 
+* INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, 
+* AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE 
+* LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL 
+* LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE 
+* SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE 
+* POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT 
+* ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY 
+* RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*
+* \asf_license_stop
+*
+*/
+/*
+* Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+*/
+
+#if (ENABLE_PDS == 1)
+/******************************************************************************
+                   Includes section
+******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <stddef.h>
+#include "pds_interface.h"
+#include "pds_common.h"
+#include "pds_nvm.h"
+#include "pds_journal.h"
+#include "pds_task_handler.h"
+
+#if (PDS_JOURNAL == 1)
+/************************************************************************/
+/*  Static variables                                                    */
+/************************************************************************/
+/* Journal row in use, relative to PDS_JOURNAL_FIRST_ROW */
+static uint8_t journalRow;
+static uint32_t journalRowSeq;
+static bool isJournalRowValid = false;
+static uint8_t journalNextEntry;
+
+/* Last value of each counter: PDS_JOURNAL_ERASED_ID when there is none.
+ * While the pending bit of the counter is set, it is not in the rows yet */
+static uint8_t journalType[PDS_JOURNAL_MAX_COUNTERS];
+static uint32_t journalValue[PDS_JOURNAL_MAX_COUNTERS];
+
+static PdsJournalWrite_t journalWrite;
+
+/************************************************************************/
+/*  Extern variables                                                    */
+/************************************************************************/
+#if (PDS_STATS == 1)
+extern PdsWriteStats_t pdsWriteStats;
+#endif
+
+/******************************************************************************
+                   Static prototype section
+******************************************************************************/
+static uint16_t pdsJournalEntryCrc(PdsJournalEntry_t *entry);
+static bool pdsJournalReadEntry(uint8_t row, uint8_t entryIdx, PdsJournalEntry_t *entry);
+static bool pdsJournalIsErased(PdsJournalEntry_t *entry);
+static uint8_t pdsJournalReplayRow(uint8_t row);
+static void pdsJournalPost(uint8_t counterId, uint8_t type, uint32_t value);
+static void pdsJournalStartNext(void);
+static void pdsJournalProgramEntry(uint8_t counterId, uint8_t type, uint32_t value);
+static void pdsJournalEntryDone(void);
+static void pdsJournalFail(uint8_t counterId);
+static void pdsJournalInvalidateNext(void);
+
+/******************************************************************************
+                   Implementations section
+******************************************************************************/
+
+/**************************************************************************//**
+\brief	Replays the journal rows into the RAM copy of the counters and finds
+		the next free entry.
+
+\param[in] none
+\param[out] none
+******************************************************************************/
+void pdsJournalInit(void)
+{
+	PdsJournalEntry_t header;
+	bool isHeaderValid[PDS_JOURNAL_ROWS];
+	uint32_t rowSeq[PDS_JOURNAL_ROWS];
+
+	pdsJournalDeleteAll();
+
+	for (uint8_t row = 0; row < PDS_JOURNAL_ROWS; row++)
+	{
+		isHeaderValid[row] = pdsJournalReadEntry(row, 0, &header) && \
+			(PDS_JOURNAL_ROW_HEADER_ID == header.counterId) && \
+			(PDS_JOURNAL_VALUE == header.type);
+		rowSeq[row] = header.value;
+	}
+
+	if (isHeaderValid[0] && isHeaderValid[1])
+	{
+		/* The row started last holds the newest entries, replay it last */
+		journalRow = ((int32_t)(rowSeq[1] - rowSeq[0]) > 0) ? 1 : 0;
+		pdsJournalReplayRow(journalRow ^ 1);
+	}
+	else if (isHeaderValid[0] || isHeaderValid[1])
+	{
+		journalRow = isHeaderValid[0] ? 0 : 1;
+	}
+	else
+	{
+		/* Blank or foreign rows: the first write starts row 0 */
+		return;
+	}
+
+	journalRowSeq = rowSeq[journalRow];
+	journalNextEntry = pdsJournalReplayRow(journalRow);
+	isJournalRowValid = true;
+}
+
+/**************************************************************************//**
+\brief	Queues a counter value for the journal, the PDS task appends it.
+		If the append fails, the older entries of the counter are
+		invalidated and pdsJournalWriteFailed is called, so that the value
+		is stored in the file row instead.
+
+\param[in] 	counterId - The journal id of the counter.
+\param[in] 	value - The value of the counter.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsJournalWrite(uint8_t counterId, uint32_t value)
+{
+	if (PDS_JOURNAL_MAX_COUNTERS <= counterId)
+	{
+		return PDS_NOT_FOUND;
+	}
+	if ((PDS_JOURNAL_VALUE != journalType[counterId]) || (value != journalValue[counterId]))
+	{
+		pdsJournalPost(counterId, PDS_JOURNAL_VALUE, value);
+	}
+	return PDS_OK;
+}
+
+/**************************************************************************//**
+\brief	Queues a deleted mark for a counter, the PDS task appends it. If the
+		append fails, the entries of the counter are invalidated instead.
+
+\param[in] 	counterId - The journal id of the counter.
+\param[out] status - The return status of the function's operation of type PdsStatus_t.
+******************************************************************************/
+PdsStatus_t pdsJournalDelete(uint8_t counterId)
+{
+	if (PDS_JOURNAL_MAX_COUNTERS <= counterId)
+	{
+		return PDS_NOT_FOUND;
+	}
+	/* A counter without a value may still have one left in the rows by a
+	 * failed invalidation */
+	if (PDS_JOURNAL_DELETED != journalType[counterId])
+	{
+		pdsJournalPost(counterId, PDS_JOURNAL_DELETED, UINT32_MAX);
+	}
+	return PDS_OK;
+}
+
+/**************************************************************************//**
+\brief	Reads the last value of a counter written to the journal.
+
+\param[in] 	counterId - The journal id of the counter.
+\param[in] 	value - The last value of the counter.
+\param[out] - return true if the journal holds a value of the counter
+******************************************************************************/
+bool pdsJournalRead(uint8_t counterId, uint32_t *value)
+{
+	if ((PDS_JOURNAL_MAX_COUNTERS <= counterId) || (PDS_JOURNAL_VALUE != journalType[counterId]))
+	{
+		return false;
+	}
+	*value = journalValue[counterId];
+	return true;
+}
+
+/**************************************************************************//**
+\brief	Forgets the journal content and the queued writes. The rows are
+		erased by pdsNvmEraseAll.
+
+\param[out] - void
+******************************************************************************/
+void pdsJournalDeleteAll(void)
+{
+	/* The cache is turned on again once an erase in progress is over */
+	if (PDS_JOURNAL_WRITE_IDLE != journalWrite.state)
+	{
+		while (PDS_BUSY == pdsNvmCheckReady())
+		{
+		}
+	}
+	memset(&journalWrite, 0, sizeof(journalWrite));
+
+	/* The first row started is row 0, with sequence number 0 */
+	journalRow = 1;
+	journalRowSeq = UINT32_MAX;
+	isJournalRowValid = false;
+	memset(journalType, PDS_JOURNAL_ERASED_ID, sizeof(journalType));
+}
+
+/**************************************************************************//**
+\brief	Takes the queued journal writes one step further when the NVM
+		controller is ready: the erase of the next row, one entry, or the
+		invalidation of one entry of a counter whose append failed. An
+		entry is checked by reading it back on the next call.
+
+\param[out] status - PDS_BUSY until the queued writes are over, then PDS_OK.
+******************************************************************************/
+PdsStatus_t pdsJournalResume(void)
+{
+	if (false == pdsJournalIsWriting())
+	{
+		return PDS_OK;
+	}
+	/* The status of the controller may be the one of a row write that ran
+	 * in between, the read back tells if the step worked */
+	if (PDS_BUSY == pdsNvmCheckReady())
+	{
+		return PDS_BUSY;
+	}
+
+	switch (journalWrite.state)
+	{
+		case PDS_JOURNAL_WRITE_ERASE:
+		{
+			/* Until the header is written the row does not replace the current one */
+			journalRow ^= 1;
+			journalNextEntry = 0;
+			pdsJournalProgramEntry(PDS_JOURNAL_ROW_HEADER_ID, PDS_JOURNAL_VALUE, journalRowSeq + 1);
+			return PDS_BUSY;
+		}
+		case PDS_JOURNAL_WRITE_ENTRY:
+		{
+			pdsJournalEntryDone();
+			break;
+		}
+		case PDS_JOURNAL_WRITE_INVALIDATE:
+		{
+			/* An entry still valid is left, the next write of its counter
+			 * replaces it */
+			journalWrite.entryIdx++;
+			break;
+		}
+		default:
+		break;
+	}
+
+	journalWrite.state = PDS_JOURNAL_WRITE_IDLE;
+	pdsJournalStartNext();
+
+	return pdsJournalIsWriting() ? PDS_BUSY : PDS_OK;
+}
+
+/**************************************************************************//**
+\brief	Checks if journal writes are queued or in progress.
+
+\param[out] - return true or false
+******************************************************************************/
+bool pdsJournalIsWriting(void)
+{
+	return (PDS_JOURNAL_WRITE_IDLE != journalWrite.state) || \
+		(0 != journalWrite.pendingMask) || (0 != journalWrite.invalidateMask);
+}
+
+/**************************************************************************//**
+\brief	Calculates the CRC of an entry, without its crc field.
+
+\param[in] 	entry - The entry.
+\param[out] uint16_t - The calculated 16 bit CRC.
+******************************************************************************/
+static uint16_t pdsJournalEntryCrc(PdsJournalEntry_t *entry)
+{
+	uint8_t data[sizeof(entry->counterId) + sizeof(entry->type) + sizeof(entry->value)];
+
+	data[0] = entry->counterId;
+	data[1] = entry->type;
+	memcpy(&data[2], &entry->value, sizeof(entry->value));
+	return pdsNvmCrc(sizeof(data), data);
+}
+
+/**************************************************************************//**
+\brief	Reads an entry of a journal row and checks its CRC.
+
+\param[in] 	row - The journal row.
+\param[in] 	entryIdx - The entry index in the row.
+\param[in] 	entry - The entry read.
+\param[out] - return true if the entry is valid
+******************************************************************************/
+static bool pdsJournalReadEntry(uint8_t row, uint8_t entryIdx, PdsJournalEntry_t *entry)
+{
+	if (PDS_OK != pdsNvmReadRaw(PDS_JOURNAL_FIRST_ROW + row, entryIdx * sizeof(PdsJournalEntry_t), (uint8_t *)entry, sizeof(PdsJournalEntry_t)))
+	{
+		memset(entry, UCHAR_MAX, sizeof(PdsJournalEntry_t));
+		return false;
+	}
+	return (entry->crc == pdsJournalEntryCrc(entry));
+}
+
+/**************************************************************************//**
+\brief	Checks if an entry read is still erased.
+
+\param[in] 	entry - The entry read.
+\param[out] - return true or false
+******************************************************************************/
+static bool pdsJournalIsErased(PdsJournalEntry_t *entry)
+{
+	return (PDS_JOURNAL_ERASED_ID == entry->counterId) && (UCHAR_MAX == entry->type) && \
+		(USHRT_MAX == entry->crc) && (UINT32_MAX == entry->value);
+}
+
+/**************************************************************************//**
+\brief	Applies the valid entries of a journal row to the RAM copy of the
+		counters. Entries torn by a reset fail their CRC and are skipped,
+		a failed write may have left its entry erased.
+
+\param[in] 	row - The journal row.
+\param[out] uint8_t - The index of the entry after the last one written.
+******************************************************************************/
+static uint8_t pdsJournalReplayRow(uint8_t row)
+{
+	PdsJournalEntry_t entry;
+	uint8_t nextEntry = 1;
+
+	for (uint8_t entryIdx = 1; entryIdx < PDS_JOURNAL_ENTRIES_PER_ROW; entryIdx++)
+	{
+		if (pdsJournalReadEntry(row, entryIdx, &entry))
+		{
+			if ((PDS_JOURNAL_MAX_COUNTERS > entry.counterId) && \
+				((PDS_JOURNAL_VALUE == entry.type) || (PDS_JOURNAL_DELETED == entry.type)))
+			{
+				journalType[entry.counterId] = entry.type;
+				journalValue[entry.counterId] = entry.value;
+			}
+		}
+		if (false == pdsJournalIsErased(&entry))
+		{
+			nextEntry = entryIdx + 1;
+		}
+	}
+	return nextEntry;
+}
+
+/**************************************************************************//**
+\brief	Sets the last value of a counter and queues its entry.
+
+\param[in] 	counterId - The journal id of the counter.
+\param[in] 	type - PDS_JOURNAL_VALUE or PDS_JOURNAL_DELETED.
+\param[in] 	value - The value of the counter.
+******************************************************************************/
+static void pdsJournalPost(uint8_t counterId, uint8_t type, uint32_t value)
+{
+	journalType[counterId] = type;
+	journalValue[counterId] = value;
+	journalWrite.pendingMask |= (1 << counterId);
+	journalWrite.failures[counterId] = 0;
+	pdsPostTask(PDS_JOURNAL_TASK_ID);
+}
+
+/**************************************************************************//**
+\brief	Issues the next step of the queued writes, the invalidations first.
+		A row is erased only when the journal moves to it because the
+		current row is full.
+******************************************************************************/
+static void pdsJournalStartNext(void)
+{
+	uint8_t counterId = 0;
+
+	if (0 != journalWrite.invalidateMask)
+	{
+		pdsJournalInvalidateNext();
+		return;
+	}
+	if (0 == journalWrite.pendingMask)
+	{
+		return;
+	}
+	if ((false == isJournalRowValid) || (PDS_JOURNAL_ENTRIES_PER_ROW <= journalNextEntry))
+	{
+		if (PDS_OK == pdsNvmEraseStart(PDS_JOURNAL_FIRST_ROW + (journalRow ^ 1)))
+		{
+			journalWrite.state = PDS_JOURNAL_WRITE_ERASE;
+		}
+		return;
+	}
+	while (0 == (journalWrite.pendingMask & (1 << counterId)))
+	{
+		counterId++;
+	}
+	journalWrite.pendingMask &= ~(1 << counterId);
+	pdsJournalProgramEntry(counterId, journalType[counterId], journalValue[counterId]);
+}
+
+/**************************************************************************//**
+\brief	Issues the program of the next entry of the current row.
+
+\param[in] 	counterId - The journal id of the counter, or the row header id.
+\param[in] 	type - PDS_JOURNAL_VALUE or PDS_JOURNAL_DELETED.
+\param[in] 	value - The value of the counter.
+******************************************************************************/
+static void pdsJournalProgramEntry(uint8_t counterId, uint8_t type, uint32_t value)
+{
+	PdsJournalEntry_t *entry = &journalWrite.entry;
+
+	entry->counterId = counterId;
+	entry->type = type;
+	entry->value = value;
+	entry->crc = pdsJournalEntryCrc(entry);
+
+	/* A failed entry may be partly programmed, it is never used again. One
+	 * that could not be issued is found erased by the read back */
+	journalWrite.row = journalRow;
+	journalWrite.entryIdx = journalNextEntry++;
+	journalWrite.state = PDS_JOURNAL_WRITE_ENTRY;
+	(void)pdsNvmProgramStart(PDS_JOURNAL_FIRST_ROW + journalWrite.row, journalWrite.entryIdx * sizeof(PdsJournalEntry_t), (uint8_t *)entry, sizeof(PdsJournalEntry_t));
+}
+
+/**************************************************************************//**
+\brief	Reads back the entry programmed. A counter entry that failed is
+		queued again in the next free entry, once. A row header that failed
+		leaves the previous row in use, and the switch is done again once.
+		The previous row is still replayed first at init, so it holds the
+		counters until the next switch erases it: every counter is copied
+		to the new row.
+******************************************************************************/
+static void pdsJournalEntryDone(void)
+{
+	PdsJournalEntry_t readEntry;
+	uint8_t counterId = journalWrite.entry.counterId;
+	bool isWritten = pdsJournalReadEntry(journalWrite.row, journalWrite.entryIdx, &readEntry) && \
+		(0 == memcmp(&journalWrite.entry, &readEntry, sizeof(PdsJournalEntry_t)));
+
+	if (PDS_JOURNAL_ROW_HEADER_ID == counterId)
+	{
+		if (isWritten)
+		{
+			journalRowSeq++;
+			isJournalRowValid = true;
+			journalWrite.switchFailures = 0;
+			for (counterId = 0; counterId < PDS_JOURNAL_MAX_COUNTERS; counterId++)
+			{
+				if (PDS_JOURNAL_ERASED_ID != journalType[counterId])
+				{
+					journalWrite.pendingMask |= (1 << counterId);
+				}
+			}
+		}
+		else
+		{
+			journalRow ^= 1;
+			journalNextEntry = PDS_JOURNAL_ENTRIES_PER_ROW;
+			if (PDS_JOURNAL_WRITE_ATTEMPTS <= ++journalWrite.switchFailures)
+			{
+				journalWrite.switchFailures = 0;
+				for (counterId = 0; counterId < PDS_JOURNAL_MAX_COUNTERS; counterId++)
+				{
+					if (journalWrite.pendingMask & (1 << counterId))
+					{
+						pdsJournalFail(counterId);
+					}
+				}
+			}
+		}
+	}
+	else if (isWritten)
+	{
+		journalWrite.failures[counterId] = 0;
+#if (PDS_STATS == 1)
+		pdsWriteStats.journalWrites++;
+#endif
+	}
+	else if (0 == (journalWrite.pendingMask & (1 << counterId)))
+	{
+		/* Not written again meanwhile */
+		if (PDS_JOURNAL_WRITE_ATTEMPTS <= ++journalWrite.failures[counterId])
+		{
+			pdsJournalFail(counterId);
+		}
+		else
+		{
+			journalWrite.pendingMask |= (1 << counterId);
+		}
+	}
+}
+
+/**************************************************************************//**
+\brief	Gives up the queued entry of a counter. Its older entries would win
+		over the file row at restore, they are invalidated by the next steps,
+		and a value is handed to the file row.
+
+\param[in] 	counterId - The journal id of the counter.
+******************************************************************************/
+static void pdsJournalFail(uint8_t counterId)
+{
+	bool isValue = (PDS_JOURNAL_VALUE == journalType[counterId]);
+
+	journalType[counterId] = PDS_JOURNAL_ERASED_ID;
+	journalWrite.pendingMask &= ~(1 << counterId);
+	journalWrite.failures[counterId] = 0;
+	/* The scan starts over for the entries it has passed already */
+	journalWrite.invalidateMask |= (1 << counterId);
+	journalWrite.row = 0;
+	journalWrite.entryIdx = 1;
+	if (isValue)
+	{
+		pdsJournalWriteFailed(counterId);
+	}
+}
+
+/**************************************************************************//**
+\brief	Finds the next valid entry of a counter being invalidated, in both
+		rows, and issues the clear of its type, which fails its CRC.
+******************************************************************************/
+static void pdsJournalInvalidateNext(void)
+{
+	static const uint8_t type = 0;
+	PdsJournalEntry_t *entry = &journalWrite.entry;
+
+	for (; journalWrite.row < PDS_JOURNAL_ROWS; journalWrite.row++, journalWrite.entryIdx = 1)
+	{
+		for (; journalWrite.entryIdx < PDS_JOURNAL_ENTRIES_PER_ROW; journalWrite.entryIdx++)
+		{
+			if (pdsJournalReadEntry(journalWrite.row, journalWrite.entryIdx, entry) && \
+				(PDS_JOURNAL_MAX_COUNTERS > entry->counterId) && \
+				(journalWrite.invalidateMask & (1 << entry->counterId)))
+			{
+				journalWrite.state = PDS_JOURNAL_WRITE_INVALIDATE;
+				(void)pdsNvmProgramStart(PDS_JOURNAL_FIRST_ROW + journalWrite.row, (journalWrite.entryIdx * sizeof(PdsJournalEntry_t)) + offsetof(PdsJournalEntry_t, type), (uint8_t *)&type, sizeof(type));
+				return;
+			}
+		}
+	}
+	journalWrite.invalidateMask = 0;
+}
+
+#endif /* #if (PDS_JOURNAL == 1) */
+#endif
+/* eof pds_journal.c */
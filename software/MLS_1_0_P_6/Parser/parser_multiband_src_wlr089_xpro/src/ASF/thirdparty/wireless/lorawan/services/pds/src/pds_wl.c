@@ -52,22 +52,34 @@
 /************************************************************************/
 /*  Static variables                                                    */
 /************************************************************************/
-static RowMap_t rowMap[EEPROM_NUM_ROWS];
 static FileMap_t fileMap[PDS_MAX_FILE_IDX];
 
+/* One bit per wear leveling row. A row is free when it can be written, stale
+ * when it holds an old copy of a file. Stale rows become free only when no
+ * free row is left, so that the writes rotate through all the rows */
+static uint32_t freeRowMask;
+static uint32_t staleRowMask;
+
+/* Row taken by the last write, the next write takes the next free row
+ * after it */
+static uint16_t lastRowIdx;
+
+static PdsWlWrite_t pdsWlPending;
+
 /******************************************************************************
                    Static prototype section
 ******************************************************************************/
-static void pdsUpdateRowMap(void);
-static void pdsUpdateFileMap(UpdateFileMap_t *updateFileMap);
+static void pdsUpdateFileMap(PdsFileItemIdx_t pdsFileItemIdx, uint16_t rowIdx, uint32_t counter);
 static uint16_t pdsReturnFreeRowIdx(void);
+static void pdsWlDeleteMaps(void);
 
 /******************************************************************************
                    Implementations section
 ******************************************************************************/
 
 /**************************************************************************//**
-\brief Initializes the WL PDS by updating the row and file map.
+\brief Initializes the WL PDS by building the file map and the row masks from
+		the row headers, in a single pass over the rows.
 
 \param[in] none
 \param[out] status - The return status of the function's operation of type PdsStatus_t.
@@ -81,26 +93,46 @@ PdsStatus_t pdsWlInit(void)
 		return status;
 	}
 	PdsMem_t buffer;
-	memset(&rowMap, UCHAR_MAX, EEPROM_NUM_ROWS * sizeof(RowMap_t));
-    memset(&fileMap, UCHAR_MAX, PDS_MAX_FILE_IDX * sizeof(FileMap_t));
+	PdsWlHeader_t *wlHeader = &buffer.NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader;
 	memset(&buffer, 0, sizeof(PdsMem_t));
-    UpdateFileMap_t updateFileMap;
+	pdsWlDeleteMaps();
 	
     for(uint8_t rowIdx = 0; rowIdx< EEPROM_NUM_ROWS; rowIdx++)
     {
 		status = pdsNvmRead(rowIdx, &buffer, EEPROM_ROW_SIZE);
 		if (PDS_OK == status)
 		{
-			rowMap[rowIdx].counter = buffer.NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.counter;
-            rowMap[rowIdx].memId = buffer.NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.memId;
-            rowMap[rowIdx].previousIdx = USHRT_MAX;
-            updateFileMap.counter = buffer.NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.counter;
-            updateFileMap.memId = buffer.NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.memId;
-            updateFileMap.rowIdx = rowIdx;
-            pdsUpdateFileMap(&updateFileMap);
+			/* The journal rows only hold a file written before the journal
+			 * took them */
+			if ((PDS_MAGIC != wlHeader->magicNo) || (PDS_MAX_FILE_IDX <= wlHeader->memId))
+			{
+				status = PDS_NOT_FOUND;
+			}
+		}
+		if (PDS_OK == status)
+		{
+			pdsUpdateFileMap((PdsFileItemIdx_t)wlHeader->memId, rowIdx, wlHeader->counter);
 		}
     }
-    pdsUpdateRowMap();
+
+	/* The old copies found are not needed after a reset, they are free */
+	freeRowMask |= staleRowMask;
+	staleRowMask = 0;
+
+#if (PDS_JOURNAL == 1)
+	/* Move the files found in the journal rows to the wear leveling rows */
+	for (uint8_t memId = 0; memId < PDS_MAX_FILE_IDX; memId++)
+	{
+		uint16_t rowIdx = fileMap[memId].maxCounterRowIdx;
+		if ((USHRT_MAX != rowIdx) && (PDS_WL_NUM_ROWS <= rowIdx))
+		{
+			if (PDS_OK == pdsNvmRead(rowIdx, &buffer, EEPROM_ROW_SIZE))
+			{
+				pdsWlWrite((PdsFileItemIdx_t)memId, &buffer, wlHeader->size);
+			}
+		}
+	}
+#endif
 	
 	return PDS_OK;
 }
@@ -108,7 +140,8 @@ PdsStatus_t pdsWlInit(void)
 /**************************************************************************//**
 \brief	This function will find the free row index to write to, updates the WL_Struct
 		header and writes to NVM. If the nvm write is successful it updates the
-		row and file map.
+		file map and the row masks. A row write already in progress is
+		finished first.
 
 \param[in] 	pdsFileItemIdx - The file id to be written to.
 \param[in] 	buffer - The buffer containing data to be written.
@@ -117,33 +150,158 @@ PdsStatus_t pdsWlInit(void)
 ******************************************************************************/
 PdsStatus_t pdsWlWrite(PdsFileItemIdx_t pdsFileItemIdx, PdsMem_t *buffer, uint16_t size)
 {
-	UpdateFileMap_t updateFileMap;
-	PdsStatus_t status = PDS_OK;
-	uint32_t counter;
-    uint16_t rowIdx = pdsReturnFreeRowIdx();
+	PdsStatus_t status;
+
+	while (PDS_BUSY == pdsWlWriteResume())
+	{
+	}
+	status = pdsWlWriteStart(pdsFileItemIdx, buffer, size);
+	while (PDS_BUSY == status)
+	{
+		status = pdsWlWriteResume();
+	}
+	
+	return status;
+}
+
+/**************************************************************************//**
+\brief	Starts writing a file to a free row. The write goes on in
+		pdsWlWriteResume, the buffer must stay untouched until it is over.
+
+\param[in] 	pdsFileItemIdx - The file id to be written to.
+\param[in] 	buffer - The buffer containing data to be written.
+\param[in] 	size - The size of the data in the buffer.
+\param[out] status - PDS_BUSY once the write is started, or the error that
+		prevented it.
+******************************************************************************/
+PdsStatus_t pdsWlWriteStart(PdsFileItemIdx_t pdsFileItemIdx, PdsMem_t *buffer, uint16_t size)
+{
+	uint16_t rowIdx;
+
+	if (PDS_WL_WRITE_IDLE != pdsWlPending.state)
+	{
+		return PDS_BUSY;
+	}
+    rowIdx = pdsReturnFreeRowIdx();
+	if (USHRT_MAX == rowIdx)
+	{
+		return PDS_NOT_ENOUGH_MEMORY;
+	}
 	buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.counter++;
 	buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.memId = pdsFileItemIdx;
 	buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.magicNo = PDS_MAGIC;
 	buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.version = PDS_WL_VERSION;
 	buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.size = size;
-	counter = buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.counter;
 	size += sizeof(PdsWlHeader_t);
+	pdsNvmSetHeader(buffer, size);
+
+	/* The row is taken until the write is over */
+	freeRowMask &= ~(1UL << rowIdx);
+	lastRowIdx = rowIdx;
+
+	pdsWlPending.buffer = buffer;
+	pdsWlPending.counter = buffer->NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader.counter;
+	pdsWlPending.rowIdx = rowIdx;
+	pdsWlPending.size = size;
+	pdsWlPending.fileId = pdsFileItemIdx;
+	pdsWlPending.page = 0;
+	pdsWlPending.numPages = (size + sizeof(PdsNvmHeader_t) + EEPROM_PAGE_SIZE - 1) / EEPROM_PAGE_SIZE;
+	pdsWlPending.state = PDS_WL_WRITE_ERASE;
 
-	status = pdsNvmWrite(rowIdx, buffer, size);
-	if (PDS_OK == status)
+	return pdsWlWriteResume();
+}
+
+/**************************************************************************//**
+\brief	Takes the row write one step further when the NVM controller is
+		ready: erase, then one page at a time, then the verify read. The
+		file map and the row masks are updated when the row is verified.
+
+\param[out] status - PDS_BUSY until the write is over, then its result.
+******************************************************************************/
+PdsStatus_t pdsWlWriteResume(void)
+{
+	PdsStatus_t status;
+
+	if (PDS_WL_WRITE_IDLE == pdsWlPending.state)
 	{
-		rowMap[rowIdx].counter = counter;
-		rowMap[rowIdx].memId = pdsFileItemIdx;
-		rowMap[rowIdx].previousIdx = USHRT_MAX;
-		updateFileMap.counter = rowMap[rowIdx].counter;
-		updateFileMap.memId = rowMap[rowIdx].memId;
-		updateFileMap.rowIdx = rowIdx;
-		pdsUpdateFileMap(&updateFileMap);
+		return PDS_OK;
+	}
+	/* The result of the erase or of the previous page */
+	status = pdsNvmCheckReady();
+	if (PDS_BUSY == status)
+	{
+		return PDS_BUSY;
+	}
+
+	switch (pdsWlPending.state)
+	{
+		case PDS_WL_WRITE_ERASE:
+		{
+			status = pdsNvmEraseStart(pdsWlPending.rowIdx);
+			if (PDS_OK == status)
+			{
+				pdsWlPending.state = PDS_WL_WRITE_PROGRAM;
+				status = PDS_BUSY;
+			}
+			break;
+		}
+		case PDS_WL_WRITE_PROGRAM:
+		{
+			if (PDS_OK == status)
+			{
+				status = pdsNvmWritePageStart(pdsWlPending.rowIdx, pdsWlPending.page, \
+					&pdsWlPending.buffer->NVM_Mem.pdsNvmMem[pdsWlPending.page * EEPROM_PAGE_SIZE]);
+			}
+			if (PDS_OK == status)
+			{
+				pdsWlPending.page++;
+				if (pdsWlPending.page == pdsWlPending.numPages)
+				{
+					pdsWlPending.state = PDS_WL_WRITE_VERIFY;
+				}
+				status = PDS_BUSY;
+			}
+			break;
+		}
+		case PDS_WL_WRITE_VERIFY:
+		{
+			if (PDS_OK == status)
+			{
+				status = pdsNvmRead(pdsWlPending.rowIdx, pdsWlPending.buffer, pdsWlPending.size);
+			}
+			if (PDS_OK == status)
+			{
+				pdsUpdateFileMap(pdsWlPending.fileId, pdsWlPending.rowIdx, pdsWlPending.counter);
+			}
+			break;
+		}
+		default:
+		break;
+	}
+
+	if (PDS_BUSY != status)
+	{
+		if (PDS_OK != status)
+		{
+			/* The row is erased again before it is used */
+			staleRowMask |= (1UL << pdsWlPending.rowIdx);
+		}
+		pdsWlPending.state = PDS_WL_WRITE_IDLE;
 	}
 	
 	return status;
 }
 
+/**************************************************************************//**
+\brief	Checks if a row write is in progress.
+
+\param[out] - return true or false
+******************************************************************************/
+bool pdsWlIsWriting(void)
+{
+	return (PDS_WL_WRITE_IDLE != pdsWlPending.state);
+}
+
 /**************************************************************************//**
 \brief	This function will find extract the row where the file is stored and 
 		read from NVM.
@@ -169,127 +327,63 @@ PdsStatus_t pdsWlRead(PdsFileItemIdx_t pdsFileItemIdx, PdsMem_t *buffer, uint16_
 }
 
 /**************************************************************************//**
-\brief	Updates the row map so that the old entries of the file are erased
-		in the row map.
+\brief	Makes a row the latest copy of a file if its counter is the highest
+		seen for the file. The row that loses becomes stale.
 
-\param[in] - return none
+\param[in] 	pdsFileItemIdx - The file id.
+\param[in] 	rowIdx - The row holding a copy of the file.
+\param[in] 	counter - The counter of the copy.
 ******************************************************************************/
-static void pdsUpdateRowMap()
+static void pdsUpdateFileMap(PdsFileItemIdx_t pdsFileItemIdx, uint16_t rowIdx, uint32_t counter)
 {
-	uint16_t rowIdx = USHRT_MAX;
-    for(uint16_t memId = 0, rowIdxLocal = 0 ; memId < PDS_MAX_FILE_IDX; memId++)
-    {
-		
-        // make all the previous indexes of the max_counter_row_idx invalid by writing 0xFF
-		if(USHRT_MAX != fileMap[memId].maxCounterRowIdx)
-		{
-			rowIdx = rowMap[fileMap[memId].maxCounterRowIdx].previousIdx;
-			rowMap[fileMap[memId].maxCounterRowIdx].previousIdx = USHRT_MAX;
-			while(rowIdx != USHRT_MAX)
-			{
-				rowIdxLocal = rowMap[rowIdx].previousIdx;
-				rowMap[rowIdx].previousIdx = USHRT_MAX;
-				rowMap[rowIdx].counter = UINT_MAX;
-				rowMap[rowIdx].memId = USHRT_MAX;
-				rowIdx = rowIdxLocal;
-			}
-		}
-    }
-}
-
-/**************************************************************************//**
-\brief Updates the file map so that it points to the latest row index for a file id.
+	FileMap_t *file = &fileMap[pdsFileItemIdx];
+	uint16_t staleRowIdx = rowIdx;
 
-\param[out] - returns none
-******************************************************************************/
-static void pdsUpdateFileMap(UpdateFileMap_t *updateFileMap)
-{
-    uint16_t *presentRowIdx;
-    uint16_t *previousRowIdx;
-    uint16_t *lastRowIdx;
-    uint16_t prevTemp;
-    if(USHRT_MAX == fileMap[updateFileMap->memId].maxCounterRowIdx)
-    {   
-		/* If there is no entry in filemap update current rowidx as maxcounteridx*/
-        fileMap[updateFileMap->memId].maxCounterRowIdx = updateFileMap->rowIdx;
-
-    }
-    else if(rowMap[fileMap[updateFileMap->memId].maxCounterRowIdx].counter < rowMap[updateFileMap->rowIdx].counter)
-    {
-        /* If the entry in filemap is lesser than  current rowidx update current idx as maxcounteridx*/
-		// update the max counter rowIdx of the memId as previous_idx in the present row
-        rowMap[updateFileMap->rowIdx].previousIdx = fileMap[updateFileMap->memId].maxCounterRowIdx;
-        fileMap[updateFileMap->memId].maxCounterRowIdx = updateFileMap->rowIdx;
-
-    }
-	else if (rowMap[fileMap[updateFileMap->memId].maxCounterRowIdx].counter == rowMap[updateFileMap->rowIdx].counter)
+	if ((USHRT_MAX == file->maxCounterRowIdx) || (file->counter < counter))
 	{
-
-		return;
+		staleRowIdx = file->maxCounterRowIdx;
+		file->maxCounterRowIdx = rowIdx;
+		file->counter = counter;
 	}
-    else
-    {
-        previousRowIdx = &rowMap[fileMap[updateFileMap->memId].maxCounterRowIdx].previousIdx;
-        presentRowIdx = &updateFileMap->rowIdx;
-        lastRowIdx = &fileMap[updateFileMap->memId].maxCounterRowIdx;
-		do
-		{
-			if (USHRT_MAX == *previousRowIdx)
-			{
-				*previousRowIdx = *presentRowIdx;
-				break;
-			}
-			if (rowMap[*previousRowIdx].counter > rowMap[*presentRowIdx].counter)
-			{
-				lastRowIdx = previousRowIdx;
-				previousRowIdx = &rowMap[*previousRowIdx].previousIdx;
-			}
-			else
-			{
-			    prevTemp = *previousRowIdx;
-				rowMap[*lastRowIdx].previousIdx = *presentRowIdx;
-				rowMap[*presentRowIdx].previousIdx = prevTemp;
-				break;
-			}
-		} while(true);
 
-    }
+	if (PDS_WL_NUM_ROWS > rowIdx)
+	{
+		freeRowMask &= ~(1UL << rowIdx);
+	}
+	if ((USHRT_MAX != staleRowIdx) && (PDS_WL_NUM_ROWS > staleRowIdx))
+	{
+		staleRowMask |= (1UL << staleRowIdx);
+	}
 }
 
 /**************************************************************************//**
-\brief Finds free row index by scanning the row map.
+\brief Takes the first free row after the row taken last, wrapping to the
+		lowest. When there is none, the stale rows become free first.
+		Taking the rows in turn keeps the rows that were the latest
+		copies at the last refill from falling behind the others.
 
-\param[out] - returns free row index
+\param[out] - returns free row index, USHRT_MAX if every row holds the
+		latest copy of a file
 ******************************************************************************/
 static uint16_t pdsReturnFreeRowIdx(void)
 {
-    uint8_t rowIdx;
-    bool found = 0;
-    for(rowIdx = 0; rowIdx < EEPROM_NUM_ROWS; rowIdx++)
-    {
-        if( (UINT_MAX == rowMap[rowIdx].counter) &&
-            (USHRT_MAX == rowMap[rowIdx].previousIdx) &&
-            (USHRT_MAX == rowMap[rowIdx].memId) )
-        {
-            found = 1;
-            break;
-        }
-    }
+	uint32_t nextRowMask;
 
-    if(!found)
-    {
-        pdsUpdateRowMap();
-        for(rowIdx = 0; rowIdx < EEPROM_NUM_ROWS; rowIdx++)
-        {
-            if( (UINT_MAX == rowMap[rowIdx].counter) &&
-                (USHRT_MAX == rowMap[rowIdx].previousIdx) &&
-                (USHRT_MAX == rowMap[rowIdx].memId))
-            {
-                break;
-            }
-        }
-    }
-	return rowIdx;
+	if (0 == freeRowMask)
+	{
+		freeRowMask = staleRowMask;
+		staleRowMask = 0;
+	}
+	if (0 == freeRowMask)
+	{
+		return USHRT_MAX;
+	}
+	nextRowMask = freeRowMask & ((UINT32_MAX << lastRowIdx) << 1);
+	if (0 == nextRowMask)
+	{
+		nextRowMask = freeRowMask;
+	}
+	return (uint16_t)__builtin_ctz(nextRowMask);
 }
 
 /**************************************************************************//**
@@ -312,13 +406,29 @@ bool isFileFound(PdsFileItemIdx_t pdsFileItemIdx)
 
 void pdsWlDeleteAll(void)
 {
-	/* Clear Filemap array */
-	memset(&rowMap, UCHAR_MAX, EEPROM_NUM_ROWS * sizeof(RowMap_t));
-	/* Clear Row Map Array */
-    memset(&fileMap, UCHAR_MAX, PDS_MAX_FILE_IDX * sizeof(FileMap_t));
+	/* Finish the row write in progress, its row is erased below */
+	while (PDS_BUSY == pdsWlWriteResume())
+	{
+	}
+	/* Clear the file map and the row masks */
+	pdsWlDeleteMaps();
 	/* Call NVM Erase All */
 	pdsNvmEraseAll();
 }
 
+/**************************************************************************//**
+\brief Empties the file map and makes all the wear leveling rows free.
+
+\param[out] - void
+******************************************************************************/
+static void pdsWlDeleteMaps(void)
+{
+    memset(&fileMap, UCHAR_MAX, PDS_MAX_FILE_IDX * sizeof(FileMap_t));
+	freeRowMask = (PDS_WL_NUM_ROWS < 32) ? ((1UL << PDS_WL_NUM_ROWS) - 1) : UINT32_MAX;
+	staleRowMask = 0;
+	/* The first write takes the lowest row */
+	lastRowIdx = PDS_WL_NUM_ROWS - 1;
+}
+
 #endif
 /* eof pds_wl.c */
@@ -49,6 +49,11 @@
 #include "stack_common.h"
 #include "system_task_manager.h"
 
+/* Lateness accounting of the timer callbacks, set to 0 to compile it out */
+#ifndef SWTIMER_STATS
+#define SWTIMER_STATS 1
+#endif
+
 /******************************************************************************
                      Types section
 ******************************************************************************/
@@ -72,19 +77,40 @@ typedef struct _SwTimer {
 	/* Timeout in microseconds */
 	uint32_t absoluteExpiryTime;
 
+	/* Delay in microseconds the expiry may take to share a wakeup */
+	uint32_t slack;
+
 	/* Callback function to be executed on expiry of the timer */
 	void (*timerCb)(void*);
 
 	/* Parameter to be passed to callback function of the expired timer */
 	void *paramCb;
 
-	/* Next timer which was started or has expired */
+	/* Next timer which has expired */
 	uint8_t nextTimer;
 
+	/* Position in the running timer heap, SWTIMER_INVALID if not running */
+	uint8_t heapIndex;
+
 	/* Whether this time is loaded is actually loaded into timer or not? */
 	bool loaded;
 } SwTimer_t;
 
+/*
+* Lateness of the callbacks of a timer: time between its expiry time and
+* the call of its callback
+*/
+typedef struct _SwTimerStats {
+	/* Number of callbacks called */
+	uint32_t expiryCount;
+
+	/* Largest lateness in microseconds */
+	uint32_t maxLateness;
+
+	/* Sum of the lateness in microseconds */
+	uint64_t totalLateness;
+} SwTimerStats_t;
+
 /*
 * This defines the type of the system timestamp
 */
@@ -98,16 +124,6 @@ typedef uint64_t SwTimestamp_t;
 */
 #define SWTIMER_INVALID              (0xFF)
 
-/*
-* Shift mask to obtain the 16-bit system time out of a 32-bit timeout
-*/
-#define SWTIMER_SYSTIME_SHIFTMASK    (16)
-
-/*
-* Mask to obtain the 16-bit H/W time out of a 32-bit timeout
-*/
-#define SWTIMER_HWTIME_MASK          (0xFFFF)
-
 /*
 * The smallest timeout in microseconds
 */
@@ -123,6 +139,18 @@ typedef uint64_t SwTimestamp_t;
 */
 #define SWTIMER_INVALID_TIMEOUT      (0xFFFFFFFF)
 
+/*
+* Slack of a timer which has to expire on time
+*/
+#define SWTIMER_NO_SLACK             (0)
+
+/*
+* Lateness histogram: bin 0 counts lateness below 64 us, each next bin
+* doubles the bound and the last bin counts the rest
+*/
+#define SWTIMER_LATENESS_BINS        (12)
+#define SWTIMER_LATENESS_BIN0_SHIFT  (6)
+
 /**
 * Adds two time values
 */
@@ -186,6 +214,49 @@ StackRetStatus_t SwTimerCreate(uint8_t *timerId);
 StackRetStatus_t SwTimerStart(uint8_t timerId, uint32_t timerCount,
   SwTimeoutType_t timeoutType, void *timerCb, void *paramCb);
 
+/**************************************************************************//**
+\brief Starts a timer which may expire late by up to the given slack
+
+       Timers whose expiry windows overlap are expired together on a single
+       hardware wakeup. Timers started by \ref SwTimerStart have no slack.
+
+\param[in] timerId Timer identifier
+\param[in] timerCount Timeout in microseconds
+\param[in] timeoutType \ref SW_TIMEOUT_RELATIVE or \ref SW_TIMEOUT_ABSOLUTE
+\param[in] slack Tolerated delay of the expiry in microseconds
+\param[in] timerCb Callback handler invoked upon timer expiry
+\param[in] paramCb Argument for the callback handler
+
+\return LORAWAN_INVALID_PARAMETER if at least one input parameter in invalid
+        LORAWAN_INVALID_REQUEST if \timerId is already running
+        LORAWAN_SUCCESS if \timerId is successfully queued for running
+******************************************************************************/
+StackRetStatus_t SwTimerStartWithSlack(uint8_t timerId, uint32_t timerCount,
+  SwTimeoutType_t timeoutType, uint32_t slack, void *timerCb, void *paramCb);
+
+/**************************************************************************//**
+\brief Returns the wakeup counters of the software timer
+\param[out] wakeups Number of hardware timer wakeups
+\param[out] wakeupsSaved Number of expiries served by the wakeup of
+            another timer
+******************************************************************************/
+void SwTimerGetWakeupStats(uint32_t *wakeups, uint32_t *wakeupsSaved);
+
+#if (SWTIMER_STATS == 1)
+/**************************************************************************//**
+\brief Returns the lateness of the callbacks of the given timer
+\param[in] timerId Timer identifier
+\param[out] stats Lateness accounting of the timer
+******************************************************************************/
+void SwTimerGetStats(uint8_t timerId, SwTimerStats_t *stats);
+
+/**************************************************************************//**
+\brief Returns the lateness histogram of the timers started without slack
+\param[out] histogram \ref SWTIMER_LATENESS_BINS counters
+******************************************************************************/
+void SwTimerGetLatenessHistogram(uint32_t *histogram);
+#endif /* #if (SWTIMER_STATS == 1) */
+
 /**************************************************************************//**
 \brief Stops a running timer. It stops a running timer with specified timerId
 \param timer_id Timer identifier
@@ -238,8 +309,9 @@ uint32_t SwTimerReadValue(uint8_t timerId);
 void SwTimerRunRemainingTime(uint32_t offset);
 
 /**************************************************************************//**
-\brief Returns the duration until the next timer expiry
-\return Returns the duration until the next timeout in microseconds
+\brief Returns the duration until the next timer wakeup, the slack of the
+       running timers included
+\return Returns the duration until the next wakeup in microseconds
 ******************************************************************************/
 uint32_t SwTimerNextExpiryDuration(void);
 
@@ -42,7 +42,9 @@
 #include "atomic.h"
 #include "system_assert.h"
 #include "conf_sw_timer.h"
-#include "common_hw_timer.h"
+#include "tc.h"
+#include "tc_interrupt.h"
+#include "conf_hw_timer.h"
 #include "sw_timer.h"
 
 #ifndef TOTAL_NUMBER_SW_TIMESTAMPS
@@ -55,34 +57,39 @@
                      Prototypes section
 ******************************************************************************/
 static inline uint64_t gettime(void);
-static void hwTimerExpiryCallback(void);
-static void hwTimerOverflowCallback(void);
+static void hwTimerExpiryCallback(struct tc_module *const module);
+static void hwTimerOverflowCallback(struct tc_module *const module);
+static void hwTimerInit(uint32_t count);
+static void hwTimerSetCompare(uint32_t compareValue);
+static void hwTimerCompareStop(void);
 static void loadHwTimer(uint8_t timer_id);
-static void swtimerProcessOverflow(void);
 static void swtimerInternalHandler(void);
 static inline bool swtimerCompareTime(uint32_t t1, uint32_t t2);
+static void swtimerHeapSiftUp(uint8_t heapIndex);
+static void swtimerHeapSiftDown(uint8_t heapIndex);
+static void swtimerHeapRemove(uint8_t timerId);
+static void swtimerUpdateHead(void);
+static uint32_t swtimerWakeTime(void);
+#if (SWTIMER_STATS == 1)
+static void swtimerRecordLateness(uint8_t timerId, uint32_t lateness, bool exact);
+#endif
 static void swtimerStartAbsoluteTimer(uint8_t timer_id,
-    uint32_t point_in_time, void * handler_cb, void *parameter);
+    uint32_t point_in_time, uint32_t slack, void * handler_cb, void *parameter);
 
 /******************************************************************************
                      Global variables section
 ******************************************************************************/
 
 /******************************************************************************
-             +-------------------+----------+-----------+
-             | SYS_TIME_OVERFLOW | SYS_TIME | TC0_COUNT |
-             +-------------------+----------+-----------+
-             63                  31         15          0
+             +-------------------+--------------------+
+             | SYS_TIME_OVERFLOW |    TIMER COUNT32   |
+             +-------------------+--------------------+
+             63                  31                   0
 ******************************************************************************/
 /*
-* This represents the bits 15 to 31 of the low word of system time.
-* And, it is incremented whenever the TC0_COUNT overflows.
-*/
-volatile uint16_t sysTime;
-
-/*
-* This represents the bits 31 to 63 of the high word of system time.
-* And, it is incremented whenever the \sysTime overflows.
+* This represents the bits 32 to 63 of system time.
+* And, it is incremented whenever the 32-bit 1 MHz hardware counter
+* overflows, i.e. every 71.6 minutes.
 */
 volatile uint32_t sysTimeOvf;
 
@@ -104,6 +111,12 @@ static volatile uint8_t runningTimers;
 /* This is the reference to the head of the running timer queue. */
 static uint_fast8_t runningTimerQueueHead;
 
+/*
+* Running timers as a binary min-heap on absoluteExpiryTime, the first
+* runningTimers entries are valid and the head is at index 0.
+*/
+static uint8_t runningTimerHeap[TOTAL_NUMBER_OF_SW_TIMERS];
+
 /* This is the reference to the head of the expired timer queue. */
 static uint_fast8_t expiredTimerQueueHead;
 
@@ -119,24 +132,49 @@ static uint8_t allocatedTimestampId = 0;
 /* This is the last known system time saved before sleep */
 static uint64_t sysTimeLastKnown = 0;
 
+/* TIMER and the next TC in 32-bit mode, counting microseconds */
+static struct tc_module hwTimerInstance;
+
+/* Time the compare is armed for, valid while the head timer is loaded */
+static uint32_t armedWakeTime;
+
+/* Set from a compare wakeup until the compare is armed again */
+static bool isWakeupBatchOpen;
+
+/* Number of timers expired since the last compare wakeup */
+static uint8_t wakeupBatchExpiries;
+
+/* Compare wakeups, and expiries that did not need a wakeup of their own */
+static uint32_t hwTimerWakeups;
+static uint32_t hwTimerWakeupsSaved;
+
+#if (SWTIMER_STATS == 1)
+/* Lateness of the callbacks, per timer and for the timers without slack */
+static SwTimerStats_t swTimerStats[TOTAL_NUMBER_OF_SW_TIMERS];
+static uint32_t swTimerLatenessHistogram[SWTIMER_LATENESS_BINS];
+#endif
+
 /******************************************************************************
                      Interrupt service routines
 ******************************************************************************/
-/* ISR to handle OVF interrupt from TC0 */
-static void hwTimerOverflowCallback(void)
+/* ISR to handle OVF interrupt from TIMER */
+static void hwTimerOverflowCallback(struct tc_module *const module)
 {
-    uint16_t temp = sysTime;
-    if (++sysTime < temp)
-    {
-        sysTimeOvf++;
-    }
-
-    swtimerProcessOverflow();
+    sysTimeOvf++;
+    (void)module;
 }
 
-/* ISR to handle CC0 interrupt from TC0 */
-static void hwTimerExpiryCallback(void)
+/* ISR to handle CC0 interrupt from TIMER */
+static void hwTimerExpiryCallback(struct tc_module *const module)
 {
+    /* One shot: the counter would match again after a full wrap */
+    hwTimerCompareStop();
+    (void)module;
+
+    hwTimerWakeups++;
+    isWakeupBatchOpen = true;
+    wakeupBatchExpiries = 0;
+
     if (0 < runningTimers)
     {
         isTimerTriggered = true;
@@ -149,88 +187,292 @@ static void hwTimerExpiryCallback(void)
 ******************************************************************************/
 
 /**************************************************************************//**
-\brief Inserts the timer in running timers queue in sorted order
+\brief Starts the hardware time base: TIMER and its pair in 32-bit mode,
+       clocked at 1 MHz, so a timer is armed once with its full 32-bit
+       expiry time and the counter only interrupts on overflow every
+       71.6 minutes
+\param[in] count Initial value of the counter in microseconds
 ******************************************************************************/
-static void swtimerStartAbsoluteTimer(uint8_t timerId, uint32_t pointInTime,
-    void *handlerCb, void *parameter)
+static void hwTimerInit(uint32_t count)
 {
-    uint8_t flags = cpu_irq_save();
+    struct tc_config timerConfig;
+
+    tc_get_config_defaults(&timerConfig);
+    timerConfig.clock_source = SWTIMER_GCLK_GENERATOR;
+    timerConfig.clock_prescaler = SWTIMER_TC_PRESCALER;
+    timerConfig.counter_size = TC_COUNTER_SIZE_32BIT;
+    timerConfig.counter_32_bit.value = count;
+
+    tc_init(&hwTimerInstance, TIMER, &timerConfig);
+    tc_register_callback(&hwTimerInstance, hwTimerOverflowCallback,
+            TC_CALLBACK_OVERFLOW);
+    tc_register_callback(&hwTimerInstance, hwTimerExpiryCallback,
+            TC_CALLBACK_CC_CHANNEL0);
+    tc_enable_callback(&hwTimerInstance, TC_CALLBACK_OVERFLOW);
+
+    tc_enable(&hwTimerInstance);
+}
 
-    /* Check is done to see if any timer has expired */
-    swtimerInternalHandler();
+/**************************************************************************//**
+\brief Arms the compare interrupt at the given system time
+\param[in] compareValue Low 32 bits of the expiry time in microseconds
+******************************************************************************/
+static void hwTimerSetCompare(uint32_t compareValue)
+{
+    armedWakeTime = compareValue;
+    isWakeupBatchOpen = false;
 
-    swTimers[timerId].absoluteExpiryTime = pointInTime;
-    swTimers[timerId].timerCb = (void (*)(void*))handlerCb;
-    swTimers[timerId].paramCb = parameter;
-    swTimers[timerId].loaded = false;
-    runningTimers++;
+    tc_set_compare_value(&hwTimerInstance, TC_COMPARE_CAPTURE_CHANNEL_0,
+            compareValue);
+    tc_clear_status(&hwTimerInstance, TC_STATUS_CHANNEL_0_MATCH);
+    tc_enable_callback(&hwTimerInstance, TC_CALLBACK_CC_CHANNEL0);
+}
+
+/**************************************************************************//**
+\brief Disarms the compare interrupt
+******************************************************************************/
+static void hwTimerCompareStop(void)
+{
+    isWakeupBatchOpen = false;
+    tc_disable_callback(&hwTimerInstance, TC_CALLBACK_CC_CHANNEL0);
+}
+
+/**************************************************************************//**
+\brief Moves the timer at the given heap position up to its place
+\param[in] heapIndex Position in the running timer heap
+******************************************************************************/
+static void swtimerHeapSiftUp(uint8_t heapIndex)
+{
+    uint8_t timerId = runningTimerHeap[heapIndex];
+    uint32_t expiryTime = swTimers[timerId].absoluteExpiryTime;
+
+    while (heapIndex > 0)
+    {
+        uint8_t parentIndex = (heapIndex - 1) >> 1;
+        uint8_t parentId = runningTimerHeap[parentIndex];
+
+        if (swtimerCompareTime(swTimers[parentId].absoluteExpiryTime, expiryTime))
+        {
+            break;
+        }
+
+        runningTimerHeap[heapIndex] = parentId;
+        swTimers[parentId].heapIndex = heapIndex;
+        heapIndex = parentIndex;
+    }
+
+    runningTimerHeap[heapIndex] = timerId;
+    swTimers[timerId].heapIndex = heapIndex;
+}
+
+/**************************************************************************//**
+\brief Moves the timer at the given heap position down to its place
+\param[in] heapIndex Position in the running timer heap
+******************************************************************************/
+static void swtimerHeapSiftDown(uint8_t heapIndex)
+{
+    uint8_t timerId = runningTimerHeap[heapIndex];
+    uint32_t expiryTime = swTimers[timerId].absoluteExpiryTime;
+    uint8_t childIndex;
+
+    while ((childIndex = (heapIndex << 1) + 1) < runningTimers)
+    {
+        uint8_t childId = runningTimerHeap[childIndex];
+
+        /* Pick the earlier of the two children */
+        if ((childIndex + 1 < runningTimers) &&
+            !swtimerCompareTime(swTimers[childId].absoluteExpiryTime,
+                swTimers[runningTimerHeap[childIndex + 1]].absoluteExpiryTime))
+        {
+            childIndex++;
+            childId = runningTimerHeap[childIndex];
+        }
+
+        if (swtimerCompareTime(expiryTime, swTimers[childId].absoluteExpiryTime))
+        {
+            break;
+        }
+
+        runningTimerHeap[heapIndex] = childId;
+        swTimers[childId].heapIndex = heapIndex;
+        heapIndex = childIndex;
+    }
+
+    runningTimerHeap[heapIndex] = timerId;
+    swTimers[timerId].heapIndex = heapIndex;
+}
+
+/**************************************************************************//**
+\brief Takes the given timer out of the running timer heap
+\param[in] timerId Running timer to be removed
+******************************************************************************/
+static void swtimerHeapRemove(uint8_t timerId)
+{
+    uint8_t heapIndex = swTimers[timerId].heapIndex;
 
-    if (SWTIMER_INVALID == runningTimerQueueHead)
+    swTimers[timerId].heapIndex = SWTIMER_INVALID;
+    runningTimers--;
+
+    if (heapIndex < runningTimers)
+    {
+        /* The last timer fills the hole and is moved to its place */
+        runningTimerHeap[heapIndex] = runningTimerHeap[runningTimers];
+
+        if ((heapIndex > 0) &&
+            !swtimerCompareTime(swTimers[runningTimerHeap[(heapIndex - 1) >> 1]].absoluteExpiryTime,
+                swTimers[runningTimerHeap[heapIndex]].absoluteExpiryTime))
+        {
+            swtimerHeapSiftUp(heapIndex);
+        }
+        else
+        {
+            swtimerHeapSiftDown(heapIndex);
+        }
+    }
+}
+
+/**************************************************************************//**
+\brief Reloads the hardware timer if the head of the running timer heap
+       has changed
+******************************************************************************/
+static void swtimerUpdateHead(void)
+{
+    uint8_t head = (runningTimers > 0) ? runningTimerHeap[0] : SWTIMER_INVALID;
+
+    if (head != runningTimerQueueHead)
     {
-        runningTimerQueueHead = timerId;
+        if (SWTIMER_INVALID != runningTimerQueueHead)
+        {
+            swTimers[runningTimerQueueHead].loaded = false;
+        }
+
+        runningTimerQueueHead = head;
+
+        /* Stops the compare if there is no running timer left */
         loadHwTimer(runningTimerQueueHead);
     }
-    else
+}
+
+/**************************************************************************//**
+\brief Returns the latest time the head timer can be expired at, so that
+       no running timer is expired later than its slack allows. All timers
+       due at that time are expired on the same wakeup.
+\return Wake time in microseconds
+******************************************************************************/
+static uint32_t swtimerWakeTime(void)
+{
+    uint8_t pending[TOTAL_NUMBER_OF_SW_TIMERS];
+    uint8_t pendingCount = 0;
+    uint8_t timerId = runningTimerHeap[0];
+    uint32_t wakeTime = swTimers[timerId].absoluteExpiryTime + swTimers[timerId].slack;
+
+    if (runningTimers > 1)
     {
-        uint8_t index;
-        bool isTimerInserted = false;
-        uint8_t currIndex = runningTimerQueueHead;
-        uint8_t prevIndex = runningTimerQueueHead;
+        pending[pendingCount++] = 1;
+    }
 
-        /*
-        * Loop through the running timers in the array of swTimers.
-        * Find the correct position for timer identified by 'timerId'
-        * to be inserted in the runningTimersQueue.
-        */
-        for (index = 0; index < runningTimers; index++)
+    /*
+    * Only the timers expiring before the wake time can pull it in. A heap
+    * child never expires before its parent, so a subtree is skipped as
+    * soon as its root expires after the wake time.
+    */
+    while (pendingCount > 0)
+    {
+        uint8_t heapIndex = pending[--pendingCount];
+
+        for (uint8_t sibling = 0; (sibling < 2) && (heapIndex < runningTimers); sibling++, heapIndex++)
         {
-            if (SWTIMER_INVALID != currIndex)
+            uint32_t deadline;
+
+            timerId = runningTimerHeap[heapIndex];
+
+            if (swtimerCompareTime(wakeTime, swTimers[timerId].absoluteExpiryTime))
             {
-                if (swtimerCompareTime(swTimers[currIndex].absoluteExpiryTime,
-                                       pointInTime))
-                {
-                    /*
-                    * Requested absolute time value is greater than the time
-                    * value pointed by the curr_index in the timer array
-                    */
-                    prevIndex = currIndex;
-                    currIndex = swTimers[currIndex].nextTimer;
-                }
-                else
-                {
-                /*
-                * New timer 'timerId' to be inserted is having expiryDuration
-                * that is lesser than the timer pointed by 'currentIndex'.
-                */
-                    swTimers[timerId].nextTimer = currIndex;
-                    swTimers[currIndex].loaded = false;
-                    if (runningTimerQueueHead == currIndex)
-                    {
-                        /* Insertion at the head of the timer queue. */
-                        runningTimerQueueHead = timerId;
+                continue;
+            }
 
-                        loadHwTimer(runningTimerQueueHead);
-                    }
-                    else
-                    {
-                    /* Insertion at somewhere in the middle of timer queue. */
-                        swTimers[prevIndex].nextTimer = timerId;
-                    }
+            deadline = swTimers[timerId].absoluteExpiryTime + swTimers[timerId].slack;
+            if (!swtimerCompareTime(wakeTime, deadline))
+            {
+                wakeTime = deadline;
+            }
 
-                    isTimerInserted = true;
-                    break;
-                }
+            if (((heapIndex << 1) + 1) < runningTimers)
+            {
+                pending[pendingCount++] = (heapIndex << 1) + 1;
             }
         }
+    }
 
-        if (!isTimerInserted)
+    return wakeTime;
+}
+
+#if (SWTIMER_STATS == 1)
+/**************************************************************************//**
+\brief Accounts the lateness of a timer callback
+\param[in] timerId Expired timer
+\param[in] lateness Time from the expiry time to the callback in microseconds
+\param[in] exact True if the timer was started without slack
+******************************************************************************/
+static void swtimerRecordLateness(uint8_t timerId, uint32_t lateness, bool exact)
+{
+    SwTimerStats_t *stats = &swTimerStats[timerId];
+
+    stats->expiryCount++;
+    stats->totalLateness += lateness;
+    if (lateness > stats->maxLateness)
+    {
+        stats->maxLateness = lateness;
+    }
+
+    /* The timers with slack are late by design, keep them out */
+    if (exact)
+    {
+        uint8_t bin = 0;
+
+        lateness >>= SWTIMER_LATENESS_BIN0_SHIFT;
+        while ((0 != lateness) && (bin < (SWTIMER_LATENESS_BINS - 1)))
         {
-            /* Insertion at the tail of the timer queue. */
-            swTimers[prevIndex].nextTimer = timerId;
-            swTimers[timerId].nextTimer = SWTIMER_INVALID;
+            lateness >>= 1;
+            bin++;
         }
+
+        swTimerLatenessHistogram[bin]++;
+    }
+}
+#endif /* #if (SWTIMER_STATS == 1) */
+
+/**************************************************************************//**
+\brief Inserts the timer in the running timer heap
+******************************************************************************/
+static void swtimerStartAbsoluteTimer(uint8_t timerId, uint32_t pointInTime,
+    uint32_t slack, void *handlerCb, void *parameter)
+{
+    uint8_t flags = cpu_irq_save();
+
+    /* Check is done to see if any timer has expired */
+    swtimerInternalHandler();
+
+    swTimers[timerId].absoluteExpiryTime = pointInTime;
+    swTimers[timerId].slack = slack;
+    swTimers[timerId].timerCb = (void (*)(void*))handlerCb;
+    swTimers[timerId].paramCb = parameter;
+    swTimers[timerId].loaded = false;
+
+    runningTimerHeap[runningTimers] = timerId;
+    swtimerHeapSiftUp(runningTimers);
+    runningTimers++;
+
+    if ((timerId != runningTimerHeap[0]) && swTimers[runningTimerQueueHead].loaded &&
+        !swtimerCompareTime(armedWakeTime, pointInTime + slack))
+    {
+        /* The new timer cannot wait for the armed wakeup */
+        swTimers[runningTimerQueueHead].loaded = false;
+        loadHwTimer(runningTimerQueueHead);
     }
 
+    swtimerUpdateHead();
+
     cpu_irq_restore(flags);
 }
 
@@ -255,14 +497,11 @@ static void loadHwTimer(uint8_t timerId)
                     isTimerTriggered = true;
                     SYSTEM_PostTask(TIMER_TASK_ID);
                 }
-                else  if ((uint32_t)TIMER_PERIOD >= timeDiff)
-                {
-                    common_tc_delay((uint16_t)timeDiff);
-                    swTimers[timerId].loaded = true;
-                }
                 else
                 {
-                    swTimers[timerId].loaded = false;
+                    /* The whole 32-bit wake time fits in the compare register */
+                    hwTimerSetCompare(swtimerWakeTime());
+                    swTimers[timerId].loaded = true;
                 }
             }
         }
@@ -274,7 +513,7 @@ static void loadHwTimer(uint8_t timerId)
     }
     else
     {
-        common_tc_compare_stop();
+        hwTimerCompareStop();
     }
 }
 
@@ -297,44 +536,26 @@ static inline bool swtimerCompareTime(uint32_t t1, uint32_t t2)
 ******************************************************************************/
 static inline uint64_t gettime(void)
 {
-    uint64_t time = 0uL;
-    time |= ((uint64_t) sysTimeOvf) << 32;
-    time |= ((uint64_t) sysTime) << 16;
-    time |= (uint64_t) common_tc_read_count();
-    return time;
-}
-
-/**************************************************************************//**
-\brief Process the overflow interrupt of TC0
-******************************************************************************/
-static void swtimerProcessOverflow(void)
-{
-    uint32_t tmo32;
-    uint16_t tmoHigh16, tmoLow16;
+    uint32_t count;
+    uint32_t overflow;
     uint8_t flags = cpu_irq_save();
 
-    if (SWTIMER_INVALID != runningTimerQueueHead && !swTimers[runningTimerQueueHead].loaded)
-    {
-        tmo32 = swTimers[runningTimerQueueHead].absoluteExpiryTime;
-        tmoHigh16 = (uint16_t)(tmo32 >> SWTIMER_SYSTIME_SHIFTMASK);
+    count = tc_get_count_value(&hwTimerInstance);
+    overflow = sysTimeOvf;
 
-        if (tmoHigh16 == sysTime)
-        {
-            tmoLow16 = (uint16_t)(tmo32 & SWTIMER_HWTIME_MASK);
-            if (SWTIMER_MIN_TIMEOUT < tmoLow16)
-            {
-                common_tc_delay(tmoLow16);
-                swTimers[runningTimerQueueHead].loaded = true;
-            }
-            else
-            {
-                isTimerTriggered = true;
-                SYSTEM_PostTask(TIMER_TASK_ID);
-            }
-        }
+    /*
+    * The counter wrapped but the overflow interrupt is not served yet
+    * (interrupts are disabled by the caller or by this function)
+    */
+    if ((tc_get_status(&hwTimerInstance) & TC_STATUS_COUNT_OVERFLOW) &&
+        (count < INT32_MAX))
+    {
+        overflow++;
     }
 
     cpu_irq_restore(flags);
+
+    return (((uint64_t) overflow) << 32) | count;
 }
 
 /**************************************************************************//**
@@ -348,26 +569,31 @@ static void swtimerInternalHandler(void)
 
         if (0 < runningTimers)
         { /* Holds the number of running timers */
+            uint8_t expiredTimer = runningTimerQueueHead;
+
+            if (isWakeupBatchOpen && (0 < wakeupBatchExpiries++))
+            {
+                /* Expired on the wakeup of an earlier timer */
+                hwTimerWakeupsSaved++;
+            }
+
             if ((expiredTimerQueueHead == SWTIMER_INVALID) && \
                 (expiredTimerQueueTail == SWTIMER_INVALID))
             { /* in case of this is the only timer that has expired so far */
-                expiredTimerQueueHead = runningTimerQueueHead;
-                expiredTimerQueueTail = runningTimerQueueHead;
+                expiredTimerQueueHead = expiredTimer;
+                expiredTimerQueueTail = expiredTimer;
             }
             else
             { /* there were already some timers expired before this one */
-                swTimers[expiredTimerQueueTail].nextTimer = runningTimerQueueHead;
-                expiredTimerQueueTail = runningTimerQueueHead;
+                swTimers[expiredTimerQueueTail].nextTimer = expiredTimer;
+                expiredTimerQueueTail = expiredTimer;
             }
 
-            runningTimerQueueHead = swTimers[runningTimerQueueHead].nextTimer;
-
             swTimers[expiredTimerQueueTail].nextTimer = SWTIMER_INVALID;
 
-            if ((--runningTimers) > 0)
-            { /* keep the ball rolling! load the next head timer from the queue */
-                loadHwTimer(runningTimerQueueHead);
-            }
+            /* keep the ball rolling! load the next head timer from the heap */
+            swtimerHeapRemove(expiredTimer);
+            swtimerUpdateHead();
         }
     }
 }
@@ -403,6 +629,7 @@ void SwTimerReset(void)
     for (index = 0; index < TOTAL_NUMBER_OF_SW_TIMERS; index++)
     {
         swTimers[index].nextTimer = SWTIMER_INVALID;
+        swTimers[index].heapIndex = SWTIMER_INVALID;
         swTimers[index].timerCb = NULL;
     }
 
@@ -418,11 +645,8 @@ void SystemTimerInit(void)
 
     /* initialize system time parameters */
     sysTimeOvf = 0x00000000;
-    sysTime = 0x0000;
 
-    common_tc_init();
-    set_common_tc_overflow_callback(hwTimerOverflowCallback);
-    set_common_tc_expiry_callback(hwTimerExpiryCallback);
+    hwTimerInit(0u);
 }
 
 /**************************************************************************//**
@@ -485,6 +709,30 @@ StackRetStatus_t SwTimerCreate(uint8_t *timerId)
 ******************************************************************************/
 StackRetStatus_t SwTimerStart(uint8_t timerId, uint32_t timerCount,
     SwTimeoutType_t timeoutType, void *timerCb, void *paramCb)
+{
+    return SwTimerStartWithSlack(timerId, timerCount, timeoutType,
+            SWTIMER_NO_SLACK, timerCb, paramCb);
+}
+
+/**************************************************************************//**
+\brief Starts a timer which may expire late by up to the given slack
+
+       Timers whose expiry windows overlap are expired together on a single
+       hardware wakeup. Timers started by \ref SwTimerStart have no slack.
+
+\param[in] timerId Timer identifier
+\param[in] timerCount Timeout in microseconds
+\param[in] timeoutType \ref SW_TIMEOUT_RELATIVE or \ref SW_TIMEOUT_ABSOLUTE
+\param[in] slack Tolerated delay of the expiry in microseconds
+\param[in] timerCb Callback handler invoked upon timer expiry
+\param[in] paramCb Argument for the callback handler
+
+\return LORAWAN_INVALID_PARAMETER if at least one input parameter in invalid
+        LORAWAN_INVALID_REQUEST if \timerId is already running
+        LORAWAN_SUCCESS if \timerId is successfully queued for running
+******************************************************************************/
+StackRetStatus_t SwTimerStartWithSlack(uint8_t timerId, uint32_t timerCount,
+    SwTimeoutType_t timeoutType, uint32_t slack, void *timerCb, void *paramCb)
 {
     uint32_t now = 0;
     uint32_t pointInTime;
@@ -545,7 +793,13 @@ StackRetStatus_t SwTimerStart(uint8_t timerId, uint32_t timerCount,
         }
     }
 
-    swtimerStartAbsoluteTimer(timerId, pointInTime, timerCb, paramCb);
+    /* The latest expiry has to stay within the comparable time range */
+    if (slack > (SWTIMER_MAX_TIMEOUT - SUB_TIME(pointInTime, now)))
+    {
+        slack = SWTIMER_MAX_TIMEOUT - SUB_TIME(pointInTime, now);
+    }
+
+    swtimerStartAbsoluteTimer(timerId, pointInTime, slack, timerCb, paramCb);
     return LORAWAN_SUCCESS;
 }
 
@@ -597,17 +851,26 @@ uint32_t SwTimerReadValue(uint8_t timerId)
 }
 
 /**************************************************************************//**
-\brief Returns the duration until the next timer expiry
-\return Returns the duration until the next timeout in microseconds
+\brief Returns the duration until the next timer wakeup, the coalesced wake
+       time loadHwTimer arms rather than the expiry of the head timer, so
+       that a sleep is not cut short within the slack of the timers
+\return Returns the duration until the next wakeup in microseconds
 ******************************************************************************/
 uint32_t SwTimerNextExpiryDuration(void)
 {
     uint32_t duration = SWTIMER_INVALID_TIMEOUT;
+    uint32_t wakeTime;
+    uint32_t now;
 
+    ATOMIC_SECTION_ENTER
     if (SWTIMER_INVALID != runningTimerQueueHead)
     {
-        duration = SwTimerReadValue(runningTimerQueueHead);
+        wakeTime = swtimerWakeTime();
+        now = (uint32_t) gettime();
+        /* Already due but not handled yet */
+        duration = swtimerCompareTime(now, wakeTime) ? (wakeTime - now) : 0u;
     }
+    ATOMIC_SECTION_EXIT
 
     return duration;
 }
@@ -620,11 +883,12 @@ void SwTimerRunRemainingTime(uint32_t offset)
 {
     void * timerCb = (void*)(swTimers[runningTimerQueueHead].timerCb);
     void *paramCb = swTimers[runningTimerQueueHead].paramCb;
+    uint32_t slack = swTimers[runningTimerQueueHead].slack;
     uint8_t timerId = runningTimerQueueHead;
 
     if (LORAWAN_SUCCESS == SwTimerStop(runningTimerQueueHead))
     {
-        SwTimerStart(timerId, offset, SW_TIMEOUT_RELATIVE, timerCb, paramCb);
+        SwTimerStartWithSlack(timerId, offset, SW_TIMEOUT_RELATIVE, slack, timerCb, paramCb);
     }
 }
 
@@ -633,8 +897,6 @@ void SwTimerRunRemainingTime(uint32_t offset)
 ******************************************************************************/
 void SwTimersExecute(void)
 {
-    uint64_t now = gettime();
-
     uint8_t flags = cpu_irq_save();
     swtimerInternalHandler();
     cpu_irq_restore(flags);
@@ -648,6 +910,11 @@ void SwTimersExecute(void)
         SwTimerCallbackFunc_t callback;
         void *cbParam;
         uint8_t nextExpiredTimer;
+#if (SWTIMER_STATS == 1)
+        uint8_t expiredTimer;
+        uint32_t expiryTime;
+        bool exact;
+#endif
 
         /* Expired timer if any will be processed here */
         while (SWTIMER_INVALID != expiredTimerQueueHead)
@@ -662,6 +929,12 @@ void SwTimersExecute(void)
             /* Callback parameter is stored */
             cbParam = swTimers[expiredTimerQueueHead].paramCb;
 
+#if (SWTIMER_STATS == 1)
+            expiredTimer = expiredTimerQueueHead;
+            expiryTime = swTimers[expiredTimerQueueHead].absoluteExpiryTime;
+            exact = (SWTIMER_NO_SLACK == swTimers[expiredTimerQueueHead].slack);
+#endif
+
             /*
             * The expired timer's structure elements are updated
             * and the timer is taken out of expired timer queue
@@ -686,9 +959,12 @@ void SwTimersExecute(void)
 
             if (NULL != callback)
             {
+#if (SWTIMER_STATS == 1)
+                swtimerRecordLateness(expiredTimer,
+                        SUB_TIME((uint32_t) gettime(), expiryTime), exact);
+#endif
                 /* Callback function is called */
                 callback(cbParam);
-                (void)now;
             }
         }
     }
@@ -719,54 +995,17 @@ StackRetStatus_t SwTimerStop(uint8_t timerId)
     /* Check if any timer has expired. */
     swtimerInternalHandler();
 
-    /* The requested timer is first searched in the running timer queue */
-    if (runningTimers > 0)
+    /* The requested timer is first looked up in the running timer heap */
+    if (SWTIMER_INVALID != swTimers[timerId].heapIndex)
     {
-        uint8_t timer_count = runningTimers;
-        prevIndex = currIndex = runningTimerQueueHead;
-        while (timer_count > 0)
-        {
-            if (timerId == currIndex)
-            {
-                timerStopReqStatus = true;
-                if (timerId == runningTimerQueueHead)
-                {
-                    common_tc_compare_stop();
-                    runningTimerQueueHead = swTimers[timerId].nextTimer;
-
-                    /*
-                    * The value in OVF corresponds to the timeout pointed
-                    * by the 'running_timer_queue_head'. As the head has
-                    * changed here, OVF needs to be loaded by the new
-                    * timeout value, if any.
-                    */
-                    loadHwTimer(runningTimerQueueHead);
-                }
-                else
-                {
-                    swTimers[prevIndex].nextTimer = swTimers[timerId].nextTimer;
-                }
+        timerStopReqStatus = true;
+        swtimerHeapRemove(timerId);
 
-                /*
-                * The next timer element of the stopped timer is updated
-                * to its default value.
-                */
-                swTimers[timerId].nextTimer  = SWTIMER_INVALID;
-                break;
-            }
-            else
-            {
-                prevIndex = currIndex;
-                currIndex = swTimers[currIndex].nextTimer;
-            }
-
-            timer_count--;
-        }
-
-        if (timerStopReqStatus)
-        {
-            runningTimers--;
-        }
+        /*
+        * If the stopped timer was the head, the compare register needs
+        * to be loaded by the new head timeout value, if any.
+        */
+        swtimerUpdateHead();
     }
 
     /*
@@ -848,13 +1087,57 @@ StackRetStatus_t SwTimerStop(uint8_t timerId)
     return LORAWAN_INVALID_REQUEST;
 }
 
+/**************************************************************************//**
+\brief Returns the wakeup counters of the software timer
+\param[out] wakeups Number of hardware timer wakeups
+\param[out] wakeupsSaved Number of expiries served by the wakeup of
+            another timer
+******************************************************************************/
+void SwTimerGetWakeupStats(uint32_t *wakeups, uint32_t *wakeupsSaved)
+{
+    uint8_t flags = cpu_irq_save();
+
+    *wakeups = hwTimerWakeups;
+    *wakeupsSaved = hwTimerWakeupsSaved;
+
+    cpu_irq_restore(flags);
+}
+
+#if (SWTIMER_STATS == 1)
+/**************************************************************************//**
+\brief Returns the lateness of the callbacks of the given timer
+\param[in] timerId Timer identifier
+\param[out] stats Lateness accounting of the timer
+******************************************************************************/
+void SwTimerGetStats(uint8_t timerId, SwTimerStats_t *stats)
+{
+    if (TOTAL_NUMBER_OF_SW_TIMERS > timerId)
+    {
+        *stats = swTimerStats[timerId];
+    }
+    else
+    {
+        memset(stats, 0, sizeof(SwTimerStats_t));
+    }
+}
+
+/**************************************************************************//**
+\brief Returns the lateness histogram of the timers started without slack
+\param[out] histogram \ref SWTIMER_LATENESS_BINS counters
+******************************************************************************/
+void SwTimerGetLatenessHistogram(uint32_t *histogram)
+{
+    memcpy(histogram, swTimerLatenessHistogram, sizeof(swTimerLatenessHistogram));
+}
+#endif /* #if (SWTIMER_STATS == 1) */
+
 /**************************************************************************//**
 \brief Suspends the software timer
 ******************************************************************************/
 void SystemTimerSuspend(void)
 {
     sysTimeLastKnown = gettime();
-    common_tc_stop();
+    tc_disable(&hwTimerInstance);
 }
 
 /**************************************************************************//**
@@ -863,53 +1146,26 @@ void SystemTimerSuspend(void)
 ******************************************************************************/
 void SystemTimerSync(uint64_t timeToSync)
 {
-    uint8_t timerId;
-    uint16_t adjustOffset;
-
     sysTimeLastKnown += timeToSync;
 
-    /* 1. Update system time */
+    /*
+    * 1. Update system time: the counter restarts where the slept time
+    *    ends, so the absolute expiry times of running timers stay valid
+    */
     sysTimeOvf = (uint32_t) (sysTimeLastKnown >> 32);
-    sysTime = (uint16_t) ((sysTimeLastKnown >> SWTIMER_SYSTIME_SHIFTMASK) & 0xffff);
-
-    /* 2. Adjust expiration of running timers */
-    adjustOffset = (uint16_t) sysTimeLastKnown;
-    timerId = runningTimerQueueHead;
-    for (uint8_t index = 0; index < runningTimers; index++)
-    {
-        if (SWTIMER_INVALID != timerId)
-        {
-            swTimers[timerId].absoluteExpiryTime -= adjustOffset;
-            timerId = swTimers[timerId].nextTimer;
-        }
-    }
 
-    /* 3. Start hardware timer */
-    common_tc_init();
-    set_common_tc_overflow_callback(hwTimerOverflowCallback);
-    set_common_tc_expiry_callback(hwTimerExpiryCallback);
+    /* 2. Start hardware timer */
+    hwTimerInit((uint32_t) sysTimeLastKnown);
 
-    /* 4. Resume timer queue operations */
+    /* 3. Resume timer queue operations, expires the head timer if it is due */
     if (runningTimers && (SWTIMER_INVALID != runningTimerQueueHead))
     {
-        uint32_t remainingTime = SwTimerNextExpiryDuration();
+        uint8_t flags = cpu_irq_save();
 
-        if (SWTIMER_MIN_TIMEOUT > remainingTime)
-        {
-            /*
-            * Since head timer has very less duration...
-            * It cannot be restarted. So, expire head timer.
-            */
-            isTimerTriggered = true;
-            SYSTEM_PostTask(TIMER_TASK_ID);
-        }
-        else
-        {
-            /*
-            * There is some time left in head timer, so restart it.
-            */
-            SwTimerRunRemainingTime(remainingTime);
-        }
+        swTimers[runningTimerQueueHead].loaded = false;
+        loadHwTimer(runningTimerQueueHead);
+
+        cpu_irq_restore(flags);
     }
 }
 
@@ -45,6 +45,13 @@
 /************************************************************************/
 /* Defines                                                              */
 /************************************************************************/
+#define SYSTEM_TASK_ID_COUNT 5u
+
+/* Per task run-time accounting, set to 1 to compile it in. Off by default:
+ * it reads the timer at every SYSTEM_PostTask */
+#ifndef SYSTEM_TASK_STATS
+#define SYSTEM_TASK_STATS 0
+#endif
 
 /************************************************************************/
 /* Types                                                                */
@@ -68,6 +75,19 @@ typedef enum _SYSTEM_Task_t
   APP_TASK_ID     = 1 << 4,
 } SYSTEM_Task_t;
 
+#if (SYSTEM_TASK_STATS == 1)
+/*! \brief Run-time accounting of a task, times in microseconds */
+typedef struct _SYSTEM_TaskStats_t
+{
+  uint32_t runCount;
+  uint32_t maxRunTime;
+  uint64_t totalRunTime;
+  /* Latency: from the first post to the start of the handler */
+  uint32_t maxLatency;
+  uint64_t totalLatency;
+} SYSTEM_TaskStats_t;
+#endif
+
 /************************************************************************/
 /* Prototypes                                                           */
 /************************************************************************/
@@ -107,6 +127,33 @@ void SYSTEM_PostTask(SYSTEM_Task_t task);
 *************************************************************************/
 bool SYSTEM_ReadyToSleep(void);
 
+/*********************************************************************//**
+\brief Returns the index of the highest priority task in a bitmap, i.e.
+       the position of its lowest set bit, in constant time
+
+\param[in] taskFlags - non zero bitmap of pending tasks
+
+\return index of the lowest set bit
+*************************************************************************/
+uint8_t SYSTEM_GetFirstTaskId(uint32_t taskFlags);
+
+#if (SYSTEM_TASK_STATS == 1)
+/*********************************************************************//**
+\brief Returns the run-time accounting of a task
+
+\param[in]  taskIndex - bit position of the task in SYSTEM_Task_t
+\param[out] stats - copy of the accounting of the task
+
+\return 'true' if taskIndex is valid, 'false' otherwise
+*************************************************************************/
+bool SYSTEM_GetTaskStats(uint8_t taskIndex, SYSTEM_TaskStats_t *stats);
+
+/*********************************************************************//**
+\brief Clears the run-time accounting of all tasks
+*************************************************************************/
+void SYSTEM_ResetTaskStats(void);
+#endif
+
 #endif /* SYSTEM_TASK_MANAGER_H */
 
 /* eof system_task_manager.h */
@@ -37,13 +37,18 @@
 /************************************************************************/
 /* Includes                                                             */
 /************************************************************************/
+#include <string.h>
 #include "system_init.h"
 #include "atomic.h"
 #include "system_task_manager.h"
+#if (SYSTEM_TASK_STATS == 1)
+#include "sw_timer.h"
+#endif
 /************************************************************************/
 /* Defines                                                              */
 /************************************************************************/
-#define SYSTEM_TASK_ID_COUNT 5u
+/* Multiplier of the de Bruijn sequence used by SYSTEM_GetFirstTaskId */
+#define SYSTEM_DEBRUIJN_32 0x077CB531u
 
 /************************************************************************/
 /* Externals                                                            */
@@ -77,6 +82,18 @@ static SYSTEM_TaskStatus_t (*taskHandlers[SYSTEM_TASK_ID_COUNT])(void) ={
 
 static volatile uint16_t sysTaskFlag = 0u;
 
+/* Bit position of (x & -x) indexed by ((x & -x) * SYSTEM_DEBRUIJN_32) >> 27 */
+static const uint8_t firstTaskIdLookup[32] = {
+    0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+    31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+};
+
+#if (SYSTEM_TASK_STATS == 1)
+static SYSTEM_TaskStats_t taskStats[SYSTEM_TASK_ID_COUNT];
+/* Time of the first post of a task still pending */
+static uint64_t taskPostTime[SYSTEM_TASK_ID_COUNT];
+#endif
+
 /************************************************************************/
 /* Implementations                                                      */
 /************************************************************************/
@@ -85,30 +102,54 @@ static volatile uint16_t sysTaskFlag = 0u;
 *************************************************************************/
 void SYSTEM_RunTasks(void)
 {
+    uint8_t taskId;
+#if (SYSTEM_TASK_STATS == 1)
+    uint64_t postTime;
+    uint64_t startTime;
+    uint32_t elapsedTime;
+#endif
+
     if ((1 << SYSTEM_TASK_ID_COUNT) > sysTaskFlag)
     { /* Only valid task bits are set */
         while (sysTaskFlag)
         { /* One or more task are pending to execute */
-            for (uint16_t taskId = 0; taskId < SYSTEM_TASK_ID_COUNT; taskId++)
+            /* Highest priority pending task, picked again after every handler */
+            taskId = SYSTEM_GetFirstTaskId(sysTaskFlag);
+
+            /*
+            * Reset the task bit since it is to be executed now.
+            * It is done inside atomic section to avoid any interrupt context
+            * corrupting the bits.
+            */
+            ATOMIC_SECTION_ENTER
+            sysTaskFlag &= ~(1 << taskId);
+#if (SYSTEM_TASK_STATS == 1)
+            postTime = taskPostTime[taskId];
+#endif
+            ATOMIC_SECTION_EXIT
+
+#if (SYSTEM_TASK_STATS == 1)
+            startTime = SwTimerGetTime();
+            elapsedTime = (uint32_t)(startTime - postTime);
+            taskStats[taskId].totalLatency += elapsedTime;
+            if (elapsedTime > taskStats[taskId].maxLatency)
+            {
+                taskStats[taskId].maxLatency = elapsedTime;
+            }
+#endif
+
+            /* Return value is not used now, can be used later */
+            taskHandlers[taskId]();
+
+#if (SYSTEM_TASK_STATS == 1)
+            elapsedTime = (uint32_t)(SwTimerGetTime() - startTime);
+            taskStats[taskId].runCount++;
+            taskStats[taskId].totalRunTime += elapsedTime;
+            if (elapsedTime > taskStats[taskId].maxRunTime)
             {
-                if ((1 << taskId) & sysTaskFlag)
-                {
-                    /*
-                    * Reset the task bit since it is to be executed now.
-                    * It is done inside atomic section to avoid any interrupt context
-                    * corrupting the bits.
-                    */
-                    ATOMIC_SECTION_ENTER
-                    sysTaskFlag &= ~(1 << taskId);
-                    ATOMIC_SECTION_EXIT
-
-                    /* Return value is not used now, can be used later */
-                    taskHandlers[taskId]();
-
-                    /* Break here so that higher priority task executes next, if any */
-                    break;
-                }
+                taskStats[taskId].maxRunTime = elapsedTime;
             }
+#endif
         }
     }
     else
@@ -146,6 +187,12 @@ void SYSTEM_RunTasks(void)
 void SYSTEM_PostTask(SYSTEM_Task_t task)
 {
     ATOMIC_SECTION_ENTER
+#if (SYSTEM_TASK_STATS == 1)
+    if (!(sysTaskFlag & task))
+    {
+        taskPostTime[SYSTEM_GetFirstTaskId(task)] = SwTimerGetTime();
+    }
+#endif
     sysTaskFlag |= task;
     ATOMIC_SECTION_EXIT
 }
@@ -160,5 +207,49 @@ bool SYSTEM_ReadyToSleep(void)
     return !(sysTaskFlag & 0xffff);
 }
 
+/*********************************************************************//**
+\brief Returns the index of the highest priority task in a bitmap, i.e.
+       the position of its lowest set bit. Cortex-M0+ has no CLZ/CTZ
+       instruction, the lowest set bit is isolated and hashed with a
+       de Bruijn multiplication instead.
+
+\param[in] taskFlags - non zero bitmap of pending tasks
+
+\return index of the lowest set bit
+*************************************************************************/
+uint8_t SYSTEM_GetFirstTaskId(uint32_t taskFlags)
+{
+    return firstTaskIdLookup[((taskFlags & -taskFlags) * SYSTEM_DEBRUIJN_32) >> 27];
+}
+
+#if (SYSTEM_TASK_STATS == 1)
+/*********************************************************************//**
+\brief Returns the run-time accounting of a task
+
+\param[in]  taskIndex - bit position of the task in SYSTEM_Task_t
+\param[out] stats - copy of the accounting of the task
+
+\return 'true' if taskIndex is valid, 'false' otherwise
+*************************************************************************/
+bool SYSTEM_GetTaskStats(uint8_t taskIndex, SYSTEM_TaskStats_t *stats)
+{
+    if (taskIndex >= SYSTEM_TASK_ID_COUNT)
+    {
+        return false;
+    }
+
+    *stats = taskStats[taskIndex];
+    return true;
+}
+
+/*********************************************************************//**
+\brief Clears the run-time accounting of all tasks
+*************************************************************************/
+void SYSTEM_ResetTaskStats(void)
+{
+    memset(taskStats, 0, sizeof(taskStats));
+}
+#endif
+
 /* eof system_task_manager.c */
 
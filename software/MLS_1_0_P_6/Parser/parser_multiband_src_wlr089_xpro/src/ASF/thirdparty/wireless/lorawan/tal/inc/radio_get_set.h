@@ -81,11 +81,31 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout);
 
 \param newMode			- Sets the transceiver mode.
 \param newModulation	- Sets the modulation.
-\param blocking			- Sets if its blocking call or not.
+\param blocking			- BLOCKING_REQ to wait until the mode is ready,
+						  NON_BLOCKING_REQ to return at once.
 \return					- none.
 *************************************************************************/
 void Radio_WriteMode(RadioMode_t newMode, RadioModulation_t newModulation, uint8_t blocking);
 
+/*********************************************************************//**
+\brief	Called when the mode requested by Radio_WriteModeAsync is ready.
+*************************************************************************/
+typedef void (*RadioModeReadyCallback_t)(void);
+
+/*********************************************************************//**
+\brief	This function switches the transceiver mode like Radio_WriteMode
+		and returns without waiting for the switch. ModeReady is polled
+		from a timer and the callback is called from the timer task once
+		it is set, or after RADIO_MODE_READY_TIMEOUT_US. The callback is
+		called before the return if the mode is already ready.
+
+\param newMode			- Sets the transceiver mode.
+\param newModulation	- Sets the modulation.
+\param callback			- Function called when the mode is ready.
+\return					- none.
+*************************************************************************/
+void Radio_WriteModeAsync(RadioMode_t newMode, RadioModulation_t newModulation, RadioModeReadyCallback_t callback);
+
 #endif  /*_RADIO_GET_SET_H*/
 
 // eof radio_get_set.h
\ No newline at end of file
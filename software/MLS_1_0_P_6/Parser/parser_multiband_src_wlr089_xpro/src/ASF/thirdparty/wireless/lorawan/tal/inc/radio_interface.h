@@ -290,6 +290,8 @@ typedef struct _RadioCallbackParam_t
 		{
 
 			uint32_t timeOnAir;
+			/* System time at the end of the transmission in microseconds */
+			uint64_t txDoneTime;
 		} TX;
 		struct _FHSS
 		{
@@ -379,6 +381,7 @@ typedef struct _RadioConfiguration_t
     uint8_t timeOnAirTimerId;
     uint8_t fskRxWindowTimerId;
     uint8_t watchdogTimerId;
+    uint8_t modeReadyTimerId;
     uint8_t initialized;
     uint8_t regVersion;
     int8_t packetSNR;
@@ -639,6 +642,17 @@ void RADIO_RxTimeout(void);
 *************************************************************************/
 uint16_t RADIO_ReadRandom(void);
 
+/*********************************************************************//**
+\brief	This function returns a random number from an AES-128 counter
+		mode generator. The generator is reseeded with the RSSI samples
+		harvested during the receive windows and the LBT scans. Only the
+		first call blocks, to seed it with one RADIO_ReadRandom.
+
+\param		- none
+\return		- returns the random number generated.
+*************************************************************************/
+uint16_t RADIO_GetRandom(void);
+
 /*********************************************************************//**
 \brief	This function can be called by MAC to read radio buffer pointer
 		and length of a receive frame(typically in rxdone)
@@ -46,7 +46,7 @@
 /******************************************************************************
                    Defines section
 ******************************************************************************/
-#define RADIO_TASKS_COUNT               5u
+#define RADIO_TASKS_COUNT               6u
 
 /******************************************************************************
                                Types section
@@ -55,16 +55,18 @@ typedef enum
 {
   RADIO_TX_DONE_TASK_ID = (1 << 0),
   RADIO_RX_DONE_TASK_ID = (1 << 1),
-  RADIO_TX_TASK_ID      = (1 << 2),
-  RADIO_RX_TASK_ID      = (1 << 3),
-  RADIO_SCAN_TASK_ID = (1 << 4),
-  RADIO_SLEEP_TASK_ID = (1 << 5)
+  RADIO_TX_START_TASK_ID = (1 << 2),
+  RADIO_TX_TASK_ID      = (1 << 3),
+  RADIO_RX_TASK_ID      = (1 << 4),
+  RADIO_SCAN_TASK_ID = (1 << 5),
+  RADIO_SLEEP_TASK_ID = (1 << 6)
 } RadioTaskIds_t;
 
 /******************************************************************************
                    Prototypes section
 ******************************************************************************/
 extern SYSTEM_TaskStatus_t RADIO_TxHandler(void);
+extern SYSTEM_TaskStatus_t RADIO_TxStartHandler(void);
 extern SYSTEM_TaskStatus_t RADIO_RxHandler(void);
 extern SYSTEM_TaskStatus_t RADIO_TxDoneHandler(void);
 extern SYSTEM_TaskStatus_t RADIO_RxDoneHandler(void);
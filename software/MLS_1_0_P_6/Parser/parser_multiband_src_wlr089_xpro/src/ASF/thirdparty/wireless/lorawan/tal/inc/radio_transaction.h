@@ -64,6 +64,8 @@
 
 #define NON_BLOCKING_REQ			0
 #define BLOCKING_REQ				1
+// Maps ModeReady on DIO5 and returns at once, for Radio_WriteModeAsync
+#define MODE_READY_REQ				2
 
 /************************************************************************/
 /*  Global variables                                                    */
@@ -56,6 +56,25 @@
 /*  Prototypes															*/
 /************************************************************************/
 
+/*********************************************************************//**
+\brief	This function queues the frequency registers for the next register
+		sequence write.
+
+\param frequency	- Sets the transmit radio frequency.
+\return				- none.
+*************************************************************************/
+static void Radio_StageFrequency(uint32_t frequency);
+
+/*********************************************************************//**
+\brief	This function converts a frequency into the values of the
+		REG_FRFMSB, REG_FRFMID and REG_FRFLSB registers.
+
+\param frequency	- Radio frequency.
+\param frf			- Filled with the three register values.
+\return				- none.
+*************************************************************************/
+static void Radio_FrequencyToFrf(uint32_t frequency, uint8_t *frf);
+
 /*********************************************************************//**
 \brief	This function sets FSK frequency deviation in FSK mode.
 
@@ -506,10 +525,46 @@ void RADIO_Init(void)
 /*********************************************************************//**
 \brief	This function sets the transmit frequency.
 
+		The registers are written at once, without the register sequence,
+		since this is also called from the FHSS interrupt.
+
 \param frequency	- Sets the transmit radio frequency.
 \return				- none.
 *************************************************************************/
 void Radio_WriteFrequency(uint32_t frequency)
+{
+    uint8_t frf[3];
+
+    Radio_FrequencyToFrf(frequency, frf);
+    RADIO_RegisterBurstWrite(REG_FRFMSB, frf, sizeof(frf));
+}
+
+/*********************************************************************//**
+\brief	This function queues the frequency registers for the next register
+		sequence write.
+
+\param frequency	- Sets the transmit radio frequency.
+\return				- none.
+*************************************************************************/
+static void Radio_StageFrequency(uint32_t frequency)
+{
+    uint8_t frf[3];
+
+    Radio_FrequencyToFrf(frequency, frf);
+    RADIO_RegisterStage(REG_FRFMSB, frf[0]);
+    RADIO_RegisterStage(REG_FRFMID, frf[1]);
+    RADIO_RegisterStage(REG_FRFLSB, frf[2]);
+}
+
+/*********************************************************************//**
+\brief	This function converts a frequency into the values of the
+		REG_FRFMSB, REG_FRFMID and REG_FRFLSB registers.
+
+\param frequency	- Radio frequency.
+\param frf			- Filled with the three register values.
+\return				- none.
+*************************************************************************/
+static void Radio_FrequencyToFrf(uint32_t frequency, uint8_t *frf)
 {
     uint32_t num, num_mod;
     // Frf = (Fxosc * num) / 2^19
@@ -533,9 +588,9 @@ void Radio_WriteFrequency(uint32_t frequency)
 
     // Now variable num holds the representation of the frequency that needs to
     // be loaded into the radio chip
-    RADIO_RegisterWrite(REG_FRFMSB, (num >> SHIFT16) & 0xFF);
-    RADIO_RegisterWrite(REG_FRFMID, (num >> SHIFT8) & 0xFF);
-    RADIO_RegisterWrite(REG_FRFLSB, num & 0xFF);
+    frf[0] = (num >> SHIFT16) & 0xFF;
+    frf[1] = (num >> SHIFT8) & 0xFF;
+    frf[2] = num & 0xFF;
 }
 
 /*********************************************************************//**
@@ -559,8 +614,8 @@ static void Radio_WriteFSKFrequencyDeviation(uint32_t frequencyDeviation)
 
     // Now variable num holds the representation of the frequency deviation that
     // needs to be loaded into the radio chip
-    RADIO_RegisterWrite(REG_FSK_FDEVMSB, (num >> SHIFT8) & 0xFF);
-    RADIO_RegisterWrite(REG_FSK_FDEVLSB, num & 0xFF);
+    RADIO_RegisterStage(REG_FSK_FDEVMSB, (num >> SHIFT8) & 0xFF);
+    RADIO_RegisterStage(REG_FSK_FDEVLSB, num & 0xFF);
 }
 
 /*********************************************************************//**
@@ -578,9 +633,9 @@ static void Radio_WriteFSKBitRate(uint32_t bitRate)
 
     // Now variable num holds the representation of the bitrate that
     // needs to be loaded into the radio chip
-    RADIO_RegisterWrite(REG_FSK_BITRATEMSB, (num >> SHIFT8));
-    RADIO_RegisterWrite(REG_FSK_BITRATELSB, num & 0xFF);
-    RADIO_RegisterWrite(REG_FSK_BITRATEFRAC, 0x00);
+    RADIO_RegisterStage(REG_FSK_BITRATEMSB, (num >> SHIFT8));
+    RADIO_RegisterStage(REG_FSK_BITRATELSB, num & 0xFF);
+    RADIO_RegisterStage(REG_FSK_BITRATEFRAC, 0x00);
 }
 
 /*********************************************************************//**
@@ -609,7 +664,7 @@ static void Radio_WritePower(int8_t power)
         paDac = RADIO_RegisterRead(REG_PADAC);
         paDac &= ~(0x07);
         paDac |= 0x04;
-        RADIO_RegisterWrite(REG_PADAC, paDac);
+        RADIO_RegisterStage(REG_PADAC, paDac);
 
         if (power < 0)
         {
@@ -617,14 +672,14 @@ static void Radio_WritePower(int8_t power)
             // Pout = 10.8 + MaxPower*0.6 - 15 + OutPower
             // Pout = -3 + OutPower
             power += 3;
-            RADIO_RegisterWrite(REG_PACONFIG, 0x20 | power);
+            RADIO_RegisterStage(REG_PACONFIG, 0x20 | power);
         }
         else
         {
             // MaxPower = 7
             // Pout = 10.8 + MaxPower*0.6 - 15 + OutPower
             // Pout = OutPower
-            RADIO_RegisterWrite(REG_PACONFIG, 0x70 | power);
+            RADIO_RegisterStage(REG_PACONFIG, 0x70 | power);
         }
     }
     else
@@ -663,15 +718,16 @@ static void Radio_WritePower(int8_t power)
             ocp |= 0x20;
         }
 
-        RADIO_RegisterWrite(REG_PADAC, paDac);
-        RADIO_RegisterWrite(REG_PACONFIG, 0x80 | power);
-        RADIO_RegisterWrite(REG_OCP, ocp);
+        RADIO_RegisterStage(REG_PADAC, paDac);
+        RADIO_RegisterStage(REG_PACONFIG, 0x80 | power);
+        RADIO_RegisterStage(REG_OCP, ocp);
     }
 }
 
 /*********************************************************************//**
 \brief	This function prepares the transceiver for transmit and receive
-		according to modulation set.
+		according to modulation set. The registers are queued and written
+		in one sequence, skipping the ones that already hold their value.
 
 \param symbolTimeout	- Sets the symbolTimeout parameter.
 \return					- none.
@@ -682,21 +738,25 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
     uint8_t regValue;
     uint8_t i;
 
+#if (RADIO_SPI_STATS == 1)
+    RADIO_SpiStatsNewCycle();
+#endif
+
     // Load configuration from RadioConfiguration_t structure into radio
     Radio_WriteMode(MODE_SLEEP, radioConfiguration.modulation, 0);
-    Radio_WriteFrequency(radioConfiguration.frequency);
+    Radio_StageFrequency(radioConfiguration.frequency);
     Radio_WritePower(radioConfiguration.outputPower);
 
     if (MODULATION_LORA == radioConfiguration.modulation)
     {
-        RADIO_RegisterWrite(0x39, radioConfiguration.syncWordLoRa);
+        RADIO_RegisterStage(0x39, radioConfiguration.syncWordLoRa);
 
-        RADIO_RegisterWrite(REG_LORA_MODEMCONFIG1,
+        RADIO_RegisterStage(REG_LORA_MODEMCONFIG1,
                             (radioConfiguration.bandWidth << SHIFT4) |
                             (radioConfiguration.errorCodingRate << SHIFT1) |
                             (radioConfiguration.implicitHeaderMode & 0x01));
 
-        RADIO_RegisterWrite(REG_LORA_MODEMCONFIG2,
+        RADIO_RegisterStage(REG_LORA_MODEMCONFIG2,
                             (radioConfiguration.dataRate << SHIFT4) |
                             ((radioConfiguration.crcOn & 0x01) << SHIFT2) |
                             ((symbolTimeout & 0x0300) >> SHIFT8));
@@ -730,9 +790,9 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
         {
             tempValue = 0;
         }
-        RADIO_RegisterWrite(REG_LORA_HOPPERIOD, (uint8_t) tempValue);
+        RADIO_RegisterStage(REG_LORA_HOPPERIOD, (uint8_t) tempValue);
 
-        RADIO_RegisterWrite(REG_LORA_SYMBTIMEOUTLSB, (symbolTimeout & 0xFF));
+        RADIO_RegisterStage(REG_LORA_SYMBTIMEOUTLSB, (symbolTimeout & 0xFF));
 
         // If the symbol time is > 16ms, LowDataRateOptimize needs to be set
         // This long symbol time only happens for SF12&BW125, SF12&BW250
@@ -753,15 +813,15 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
         }
 		
         regValue |= 1 << SHIFT2;         // LNA gain set by internal AGC loop
-        RADIO_RegisterWrite(REG_LORA_MODEMCONFIG3, regValue);
+        RADIO_RegisterStage(REG_LORA_MODEMCONFIG3, regValue);
 
         regValue = RADIO_RegisterRead(REG_LORA_DETECTOPTIMIZE);
         regValue &= ~(0x07);        // Clear DetectOptimize bits
         regValue |= 0x03;           // Set value for SF7 - SF12
-        RADIO_RegisterWrite(REG_LORA_DETECTOPTIMIZE, regValue);
+        RADIO_RegisterStage(REG_LORA_DETECTOPTIMIZE, regValue);
 
         // Also set DetectionThreshold value for SF7 - SF12
-        RADIO_RegisterWrite(REG_LORA_DETECTIONTHRESHOLD, 0x0A);
+        RADIO_RegisterStage(REG_LORA_DETECTIONTHRESHOLD, 0x0A);
 
         // Errata settings to mitigate spurious reception of a LoRa Signal
         if (0x12 == radioConfiguration.regVersion)
@@ -773,30 +833,30 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
             {
                 regValue = RADIO_RegisterRead(0x31);
                 regValue &= ~0x80;                                  // Clear bit 7
-                RADIO_RegisterWrite(0x31, regValue);
-                RADIO_RegisterWrite(0x2F, 0x40);
-                RADIO_RegisterWrite(0x30, 0x00);
+                RADIO_RegisterStage(0x31, regValue);
+                RADIO_RegisterStage(0x2F, 0x40);
+                RADIO_RegisterStage(0x30, 0x00);
             }
 
             if (BW_500KHZ == radioConfiguration.bandWidth)
             {
                 regValue = RADIO_RegisterRead(0x31);
                 regValue |= 0x80;                                   // Set bit 7
-                RADIO_RegisterWrite(0x31, regValue);
+                RADIO_RegisterStage(0x31, regValue);
             }
         }
 
         regValue = RADIO_RegisterRead(REG_LORA_INVERTIQ);
         regValue &= ~(1 << 6);                                        // Clear InvertIQ bit
         regValue |= (radioConfiguration.iqInverted & 0x01) << SHIFT6;    // Set InvertIQ bit if needed
-        RADIO_RegisterWrite(REG_LORA_INVERTIQ, regValue);
+        RADIO_RegisterStage(REG_LORA_INVERTIQ, regValue);
 
-        RADIO_RegisterWrite(REG_LORA_PREAMBLEMSB, radioConfiguration.preambleLen >> SHIFT8);
-        RADIO_RegisterWrite(REG_LORA_PREAMBLELSB, radioConfiguration.preambleLen & 0xFF);
+        RADIO_RegisterStage(REG_LORA_PREAMBLEMSB, radioConfiguration.preambleLen >> SHIFT8);
+        RADIO_RegisterStage(REG_LORA_PREAMBLELSB, radioConfiguration.preambleLen & 0xFF);
 
-        RADIO_RegisterWrite(REG_LORA_FIFOADDRPTR, 0x00);
-        RADIO_RegisterWrite(REG_LORA_FIFOTXBASEADDR, 0x00);
-        RADIO_RegisterWrite(REG_LORA_FIFORXBASEADDR, 0x00);
+        RADIO_RegisterStage(REG_LORA_FIFOADDRPTR, 0x00);
+        RADIO_RegisterStage(REG_LORA_FIFOTXBASEADDR, 0x00);
+        RADIO_RegisterStage(REG_LORA_FIFORXBASEADDR, 0x00);
 
         // Errata sensitivity increase for 500kHz BW
         if (0x12 == radioConfiguration.regVersion)
@@ -806,37 +866,37 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
                 (radioConfiguration.frequency <= FREQ_1020000KHZ)
                 )
             {
-                RADIO_RegisterWrite(0x36, 0x02);
-                RADIO_RegisterWrite(0x3a, 0x64);
+                RADIO_RegisterStage(0x36, 0x02);
+                RADIO_RegisterStage(0x3a, 0x64);
             }
             else if ( (BW_500KHZ == radioConfiguration.bandWidth) &&
                        (radioConfiguration.frequency >= FREQ_410000KHZ) &&
                        (radioConfiguration.frequency <= FREQ_525000KHZ)
                        )
             {
-                RADIO_RegisterWrite(0x36, 0x02);
-                RADIO_RegisterWrite(0x3a, 0x7F);
+                RADIO_RegisterStage(0x36, 0x02);
+                RADIO_RegisterStage(0x3a, 0x7F);
             }
             else
             {
-                RADIO_RegisterWrite(0x36, 0x03);
+                RADIO_RegisterStage(0x36, 0x03);
             }
 
             // LoRa Inverted Polarity 500kHz fix (May 26, 2015 document)
             if ((BW_500KHZ == radioConfiguration.bandWidth) && (1 == radioConfiguration.iqInverted))
             {
-                RADIO_RegisterWrite(0x3A, 0x65);     // Freq to time drift
-                RADIO_RegisterWrite(0x3B, 25);       // Freq to time invert = 0d25
+                RADIO_RegisterStage(0x3A, 0x65);     // Freq to time drift
+                RADIO_RegisterStage(0x3B, 25);       // Freq to time invert = 0d25
             }
             else
             {
-                RADIO_RegisterWrite(0x3A, 0x65);     // Freq to time drift
-                RADIO_RegisterWrite(0x3B, 29);       // Freq to time invert = 0d29 (default)
+                RADIO_RegisterStage(0x3A, 0x65);     // Freq to time drift
+                RADIO_RegisterStage(0x3B, 29);       // Freq to time invert = 0d29 (default)
             }
         }
 
         // Clear all interrupts (just in case)
-        RADIO_RegisterWrite(REG_LORA_IRQFLAGS, 0xFF);
+        RADIO_RegisterStage(REG_LORA_IRQFLAGS, 0xFF);
     }
     else
     {
@@ -844,18 +904,18 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
         Radio_WriteFSKFrequencyDeviation(radioConfiguration.frequencyDeviation);
         Radio_WriteFSKBitRate(radioConfiguration.bitRate);
 
-        RADIO_RegisterWrite(REG_FSK_PREAMBLEMSB, (radioConfiguration.preambleLen >> SHIFT8) & 0x00FF);
-        RADIO_RegisterWrite(REG_FSK_PREAMBLELSB, radioConfiguration.preambleLen & 0xFF);
+        RADIO_RegisterStage(REG_FSK_PREAMBLEMSB, (radioConfiguration.preambleLen >> SHIFT8) & 0x00FF);
+        RADIO_RegisterStage(REG_FSK_PREAMBLELSB, radioConfiguration.preambleLen & 0xFF);
 		
 		// Triggering event: PreambleDetect does AfcAutoOn, AgcAutoOn
 		// Also sets RestartRxOnCollision bit
-		RADIO_RegisterWrite(REG_FSK_RXCONFIG, 0x9E);
+		RADIO_RegisterStage(REG_FSK_RXCONFIG, 0x9E);
 
         // Configure PaRamp
         regValue = RADIO_RegisterRead(REG_PARAMP);
         regValue &= ~0x60;    // Clear shaping bits
         regValue |= radioConfiguration.fskDataShaping << SHIFT5;
-        RADIO_RegisterWrite(REG_PARAMP, regValue);
+        RADIO_RegisterStage(REG_PARAMP, regValue);
 
         // Variable length packets, whitening, Clear FIFO when CRC fails
         // no address filtering, CCITT CRC and whitening
@@ -864,30 +924,32 @@ void Radio_WriteConfiguration(uint16_t symbolTimeout)
         {
             regValue |= 0x10;   // Enable CRC
         }
-        RADIO_RegisterWrite(REG_FSK_PACKETCONFIG1, regValue);
-        RADIO_RegisterWrite(REG_FSK_PACKETCONFIG2, 1 << SHIFT6);
+        RADIO_RegisterStage(REG_FSK_PACKETCONFIG1, regValue);
+        RADIO_RegisterStage(REG_FSK_PACKETCONFIG2, 1 << SHIFT6);
 
         // Syncword value
         for (i = 0; i < radioConfiguration.syncWordLen; i++)
         {
             // Take advantage of the fact that the SYNCVALUE registers are
             // placed at sequential addresses
-            RADIO_RegisterWrite(REG_FSK_SYNCVALUE1 + i, radioConfiguration.syncWord[i]);
+            RADIO_RegisterStage(REG_FSK_SYNCVALUE1 + i, radioConfiguration.syncWord[i]);
         }
 
         // Enable sync word generation/detection if needed, Syncword size = syncWordLen + 1 bytes
         if (radioConfiguration.syncWordLen != 0)
         {
-            RADIO_RegisterWrite(REG_FSK_SYNCCONFIG, 0x10 | (radioConfiguration.syncWordLen - 1));
+            RADIO_RegisterStage(REG_FSK_SYNCCONFIG, 0x10 | (radioConfiguration.syncWordLen - 1));
         } else
         {
-            RADIO_RegisterWrite(REG_FSK_SYNCCONFIG, 0x00);
+            RADIO_RegisterStage(REG_FSK_SYNCCONFIG, 0x00);
         }
 
         // Clear all FSK interrupts (just in case)
-        RADIO_RegisterWrite(REG_FSK_IRQFLAGS1, 0xFF);
-        RADIO_RegisterWrite(REG_FSK_IRQFLAGS2, 0xFF);
+        RADIO_RegisterStage(REG_FSK_IRQFLAGS1, 0xFF);
+        RADIO_RegisterStage(REG_FSK_IRQFLAGS2, 0xFF);
     }
+
+    RADIO_RegisterSequenceWrite();
 }
 
 /**
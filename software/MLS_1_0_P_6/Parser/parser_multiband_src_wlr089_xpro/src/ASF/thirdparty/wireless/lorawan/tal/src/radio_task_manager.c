@@ -59,6 +59,7 @@ static SYSTEM_TaskStatus_t (*radioTaskHandlers[RADIO_TASKS_COUNT])(void) = {
     /* In the order of descending priority */
     RADIO_TxDoneHandler,
     RADIO_RxDoneHandler,
+    RADIO_TxStartHandler,
     RADIO_TxHandler,
     RADIO_RxHandler,
 	RADIO_ScanHandler
@@ -105,26 +106,23 @@ void radioClearTask(RadioTaskIds_t id)
 ******************************************************************************/
 SYSTEM_TaskStatus_t RADIO_TaskHandler(void)
 {
-    if (radioTaskFlags)
+    uint16_t pendingTasks = radioTaskFlags & ((1 << RADIO_TASKS_COUNT) - 1);
+    uint8_t taskId;
+
+    if (pendingTasks)
     {
-        for (uint16_t taskId = 0; taskId < RADIO_TASKS_COUNT; taskId++)
+        /* Highest priority pending task */
+        taskId = SYSTEM_GetFirstTaskId(pendingTasks);
+
+        ATOMIC_SECTION_ENTER
+        radioTaskFlags &= ~(1 << taskId);
+        ATOMIC_SECTION_EXIT
+
+        radioTaskHandlers[taskId]();
+
+        if (radioTaskFlags)
         {
-            if ((1 << taskId) & (radioTaskFlags))
-            {
-
-                ATOMIC_SECTION_ENTER
-                radioTaskFlags &= ~(1 << taskId);
-                ATOMIC_SECTION_EXIT
-
-                radioTaskHandlers[taskId]();
-
-                if (radioTaskFlags)
-                {
-                    SYSTEM_PostTask(RADIO_TASK_ID);
-                }
-                
-                break;
-            }
+            SYSTEM_PostTask(RADIO_TASK_ID);
         }
     }
     /*
@@ -46,6 +46,7 @@
 #include "radio_transaction.h"
 #include "sw_timer.h"
 #include "sys.h"
+#include "aes_engine.h"
 #include "stdint.h"
 #include "string.h"
 
@@ -59,9 +60,70 @@ RadioConfiguration_t radioConfiguration;
 /************************************************************************/
 extern volatile RadioCallbackMask_t radioCallbackMask;
 
+/************************************************************************/
+/*  Static variables                                                    */
+/************************************************************************/
+// RSSI samples harvested since the last reseed, LSBs spread over the 128 bits
+static uint8_t entropyPool[BLOCKSIZE];
+static volatile uint16_t entropySamples;
+
+// Key, counter and last output block of the AES counter mode generator
+static uint8_t rngKey[BLOCKSIZE];
+static uint8_t rngCounter[BLOCKSIZE];
+static uint8_t rngOutput[BLOCKSIZE];
+static uint8_t rngOutputIdx = BLOCKSIZE;
+static bool rngSeeded = false;
+// Harvested samples the next reseed waits for, fewer right after the cold seed
+static uint16_t rngReseedSamples = RADIO_ENTROPY_SEED_BITS * RADIO_ENTROPY_SAMPLES_PER_BIT;
+
+// Pending Radio_WriteModeAsync and the time it has waited for ModeReady
+static RadioModeReadyCallback_t modeReadyCallback;
+static uint16_t modeReadyWaitUs;
+
 /************************************************************************/
 /*  Static functions                                                    */
 /************************************************************************/
+/*********************************************************************//**
+\brief	This function folds the entropy pool into the generator key.
+
+\param		- none
+\return		- none.
+*************************************************************************/
+static void Radio_RandomReseed(void);
+
+/*********************************************************************//**
+\brief	This function encrypts the next counter value with the generator
+		key into the given block.
+
+\param block	- The output block.
+\return			- none.
+*************************************************************************/
+static void Radio_RandomNextBlock(uint8_t *block);
+
+/*********************************************************************//**
+\brief	This function tells if the mode requested by Radio_WriteMode
+		with BLOCKING_REQ or MODE_READY_REQ is ready.
+
+\return					- true when the radio signals ModeReady.
+*************************************************************************/
+static bool Radio_IsModeReady(void);
+
+/*********************************************************************//**
+\brief	This function is the callback of the ModeReady poll timer of
+		Radio_WriteModeAsync.
+
+\param time				- not used.
+\return					- none.
+*************************************************************************/
+static void Radio_ModeReadyPoll(uint8_t time);
+
+/*********************************************************************//**
+\brief	This function ends the pending Radio_WriteModeAsync and calls its
+		callback.
+
+\return					- none.
+*************************************************************************/
+static void Radio_ModeReadyDone(void);
 
 /************************************************************************/
 /* Implementations                                                      */
@@ -73,13 +135,16 @@ extern volatile RadioCallbackMask_t radioCallbackMask;
 
 \param newMode			- Sets the transceiver mode.
 \param newModulation	- Sets the modulation.
-\param blocking			- Sets if its blocking call or not.
+\param blocking			- BLOCKING_REQ to wait until the mode is ready,
+						  NON_BLOCKING_REQ to return at once, MODE_READY_REQ
+						  to return at once with ModeReady on DIO5.
 \return					- none.
 *************************************************************************/
 void Radio_WriteMode(RadioMode_t newMode, RadioModulation_t newModulation, uint8_t blocking)
 {
     uint8_t opMode;
     uint8_t dioMapping;
+    uint16_t waitUs;
     RadioModulation_t currentModulation;
     RadioMode_t currentMode;
 
@@ -140,7 +205,7 @@ void Radio_WriteMode(RadioMode_t newMode, RadioModulation_t newModulation, uint8
     {
         // If we need to block until the mode switch is ready, configure the
         // DIO5 pin to relay this information.
-        if ((MODE_SLEEP != newMode) && (1 == blocking))
+        if ((MODE_SLEEP != newMode) && (NON_BLOCKING_REQ != blocking))
         {
             dioMapping = RADIO_RegisterRead(REG_DIOMAPPING2);
             if (MODULATION_FSK == newModulation)
@@ -161,24 +226,102 @@ void Radio_WriteMode(RadioMode_t newMode, RadioModulation_t newModulation, uint8
         opMode |= newMode;              // Set new mode bits
         RADIO_RegisterWrite(REG_OPMODE, opMode);
 
-        // If required and possible, wait for switch to complete
-        if (1 == blocking)
+        // If required and possible, wait for switch to complete. ModeReady
+        // is cleared by the write of the mode. Sleep is entered on the write
+        // itself, as the modulation change above already relies on.
+        if ((BLOCKING_REQ == blocking) && (MODE_SLEEP != newMode))
         {
-            if (MODE_SLEEP != newMode)
-            {
-               // while (HAL_DIO5PinValue() == 0);
-			   /* Wait for Mode change to happen */
-			   delay_ms(1);
-            }
-            else
+            for (waitUs = 0; (waitUs < RADIO_MODE_READY_TIMEOUT_US) && !Radio_IsModeReady(); waitUs += RADIO_MODE_READY_POLL_US)
             {
-                SystemBlockingWaitMs(1);
+                delay_us(RADIO_MODE_READY_POLL_US);
             }
         }
     }
 
 }
 
+/*********************************************************************//**
+\brief	This function switches the transceiver mode like Radio_WriteMode
+		and returns without waiting for the switch. ModeReady is polled
+		from a timer and the callback is called from the timer task once
+		it is set, or after RADIO_MODE_READY_TIMEOUT_US. The callback is
+		called before the return if the mode is already ready.
+
+\param newMode			- Sets the transceiver mode.
+\param newModulation	- Sets the modulation.
+\param callback			- Function called when the mode is ready.
+\return					- none.
+*************************************************************************/
+void Radio_WriteModeAsync(RadioMode_t newMode, RadioModulation_t newModulation, RadioModeReadyCallback_t callback)
+{
+    // A switch still waiting is replaced by this one
+    SwTimerStop(radioConfiguration.modeReadyTimerId);
+
+    modeReadyCallback = callback;
+    Radio_WriteMode(newMode, newModulation, MODE_READY_REQ);
+
+    // Sleep does not raise ModeReady, it is entered on the write itself
+    if ((MODE_SLEEP == newMode) || Radio_IsModeReady())
+    {
+        Radio_ModeReadyDone();
+    }
+    else
+    {
+        modeReadyWaitUs = 0;
+        SwTimerStart(radioConfiguration.modeReadyTimerId, RADIO_MODE_READY_TIMER_US, SW_TIMEOUT_RELATIVE, (void *)Radio_ModeReadyPoll, NULL);
+    }
+}
+
+/*********************************************************************//**
+\brief	This function tells if the mode requested by Radio_WriteMode
+		with BLOCKING_REQ or MODE_READY_REQ is ready.
+
+\return					- true when the radio signals ModeReady.
+*************************************************************************/
+static bool Radio_IsModeReady(void)
+{
+    return (0 != HAL_DIO5PinValue());
+}
+
+/*********************************************************************//**
+\brief	This function is the callback of the ModeReady poll timer of
+		Radio_WriteModeAsync.
+
+\param time				- not used.
+\return					- none.
+*************************************************************************/
+static void Radio_ModeReadyPoll(uint8_t time)
+{
+    (void)time;
+
+    modeReadyWaitUs += RADIO_MODE_READY_TIMER_US;
+    if (!Radio_IsModeReady() && (modeReadyWaitUs < RADIO_MODE_READY_TIMEOUT_US))
+    {
+        SwTimerStart(radioConfiguration.modeReadyTimerId, RADIO_MODE_READY_TIMER_US, SW_TIMEOUT_RELATIVE, (void *)Radio_ModeReadyPoll, NULL);
+    }
+    else
+    {
+        Radio_ModeReadyDone();
+    }
+}
+
+/*********************************************************************//**
+\brief	This function ends the pending Radio_WriteModeAsync and calls its
+		callback.
+
+\return					- none.
+*************************************************************************/
+static void Radio_ModeReadyDone(void)
+{
+    RadioModeReadyCallback_t callback = modeReadyCallback;
+
+    modeReadyCallback = NULL;
+    if (NULL != callback)
+    {
+        callback();
+    }
+}
+
 /*********************************************************************//**
 \brief	This function sets the receive frequency of the transceiver
 		while hopping in FHSS.
@@ -249,6 +392,129 @@ uint16_t RADIO_ReadRandom(void)
     return retVal;
 }
 
+/*********************************************************************//**
+\brief	This function returns a random number from an AES-128 counter
+		mode generator. The generator is reseeded with the RSSI samples
+		harvested during the LBT scans and the receive windows. Only the
+		first call blocks, to seed it with one RADIO_ReadRandom. The
+		harvest reseeds it after RADIO_ENTROPY_SEED_BITS bits, then
+		after every RADIO_ENTROPY_RESEED_BITS bits.
+
+\param		- none
+\return		- returns the random number generated.
+*************************************************************************/
+uint16_t RADIO_GetRandom(void)
+{
+    uint16_t retVal;
+    uint64_t now;
+    uint8_t i;
+
+    if (!rngSeeded)
+    {
+        // Cold start, RADIO_ReadRandom packs the LSBs of 16 samples
+        retVal = RADIO_ReadRandom();
+        for (i = 0; i < 16; i++)
+        {
+            Radio_HarvestEntropy((uint8_t)((retVal >> i) & 0x01));
+        }
+        // The time only makes the counter unique, it is not counted as entropy
+        now = SwTimerGetTime();
+        for (i = 0; i < sizeof(now); i++)
+        {
+            rngCounter[i] ^= (uint8_t)(now >> (i * 8));
+        }
+        Radio_RandomReseed();
+        rngSeeded = true;
+    }
+    else if (entropySamples >= rngReseedSamples)
+    {
+        Radio_RandomReseed();
+        rngReseedSamples = RADIO_ENTROPY_RESEED_BITS * RADIO_ENTROPY_SAMPLES_PER_BIT;
+    }
+
+    if (rngOutputIdx >= BLOCKSIZE)
+    {
+        Radio_RandomNextBlock(rngOutput);
+        // Move the key forward so that past outputs cannot be recovered
+        Radio_RandomNextBlock(rngKey);
+        rngOutputIdx = 0;
+    }
+
+    retVal = rngOutput[rngOutputIdx] | ((uint16_t)rngOutput[rngOutputIdx + 1] << SHIFT8);
+    rngOutputIdx += sizeof(retVal);
+
+    return retVal;
+}
+
+/*********************************************************************//**
+\brief This function adds a noisy radio measurement to the entropy pool
+		of the random generator. It must only be called while the receiver
+		samples the channel, it can be called from interrupt context.
+
+\param sample	- The raw register value, RADIO_ENTROPY_SAMPLES_PER_BIT
+				  LSBs are counted as one bit.
+\return			- none.
+*************************************************************************/
+void Radio_HarvestEntropy(uint8_t sample)
+{
+    uint8_t bitIdx;
+
+    cpu_irq_enter_critical();
+    // The LSB of sample n lands on bit n of the 128 bit pool
+    bitIdx = (uint8_t)entropySamples & 0x7F;
+    sample = (uint8_t)((sample << (bitIdx & 0x07)) | (sample >> (8 - (bitIdx & 0x07))));
+    entropyPool[bitIdx >> SHIFT3] ^= sample;
+    if (entropySamples < UINT16_MAX)
+    {
+        entropySamples++;
+    }
+    cpu_irq_leave_critical();
+}
+
+/*********************************************************************//**
+\brief	This function folds the entropy pool into the generator key.
+
+\param		- none
+\return		- none.
+*************************************************************************/
+static void Radio_RandomReseed(void)
+{
+    uint8_t block[BLOCKSIZE];
+    uint8_t i;
+
+    cpu_irq_enter_critical();
+    memcpy(block, entropyPool, BLOCKSIZE);
+    memset(entropyPool, 0, BLOCKSIZE);
+    entropySamples = 0;
+    cpu_irq_leave_critical();
+
+    // New key = AES(old key, pool) ^ old key
+    AESEncode(block, rngKey);
+    for (i = 0; i < BLOCKSIZE; i++)
+    {
+        rngKey[i] ^= block[i];
+    }
+    rngOutputIdx = BLOCKSIZE;
+}
+
+/*********************************************************************//**
+\brief	This function encrypts the next counter value with the generator
+		key into the given block.
+
+\param block	- The output block.
+\return			- none.
+*************************************************************************/
+static void Radio_RandomNextBlock(uint8_t *block)
+{
+    uint8_t i;
+
+    for (i = 0; (i < BLOCKSIZE) && (0 == ++rngCounter[i]); i++)
+        ;
+
+    memcpy(block, rngCounter, BLOCKSIZE);
+    AESEncode(block, rngKey);
+}
+
 /*********************************************************************//**
 \brief This function reads the RSSI value for LoRa.
 
@@ -257,20 +523,23 @@ uint16_t RADIO_ReadRandom(void)
 *************************************************************************/
 RadioError_t Radio_ReadLoraRssi(int16_t *rssi)
 {	
+	uint8_t rssiValue = RADIO_RegisterRead(REG_LORA_RSSIVALUE);
+
 	if (radioConfiguration.frequency >= HF_FREQ_HZ)
 	{
-		*rssi = RSSI_HF_OFFSET + RADIO_RegisterRead(REG_LORA_RSSIVALUE);		
+		*rssi = RSSI_HF_OFFSET + rssiValue;		
 	}
 	else
 	{
-		*rssi = RSSI_LF_OFFSET + RADIO_RegisterRead(REG_LORA_RSSIVALUE);
+		*rssi = RSSI_LF_OFFSET + rssiValue;
 	}
 
 	return ERR_NONE;
 }
 
 /*********************************************************************//**
-\brief This function reads the RSSI value for FSK.
+\brief This function reads the RSSI value for FSK. The LBT scans call it
+		with the receiver on, so the value is harvested as entropy.
 
 \param rssi	- The RSSI measured in the channel.
 \return		- ERR_NONE. Other types are not used now.
@@ -278,7 +547,10 @@ RadioError_t Radio_ReadLoraRssi(int16_t *rssi)
 RadioError_t Radio_ReadFSKRssi(int16_t *rssi)
 {	
 
-	*rssi = -(RADIO_RegisterRead(REG_FSK_RSSIVALUE) >> 1);
+	uint8_t rssiValue = RADIO_RegisterRead(REG_FSK_RSSIVALUE);
+
+	Radio_HarvestEntropy(rssiValue);
+	*rssi = -(rssiValue >> 1);
 	 return ERR_NONE;
 }
 /**
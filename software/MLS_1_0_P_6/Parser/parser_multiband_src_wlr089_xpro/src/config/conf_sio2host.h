@@ -38,9 +38,12 @@
 
 #ifndef CONF_SIO2HOST_H_INCLUDED
 #define CONF_SIO2HOST_H_INCLUDED
-/** Since MCPS.DATA.indication requires max no of bytes of around 150 bytes than
- *all other primitives,the Maximum Buffer size is kept as 156 bytes */
- #define SERIAL_RX_BUF_SIZE_HOST    128
+/** Receive buffer size, must be a power of two. It holds more than one
+ *  complete "mac tx" command line so long payloads are not dropped while the
+ *  previous command is being executed */
+#define SERIAL_RX_BUF_SIZE_HOST    1024
+/** Transmit buffer size, replies are queued here and sent by the DRE interrupt */
+#define SERIAL_TX_BUF_SIZE_HOST    1024
 
 #define USART_HOST                 EXT1_UART_MODULE
 #define HOST_SERCOM_MUX_SETTING    EXT1_UART_SERCOM_MUX_SETTING
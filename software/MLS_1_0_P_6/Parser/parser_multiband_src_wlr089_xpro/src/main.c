@@ -154,13 +154,20 @@ int main(void)
     {
 		parser_serial_data_handler();
 		SYSTEM_RunTasks();
+#ifdef CONF_PMM_ENABLE
+		/* Nothing left to do: wait for the next interrupt */
+		Parser_SystemIdle();
+#endif
     }
 }
 
 
 SYSTEM_TaskStatus_t APP_TaskHandler(void)
 {
-
+#if (RF_ONLY_MODE == 0)
+	/* Send the stack notifications recorded since the last run */
+	Parser_LoraEvtProcess();
+#endif
 	Parser_Main();	
 	return SYSTEM_TASK_SUCCESS;
 }
@@ -0,0 +1,189 @@
+/**
+* \file  bench_parser_cmd.c
+*
+* \brief Host benchmark of the command resolution for every command of the
+*        tables: binary search of Parser_FindCmd against the linear strcmp
+*        walk it replaced
+*
+*/
+
+#include "host_test.h"
+/* Built in, so that Parser_FindCmd can be reached */
+#include "parser.c"
+
+#define BENCH_ROUNDS        200U
+/* The figure of a command is the fastest of the passes, which keeps the host
+ * preemptions out of it */
+#define BENCH_PASSES        10U
+#define BENCH_MAX_CMDS      256U
+#define BENCH_MAX_DEPTH     4U
+
+typedef struct _BenchCmd
+{
+    char line[64];
+    uint64_t linearCycles;
+    uint64_t searchCycles;
+} BenchCmd_t;
+
+static BenchCmd_t benchCmds[BENCH_MAX_CMDS];
+static uint16_t benchCmdsNb;
+
+/* Linear walk with a copy of every entry, as the baseline Parser_ProcessCmd */
+static const parserCmdEntry_t* Bench_FindCmdLinear(const parserCmdEntry_t* pParserCmd, uint8_t nbParserCmd,
+                                                   const char* pWord, uint8_t* pCmdIdx)
+{
+    uint8_t cmdCtr;
+    parserCmdEntry_t parserCmdEntry;
+
+    for(cmdCtr = 0; cmdCtr < nbParserCmd; cmdCtr ++)
+    {
+        parserCmdEntry = *(pParserCmd + cmdCtr);
+        if(strcmp(parserCmdEntry.pCommand, pWord) == 0U)
+        {
+            *pCmdIdx = cmdCtr;
+            return &pParserCmd[cmdCtr];
+        }
+    }
+
+    return NULL;
+}
+
+typedef const parserCmdEntry_t* (*BenchFind_t)(const parserCmdEntry_t* pParserCmd, uint8_t nbParserCmd,
+                                               const char* pWord, uint8_t* pCmdIdx);
+
+/* Resolves the keywords of a tokenized line down to its handler entry */
+static const parserCmdEntry_t* Bench_Resolve(BenchFind_t find, const parserRxCmd_t* pRxCmd)
+{
+    const parserCmdEntry_t* pCmd = gpParserStartCmd;
+    const parserCmdEntry_t* pEntry = NULL;
+    uint8_t cmdSize = gParserStartCmdSize;
+    uint8_t wordIdx;
+    uint8_t cmdIdx;
+
+    for(wordIdx = 0; wordIdx <= pRxCmd->crtWordIdx; wordIdx ++)
+    {
+        pEntry = find(pCmd, cmdSize, &pRxCmd->cmd[pRxCmd->wordStartPos[wordIdx]], &cmdIdx);
+        if((pEntry == NULL) || (pEntry->pNextParserCmd == NULL))
+        {
+            break;
+        }
+        cmdSize = pEntry->nextParserCmdSize;
+        pCmd = pEntry->pNextParserCmd;
+    }
+
+    return pEntry;
+}
+
+static volatile uintptr_t benchSink;
+
+/* Cycles to resolve one line */
+static uint64_t Bench_Time(BenchFind_t find, const parserRxCmd_t* pRxCmd)
+{
+    uint64_t start;
+    uint64_t cycles;
+    uint64_t minCycles = UINT64_MAX;
+    uint32_t round;
+    uint8_t pass;
+
+    for(pass = 0; pass < BENCH_PASSES; pass ++)
+    {
+        start = HostTest_Cycles();
+        for(round = 0; round < BENCH_ROUNDS; round ++)
+        {
+            benchSink += (uintptr_t)Bench_Resolve(find, pRxCmd);
+        }
+        cycles = HostTest_Cycles() - start;
+        if(cycles < minCycles)
+        {
+            minCycles = cycles;
+        }
+    }
+
+    return minCycles / BENCH_ROUNDS;
+}
+
+/* Lists every command of the tree, with as many parameters as it takes */
+static void Bench_ListCmds(const parserCmdEntry_t* pCmd, uint8_t cmdSize, char* pPrefix, uint8_t depth)
+{
+    size_t prefixLen = strlen(pPrefix);
+    uint8_t idx;
+    uint8_t param;
+    BenchCmd_t* pBenchCmd;
+
+    for(idx = 0; idx < cmdSize; idx ++)
+    {
+        snprintf(&pPrefix[prefixLen], 64U - prefixLen, "%s%s", (prefixLen > 0U) ? " " : "", pCmd[idx].pCommand);
+        if((pCmd[idx].pNextParserCmd != NULL) && (depth < BENCH_MAX_DEPTH))
+        {
+            Bench_ListCmds(pCmd[idx].pNextParserCmd, pCmd[idx].nextParserCmdSize, pPrefix, depth + 1U);
+        }
+        else if(benchCmdsNb < BENCH_MAX_CMDS)
+        {
+            pBenchCmd = &benchCmds[benchCmdsNb ++];
+            strcpy(pBenchCmd->line, pPrefix);
+            for(param = 0; param < pCmd[idx].flags; param ++)
+            {
+                strcat(pBenchCmd->line, " 1");
+            }
+        }
+    }
+    pPrefix[prefixLen] = '\0';
+}
+
+int main(void)
+{
+    static parserRxCmd_t rxCmd;
+    static char prefix[64];
+    char line[68];
+    BenchCmd_t* pBenchCmd;
+    uint64_t linearTotal = 0U;
+    uint64_t searchTotal = 0U;
+    uint64_t linearMax = 0U;
+    uint64_t searchMax = 0U;
+    uint16_t idx;
+    bool ok = true;
+
+    Bench_ListCmds(gpParserStartCmd, gParserStartCmdSize, prefix, 0U);
+
+    for(idx = 0; idx < benchCmdsNb; idx ++)
+    {
+        pBenchCmd = &benchCmds[idx];
+
+        /* Tokenized by the receive path, as a line from the host */
+        Parser_RxClearBuffer();
+        snprintf(line, sizeof(line), "%s\r\n", pBenchCmd->line);
+        (void)Parser_RxAddChunk((const uint8_t*)line, (uint16_t)strlen(line));
+        ok &= (Parser_RxGetCmd() != NULL);
+        memcpy(&rxCmd, Parser_RxGetCmd(), sizeof(rxCmd));
+        ok &= (Bench_Resolve(Parser_FindCmd, &rxCmd) == Bench_Resolve(Bench_FindCmdLinear, &rxCmd));
+        ok &= (Bench_Resolve(Parser_FindCmd, &rxCmd)->pNextParserCmd == NULL);
+
+        pBenchCmd->linearCycles = Bench_Time(Bench_FindCmdLinear, &rxCmd);
+        pBenchCmd->searchCycles = Bench_Time(Parser_FindCmd, &rxCmd);
+
+        linearTotal += pBenchCmd->linearCycles;
+        searchTotal += pBenchCmd->searchCycles;
+        if(pBenchCmd->linearCycles > linearMax)
+        {
+            linearMax = pBenchCmd->linearCycles;
+        }
+        if(pBenchCmd->searchCycles > searchMax)
+        {
+            searchMax = pBenchCmd->searchCycles;
+        }
+    }
+
+    printf("%-40s %12s %12s\n", "command", "linear", "search");
+    for(idx = 0; idx < benchCmdsNb; idx ++)
+    {
+        printf("%-40s %12llu %12llu\n", benchCmds[idx].line,
+               (unsigned long long)benchCmds[idx].linearCycles, (unsigned long long)benchCmds[idx].searchCycles);
+    }
+    printf("%-40s %12.1f %12.1f\n", "mean per command",
+           (double)linearTotal / benchCmdsNb, (double)searchTotal / benchCmdsNb);
+    printf("%-40s %12llu %12llu\n", "worst command",
+           (unsigned long long)linearMax, (unsigned long long)searchMax);
+    printf("%u commands\n", benchCmdsNb);
+
+    return (ok && (benchCmdsNb > 0U) && (benchCmdsNb < BENCH_MAX_CMDS)) ? 0 : 1;
+}
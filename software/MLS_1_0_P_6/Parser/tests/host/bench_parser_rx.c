@@ -0,0 +1,279 @@
+/**
+* \file  bench_parser_rx.c
+*
+* \brief Host benchmark of the receive path: bytes per second tokenized by
+*        Parser_RxDrain and Parser_RxAddChunk against the per character
+*        Parser_RxAddChar fed by sio2host_getchar_nowait that they replaced
+*
+*/
+
+#include "host_test.h"
+/* Built in, so that Parser_RxDrain can be reached */
+#include "parser.c"
+
+#define BENCH_BURSTS        2000U
+/* The figure of a path is the fastest of the passes, which keeps the host
+ * preemptions out of it */
+#define BENCH_PASSES        5U
+#define BENCH_BURST_MAX     4000U
+
+/* Line state of the baseline receive path */
+typedef struct _BenchOldRxCmd
+{
+    char cmd[PARSER_DEF_CMD_MAX_LEN];
+    uint16_t wordLen[PARSER_DEF_CMD_MAX_IDX];
+    uint16_t wordStartPos[PARSER_DEF_CMD_MAX_IDX];
+    uint8_t bCmdStatus;
+    uint8_t crtWordIdx;
+    uint16_t crtCmdPos;
+    uint16_t crtWordPos;
+} BenchOldRxCmd_t;
+
+static volatile BenchOldRxCmd_t mOldRxCmd;
+static const char* gpOldLineDelim = {PARSER_END_LINE_DELIM_STRING};
+
+static uint8_t benchBurst[BENCH_BURST_MAX];
+static uint16_t benchBurstLen;
+static uint16_t benchBurstLines;
+
+static void Bench_OldRxClearBuffer(void)
+{
+    mOldRxCmd.bCmdStatus = 0;
+    mOldRxCmd.crtWordIdx = 0;
+    mOldRxCmd.crtCmdPos = 0;
+    mOldRxCmd.crtWordPos = 0;
+
+    memset((void*)mOldRxCmd.wordLen, 0, PARSER_DEF_CMD_MAX_IDX << 1);
+    memset((void*)mOldRxCmd.wordStartPos, 0, PARSER_DEF_CMD_MAX_IDX << 1);
+}
+
+/* The baseline Parser_RxAddChar */
+static void Bench_OldRxAddChar(uint8_t rxChar)
+{
+    uint8_t retStatus = STATUS_DONE;
+    bool bIsEndLine = false;
+    uint8_t iCount;
+
+    if(rxChar == '\b')
+    {
+        if(mOldRxCmd.crtCmdPos > 0U)
+        {
+            if(mOldRxCmd.cmd[mOldRxCmd.crtCmdPos - 1] == '\0')
+            {
+                mOldRxCmd.crtWordIdx --;
+                mOldRxCmd.crtWordPos = mOldRxCmd.wordLen[mOldRxCmd.crtWordIdx];
+                mOldRxCmd.wordLen[mOldRxCmd.crtWordIdx] = 0U;
+                mOldRxCmd.wordStartPos[mOldRxCmd.crtWordIdx] = 0U;
+            }
+            else
+            {
+                mOldRxCmd.crtWordPos --;
+            }
+
+            mOldRxCmd.crtCmdPos --;
+        }
+
+        return;
+    }
+
+    if(mOldRxCmd.crtCmdPos < PARSER_DEF_CMD_MAX_LEN - 1)
+    {
+        if(rxChar == ' ')
+        {
+            if(mOldRxCmd.crtWordIdx < PARSER_DEF_CMD_MAX_IDX - 1)
+            {
+                mOldRxCmd.cmd[mOldRxCmd.crtCmdPos ++] = '\0';
+                mOldRxCmd.wordLen[mOldRxCmd.crtWordIdx] = mOldRxCmd.crtWordPos;
+                mOldRxCmd.wordStartPos[mOldRxCmd.crtWordIdx] = mOldRxCmd.crtCmdPos - mOldRxCmd.crtWordPos - 1;
+                mOldRxCmd.crtWordIdx ++;
+                mOldRxCmd.crtWordPos = 0;
+            }
+            else
+            {
+                retStatus = STATUS_ERROR;
+            }
+        }
+        else
+        {
+            mOldRxCmd.cmd[mOldRxCmd.crtCmdPos ++] = rxChar;
+            mOldRxCmd.crtWordPos ++;
+
+            if(mOldRxCmd.crtCmdPos >= strlen(gpOldLineDelim))
+            {
+                bIsEndLine = true;
+
+                for(iCount = strlen(gpOldLineDelim); (iCount > 0U) && bIsEndLine; iCount --)
+                {
+                    if(mOldRxCmd.cmd[mOldRxCmd.crtCmdPos - iCount] != gpOldLineDelim[strlen(gpOldLineDelim) - iCount])
+                    {
+                        bIsEndLine = false;
+                    }
+                }
+            }
+            if(bIsEndLine)
+            {
+                mOldRxCmd.cmd[mOldRxCmd.crtCmdPos - strlen(gpOldLineDelim)] = '\0';
+                mOldRxCmd.wordLen[mOldRxCmd.crtWordIdx] = mOldRxCmd.crtWordPos - strlen(gpOldLineDelim);
+                mOldRxCmd.wordStartPos[mOldRxCmd.crtWordIdx] = mOldRxCmd.crtCmdPos - mOldRxCmd.crtWordPos;
+                mOldRxCmd.bCmdStatus = 1;
+            }
+        }
+    }
+    else
+    {
+        retStatus = STATUS_ERROR;
+    }
+
+    if(STATUS_ERROR == retStatus)
+    {
+        Bench_OldRxClearBuffer();
+        Parser_TxAddReply((char*)gapParserStatus[ERR_STATUS_IDX], strlen(gapParserStatus[ERR_STATUS_IDX]));
+    }
+}
+
+/* Lines of a host script, the uplink payload being the longest */
+static void Bench_BuildBurst(void)
+{
+    static const char* lines[] =
+    {
+        "mac get deveui\r\n",
+        "mac set devaddr 0123abcd\r\n",
+        "mac set ch freq 3 867100000\r\n",
+        "sys get ver\r\n",
+        "mac tx uncnf 1 ",
+        "radio set freq 868100000\r\n",
+    };
+    uint16_t lineLen;
+    uint8_t lineIdx = 0U;
+    uint16_t idx;
+
+    while(true)
+    {
+        lineLen = (uint16_t)strlen(lines[lineIdx]);
+        if(benchBurstLen + lineLen + 200U + 2U > BENCH_BURST_MAX)
+        {
+            break;
+        }
+        memcpy(&benchBurst[benchBurstLen], lines[lineIdx], lineLen);
+        benchBurstLen += lineLen;
+        if(benchBurst[benchBurstLen - 1U] == ' ')
+        {
+            for(idx = 0; idx < 200U; idx ++)
+            {
+                benchBurst[benchBurstLen ++] = (uint8_t)"0123456789abcdef"[HostTest_Rand() & 0x0FU];
+            }
+            benchBurst[benchBurstLen ++] = '\r';
+            benchBurst[benchBurstLen ++] = '\n';
+        }
+        benchBurstLines ++;
+        lineIdx = (uint8_t)((lineIdx + 1U) % (sizeof(lines) / sizeof(lines[0])));
+    }
+}
+
+static uint64_t Bench_Ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/* Baseline: one byte at a time, each line executed as soon as it is complete */
+static uint32_t Bench_OldBurst(void)
+{
+    uint32_t lines = 0U;
+    int rxChar;
+
+    while((-1) != (rxChar = sio2host_getchar_nowait()))
+    {
+        Bench_OldRxAddChar((uint8_t)rxChar);
+        if(mOldRxCmd.bCmdStatus)
+        {
+            lines ++;
+            Bench_OldRxClearBuffer();
+        }
+    }
+
+    return lines;
+}
+
+/* Current path: the buffered span in place, then the queued lines */
+static uint32_t Bench_NewBurst(void)
+{
+    uint32_t lines = 0U;
+    uint8_t* pRxData;
+
+    do
+    {
+        (void)Parser_RxDrain();
+        while(Parser_RxGetCmd() != NULL)
+        {
+            lines ++;
+            Parser_RxReleaseCmd();
+        }
+    } while(sio2host_rx_peek(&pRxData) > 0U);
+
+    return lines;
+}
+
+/* Bytes per second of the fastest pass, false if a line was lost */
+static bool Bench_Run(uint32_t (*burst)(void), double* pBytesPerSec, double* pCyclesPerByte)
+{
+    uint64_t startNs;
+    uint64_t startCycles;
+    uint64_t ns;
+    uint64_t cycles;
+    uint64_t minNs = UINT64_MAX;
+    uint64_t minCycles = UINT64_MAX;
+    uint32_t round;
+    uint8_t pass;
+    bool ok = true;
+
+    for(pass = 0; pass < BENCH_PASSES; pass ++)
+    {
+        ns = 0U;
+        cycles = 0U;
+        for(round = 0; round < BENCH_BURSTS; round ++)
+        {
+            ok &= FakeSio2host_Push(benchBurst, benchBurstLen);
+            startNs = Bench_Ns();
+            startCycles = HostTest_Cycles();
+            ok &= (burst() == benchBurstLines);
+            cycles += HostTest_Cycles() - startCycles;
+            ns += Bench_Ns() - startNs;
+        }
+        if(ns < minNs)
+        {
+            minNs = ns;
+            minCycles = cycles;
+        }
+    }
+
+    *pBytesPerSec = (double)benchBurstLen * BENCH_BURSTS * 1e9 / (double)minNs;
+    *pCyclesPerByte = (double)minCycles / ((double)benchBurstLen * BENCH_BURSTS);
+
+    return ok;
+}
+
+int main(void)
+{
+    double oldBytesPerSec;
+    double oldCyclesPerByte;
+    double newBytesPerSec;
+    double newCyclesPerByte;
+    bool ok = true;
+
+    Bench_BuildBurst();
+    Bench_OldRxClearBuffer();
+    Parser_RxClearBuffer();
+
+    ok &= Bench_Run(Bench_OldBurst, &oldBytesPerSec, &oldCyclesPerByte);
+    ok &= Bench_Run(Bench_NewBurst, &newBytesPerSec, &newCyclesPerByte);
+
+    printf("%u lines, %u bytes per burst\n", benchBurstLines, benchBurstLen);
+    printf("%-24s %16s %16s\n", "path", "bytes/s", "cycles/byte");
+    printf("%-24s %16.0f %16.2f\n", "per character", oldBytesPerSec, oldCyclesPerByte);
+    printf("%-24s %16.0f %16.2f\n", "chunk", newBytesPerSec, newCyclesPerByte);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+/**
+* \file  bench_parser_utils.c
+*
+* \brief Host benchmark of Parser_HexAsciiDecode, the decoder of the mac tx payload and keys
+*
+*/
+
+#include <string.h>
+#include "host_test.h"
+#include "parser_utils.h"
+
+#define BENCH_ROUNDS        20000U
+
+/* Character by character decoder with range checks, as the baseline */
+static bool Bench_NaiveDecode(const char* pIn, uint16_t len, uint8_t* pOut)
+{
+    uint16_t idx;
+    uint8_t value = 0U;
+
+    for(idx = 0; idx < len; idx ++)
+    {
+        char c = pIn[idx];
+        uint8_t nibble;
+
+        if((c >= '0') && (c <= '9'))
+        {
+            nibble = (uint8_t)(c - '0');
+        }
+        else if((c >= 'a') && (c <= 'f'))
+        {
+            nibble = (uint8_t)(c - 'a' + 10);
+        }
+        else if((c >= 'A') && (c <= 'F'))
+        {
+            nibble = (uint8_t)(c - 'A' + 10);
+        }
+        else
+        {
+            return false;
+        }
+        value = (uint8_t)((value << 4) | nibble);
+        if(((len - idx) & 1U) == 1U)
+        {
+            *pOut ++ = value;
+            value = 0U;
+        }
+    }
+
+    return true;
+}
+
+int main(void)
+{
+    static const uint16_t lengths[] = {16U, 32U, 64U, 242U * 2U};
+    static char hex[242U * 2U + 1U];
+    static uint8_t out[242U];
+    volatile bool sink = true;
+    uint64_t start;
+    uint64_t lutCycles;
+    uint64_t naiveCycles;
+    uint32_t round;
+    uint8_t lenIdx;
+    uint16_t idx;
+
+    for(idx = 0; idx < sizeof(hex) - 1U; idx ++)
+    {
+        hex[idx] = "0123456789abcdef"[HostTest_Rand() & 0x0FU];
+    }
+
+    printf("%8s %16s %16s\n", "chars", "table/char", "naive/char");
+    for(lenIdx = 0; lenIdx < sizeof(lengths) / sizeof(lengths[0]); lenIdx ++)
+    {
+        start = HostTest_Cycles();
+        for(round = 0; round < BENCH_ROUNDS; round ++)
+        {
+            sink &= Parser_HexAsciiDecode(hex, lengths[lenIdx], out);
+        }
+        lutCycles = HostTest_Cycles() - start;
+
+        start = HostTest_Cycles();
+        for(round = 0; round < BENCH_ROUNDS; round ++)
+        {
+            sink &= Bench_NaiveDecode(hex, lengths[lenIdx], out);
+        }
+        naiveCycles = HostTest_Cycles() - start;
+
+        printf("%8u %16.2f %16.2f\n", lengths[lenIdx],
+               (double)lutCycles / ((double)BENCH_ROUNDS * lengths[lenIdx]),
+               (double)naiveCycles / ((double)BENCH_ROUNDS * lengths[lenIdx]));
+    }
+
+    return sink ? 0 : 1;
+}
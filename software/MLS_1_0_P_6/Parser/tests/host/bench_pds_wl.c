@@ -0,0 +1,56 @@
+/**
+* \file  bench_pds_wl.c
+*
+* \brief Host benchmark of the PDS wear leveling init against the number of
+*        rows holding a file copy, with the bytes read from the flash
+*
+*/
+
+#include "host_test.h"
+#include "nvm.h"
+#include "pds_interface.h"
+#include "pds_common.h"
+#include "pds_wl.h"
+
+#define BENCH_ROUNDS        2000U
+
+int main(void)
+{
+    static PdsMem_t buffer;
+    uint64_t start;
+    uint64_t initCycles;
+    uint32_t bytesRead;
+    uint32_t round;
+    uint8_t filled;
+    uint8_t idx;
+    bool ok = true;
+
+    printf("%8s %16s %16s\n", "rows", "init", "bytes read");
+    for(filled = 0; filled <= PDS_WL_NUM_ROWS; filled ++)
+    {
+        /* From an empty flash each write takes the next row, the older
+         * copies stay as stale rows */
+        FakeNvm_EraseAll();
+        ok &= (pdsWlInit() == PDS_OK);
+        memset(&buffer, 0, sizeof(buffer));
+        for(idx = 0; idx < filled; idx ++)
+        {
+            memset(buffer.NVM_Struct.pdsNvmData.WL_Struct.pdsWlData, idx, 200U);
+            ok &= (pdsWlWrite((PdsFileItemIdx_t)(idx % 4U), &buffer, 200U) == PDS_OK);
+        }
+
+        initCycles = 0U;
+        FakeNvm_ResetStats();
+        for(round = 0; round < BENCH_ROUNDS; round ++)
+        {
+            start = HostTest_Cycles();
+            ok &= (pdsWlInit() == PDS_OK);
+            initCycles += HostTest_Cycles() - start;
+        }
+        bytesRead = FakeNvm_BytesRead() / BENCH_ROUNDS;
+
+        printf("%8u %16.1f %16u\n", filled, (double)initCycles / BENCH_ROUNDS, bytesRead);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+/**
+* \file  bench_sw_timer.c
+*
+* \brief Host benchmark of SwTimerStart and SwTimerStop against the number of
+*        running timers, and of the longest interrupt masked section
+*
+*/
+
+#include "host_test.h"
+#include "sys.h"
+#include "sw_timer.h"
+#include "conf_sw_timer.h"
+
+#define BENCH_ROUNDS        20000U
+/* The masked time is the smallest of the maxima of the passes, which keeps
+ * the host preemptions out of the figure */
+#define BENCH_PASSES        100U
+/* Every window overlaps the others, so the wake time search visits the
+ * whole heap: the worst case of the masked sections */
+#define BENCH_SLACK         2000000U
+
+static void Bench_Callback(void* param)
+{
+    (void)param;
+}
+
+int main(void)
+{
+    uint8_t timerIds[TOTAL_NUMBER_OF_SW_TIMERS];
+    uint64_t start;
+    uint64_t startCycles;
+    uint64_t stopCycles;
+    uint64_t irqOffCycles;
+    uint32_t round;
+    uint8_t running;
+    uint8_t idx;
+    bool ok = true;
+
+    SystemTimerInit();
+    for(idx = 0; idx < TOTAL_NUMBER_OF_SW_TIMERS; idx ++)
+    {
+        ok &= (SwTimerCreate(&timerIds[idx]) == LORAWAN_SUCCESS);
+    }
+
+    printf("%8s %16s %16s %16s\n", "running", "start", "stop", "irq off max");
+    for(running = 0; running < TOTAL_NUMBER_OF_SW_TIMERS; running ++)
+    {
+        /* The timer under test goes in among the running ones, at a random place */
+        if(running > 0U)
+        {
+            ok &= (SwTimerStartWithSlack(timerIds[running - 1U], 1000000U + (HostTest_Rand() % 1000000U),
+                    SW_TIMEOUT_RELATIVE, BENCH_SLACK, Bench_Callback, NULL) == LORAWAN_SUCCESS);
+        }
+
+        startCycles = 0U;
+        stopCycles = 0U;
+        irqOffCycles = UINT64_MAX;
+        for(round = 0; round < BENCH_ROUNDS; round ++)
+        {
+            uint32_t timeout = 1000000U + (HostTest_Rand() % 1000000U);
+
+            if((round % (BENCH_ROUNDS / BENCH_PASSES)) == 0U)
+            {
+                if((round > 0U) && (FakeIrq_MaxMaskedCycles() < irqOffCycles))
+                {
+                    irqOffCycles = FakeIrq_MaxMaskedCycles();
+                }
+                FakeIrq_ResetStats();
+            }
+
+            start = HostTest_Cycles();
+            ok &= (SwTimerStartWithSlack(timerIds[TOTAL_NUMBER_OF_SW_TIMERS - 1U], timeout,
+                    SW_TIMEOUT_RELATIVE, BENCH_SLACK, Bench_Callback, NULL) == LORAWAN_SUCCESS);
+            startCycles += HostTest_Cycles() - start;
+
+            start = HostTest_Cycles();
+            ok &= (SwTimerStop(timerIds[TOTAL_NUMBER_OF_SW_TIMERS - 1U]) == LORAWAN_SUCCESS);
+            stopCycles += HostTest_Cycles() - start;
+        }
+
+        printf("%8u %16.1f %16.1f %16llu\n", running + 1U,
+               (double)startCycles / BENCH_ROUNDS, (double)stopCycles / BENCH_ROUNDS,
+               (unsigned long long)irqOffCycles);
+    }
+
+    return ok ? 0 : 1;
+}
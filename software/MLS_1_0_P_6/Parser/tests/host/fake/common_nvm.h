@@ -0,0 +1,23 @@
+/**
+* \file  common_nvm.h
+*
+* \brief Host replacement of the common NVM service, over the RAM flash of
+*        nvm.h
+*
+*/
+
+#ifndef COMMON_NVM_H_INCLUDED
+#define COMMON_NVM_H_INCLUDED
+
+#include "compiler.h"
+#include "status_codes.h"
+
+typedef enum
+{
+	INT_FLASH
+} mem_type_t;
+
+status_code_t nvm_init(mem_type_t mem);
+status_code_t nvm_read(mem_type_t mem, uint32_t address, void *buffer, uint32_t len);
+
+#endif /* COMMON_NVM_H_INCLUDED */
@@ -0,0 +1,22 @@
+/**
+* \file  compiler.h
+*
+* \brief Host replacement of the ASF compiler abstraction, only what the PDS
+*        headers use
+*
+*/
+
+#ifndef UTILS_COMPILER_H_INCLUDED
+#define UTILS_COMPILER_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "io.h"
+
+#define COMPILER_PRAGMA(arg)            _Pragma(#arg)
+#define COMPILER_PACK_SET(alignment)    COMPILER_PRAGMA(pack(alignment))
+#define COMPILER_PACK_RESET()           COMPILER_PRAGMA(pack())
+
+#endif /* UTILS_COMPILER_H_INCLUDED */
@@ -0,0 +1,15 @@
+/**
+* \file  conf_hw_timer.h
+*
+* \brief Host configuration of the software timer time base
+*
+*/
+
+#ifndef CONF_HW_TIMER_H_INCLUDED
+#define CONF_HW_TIMER_H_INCLUDED
+
+#define TIMER                      (NULL)
+#define SWTIMER_GCLK_GENERATOR     0
+#define SWTIMER_TC_PRESCALER       0
+
+#endif /* CONF_HW_TIMER_H_INCLUDED */
@@ -0,0 +1,11 @@
+/**
+* \file  conf_nvm.h
+*
+* \brief Host replacement of the NVM service configuration, nothing to set
+*
+*/
+
+#ifndef CONF_NVM_H_INCLUDED
+#define CONF_NVM_H_INCLUDED
+
+#endif /* CONF_NVM_H_INCLUDED */
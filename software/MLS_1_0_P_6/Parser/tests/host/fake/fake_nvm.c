@@ -0,0 +1,189 @@
+/**
+* \file  fake_nvm.c
+*
+* \brief RAM RWW EEPROM behind the NVM driver calls of pds_nvm.c
+*
+*/
+
+#include <string.h>
+#include "nvm.h"
+#include "common_nvm.h"
+
+/* Polls of nvm_is_ready a command keeps the controller busy for */
+#define FAKE_NVM_BUSY_POLLS     2U
+
+Nvmctrl fakeNvmctrl;
+
+static uint8_t mMemory[NVMCTRL_RWW_EEPROM_SIZE];
+static uint8_t mBusyPolls;
+static int16_t mFailIn = -1;
+static uint8_t mFailCount;
+static bool mFailReported;
+static uint32_t mBytesRead;
+
+/* Returns true if the command is to fail */
+static bool FakeNvm_StartCommand(void)
+{
+    bool fail = (mFailIn == 0);
+
+    if(mFailIn > 0)
+    {
+        mFailIn --;
+    }
+    else if(fail && (-- mFailCount == 0U))
+    {
+        mFailIn = -1;
+    }
+    fakeNvmctrl.STATUS.reg = (fail && mFailReported) ? NVMCTRL_STATUS_PROGE : 0U;
+    mBusyPolls = FAKE_NVM_BUSY_POLLS;
+    return fail;
+}
+
+static bool FakeNvm_IsRwweeAddress(uint32_t address, uint32_t length)
+{
+    return (address >= NVMCTRL_RWW_EEPROM_ADDR) &&
+           ((address + length) <= (NVMCTRL_RWW_EEPROM_ADDR + NVMCTRL_RWW_EEPROM_SIZE));
+}
+
+static void FakeNvm_EraseRow(uint32_t address)
+{
+    memset(&mMemory[address - NVMCTRL_RWW_EEPROM_ADDR], 0xFF, NVMCTRL_ROW_SIZE);
+}
+
+status_code_t nvm_init(mem_type_t mem)
+{
+    (void)mem;
+    return STATUS_OK;
+}
+
+status_code_t nvm_read(mem_type_t mem, uint32_t address, void *buffer, uint32_t len)
+{
+    (void)mem;
+    if(!FakeNvm_IsRwweeAddress(address, len))
+    {
+        return ERR_INVALID_ARG;
+    }
+    while(!nvm_is_ready())
+    {
+    }
+    memcpy(buffer, &mMemory[address - NVMCTRL_RWW_EEPROM_ADDR], len);
+    mBytesRead += len;
+    return STATUS_OK;
+}
+
+void nvm_get_parameters(struct nvm_parameters *const parameters)
+{
+    parameters->page_size = NVMCTRL_PAGE_SIZE;
+    parameters->nvm_number_of_pages = 4096U;
+    parameters->rww_eeprom_number_of_pages = NVMCTRL_RWW_EEPROM_SIZE / NVMCTRL_PAGE_SIZE;
+}
+
+bool nvm_is_ready(void)
+{
+    uint32_t address;
+
+    /* A command issued through the registers runs now */
+    if(fakeNvmctrl.CTRLA.reg == (NVM_COMMAND_RWWEE_ERASE_ROW | NVMCTRL_CTRLA_CMDEX_KEY))
+    {
+        fakeNvmctrl.CTRLA.reg = 0U;
+        address = fakeNvmctrl.ADDR.reg * 2U;
+        if(!FakeNvm_StartCommand() && FakeNvm_IsRwweeAddress(address, NVMCTRL_ROW_SIZE) &&
+            ((address % NVMCTRL_ROW_SIZE) == 0U))
+        {
+            FakeNvm_EraseRow(address);
+        }
+    }
+    if(mBusyPolls > 0U)
+    {
+        mBusyPolls--;
+        return false;
+    }
+    return true;
+}
+
+enum status_code nvm_write_buffer(const uint32_t destination_address,
+        const uint8_t *buffer, uint16_t length)
+{
+    uint8_t *pDest;
+
+    if(!FakeNvm_IsRwweeAddress(destination_address, length) ||
+        ((destination_address % NVMCTRL_PAGE_SIZE) != 0U))
+    {
+        return STATUS_ERR_BAD_ADDRESS;
+    }
+    if(length > NVMCTRL_PAGE_SIZE)
+    {
+        return STATUS_ERR_INVALID_ARG;
+    }
+    if(!nvm_is_ready())
+    {
+        return STATUS_BUSY;
+    }
+    if(!FakeNvm_StartCommand())
+    {
+        /* Programming only clears bits */
+        pDest = &mMemory[destination_address - NVMCTRL_RWW_EEPROM_ADDR];
+        for(uint16_t idx = 0; idx < length; idx ++)
+        {
+            pDest[idx] &= buffer[idx];
+        }
+    }
+    return STATUS_OK;
+}
+
+enum status_code nvm_erase_row(const uint32_t row_address)
+{
+    if(!FakeNvm_IsRwweeAddress(row_address, NVMCTRL_ROW_SIZE) ||
+        ((row_address % NVMCTRL_ROW_SIZE) != 0U))
+    {
+        return STATUS_ERR_BAD_ADDRESS;
+    }
+    if(!nvm_is_ready())
+    {
+        return STATUS_BUSY;
+    }
+    /* The driver waits for the erase */
+    if(FakeNvm_StartCommand())
+    {
+        mBusyPolls = 0U;
+        return mFailReported ? STATUS_ABORTED : STATUS_OK;
+    }
+    FakeNvm_EraseRow(row_address);
+    mBusyPolls = 0U;
+    return STATUS_OK;
+}
+
+void FakeNvm_EraseAll(void)
+{
+    memset(mMemory, 0xFF, sizeof(mMemory));
+    memset(&fakeNvmctrl, 0, sizeof(fakeNvmctrl));
+    mBusyPolls = 0U;
+    mFailIn = -1;
+}
+
+uint8_t *FakeNvm_Row(uint16_t row)
+{
+    return &mMemory[(uint32_t)row * NVMCTRL_ROW_SIZE];
+}
+
+void FakeNvm_FailCommand(uint8_t skip, bool reportError)
+{
+    FakeNvm_FailCommands(skip, 1U, reportError);
+}
+
+void FakeNvm_FailCommands(uint8_t skip, uint8_t count, bool reportError)
+{
+    mFailIn = skip;
+    mFailCount = count;
+    mFailReported = reportError;
+}
+
+void FakeNvm_ResetStats(void)
+{
+    mBytesRead = 0U;
+}
+
+uint32_t FakeNvm_BytesRead(void)
+{
+    return mBytesRead;
+}
@@ -0,0 +1,110 @@
+/**
+* \file  fake_sio2host.c
+*
+* \brief Host UART for the parser: a linear receive buffer and a count of
+*        the transmitted bytes
+*
+*/
+
+#include <string.h>
+#include "sio2host.h"
+
+#define FAKE_SIO2HOST_RX_SIZE   4096U
+
+static uint8_t mRxBuf[FAKE_SIO2HOST_RX_SIZE];
+static uint16_t mRxHead;
+static uint16_t mRxTail;
+static uint32_t mTxBytes;
+/* Position of the byte that follows a silence, if mRxGap */
+static uint16_t mRxGapPos;
+static bool mRxGap;
+
+uint8_t sio2host_tx(uint8_t *data, uint8_t length)
+{
+    (void)data;
+    mTxBytes += length;
+    return length;
+}
+
+uint16_t sio2host_rx_peek(uint8_t **data)
+{
+    *data = &mRxBuf[mRxHead];
+    if(mRxGap && (mRxGapPos > mRxHead))
+    {
+        return mRxGapPos - mRxHead;
+    }
+    return mRxTail - mRxHead;
+}
+
+void sio2host_rx_release(uint16_t length)
+{
+    mRxHead += length;
+    if(mRxHead == mRxTail)
+    {
+        mRxHead = 0U;
+        mRxTail = 0U;
+        mRxGapPos = 0U;
+    }
+}
+
+bool sio2host_rx_burst_ended(void)
+{
+    return (mRxTail != mRxHead);
+}
+
+void sio2host_rx_wake_every_byte(bool enable)
+{
+    (void)enable;
+}
+
+void sio2host_rx_mark_gaps(sio2host_clock_t clock, uint32_t gap_us)
+{
+    (void)clock;
+    (void)gap_us;
+    mRxGap = false;
+}
+
+bool sio2host_rx_gap(void)
+{
+    if(!mRxGap || (mRxGapPos != mRxHead))
+    {
+        return false;
+    }
+    mRxGap = false;
+    return true;
+}
+
+int sio2host_getchar_nowait(void)
+{
+    int rxChar;
+
+    if(mRxHead == mRxTail)
+    {
+        return -1;
+    }
+    rxChar = mRxBuf[mRxHead];
+    sio2host_rx_release(1U);
+    return rxChar;
+}
+
+bool FakeSio2host_Push(const uint8_t *data, uint16_t length)
+{
+    if(length > FAKE_SIO2HOST_RX_SIZE - mRxTail)
+    {
+        return false;
+    }
+    memcpy(&mRxBuf[mRxTail], data, length);
+    mRxTail += length;
+    return true;
+}
+
+void FakeSio2host_Gap(void)
+{
+    mRxGapPos = mRxTail;
+    mRxGap = true;
+}
+
+uint32_t FakeSio2host_TxBytes(void)
+{
+    return mTxBytes;
+}
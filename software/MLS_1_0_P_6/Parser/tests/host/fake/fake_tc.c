@@ -0,0 +1,264 @@
+/**
+* \file  fake_tc.c
+*
+* \brief Host time base for sw_timer.c: TC counter, interrupt masking and
+*        task posting
+*
+*/
+
+#include <string.h>
+#include "host_test.h"
+#include "sys.h"
+#include "tc.h"
+#include "system_task_manager.h"
+
+static struct tc_module* mpModule;
+static uint32_t mCount;
+static uint32_t mCompare;
+static uint32_t mStatus;
+static bool mEnabled;
+static bool mMasked;
+static bool mTimerTaskPosted;
+
+static uint8_t mIrqDepth;
+static uint64_t mIrqMaskedStart;
+static uint64_t mIrqMaskedMax;
+
+/* Interrupt masking */
+
+irqflags_t cpu_irq_save(void)
+{
+    if(mIrqDepth ++ == 0U)
+    {
+        mIrqMaskedStart = HostTest_Cycles();
+    }
+    return 0U;
+}
+
+void cpu_irq_restore(irqflags_t flags)
+{
+    uint64_t masked;
+
+    (void)flags;
+    if(-- mIrqDepth == 0U)
+    {
+        masked = HostTest_Cycles() - mIrqMaskedStart;
+        if(masked > mIrqMaskedMax)
+        {
+            mIrqMaskedMax = masked;
+        }
+    }
+}
+
+void system_enter_critical_section(void)
+{
+    (void)cpu_irq_save();
+}
+
+void system_leave_critical_section(void)
+{
+    cpu_irq_restore(0U);
+}
+
+uint64_t FakeIrq_MaxMaskedCycles(void)
+{
+    return mIrqMaskedMax;
+}
+
+void FakeIrq_ResetStats(void)
+{
+    mIrqMaskedMax = 0U;
+}
+
+bool FakeIrq_IsMasked(void)
+{
+    return (mIrqDepth != 0U);
+}
+
+/* Task manager */
+
+void SYSTEM_PostTask(SYSTEM_Task_t task)
+{
+    if(task == TIMER_TASK_ID)
+    {
+        mTimerTaskPosted = true;
+    }
+}
+
+bool FakeTask_TakeTimerPost(void)
+{
+    bool posted = mTimerTaskPosted;
+
+    mTimerTaskPosted = false;
+    return posted;
+}
+
+/* TC driver */
+
+void tc_get_config_defaults(struct tc_config *const config)
+{
+    memset(config, 0, sizeof(*config));
+}
+
+int tc_init(struct tc_module *const module, void *hw, const struct tc_config *const config)
+{
+    (void)hw;
+    memset(module, 0, sizeof(*module));
+    mpModule = module;
+    mCount = config->counter_32_bit.value;
+    mStatus = 0U;
+    mEnabled = false;
+    return 0;
+}
+
+int tc_register_callback(struct tc_module *const module, tc_callback_t callback_func,
+        enum tc_callback callback_type)
+{
+    module->callback[callback_type] = callback_func;
+    return 0;
+}
+
+void tc_enable_callback(struct tc_module *const module, enum tc_callback callback_type)
+{
+    module->callbackEnabled[callback_type] = true;
+}
+
+void tc_disable_callback(struct tc_module *const module, enum tc_callback callback_type)
+{
+    module->callbackEnabled[callback_type] = false;
+}
+
+void tc_enable(struct tc_module *const module)
+{
+    (void)module;
+    mEnabled = true;
+}
+
+void tc_disable(struct tc_module *const module)
+{
+    (void)module;
+    mEnabled = false;
+}
+
+int tc_set_compare_value(struct tc_module *const module,
+        enum tc_compare_capture_channel channel_index, uint32_t compare_value)
+{
+    (void)module;
+    (void)channel_index;
+    mCompare = compare_value;
+    return 0;
+}
+
+void tc_clear_status(struct tc_module *const module, uint32_t status_flags)
+{
+    (void)module;
+    mStatus &= ~status_flags;
+}
+
+uint32_t tc_get_count_value(struct tc_module *const module)
+{
+    (void)module;
+    return mCount;
+}
+
+uint32_t tc_get_status(struct tc_module *const module)
+{
+    (void)module;
+    return mStatus;
+}
+
+/* Test control */
+
+void FakeTc_SetCount(uint32_t count)
+{
+    mCount = count;
+}
+
+uint32_t FakeTc_GetCount(void)
+{
+    return mCount;
+}
+
+void FakeTc_MaskInterrupts(bool masked)
+{
+    mMasked = masked;
+}
+
+bool FakeTc_CompareArmed(uint32_t *compareValue)
+{
+    *compareValue = mCompare;
+    return (mpModule != NULL) && mpModule->callbackEnabled[TC_CALLBACK_CC_CHANNEL0];
+}
+
+void FakeTc_DeliverPending(void)
+{
+    if(mStatus & TC_STATUS_COUNT_OVERFLOW)
+    {
+        mStatus &= ~TC_STATUS_COUNT_OVERFLOW;
+        if(mpModule->callbackEnabled[TC_CALLBACK_OVERFLOW])
+        {
+            mpModule->callback[TC_CALLBACK_OVERFLOW](mpModule);
+        }
+    }
+    if((mStatus & TC_STATUS_CHANNEL_0_MATCH) && mpModule->callbackEnabled[TC_CALLBACK_CC_CHANNEL0])
+    {
+        mStatus &= ~TC_STATUS_CHANNEL_0_MATCH;
+        mpModule->callback[TC_CALLBACK_CC_CHANNEL0](mpModule);
+    }
+}
+
+/* Stops on every compare match and counter wrap, so that the interrupts
+ * are raised at the exact count */
+void FakeTc_Advance(uint64_t us)
+{
+    uint64_t step;
+    uint64_t toCompare = 0U;
+    uint64_t toWrap;
+    bool compareEvt;
+    bool wrapEvt;
+
+    while(mEnabled && (us > 0U))
+    {
+        step = us;
+        compareEvt = false;
+        wrapEvt = false;
+
+        if(mpModule->callbackEnabled[TC_CALLBACK_CC_CHANNEL0] && !(mStatus & TC_STATUS_CHANNEL_0_MATCH))
+        {
+            toCompare = (uint32_t)(mCompare - mCount);
+            if(toCompare == 0U)
+            {
+                toCompare = 1ULL << 32;
+            }
+            if(toCompare <= step)
+            {
+                step = toCompare;
+                compareEvt = true;
+            }
+        }
+
+        toWrap = (1ULL << 32) - mCount;
+        if(toWrap <= step)
+        {
+            step = toWrap;
+            wrapEvt = true;
+            compareEvt = compareEvt && (toCompare == toWrap);
+        }
+
+        mCount += (uint32_t)step;
+        us -= step;
+
+        if(wrapEvt)
+        {
+            mStatus |= TC_STATUS_COUNT_OVERFLOW;
+        }
+        if(compareEvt)
+        {
+            mStatus |= TC_STATUS_CHANNEL_0_MATCH;
+        }
+        if(!mMasked)
+        {
+            FakeTc_DeliverPending();
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/**
+* \file  io.h
+*
+* \brief Host replacement of the device header: the NVMCTRL sizes and the
+*        registers pds_nvm.c drives directly, backed by fake_nvm.c
+*
+*/
+
+#ifndef _IO_H_INCLUDED
+#define _IO_H_INCLUDED
+
+#include <stdint.h>
+
+#define NVMCTRL_PAGE_SIZE               64
+#define NVMCTRL_ROW_PAGES               4
+#define NVMCTRL_ROW_SIZE                (NVMCTRL_PAGE_SIZE * NVMCTRL_ROW_PAGES)
+#define NVMCTRL_RWW_EEPROM_ADDR         0x00400000UL
+#define NVMCTRL_RWW_EEPROM_SIZE         8192U
+
+#define NVMCTRL_STATUS_PROGE            (1U << 2)
+#define NVMCTRL_STATUS_LOCKE            (1U << 3)
+#define NVMCTRL_STATUS_NVME             (1U << 4)
+#define NVMCTRL_STATUS_MASK             0x011FU
+#define NVM_ERRORS_MASK                 (NVMCTRL_STATUS_PROGE | NVMCTRL_STATUS_LOCKE | NVMCTRL_STATUS_NVME)
+#define NVMCTRL_CTRLA_CMDEX_KEY         (0xA5U << 8)
+
+typedef struct
+{
+	struct
+	{
+		volatile uint16_t reg;
+	} CTRLA;
+	union
+	{
+		struct
+		{
+			volatile uint32_t CACHEDIS:1;
+		} bit;
+		volatile uint32_t reg;
+	} CTRLB;
+	struct
+	{
+		volatile uint16_t reg;
+	} STATUS;
+	struct
+	{
+		volatile uint32_t reg;
+	} ADDR;
+} Nvmctrl;
+
+extern Nvmctrl fakeNvmctrl;
+#define NVMCTRL                         (&fakeNvmctrl)
+
+#endif /* _IO_H_INCLUDED */
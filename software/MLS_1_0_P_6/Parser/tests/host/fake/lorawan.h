@@ -0,0 +1,15 @@
+/**
+* \file  lorawan.h
+*
+* \brief Host replacement of the LoRaWAN stack API header: the parser command
+*        tables only need the handler prototypes of parser_lorawan.h
+*
+*/
+
+#ifndef _LORAWAN_H_
+#define _LORAWAN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#endif /* _LORAWAN_H_ */
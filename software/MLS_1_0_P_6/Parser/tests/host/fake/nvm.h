@@ -0,0 +1,47 @@
+/**
+* \file  nvm.h
+*
+* \brief Host replacement of the SAM0 NVM driver: the RWW EEPROM section is
+*        kept in RAM, programming only clears bits and every command keeps
+*        the controller busy for a few polls
+*
+*/
+
+#ifndef NVM_H_INCLUDED
+#define NVM_H_INCLUDED
+
+#include "compiler.h"
+#include "status_codes.h"
+
+enum nvm_command
+{
+	NVM_COMMAND_RWWEE_ERASE_ROW = 0x1A
+};
+
+struct nvm_parameters
+{
+	uint8_t page_size;
+	uint16_t nvm_number_of_pages;
+	uint16_t rww_eeprom_number_of_pages;
+};
+
+void nvm_get_parameters(struct nvm_parameters *const parameters);
+bool nvm_is_ready(void);
+enum status_code nvm_write_buffer(const uint32_t destination_address,
+		const uint8_t *buffer, uint16_t length);
+enum status_code nvm_erase_row(const uint32_t row_address);
+
+/*
+ * Test control. FakeNvm_FailCommand makes the command after the next skip
+ * ones leave the memory as it is; the programming error status is set only
+ * if reportError, otherwise the failure shows on the read back.
+ * FakeNvm_FailCommands fails count commands in a row.
+ */
+void FakeNvm_EraseAll(void);
+uint8_t *FakeNvm_Row(uint16_t row);
+void FakeNvm_FailCommand(uint8_t skip, bool reportError);
+void FakeNvm_FailCommands(uint8_t skip, uint8_t count, bool reportError);
+void FakeNvm_ResetStats(void);
+uint32_t FakeNvm_BytesRead(void);
+
+#endif /* NVM_H_INCLUDED */
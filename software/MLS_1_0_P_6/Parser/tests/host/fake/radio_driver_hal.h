@@ -0,0 +1,15 @@
+/**
+* \file  radio_driver_hal.h
+*
+* \brief Host replacement of the radio HAL header, which parser_system.h
+*        includes for the radio SPI statistics only
+*
+*/
+
+#ifndef RADIO_DRIVER_HAL_H
+#define RADIO_DRIVER_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#endif /* RADIO_DRIVER_HAL_H */
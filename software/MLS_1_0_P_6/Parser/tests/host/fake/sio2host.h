@@ -0,0 +1,32 @@
+/**
+* \file  sio2host.h
+*
+* \brief Host replacement of the host UART service: the received bytes are
+*        pushed by the test and served through both the peek and the getchar
+*        APIs, the transmitted bytes are only counted
+*
+*/
+
+#ifndef SIO2HOST_H
+#define SIO2HOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+uint8_t sio2host_tx(uint8_t *data, uint8_t length);
+uint16_t sio2host_rx_peek(uint8_t **data);
+void sio2host_rx_release(uint16_t length);
+bool sio2host_rx_burst_ended(void);
+void sio2host_rx_wake_every_byte(bool enable);
+typedef uint64_t (*sio2host_clock_t)(void);
+void sio2host_rx_mark_gaps(sio2host_clock_t clock, uint32_t gap_us);
+bool sio2host_rx_gap(void);
+int sio2host_getchar_nowait(void);
+
+/* Test control */
+bool FakeSio2host_Push(const uint8_t *data, uint16_t length);
+uint32_t FakeSio2host_TxBytes(void);
+/* The next pushed byte follows a silence, as marked by the receive interrupt */
+void FakeSio2host_Gap(void);
+
+#endif /* SIO2HOST_H */
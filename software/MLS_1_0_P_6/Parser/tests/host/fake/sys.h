@@ -0,0 +1,28 @@
+/**
+* \file  sys.h
+*
+* \brief Host replacement of the HAL system header: interrupt masking is
+*        emulated and timed, so that the longest masked section can be reported
+*
+*/
+
+#ifndef _SYSTEM_H
+#define _SYSTEM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef uint8_t irqflags_t;
+
+irqflags_t cpu_irq_save(void);
+void cpu_irq_restore(irqflags_t flags);
+void system_enter_critical_section(void);
+void system_leave_critical_section(void);
+
+/* Longest time spent with interrupts masked, in HostTest_Cycles units */
+uint64_t FakeIrq_MaxMaskedCycles(void);
+void FakeIrq_ResetStats(void);
+bool FakeIrq_IsMasked(void);
+
+#endif /* _SYSTEM_H */
@@ -0,0 +1,85 @@
+/**
+* \file  tc.h
+*
+* \brief Host replacement of the ASF TC driver used by sw_timer.c: a 32-bit
+*        counter advanced by the test, with the overflow and compare
+*        channel 0 interrupts
+*
+*/
+
+#ifndef TC_H_INCLUDED
+#define TC_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum tc_callback
+{
+	TC_CALLBACK_OVERFLOW,
+	TC_CALLBACK_CC_CHANNEL0,
+	TC_CALLBACK_N
+};
+
+enum tc_counter_size
+{
+	TC_COUNTER_SIZE_32BIT
+};
+
+enum tc_compare_capture_channel
+{
+	TC_COMPARE_CAPTURE_CHANNEL_0
+};
+
+#define TC_STATUS_CHANNEL_0_MATCH   (1UL << 0)
+#define TC_STATUS_COUNT_OVERFLOW    (1UL << 5)
+
+struct tc_module;
+typedef void (*tc_callback_t)(struct tc_module *const module);
+
+struct tc_module
+{
+	tc_callback_t callback[TC_CALLBACK_N];
+	bool callbackEnabled[TC_CALLBACK_N];
+};
+
+struct tc_config
+{
+	int clock_source;
+	int clock_prescaler;
+	enum tc_counter_size counter_size;
+	struct
+	{
+		uint32_t value;
+	} counter_32_bit;
+};
+
+void tc_get_config_defaults(struct tc_config *const config);
+int tc_init(struct tc_module *const module, void *hw, const struct tc_config *const config);
+int tc_register_callback(struct tc_module *const module, tc_callback_t callback_func,
+		enum tc_callback callback_type);
+void tc_enable_callback(struct tc_module *const module, enum tc_callback callback_type);
+void tc_disable_callback(struct tc_module *const module, enum tc_callback callback_type);
+void tc_enable(struct tc_module *const module);
+void tc_disable(struct tc_module *const module);
+int tc_set_compare_value(struct tc_module *const module,
+		enum tc_compare_capture_channel channel_index, uint32_t compare_value);
+void tc_clear_status(struct tc_module *const module, uint32_t status_flags);
+uint32_t tc_get_count_value(struct tc_module *const module);
+uint32_t tc_get_status(struct tc_module *const module);
+
+/*
+ * Test control. Time only moves in FakeTc_Advance, which raises the
+ * interrupts on the way unless they are masked; masked interrupts stay
+ * pending until FakeTc_DeliverPending.
+ */
+void FakeTc_SetCount(uint32_t count);
+uint32_t FakeTc_GetCount(void);
+void FakeTc_Advance(uint64_t us);
+void FakeTc_DeliverPending(void);
+void FakeTc_MaskInterrupts(bool masked);
+bool FakeTc_CompareArmed(uint32_t *compareValue);
+
+/* True once per SYSTEM_PostTask(TIMER_TASK_ID) not yet consumed by the test */
+bool FakeTask_TakeTimerPost(void);
+
+#endif /* TC_H_INCLUDED */
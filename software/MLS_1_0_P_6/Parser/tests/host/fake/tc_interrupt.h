@@ -0,0 +1,13 @@
+/**
+* \file  tc_interrupt.h
+*
+* \brief Host replacement of the ASF TC callback header, see tc.h
+*
+*/
+
+#ifndef TC_INTERRUPT_H_INCLUDED
+#define TC_INTERRUPT_H_INCLUDED
+
+#include "tc.h"
+
+#endif /* TC_INTERRUPT_H_INCLUDED */
@@ -0,0 +1,58 @@
+/**
+* \file  host_test.h
+*
+* \brief Minimal check and timing helpers for the host builds of the firmware modules
+*
+*/
+
+#ifndef _HOST_TEST_H
+#define _HOST_TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static unsigned int hostTestFailures __attribute__((unused));
+
+#define HOST_CHECK(cond)                                                      \
+    do                                                                        \
+    {                                                                         \
+        if(!(cond))                                                           \
+        {                                                                     \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);   \
+            hostTestFailures ++;                                              \
+        }                                                                     \
+    } while(0)
+
+#define HOST_TEST_RESULT()                                                    \
+    ((hostTestFailures == 0U) ? (printf("PASS\n"), 0) :                       \
+                                (printf("FAIL (%u)\n", hostTestFailures), 1))
+
+/* CPU cycles where the host has a cycle counter, nanoseconds otherwise */
+static inline uint64_t HostTest_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* Small deterministic generator, so that failures can be reproduced */
+static uint32_t hostTestSeed = 0x12345678U;
+
+static inline uint32_t HostTest_Rand(void)
+{
+    hostTestSeed ^= hostTestSeed << 13;
+    hostTestSeed ^= hostTestSeed >> 17;
+    hostTestSeed ^= hostTestSeed << 5;
+    return hostTestSeed;
+}
+
+#endif /* _HOST_TEST_H */
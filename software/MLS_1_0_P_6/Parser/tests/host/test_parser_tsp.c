@@ -0,0 +1,285 @@
+/**
+* \file  test_parser_tsp.c
+*
+* \brief Host tests of the binary protocol: opcode table, frame CRC, frame
+*        decoding and the drop of a partial frame after a silence
+*
+*/
+
+#include "host_test.h"
+/* Built in, so that Parser_RxDrain and Parser_FindCmd can be reached */
+#include "parser.c"
+#include "system_crc.h"
+
+#define TEST_FRAME_MAX      64U
+
+static uint8_t maFrame[TEST_FRAME_MAX];
+
+/* Resolves the keywords of an opcode command down to its entry, NULL if a
+ * keyword is not part of this build */
+static const parserCmdEntry_t* Test_Resolve(const char* pCommand)
+{
+    char words[PARSER_DEF_CMD_MAX_LEN];
+    const parserCmdEntry_t* pCmd = gpParserStartCmd;
+    const parserCmdEntry_t* pEntry = NULL;
+    uint8_t cmdSize = gParserStartCmdSize;
+    uint8_t cmdIdx;
+    char* pWord;
+
+    strcpy(words, pCommand);
+    for(pWord = strtok(words, " "); pWord != NULL; pWord = strtok(NULL, " "))
+    {
+        if(pCmd == NULL)
+        {
+            return NULL;
+        }
+        pEntry = Parser_FindCmd(pCmd, cmdSize, pWord, &cmdIdx);
+        if(pEntry == NULL)
+        {
+            return NULL;
+        }
+        cmdSize = pEntry->nextParserCmdSize;
+        pCmd = pEntry->pNextParserCmd;
+    }
+
+    return pEntry;
+}
+
+/* Counts the commands of the tree that take no further keyword */
+static uint16_t Test_CountTerminals(const parserCmdEntry_t* pCmd, uint8_t cmdSize)
+{
+    uint16_t count = 0U;
+    uint8_t idx;
+
+    for(idx = 0; idx < cmdSize; idx ++)
+    {
+        if(pCmd[idx].pNextParserCmd != NULL)
+        {
+            count += Test_CountTerminals(pCmd[idx].pNextParserCmd, pCmd[idx].nextParserCmdSize);
+        }
+        else
+        {
+            count ++;
+        }
+    }
+
+    return count;
+}
+
+static void Test_OpcodeTable(void)
+{
+    const parserCmdEntry_t* pEntry;
+    uint16_t resolved = 0U;
+    uint16_t idx;
+
+    for(idx = 0; idx < gParserBinOpcodeSize; idx ++)
+    {
+        /* Sorted without duplicates, for the binary search */
+        if(idx > 0U)
+        {
+            HOST_CHECK(gaParserBinOpcode[idx - 1U].opcode < gaParserBinOpcode[idx].opcode);
+        }
+
+        /* Only commands with a handler get an opcode */
+        pEntry = Test_Resolve(gaParserBinOpcode[idx].pCommand);
+        if(pEntry != NULL)
+        {
+            HOST_CHECK(pEntry->pNextParserCmd == NULL);
+            HOST_CHECK(pEntry->pActionCbFct != NULL);
+            resolved ++;
+        }
+    }
+
+    /* and every command of the build has one */
+    HOST_CHECK(resolved == Test_CountTerminals(gpParserStartCmd, gParserStartCmdSize));
+}
+
+static void Test_Crc(void)
+{
+    static const uint8_t check[] = "123456789";
+
+    /* Check values of CRC-16/MCRF4XX and CRC-16/KERMIT */
+    HOST_CHECK(SYSTEM_Crc16(SYSTEM_CRC16_INIT_FRAME, check, 9U) == 0x6F91U);
+    HOST_CHECK(SYSTEM_Crc16(SYSTEM_CRC16_INIT_PDS, check, 9U) == 0x2189U);
+    /* Continued over two calls */
+    HOST_CHECK(SYSTEM_Crc16(SYSTEM_Crc16(SYSTEM_CRC16_INIT_FRAME, check, 4U), &check[4], 5U) == 0x6F91U);
+}
+
+/* Frame of an opcode without parameters */
+static uint16_t Test_BuildFrame(uint16_t opcode)
+{
+    uint16_t crc;
+
+    maFrame[0] = PARSER_BIN_FRAME_SOF;
+    maFrame[1] = 4U;
+    maFrame[2] = 0U;
+    maFrame[3] = 0U;
+    maFrame[4] = (uint8_t)opcode;
+    maFrame[5] = (uint8_t)(opcode >> 8);
+    maFrame[6] = 0U;
+    crc = SYSTEM_Crc16(SYSTEM_CRC16_INIT_FRAME, &maFrame[PARSER_BIN_FRAME_HDR_LEN], 4U);
+    maFrame[7] = (uint8_t)crc;
+    maFrame[8] = (uint8_t)(crc >> 8);
+
+    return 9U;
+}
+
+/* Every opcode is decoded to its keywords, unknown ones are rejected */
+static void Test_Opcodes(void)
+{
+    static const uint16_t unknown[] = {0x0000U, 0x0100U, 0x0108U, 0x0405U, 0xFFFFU};
+    char line[PARSER_DEF_CMD_MAX_LEN];
+    const parserRxCmd_t* pRxCmd;
+    uint32_t txBytes;
+    uint16_t idx;
+    uint8_t wordIdx;
+
+    Parser_SetProtocol(PARSER_PROTOCOL_BIN);
+
+    for(idx = 0; idx < gParserBinOpcodeSize; idx ++)
+    {
+        HOST_CHECK(FakeSio2host_Push(maFrame, Test_BuildFrame(gaParserBinOpcode[idx].opcode)));
+        (void)Parser_RxDrain();
+        pRxCmd = Parser_RxGetCmd();
+        HOST_CHECK(pRxCmd != NULL);
+        if(pRxCmd != NULL)
+        {
+            line[0] = '\0';
+            for(wordIdx = 0; wordIdx <= pRxCmd->crtWordIdx; wordIdx ++)
+            {
+                strcat(line, (wordIdx > 0U) ? " " : "");
+                strcat(line, &pRxCmd->cmd[pRxCmd->wordStartPos[wordIdx]]);
+            }
+            HOST_CHECK(strcmp(line, gaParserBinOpcode[idx].pCommand) == 0);
+            Parser_RxReleaseCmd();
+        }
+    }
+
+    for(idx = 0; idx < sizeof(unknown) / sizeof(unknown[0]); idx ++)
+    {
+        txBytes = FakeSio2host_TxBytes();
+        HOST_CHECK(FakeSio2host_Push(maFrame, Test_BuildFrame(unknown[idx])));
+        (void)Parser_RxDrain();
+        HOST_CHECK(Parser_RxGetCmd() == NULL);
+        HOST_CHECK(FakeSio2host_TxBytes() > txBytes);
+    }
+}
+
+/* "mac tx uncnf 1 <payload>" frame, the payload as raw data */
+static uint16_t Test_BuildTxFrame(const uint8_t* pPayload, uint8_t payloadLen)
+{
+    uint16_t pos = PARSER_BIN_FRAME_HDR_LEN;
+    uint16_t bodyLen;
+    uint16_t crc;
+
+    maFrame[pos ++] = PARSER_BIN_FLAG_RAW_LAST_PARAM;
+    maFrame[pos ++] = 0x07U;
+    maFrame[pos ++] = 0x01U;
+    maFrame[pos ++] = 3U;
+    maFrame[pos ++] = 5U;
+    memcpy(&maFrame[pos], "uncnf", 5U);
+    pos += 5U;
+    maFrame[pos ++] = 1U;
+    maFrame[pos ++] = '1';
+    maFrame[pos ++] = payloadLen;
+    memcpy(&maFrame[pos], pPayload, payloadLen);
+    pos += payloadLen;
+
+    bodyLen = pos - PARSER_BIN_FRAME_HDR_LEN;
+    maFrame[0] = PARSER_BIN_FRAME_SOF;
+    maFrame[1] = (uint8_t)bodyLen;
+    maFrame[2] = (uint8_t)(bodyLen >> 8);
+    crc = SYSTEM_Crc16(SYSTEM_CRC16_INIT_FRAME, &maFrame[PARSER_BIN_FRAME_HDR_LEN], bodyLen);
+    maFrame[pos ++] = (uint8_t)crc;
+    maFrame[pos ++] = (uint8_t)(crc >> 8);
+
+    return pos;
+}
+
+static bool Test_IsTxCmd(const parserRxCmd_t* pRxCmd, const uint8_t* pPayload, uint8_t payloadLen)
+{
+    return (pRxCmd != NULL) && (pRxCmd->crtWordIdx == 4U) &&
+           (strcmp(&pRxCmd->cmd[pRxCmd->wordStartPos[0]], "mac") == 0) &&
+           (strcmp(&pRxCmd->cmd[pRxCmd->wordStartPos[1]], "tx") == 0) &&
+           (strcmp(&pRxCmd->cmd[pRxCmd->wordStartPos[2]], "uncnf") == 0) &&
+           (pRxCmd->binDataLen == payloadLen) &&
+           (memcmp(&pRxCmd->cmd[pRxCmd->binDataPos], pPayload, payloadLen) == 0);
+}
+
+static void Test_Frames(void)
+{
+    static const uint8_t payload[] = {0x00, 0xA5, 0x0A, 0xFF};
+    uint16_t frameLen = Test_BuildTxFrame(payload, sizeof(payload));
+    uint32_t txBytes;
+    uint16_t idx;
+
+    Parser_SetProtocol(PARSER_PROTOCOL_BIN);
+
+    /* Whole frame */
+    HOST_CHECK(FakeSio2host_Push(maFrame, frameLen));
+    (void)Parser_RxDrain();
+    HOST_CHECK(Test_IsTxCmd(Parser_RxGetCmd(), payload, sizeof(payload)));
+    Parser_RxReleaseCmd();
+
+    /* One byte per drain */
+    for(idx = 0; idx < frameLen; idx ++)
+    {
+        HOST_CHECK(Parser_RxGetCmd() == NULL);
+        HOST_CHECK(FakeSio2host_Push(&maFrame[idx], 1U));
+        (void)Parser_RxDrain();
+    }
+    HOST_CHECK(Test_IsTxCmd(Parser_RxGetCmd(), payload, sizeof(payload)));
+    Parser_RxReleaseCmd();
+
+    /* Bad CRC */
+    txBytes = FakeSio2host_TxBytes();
+    maFrame[frameLen - 1U] ^= 0x01U;
+    HOST_CHECK(FakeSio2host_Push(maFrame, frameLen));
+    (void)Parser_RxDrain();
+    HOST_CHECK(Parser_RxGetCmd() == NULL);
+    HOST_CHECK(FakeSio2host_TxBytes() > txBytes);
+    maFrame[frameLen - 1U] ^= 0x01U;
+}
+
+static void Test_Silence(void)
+{
+    static const uint8_t payload[] = {0x01, 0x02};
+    uint16_t frameLen = Test_BuildTxFrame(payload, sizeof(payload));
+    uint32_t txBytes;
+
+    Parser_SetProtocol(PARSER_PROTOCOL_BIN);
+
+    /* A partial frame, then a whole one after a silence, both in the buffer
+     * when the main loop gets to it: the partial frame alone is dropped */
+    txBytes = FakeSio2host_TxBytes();
+    HOST_CHECK(FakeSio2host_Push(maFrame, frameLen / 2U));
+    FakeSio2host_Gap();
+    HOST_CHECK(FakeSio2host_Push(maFrame, frameLen));
+    (void)Parser_RxDrain();
+    HOST_CHECK(Test_IsTxCmd(Parser_RxGetCmd(), payload, sizeof(payload)));
+    HOST_CHECK(FakeSio2host_TxBytes() == txBytes);
+    Parser_RxReleaseCmd();
+
+    /* Without the silence the second frame is taken as the rest of the first */
+    HOST_CHECK(FakeSio2host_Push(maFrame, frameLen / 2U));
+    HOST_CHECK(FakeSio2host_Push(maFrame, frameLen));
+    (void)Parser_RxDrain();
+    HOST_CHECK(!Test_IsTxCmd(Parser_RxGetCmd(), payload, sizeof(payload)));
+    HOST_CHECK(FakeSio2host_TxBytes() > txBytes);
+
+    Parser_SetProtocol(PARSER_PROTOCOL_ASCII);
+    Parser_RxClearBuffer();
+}
+
+int main(void)
+{
+    Parser_RxClearBuffer();
+
+    Test_OpcodeTable();
+    Test_Crc();
+    Test_Opcodes();
+    Test_Frames();
+    Test_Silence();
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,149 @@
+/**
+* \file  test_parser_utils.c
+*
+* \brief Host tests of the hex conversions of parser_utils.c
+*
+*/
+
+#include <string.h>
+#include "host_test.h"
+#include "parser_utils.h"
+
+#define TEST_MAX_BYTES      70U
+
+static const char maHexDigits[] = "0123456789abcdefABCDEF";
+
+/* Straightforward reference: odd lengths are right aligned */
+static bool Ref_HexDecode(const char* pIn, uint16_t len, uint8_t* pOut)
+{
+    uint16_t outLen = (len + 1U) / 2U;
+    uint16_t idx;
+
+    memset(pOut, 0, outLen);
+    for(idx = 0; idx < len; idx ++)
+    {
+        char c = pIn[len - 1U - idx];
+        uint8_t nibble;
+
+        if((c >= '0') && (c <= '9'))
+        {
+            nibble = (uint8_t)(c - '0');
+        }
+        else if((c >= 'a') && (c <= 'f'))
+        {
+            nibble = (uint8_t)(c - 'a' + 10);
+        }
+        else if((c >= 'A') && (c <= 'F'))
+        {
+            nibble = (uint8_t)(c - 'A' + 10);
+        }
+        else
+        {
+            return false;
+        }
+        pOut[outLen - 1U - (idx / 2U)] |= (uint8_t)(nibble << ((idx & 1U) * 4U));
+    }
+
+    return true;
+}
+
+static void Test_DecodeValid(void)
+{
+    char hex[2 * TEST_MAX_BYTES + 1];
+    uint8_t out[TEST_MAX_BYTES];
+    uint8_t ref[TEST_MAX_BYTES];
+    uint16_t len;
+    uint16_t idx;
+    uint8_t round;
+
+    for(len = 0; len <= 2 * TEST_MAX_BYTES; len ++)
+    {
+        for(round = 0; round < 8; round ++)
+        {
+            for(idx = 0; idx < len; idx ++)
+            {
+                hex[idx] = maHexDigits[HostTest_Rand() % (sizeof(maHexDigits) - 1U)];
+            }
+            hex[len] = '\0';
+
+            HOST_CHECK(Ref_HexDecode(hex, len, ref));
+            HOST_CHECK(Parser_HexAsciiDecode(hex, len, out));
+            HOST_CHECK(memcmp(out, ref, (len + 1U) / 2U) == 0);
+            HOST_CHECK(Validate_HexValue(hex));
+        }
+    }
+}
+
+static void Test_DecodeInvalid(void)
+{
+    char hex[2 * TEST_MAX_BYTES + 1];
+    uint8_t out[TEST_MAX_BYTES];
+    uint16_t len;
+    uint16_t badPos;
+    uint16_t c;
+
+    /* Every non hex character, at every position of every length */
+    for(len = 1; len <= 2 * TEST_MAX_BYTES; len ++)
+    {
+        for(badPos = 0; badPos < len; badPos ++)
+        {
+            memset(hex, 'a', len);
+            hex[len] = '\0';
+            for(c = 1; c < 256U; c ++)
+            {
+                if(strchr(maHexDigits, (int)c) != NULL)
+                {
+                    continue;
+                }
+                hex[badPos] = (char)c;
+                HOST_CHECK(!Parser_HexAsciiDecode(hex, len, out));
+                HOST_CHECK(!Validate_HexValue(hex));
+            }
+        }
+    }
+}
+
+static void Test_HexAsciiToInt(void)
+{
+    uint8_t out[4];
+    char hex[] = "0A1b2C3d";
+
+    HOST_CHECK(Parser_HexAsciiToInt(8U, hex, out) == 1U);
+    HOST_CHECK((out[0] == 0x0AU) && (out[1] == 0x1BU) && (out[2] == 0x2CU) && (out[3] == 0x3DU));
+    /* The expected length must match the string */
+    HOST_CHECK(Parser_HexAsciiToInt(6U, hex, out) == 0U);
+    /* Odd lengths are right aligned */
+    HOST_CHECK(Parser_HexAsciiToInt(3U, "abc", out) == 1U);
+    HOST_CHECK((out[0] == 0x0AU) && (out[1] == 0xBCU));
+}
+
+static void Test_EncodeRoundTrip(void)
+{
+    uint8_t in[TEST_MAX_BYTES];
+    uint8_t out[TEST_MAX_BYTES];
+    char hex[2 * TEST_MAX_BYTES + 1];
+    uint8_t len;
+    uint8_t idx;
+
+    for(len = 0; len <= TEST_MAX_BYTES; len ++)
+    {
+        for(idx = 0; idx < len; idx ++)
+        {
+            in[idx] = (uint8_t)HostTest_Rand();
+        }
+        Parser_IntArrayToHexAscii(len, in, hex);
+        HOST_CHECK(strlen(hex) == 2U * len);
+        HOST_CHECK(Parser_HexAsciiDecode(hex, 2U * len, out));
+        HOST_CHECK(memcmp(in, out, len) == 0);
+    }
+}
+
+int main(void)
+{
+    Test_DecodeValid();
+    Test_DecodeInvalid();
+    Test_HexAsciiToInt();
+    Test_EncodeRoundTrip();
+
+    return HOST_TEST_RESULT();
+}
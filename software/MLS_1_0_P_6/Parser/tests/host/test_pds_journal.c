@@ -0,0 +1,269 @@
+/**
+* \file  test_pds_journal.c
+*
+* \brief Host tests of the PDS counter journal over the RAM flash of
+*        fake/nvm.h: replay at init, queued writes, row switch, torn entries
+*        and the invalidation of a counter whose append failed
+*
+*/
+
+#include "host_test.h"
+#include "nvm.h"
+/* Built in, so that the row in use and the next entry can be reached */
+#include "pds_journal.c"
+
+#define TEST_COUNTER        0U
+#define TEST_OTHER          1U
+#define TEST_MAX_PASSES     10000U
+
+/* Defined by pds_interface.c and pds_task_handler.c in the firmware */
+PdsWriteStats_t pdsWriteStats;
+static uint32_t testPosts;
+static uint8_t testFailedMask;
+
+void pdsPostTask(PdsTaskIds_t id)
+{
+    HOST_CHECK(id == PDS_JOURNAL_TASK_ID);
+    testPosts ++;
+}
+
+void pdsJournalWriteFailed(uint8_t counterId)
+{
+    testFailedMask |= (1U << counterId);
+}
+
+static uint8_t *Test_Entry(uint8_t row, uint8_t entryIdx)
+{
+    return FakeNvm_Row(PDS_JOURNAL_FIRST_ROW + row) + (entryIdx * sizeof(PdsJournalEntry_t));
+}
+
+static void Test_Reset(void)
+{
+    FakeNvm_EraseAll();
+    pdsJournalInit();
+    testFailedMask = 0U;
+}
+
+/* Runs the queued writes as the PDS task does, one step per pass */
+static uint32_t Test_Run(void)
+{
+    uint32_t passes = 1U;
+
+    while((PDS_BUSY == pdsJournalResume()) && (passes < TEST_MAX_PASSES))
+    {
+        passes ++;
+    }
+    HOST_CHECK(!pdsJournalIsWriting());
+    return passes;
+}
+
+static void Test_Write(uint8_t counterId, uint32_t value)
+{
+    HOST_CHECK(pdsJournalWrite(counterId, value) == PDS_OK);
+    (void)Test_Run();
+}
+
+static void Test_Delete(uint8_t counterId)
+{
+    HOST_CHECK(pdsJournalDelete(counterId) == PDS_OK);
+    (void)Test_Run();
+}
+
+/* The RAM copy of a reset device is rebuilt from the rows */
+static bool Test_ReadAfterReset(uint8_t counterId, uint32_t *value)
+{
+    pdsJournalInit();
+    return pdsJournalRead(counterId, value);
+}
+
+/* Writes the counter until the row in use is full */
+static uint32_t Test_FillRow(uint32_t value)
+{
+    while(journalNextEntry < PDS_JOURNAL_ENTRIES_PER_ROW)
+    {
+        Test_Write(TEST_COUNTER, ++ value);
+    }
+    return value;
+}
+
+static void Test_Replay(void)
+{
+    uint32_t value;
+    uint32_t last;
+
+    Test_Reset();
+    HOST_CHECK(!pdsJournalRead(TEST_COUNTER, &value));
+    Test_Write(TEST_OTHER, 7U);
+    last = Test_FillRow(100U);
+    HOST_CHECK(Test_ReadAfterReset(TEST_COUNTER, &value) && (value == last));
+
+    /* Over the row switch, the old row is kept until the next one */
+    Test_Write(TEST_COUNTER, last + 1U);
+    HOST_CHECK(journalRow == 1U);
+    HOST_CHECK(Test_ReadAfterReset(TEST_COUNTER, &value) && (value == last + 1U));
+    HOST_CHECK(Test_ReadAfterReset(TEST_OTHER, &value) && (value == 7U));
+
+    Test_Delete(TEST_OTHER);
+    HOST_CHECK(!Test_ReadAfterReset(TEST_OTHER, &value));
+    HOST_CHECK(testFailedMask == 0U);
+}
+
+/* Writes are queued: nothing is programmed before the task runs, and a
+ * value written again before its entry keeps the last one only */
+static void Test_Queue(void)
+{
+    static uint8_t rows[PDS_JOURNAL_ROWS * EEPROM_ROW_SIZE];
+    uint32_t value;
+    uint32_t posts = testPosts;
+    uint32_t writes;
+
+    Test_Reset();
+    memcpy(rows, FakeNvm_Row(PDS_JOURNAL_FIRST_ROW), sizeof(rows));
+    HOST_CHECK(pdsJournalWrite(TEST_COUNTER, 1U) == PDS_OK);
+    HOST_CHECK(pdsJournalWrite(TEST_COUNTER, 2U) == PDS_OK);
+    HOST_CHECK(pdsJournalWrite(TEST_OTHER, 3U) == PDS_OK);
+    HOST_CHECK(testPosts == posts + 3U);
+    HOST_CHECK(memcmp(rows, FakeNvm_Row(PDS_JOURNAL_FIRST_ROW), sizeof(rows)) == 0);
+    HOST_CHECK(pdsJournalRead(TEST_COUNTER, &value) && (value == 2U));
+
+    /* The switch to the first row: its erase is issued, not waited for */
+    writes = pdsWriteStats.journalWrites;
+    HOST_CHECK(pdsJournalResume() == PDS_BUSY);
+    HOST_CHECK(journalWrite.state == PDS_JOURNAL_WRITE_ERASE);
+    (void)Test_Run();
+    HOST_CHECK(pdsWriteStats.journalWrites == writes + 2U);
+    HOST_CHECK(journalNextEntry == 3U);
+    HOST_CHECK(Test_ReadAfterReset(TEST_COUNTER, &value) && (value == 2U));
+    HOST_CHECK(Test_ReadAfterReset(TEST_OTHER, &value) && (value == 3U));
+
+    /* The same value again is not queued */
+    posts = testPosts;
+    HOST_CHECK(pdsJournalWrite(TEST_OTHER, 3U) == PDS_OK);
+    HOST_CHECK(testPosts == posts);
+    HOST_CHECK(!pdsJournalIsWriting());
+}
+
+/* A failed append leaves no older value of the counter to be restored over
+ * the one the caller stores in the file row instead */
+static void Test_FailedAppend(void)
+{
+    uint32_t value;
+
+    Test_Reset();
+    Test_Write(TEST_COUNTER, 10U);
+    Test_Write(TEST_OTHER, 20U);
+
+    /* The entry and its retry */
+    FakeNvm_FailCommands(0U, 2U, false);
+    Test_Write(TEST_COUNTER, 11U);
+    HOST_CHECK(testFailedMask == (1U << TEST_COUNTER));
+    HOST_CHECK(!pdsJournalRead(TEST_COUNTER, &value));
+    HOST_CHECK(pdsJournalRead(TEST_OTHER, &value) && (value == 20U));
+
+    /* The next write journals the counter again, after the entries the
+     * failed writes left erased */
+    Test_Write(TEST_COUNTER, 12U);
+    HOST_CHECK(Test_ReadAfterReset(TEST_COUNTER, &value) && (value == 12U));
+    HOST_CHECK(Test_ReadAfterReset(TEST_OTHER, &value) && (value == 20U));
+
+    /* Without a reset in between, the failure alone */
+    Test_Reset();
+    Test_Write(TEST_COUNTER, 10U);
+    FakeNvm_FailCommands(0U, 2U, false);
+    Test_Write(TEST_COUNTER, 11U);
+    HOST_CHECK(!Test_ReadAfterReset(TEST_COUNTER, &value));
+
+    /* A failed delete is not handed to the file row. The invalidation
+     * fails too: the value is left until the next delete */
+    Test_Write(TEST_COUNTER, 12U);
+    testFailedMask = 0U;
+    FakeNvm_FailCommands(0U, 3U, false);
+    Test_Delete(TEST_COUNTER);
+    HOST_CHECK(testFailedMask == 0U);
+    HOST_CHECK(!pdsJournalRead(TEST_COUNTER, &value));
+    Test_Delete(TEST_COUNTER);
+    HOST_CHECK(!Test_ReadAfterReset(TEST_COUNTER, &value));
+}
+
+/* The entries copied by a row switch and the ones left in the old row are
+ * invalidated alike */
+static void Test_FailedAppendAfterSwitch(void)
+{
+    uint32_t value;
+    uint32_t last;
+
+    Test_Reset();
+    Test_Write(TEST_OTHER, 7U);
+    last = Test_FillRow(0U);
+    Test_Write(TEST_COUNTER, ++ last);
+    HOST_CHECK(journalRow == 1U);
+
+    FakeNvm_FailCommands(0U, 2U, false);
+    Test_Write(TEST_COUNTER, last + 1U);
+    HOST_CHECK(testFailedMask == (1U << TEST_COUNTER));
+    HOST_CHECK(!Test_ReadAfterReset(TEST_COUNTER, &value));
+    HOST_CHECK(Test_ReadAfterReset(TEST_OTHER, &value) && (value == 7U));
+
+    /* Both switches fail, at the erase and at the header: the counters
+     * queued are given up */
+    Test_Reset();
+    Test_Write(TEST_OTHER, 7U);
+    last = Test_FillRow(0U);
+    FakeNvm_FailCommands(0U, 2U * PDS_JOURNAL_WRITE_ATTEMPTS, true);
+    Test_Write(TEST_COUNTER, last + 1U);
+    HOST_CHECK(testFailedMask == (1U << TEST_COUNTER));
+    HOST_CHECK(journalRow == 0U);
+    HOST_CHECK(!Test_ReadAfterReset(TEST_COUNTER, &value));
+    HOST_CHECK(Test_ReadAfterReset(TEST_OTHER, &value) && (value == 7U));
+    Test_Write(TEST_COUNTER, last + 2U);
+    HOST_CHECK(journalRow == 1U);
+    HOST_CHECK(Test_ReadAfterReset(TEST_COUNTER, &value) && (value == last + 2U));
+    HOST_CHECK(Test_ReadAfterReset(TEST_OTHER, &value) && (value == 7U));
+}
+
+/* Entries torn by a reset fail their CRC: the previous value is restored and
+ * the next entries go after them */
+static void Test_TornEntries(void)
+{
+    uint32_t value;
+    uint32_t last;
+    uint8_t entryIdx;
+
+    Test_Reset();
+    Test_Write(TEST_COUNTER, 1U);
+    Test_Write(TEST_COUNTER, 2U);
+    Test_Write(TEST_COUNTER, 3U);
+
+    /* Bits of the value left unprogrammed */
+    entryIdx = journalNextEntry - 1U;
+    Test_Entry(journalRow, entryIdx)[offsetof(PdsJournalEntry_t, value)] |= 0xF0U;
+    HOST_CHECK(Test_ReadAfterReset(TEST_COUNTER, &value) && (value == 2U));
+    HOST_CHECK(journalNextEntry == entryIdx + 1U);
+    Test_Write(TEST_COUNTER, 4U);
+    HOST_CHECK(Test_ReadAfterReset(TEST_COUNTER, &value) && (value == 4U));
+
+    /* The header of the next row torn by a failed write: the switch starts
+     * the row again */
+    last = Test_FillRow(4U);
+    FakeNvm_FailCommand(1U, false);
+    Test_Write(TEST_COUNTER, last + 1U);
+    HOST_CHECK(journalRow == 1U);
+    HOST_CHECK(Test_ReadAfterReset(TEST_COUNTER, &value) && (value == last + 1U));
+
+    /* A torn header alone leaves the old row in use */
+    Test_Entry(1U, 0U)[offsetof(PdsJournalEntry_t, crc)] |= 0x0FU;
+    Test_Entry(1U, 0U)[offsetof(PdsJournalEntry_t, crc) + 1U] |= 0x0FU;
+    HOST_CHECK(Test_ReadAfterReset(TEST_COUNTER, &value) && (value == last));
+    HOST_CHECK(journalRow == 0U);
+}
+
+int main(void)
+{
+    Test_Replay();
+    Test_Queue();
+    Test_FailedAppend();
+    Test_FailedAppendAfterSwitch();
+    Test_TornEntries();
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,256 @@
+/**
+* \file  test_pds_task.c
+*
+* \brief Host tests of the PDS store and delete task over the RAM flash of
+*        fake/nvm.h: retries of the failed row writes, the marks kept
+*        until their file is written and the journal task
+*
+*/
+
+#include "host_test.h"
+#include "nvm.h"
+/* Built in, so that the row masks and the task state can be reached */
+#include "pds_wl.c"
+#include "pds_task_handler.c"
+#include "pds_journal.c"
+
+#define TEST_FILE           PDS_FILE_MAC_01_IDX
+#define TEST_NUM_ITEMS      2U
+
+/* Defined by pds_interface.c in the firmware */
+bool isFileSet[PDS_MAX_FILE_IDX];
+PdsFileMarks_t fileMarks[PDS_MAX_FILE_IDX];
+PdsWriteStats_t pdsWriteStats;
+
+static uint32_t testCounter;
+static uint8_t testName[10];
+static PdsOperations_t testMarks[TEST_NUM_ITEMS];
+/* pdsStoreDelete reads the entry after the last item */
+static ItemMap_t testItems[TEST_NUM_ITEMS + 1U] =
+{
+    DECLARE_ITEM((uint8_t *)&testCounter, TEST_FILE, 0U, sizeof(testCounter), 0U),
+    DECLARE_ITEM(testName, TEST_FILE, 1U, sizeof(testName), sizeof(testCounter) + sizeof(ItemHeader_t)),
+};
+
+static bool testHeld;
+static uint8_t testJournalFailedMask;
+
+bool pdsIsHeld(void)
+{
+    return testHeld;
+}
+
+void pdsJournalWriteFailed(uint8_t counterId)
+{
+    testJournalFailedMask |= (1U << counterId);
+}
+
+uint8_t SYSTEM_GetFirstTaskId(uint32_t taskFlags)
+{
+    return (uint8_t)__builtin_ctz(taskFlags);
+}
+
+static void Test_Mark(uint8_t item)
+{
+    testMarks[item] = PDS_OP_STORE;
+    isFileSet[TEST_FILE] = true;
+    pdsPostTask(PDS_STORE_DELETE_TASK_ID);
+}
+
+static void Test_RunTask(void)
+{
+    uint32_t passes = 0U;
+
+    while((pdsTaskFlags != 0U) && (passes ++ < 1000U))
+    {
+        (void)PDS_TaskHandler();
+    }
+    HOST_CHECK(pdsTaskFlags == 0U);
+}
+
+/* The values held by the file row */
+static void Test_CheckRow(uint32_t counter, uint8_t nameFill)
+{
+    static PdsMem_t row;
+    uint8_t *data = row.NVM_Struct.pdsNvmData.WL_Struct.pdsWlData;
+    uint32_t rowCounter;
+    uint8_t idx;
+
+    HOST_CHECK(pdsWlRead(TEST_FILE, &row, testItems[TEST_NUM_ITEMS - 1U].itemOffset +
+            sizeof(ItemHeader_t) + sizeof(testName)) == PDS_OK);
+    memcpy(&rowCounter, &data[testItems[0].itemOffset + sizeof(ItemHeader_t)], sizeof(rowCounter));
+    HOST_CHECK(rowCounter == counter);
+    for(idx = 0; idx < sizeof(testName); idx ++)
+    {
+        HOST_CHECK(data[testItems[1].itemOffset + sizeof(ItemHeader_t) + idx] == nameFill);
+    }
+}
+
+static void Test_Reset(void)
+{
+    FakeNvm_EraseAll();
+    HOST_CHECK(pdsWlInit() == PDS_OK);
+    pdsJournalInit();
+    memset(isFileSet, 0, sizeof(isFileSet));
+    memset(testMarks, 0, sizeof(testMarks));
+    memset(&pdsWriteStats, 0, sizeof(pdsWriteStats));
+    fileMarks[TEST_FILE].fileMarkListAddr = testMarks;
+    fileMarks[TEST_FILE].numItems = TEST_NUM_ITEMS;
+    fileMarks[TEST_FILE].itemListAddr = testItems;
+    pdsWriteRetries = 0U;
+
+    testCounter = 1U;
+    memset(testName, 0x11, sizeof(testName));
+    Test_Mark(0U);
+    Test_Mark(1U);
+    Test_RunTask();
+    Test_CheckRow(1U, 0x11U);
+    HOST_CHECK(pdsWriteStats.rowsWritten == 1U);
+}
+
+/* A failed read back is written again to another row */
+static void Test_VerifyFailure(void)
+{
+    Test_Reset();
+    testCounter = 2U;
+    Test_Mark(0U);
+    /* The second page is left as it was erased */
+    FakeNvm_FailCommand(2U, false);
+    Test_RunTask();
+
+    HOST_CHECK(pdsWriteStats.writeFailures == 1U);
+    HOST_CHECK(pdsWriteStats.rowsWritten == 2U);
+    HOST_CHECK(!isFileSet[TEST_FILE]);
+    HOST_CHECK((testMarks[0] == PDS_OP_NONE) && (testMarks[1] == PDS_OP_NONE));
+    Test_CheckRow(2U, 0x11U);
+}
+
+/* A write that cannot start is retried a bounded number of times, then its
+ * marks wait for the next store of the file */
+static void Test_StartFailure(void)
+{
+    Test_Reset();
+    testCounter = 3U;
+    Test_Mark(0U);
+    freeRowMask = 0U;
+    staleRowMask = 0U;
+    Test_RunTask();
+
+    HOST_CHECK(pdsWriteStats.writeFailures == (1U + PDS_WRITE_RETRIES));
+    HOST_CHECK(pdsWriteStats.rowsWritten == 1U);
+    HOST_CHECK(!isFileSet[TEST_FILE]);
+    HOST_CHECK(testMarks[0] == PDS_OP_STORE);
+    Test_CheckRow(1U, 0x11U);
+
+    /* The next store writes the kept mark too */
+    HOST_CHECK(pdsWlInit() == PDS_OK);
+    memset(testName, 0x22, sizeof(testName));
+    Test_Mark(1U);
+    Test_RunTask();
+    HOST_CHECK(pdsWriteStats.rowsWritten == 2U);
+    HOST_CHECK((testMarks[0] == PDS_OP_NONE) && (testMarks[1] == PDS_OP_NONE));
+    Test_CheckRow(3U, 0x22U);
+}
+
+/* A mark set while its file is written keeps the file dirty */
+static void Test_MarkDuringWrite(void)
+{
+    Test_Reset();
+    testCounter = 4U;
+    Test_Mark(0U);
+    (void)PDS_TaskHandler();
+    HOST_CHECK(pdsWlIsWriting());
+    memset(testName, 0x33, sizeof(testName));
+    Test_Mark(1U);
+    Test_RunTask();
+
+    HOST_CHECK(pdsWriteStats.rowsWritten == 3U);
+    HOST_CHECK(pdsWriteStats.writeFailures == 0U);
+    HOST_CHECK((testMarks[0] == PDS_OP_NONE) && (testMarks[1] == PDS_OP_NONE));
+    Test_CheckRow(4U, 0x33U);
+}
+
+/* The flush retries too, and fails only once the retries are used */
+static void Test_Flush(void)
+{
+    Test_Reset();
+    testCounter = 5U;
+    Test_Mark(0U);
+    FakeNvm_FailCommand(0U, true);
+    HOST_CHECK(pdsFlush() == PDS_OK);
+    HOST_CHECK(pdsWriteStats.writeFailures == 1U);
+    Test_CheckRow(5U, 0x11U);
+
+    testCounter = 6U;
+    Test_Mark(0U);
+    freeRowMask = 0U;
+    staleRowMask = 0U;
+    HOST_CHECK(pdsFlush() == PDS_NOT_ENOUGH_MEMORY);
+    HOST_CHECK(pdsWriteStats.writeFailures == (2U + PDS_WRITE_RETRIES));
+    HOST_CHECK(!isFileSet[TEST_FILE]);
+    HOST_CHECK(testMarks[0] == PDS_OP_STORE);
+    HOST_CHECK(pdsTaskFlags == 0U);
+}
+
+/* The journal writes wait for the hold, then for the row write in progress,
+ * and issue one NVM command per pass */
+static void Test_Journal(void)
+{
+    static uint8_t rows[PDS_JOURNAL_ROWS * EEPROM_ROW_SIZE];
+    uint32_t value;
+
+    Test_Reset();
+    memcpy(rows, FakeNvm_Row(PDS_JOURNAL_FIRST_ROW), sizeof(rows));
+    testHeld = true;
+    HOST_CHECK(pdsJournalWrite(0U, 10U) == PDS_OK);
+    Test_RunTask();
+    HOST_CHECK(pdsJournalIsWriting());
+    HOST_CHECK(memcmp(rows, FakeNvm_Row(PDS_JOURNAL_FIRST_ROW), sizeof(rows)) == 0);
+
+    /* Posted again by the hold timer. The row switch erase is issued, not
+     * waited for */
+    testHeld = false;
+    pdsPostTask(PDS_JOURNAL_TASK_ID);
+    (void)PDS_TaskHandler();
+    HOST_CHECK(journalWrite.state == PDS_JOURNAL_WRITE_ERASE);
+    Test_RunTask();
+    HOST_CHECK(!pdsJournalIsWriting());
+    HOST_CHECK(pdsWriteStats.journalWrites == 1U);
+
+    /* A row write in progress keeps the journal off the NVM controller */
+    testCounter = 7U;
+    Test_Mark(0U);
+    (void)PDS_TaskHandler();
+    HOST_CHECK(pdsWlIsWriting());
+    HOST_CHECK(pdsJournalWrite(0U, 11U) == PDS_OK);
+    while(pdsWlIsWriting())
+    {
+        HOST_CHECK(journalWrite.state == PDS_JOURNAL_WRITE_IDLE);
+        (void)PDS_TaskHandler();
+    }
+    Test_RunTask();
+    Test_CheckRow(7U, 0x11U);
+    HOST_CHECK(pdsWriteStats.journalWrites == 2U);
+    pdsJournalInit();
+    HOST_CHECK(pdsJournalRead(0U, &value) && (value == 11U));
+
+    /* The flush writes the queued entries too */
+    HOST_CHECK(pdsJournalWrite(0U, 12U) == PDS_OK);
+    HOST_CHECK(pdsFlush() == PDS_OK);
+    HOST_CHECK(!pdsJournalIsWriting());
+    HOST_CHECK(pdsTaskFlags == 0U);
+    pdsJournalInit();
+    HOST_CHECK(pdsJournalRead(0U, &value) && (value == 12U));
+    HOST_CHECK(testJournalFailedMask == 0U);
+}
+
+int main(void)
+{
+    Test_VerifyFailure();
+    Test_StartFailure();
+    Test_MarkDuringWrite();
+    Test_Flush();
+    Test_Journal();
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,347 @@
+/**
+* \file  test_pds_wl.c
+*
+* \brief Host tests of the PDS wear leveling over the RAM flash of fake/nvm.h:
+*        free and stale row masks, init scan and relocation of the files
+*        found in the journal rows
+*
+*/
+
+#include "host_test.h"
+#include "nvm.h"
+/* Built in, so that the file map and the row masks can be checked */
+#include "pds_wl.c"
+
+#define WL_ALL_ROWS         ((1UL << PDS_WL_NUM_ROWS) - 1U)
+#define TEST_ROUNDS         3000U
+
+typedef struct _TestFile
+{
+    bool valid;
+    uint8_t fill;
+    uint8_t size;
+} TestFile_t;
+
+static TestFile_t testFiles[PDS_MAX_FILE_IDX];
+static PdsMem_t testBuffer;
+
+static bool Test_IsFilled(const uint8_t *data, uint8_t fill, uint8_t size)
+{
+    uint8_t idx;
+
+    for(idx = 0; idx < size; idx ++)
+    {
+        if(data[idx] != fill)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Every wear leveling row holds the latest copy of one file, or is free, or
+ * is stale */
+static void Test_CheckMasks(void)
+{
+    uint32_t latestMask = 0U;
+    uint16_t rowIdx;
+    uint8_t fileId;
+
+    HOST_CHECK((freeRowMask & staleRowMask) == 0U);
+    HOST_CHECK(((freeRowMask | staleRowMask) & ~WL_ALL_ROWS) == 0U);
+    for(fileId = 0; fileId < PDS_MAX_FILE_IDX; fileId ++)
+    {
+        rowIdx = fileMap[fileId].maxCounterRowIdx;
+        HOST_CHECK(testFiles[fileId].valid == (USHRT_MAX != rowIdx));
+        if(USHRT_MAX == rowIdx)
+        {
+            continue;
+        }
+        HOST_CHECK(rowIdx < PDS_WL_NUM_ROWS);
+        HOST_CHECK(((freeRowMask | staleRowMask | latestMask) & (1UL << rowIdx)) == 0U);
+        latestMask |= (1UL << rowIdx);
+    }
+    HOST_CHECK((freeRowMask | staleRowMask | latestMask) == WL_ALL_ROWS);
+}
+
+static void Test_CheckContents(void)
+{
+    PdsWlHeader_t *wlHeader = &testBuffer.NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader;
+    uint8_t fileId;
+
+    for(fileId = 0; fileId < PDS_MAX_FILE_IDX; fileId ++)
+    {
+        HOST_CHECK(isFileFound(fileId) == testFiles[fileId].valid);
+        if(!testFiles[fileId].valid)
+        {
+            HOST_CHECK(pdsWlRead(fileId, &testBuffer, 1U) == PDS_NOT_FOUND);
+            continue;
+        }
+        memset(&testBuffer, 0, sizeof(testBuffer));
+        HOST_CHECK(pdsWlRead(fileId, &testBuffer, testFiles[fileId].size) == PDS_OK);
+        HOST_CHECK(wlHeader->memId == fileId);
+        HOST_CHECK(wlHeader->size == testFiles[fileId].size);
+        HOST_CHECK(Test_IsFilled(testBuffer.NVM_Struct.pdsNvmData.WL_Struct.pdsWlData,
+                testFiles[fileId].fill, testFiles[fileId].size));
+    }
+}
+
+/* Writes a file the way the PDS task does: the latest copy is read first,
+ * so that the counter goes on from it */
+static PdsStatus_t Test_Store(uint8_t fileId, uint8_t fill, uint8_t size)
+{
+    PdsStatus_t status;
+
+    memset(&testBuffer, 0, sizeof(testBuffer));
+    if(testFiles[fileId].valid)
+    {
+        HOST_CHECK(pdsWlRead(fileId, &testBuffer, testFiles[fileId].size) == PDS_OK);
+    }
+    memset(testBuffer.NVM_Struct.pdsNvmData.WL_Struct.pdsWlData, fill, size);
+    status = pdsWlWrite(fileId, &testBuffer, size);
+    if(PDS_OK == status)
+    {
+        testFiles[fileId].valid = true;
+        testFiles[fileId].fill = fill;
+        testFiles[fileId].size = size;
+    }
+    return status;
+}
+
+/* Writes a file copy straight to a row, as an older firmware or the
+ * journal would have left it */
+static void Test_PlaceRow(uint16_t rowIdx, uint8_t fileId, uint32_t counter, uint8_t fill, uint8_t size)
+{
+    PdsMem_t row;
+    PdsWlHeader_t *wlHeader = &row.NVM_Struct.pdsNvmData.WL_Struct.pdsWlHeader;
+
+    memset(&row, 0, sizeof(row));
+    wlHeader->magicNo = PDS_MAGIC;
+    wlHeader->version = PDS_WL_VERSION;
+    wlHeader->memId = fileId;
+    wlHeader->counter = counter;
+    wlHeader->size = size;
+    memset(row.NVM_Struct.pdsNvmData.WL_Struct.pdsWlData, fill, size);
+    pdsNvmSetHeader(&row, size + sizeof(PdsWlHeader_t));
+    memcpy(FakeNvm_Row(rowIdx), &row, sizeof(row));
+}
+
+static void Test_Reset(void)
+{
+    FakeNvm_EraseAll();
+    memset(testFiles, 0, sizeof(testFiles));
+    HOST_CHECK(pdsWlInit() == PDS_OK);
+}
+
+static void Test_Empty(void)
+{
+    uint8_t fileId;
+
+    Test_Reset();
+    HOST_CHECK(freeRowMask == WL_ALL_ROWS);
+    HOST_CHECK(staleRowMask == 0U);
+    for(fileId = 0; fileId < PDS_MAX_FILE_IDX; fileId ++)
+    {
+        HOST_CHECK(!isFileFound(fileId));
+    }
+    Test_CheckMasks();
+}
+
+/* The rows are taken in turn, the old copy goes stale, and the stale rows
+ * are only reused once no free row is left */
+static void Test_Rotation(void)
+{
+    uint32_t rowWrites[PDS_WL_NUM_ROWS] = {0};
+    uint32_t expectedMask;
+    uint16_t expectedRowIdx;
+    uint16_t rowIdx = PDS_WL_NUM_ROWS - 1U;
+    uint16_t oldRowIdx;
+    uint32_t round;
+    uint8_t fileId;
+
+    Test_Reset();
+    for(round = 0; round < PDS_WL_NUM_ROWS * 20U; round ++)
+    {
+        fileId = (uint8_t)(round % 3U);
+        oldRowIdx = fileMap[fileId].maxCounterRowIdx;
+        expectedMask = (0U != freeRowMask) ? freeRowMask : staleRowMask;
+        expectedRowIdx = rowIdx;
+        do
+        {
+            expectedRowIdx = (expectedRowIdx + 1U) % PDS_WL_NUM_ROWS;
+        } while((expectedMask & (1UL << expectedRowIdx)) == 0U);
+        HOST_CHECK(Test_Store(fileId, (uint8_t)round, 40U) == PDS_OK);
+
+        rowIdx = fileMap[fileId].maxCounterRowIdx;
+        HOST_CHECK(rowIdx == expectedRowIdx);
+        if(USHRT_MAX != oldRowIdx)
+        {
+            HOST_CHECK(staleRowMask & (1UL << oldRowIdx));
+        }
+        rowWrites[rowIdx] ++;
+        Test_CheckMasks();
+    }
+    Test_CheckContents();
+
+    /* Every row takes the same share of the writes, whatever rows held the
+     * latest copies when the stale rows were freed */
+    for(rowIdx = 0; rowIdx < PDS_WL_NUM_ROWS; rowIdx ++)
+    {
+        HOST_CHECK(rowWrites[rowIdx] >= 19U);
+        HOST_CHECK(rowWrites[rowIdx] <= 21U);
+    }
+}
+
+/* Random writes of every file, with inits in between */
+static void Test_Random(void)
+{
+    uint32_t round;
+    uint8_t fileId;
+
+    Test_Reset();
+    for(round = 0; round < TEST_ROUNDS; round ++)
+    {
+        fileId = (uint8_t)(HostTest_Rand() % PDS_MAX_FILE_IDX);
+        HOST_CHECK(Test_Store(fileId, (uint8_t)HostTest_Rand(),
+                (uint8_t)(1U + (HostTest_Rand() % 200U))) == PDS_OK);
+        Test_CheckMasks();
+
+        if((HostTest_Rand() % 64U) == 0U)
+        {
+            HOST_CHECK(pdsWlInit() == PDS_OK);
+            /* The old copies are free again after an init */
+            HOST_CHECK(staleRowMask == 0U);
+            Test_CheckMasks();
+            Test_CheckContents();
+        }
+    }
+    Test_CheckContents();
+}
+
+/* A file found in a journal row is moved to a wear leveling row, unless a
+ * wear leveling row holds a newer copy */
+static void Test_JournalRelocation(void)
+{
+    uint8_t journalRow[EEPROM_ROW_SIZE];
+    uint16_t rowIdx;
+
+    Test_Reset();
+    HOST_CHECK(Test_Store(PDS_FILE_MAC_01_IDX, 0x11U, 30U) == PDS_OK);
+    HOST_CHECK(Test_Store(PDS_FILE_MAC_02_IDX, 0x22U, 60U) == PDS_OK);
+
+    Test_PlaceRow(PDS_JOURNAL_FIRST_ROW, PDS_FILE_MAC_01_IDX, fileMap[PDS_FILE_MAC_01_IDX].counter + 5U, 0x33U, 30U);
+    Test_PlaceRow(PDS_JOURNAL_FIRST_ROW + 1U, PDS_FILE_MAC_02_IDX, fileMap[PDS_FILE_MAC_02_IDX].counter - 1U, 0x44U, 60U);
+    memcpy(journalRow, FakeNvm_Row(PDS_JOURNAL_FIRST_ROW), sizeof(journalRow));
+
+    HOST_CHECK(pdsWlInit() == PDS_OK);
+    testFiles[PDS_FILE_MAC_01_IDX].fill = 0x33U;
+
+    /* The old wear leveling copy was freed by the scan and takes the newer
+     * one, the journal row is left to the journal */
+    rowIdx = fileMap[PDS_FILE_MAC_01_IDX].maxCounterRowIdx;
+    HOST_CHECK(rowIdx == 0U);
+    HOST_CHECK(fileMap[PDS_FILE_MAC_01_IDX].counter == 7U);
+    HOST_CHECK(memcmp(journalRow, FakeNvm_Row(PDS_JOURNAL_FIRST_ROW), sizeof(journalRow)) == 0);
+    HOST_CHECK(fileMap[PDS_FILE_MAC_02_IDX].maxCounterRowIdx == 1U);
+    Test_CheckMasks();
+    Test_CheckContents();
+
+    /* Once moved, a second init finds the same copies without a write */
+    HOST_CHECK(pdsWlInit() == PDS_OK);
+    HOST_CHECK(fileMap[PDS_FILE_MAC_01_IDX].maxCounterRowIdx == 0U);
+    HOST_CHECK(fileMap[PDS_FILE_MAC_01_IDX].counter == 7U);
+    Test_CheckMasks();
+    Test_CheckContents();
+}
+
+/* A row that fails its CRC check is left out, the older copy is used */
+static void Test_CrcFallback(void)
+{
+    Test_Reset();
+    HOST_CHECK(Test_Store(PDS_FILE_MAC_01_IDX, 0x55U, 50U) == PDS_OK);
+    HOST_CHECK(Test_Store(PDS_FILE_MAC_01_IDX, 0x66U, 50U) == PDS_OK);
+    HOST_CHECK(fileMap[PDS_FILE_MAC_01_IDX].maxCounterRowIdx == 1U);
+
+    FakeNvm_Row(1U)[sizeof(PdsNvmHeader_t) + sizeof(PdsWlHeader_t) + 10U] ^= 0x01U;
+    HOST_CHECK(pdsWlInit() == PDS_OK);
+    testFiles[PDS_FILE_MAC_01_IDX].fill = 0x55U;
+    HOST_CHECK(fileMap[PDS_FILE_MAC_01_IDX].maxCounterRowIdx == 0U);
+    HOST_CHECK(freeRowMask & (1UL << 1));
+    Test_CheckMasks();
+    Test_CheckContents();
+}
+
+/* A failed erase, page write or read back leaves the file map as it was and
+ * the row stale */
+static void Test_WriteErrors(void)
+{
+    static const struct
+    {
+        uint8_t skip;
+        bool reportError;
+    } failures[] =
+    {
+        {0U, true},     /* Erase */
+        {2U, true},     /* Third page */
+        {1U, false},    /* Second page, found by the read back */
+    };
+    uint16_t rowIdx;
+    uint8_t idx;
+
+    Test_Reset();
+    HOST_CHECK(Test_Store(PDS_FILE_MAC_01_IDX, 0x77U, 200U) == PDS_OK);
+    for(idx = 0; idx < (sizeof(failures) / sizeof(failures[0])); idx ++)
+    {
+        rowIdx = (uint16_t)__builtin_ctz(freeRowMask);
+        FakeNvm_FailCommand(failures[idx].skip, failures[idx].reportError);
+        HOST_CHECK(Test_Store(PDS_FILE_MAC_01_IDX, (uint8_t)(0x80U + idx), 200U) != PDS_OK);
+        HOST_CHECK(!pdsWlIsWriting());
+        HOST_CHECK(fileMap[PDS_FILE_MAC_01_IDX].maxCounterRowIdx == 0U);
+        HOST_CHECK(staleRowMask & (1UL << rowIdx));
+        Test_CheckMasks();
+        Test_CheckContents();
+    }
+
+    /* The next write goes to the next free row */
+    HOST_CHECK(Test_Store(PDS_FILE_MAC_01_IDX, 0x99U, 200U) == PDS_OK);
+    HOST_CHECK(fileMap[PDS_FILE_MAC_01_IDX].maxCounterRowIdx == 4U);
+    Test_CheckMasks();
+    Test_CheckContents();
+}
+
+/* Thirteen files in fourteen rows: the one row left over takes every write */
+static void Test_Full(void)
+{
+    uint8_t fileId;
+
+    Test_Reset();
+    for(fileId = 0; fileId < PDS_MAX_FILE_IDX; fileId ++)
+    {
+        HOST_CHECK(Test_Store(fileId, fileId, 100U) == PDS_OK);
+    }
+    HOST_CHECK(freeRowMask == (1UL << PDS_MAX_FILE_IDX));
+    HOST_CHECK(Test_Store(0U, 0xA0U, 100U) == PDS_OK);
+    HOST_CHECK(Test_Store(1U, 0xA1U, 100U) == PDS_OK);
+    HOST_CHECK(fileMap[1].maxCounterRowIdx == 0U);
+    HOST_CHECK((freeRowMask == 0U) && (staleRowMask == (1UL << 1)));
+    Test_CheckMasks();
+    Test_CheckContents();
+
+    /* Without a free or stale row the write is refused before any row is taken */
+    staleRowMask = 0U;
+    HOST_CHECK(pdsWlWriteStart(PDS_FILE_MAC_02_IDX, &testBuffer, 10U) == PDS_NOT_ENOUGH_MEMORY);
+    HOST_CHECK(!pdsWlIsWriting());
+}
+
+int main(void)
+{
+    Test_Empty();
+    Test_Rotation();
+    Test_Random();
+    Test_JournalRelocation();
+    Test_CrcFallback();
+    Test_WriteErrors();
+    Test_Full();
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,297 @@
+/**
+* \file  test_sw_timer.c
+*
+* \brief Host tests of the software timer heap over the fake TC time base
+*
+*/
+
+#include "host_test.h"
+/* Built in, so that the heap and the wakeup state can be checked */
+#include "sw_timer.c"
+
+/* Largest time step of the simulation, the bound on the ISR to task delay */
+#define SIM_STEP_MAX        16U
+#define SIM_ROUNDS          4000U
+
+typedef struct _SimTimer
+{
+    uint8_t id;
+    bool running;
+    uint64_t expiry;
+    uint32_t slack;
+} SimTimer_t;
+
+static SimTimer_t simTimers[TOTAL_NUMBER_OF_SW_TIMERS];
+static uint64_t simLastExpiry;
+static uint32_t simExpiries;
+static bool simRestartInCallback;
+
+static void Test_CheckHeap(void)
+{
+    uint8_t running = 0U;
+    uint8_t idx;
+    uint8_t timerId;
+    uint32_t compareValue;
+
+    for(idx = 0; idx < TOTAL_NUMBER_OF_SW_TIMERS; idx ++)
+    {
+        if(swTimers[idx].heapIndex != SWTIMER_INVALID)
+        {
+            running ++;
+            HOST_CHECK(swTimers[idx].heapIndex < runningTimers);
+            HOST_CHECK(runningTimerHeap[swTimers[idx].heapIndex] == idx);
+        }
+    }
+    HOST_CHECK(running == runningTimers);
+
+    for(idx = 1; idx < runningTimers; idx ++)
+    {
+        HOST_CHECK(swtimerCompareTime(swTimers[runningTimerHeap[(idx - 1) >> 1]].absoluteExpiryTime,
+                swTimers[runningTimerHeap[idx]].absoluteExpiryTime));
+    }
+
+    if(runningTimers == 0U)
+    {
+        HOST_CHECK(runningTimerQueueHead == SWTIMER_INVALID);
+        return;
+    }
+    HOST_CHECK(runningTimerQueueHead == runningTimerHeap[0]);
+
+    /* The armed wakeup is in time for every running timer */
+    if(swTimers[runningTimerQueueHead].loaded)
+    {
+        HOST_CHECK(FakeTc_CompareArmed(&compareValue));
+        HOST_CHECK(compareValue == armedWakeTime);
+        for(idx = 0; idx < runningTimers; idx ++)
+        {
+            timerId = runningTimerHeap[idx];
+            HOST_CHECK(swtimerCompareTime(armedWakeTime,
+                    swTimers[timerId].absoluteExpiryTime + swTimers[timerId].slack));
+        }
+    }
+}
+
+static void Sim_Callback(void* param);
+
+static void Sim_Start(uint8_t timerId, uint32_t timeout, uint32_t slack)
+{
+    SimTimer_t* pTimer = &simTimers[timerId];
+
+    pTimer->expiry = SwTimerGetTime() + timeout;
+    pTimer->slack = slack;
+    pTimer->running = true;
+    HOST_CHECK(SwTimerStartWithSlack(timerId, timeout, SW_TIMEOUT_RELATIVE, slack,
+            Sim_Callback, pTimer) == LORAWAN_SUCCESS);
+}
+
+static void Sim_Callback(void* param)
+{
+    SimTimer_t* pTimer = param;
+    uint64_t now = SwTimerGetTime();
+
+    HOST_CHECK(pTimer->running);
+    /* A head due within SWTIMER_MIN_TIMEOUT is expired without a wakeup */
+    HOST_CHECK(now + SWTIMER_MIN_TIMEOUT >= pTimer->expiry);
+    HOST_CHECK(now <= pTimer->expiry + pTimer->slack + SIM_STEP_MAX);
+    HOST_CHECK(simLastExpiry <= pTimer->expiry);
+    simLastExpiry = pTimer->expiry;
+    pTimer->running = false;
+    simExpiries ++;
+
+    if(simRestartInCallback && ((HostTest_Rand() & 3U) == 0U))
+    {
+        Sim_Start(pTimer->id, 256U + (HostTest_Rand() % 20000U), HostTest_Rand() % 2000U);
+    }
+}
+
+/* Moves the time on in small steps, running the timer task when posted */
+static void Sim_Run(uint32_t us)
+{
+    uint64_t before;
+    uint64_t after;
+    uint32_t step;
+
+    while(us > 0U)
+    {
+        step = 1U + (HostTest_Rand() % SIM_STEP_MAX);
+        if(step > us)
+        {
+            step = us;
+        }
+        before = SwTimerGetTime();
+        FakeTc_Advance(step);
+        after = SwTimerGetTime();
+        HOST_CHECK(after == before + step);
+        us -= step;
+
+        while(FakeTask_TakeTimerPost())
+        {
+            TIMER_TaskHandler();
+            Test_CheckHeap();
+        }
+    }
+}
+
+static void Sim_Init(uint32_t count)
+{
+    uint8_t timerId = 0U;
+    uint8_t idx;
+
+    SystemTimerInit();
+    FakeTc_SetCount(count);
+    (void)FakeTask_TakeTimerPost();
+    memset(simTimers, 0, sizeof(simTimers));
+    for(idx = 0; idx < TOTAL_NUMBER_OF_SW_TIMERS; idx ++)
+    {
+        HOST_CHECK(SwTimerCreate(&timerId) == LORAWAN_SUCCESS);
+        simTimers[timerId].id = timerId;
+    }
+    simLastExpiry = SwTimerGetTime();
+    simExpiries = 0U;
+}
+
+/* Random starts and stops without expiries, the heap is checked after each */
+static void Test_HeapRandom(void)
+{
+    uint32_t round;
+    uint8_t timerId;
+
+    Sim_Init(HostTest_Rand());
+    for(round = 0; round < SIM_ROUNDS * 4U; round ++)
+    {
+        timerId = (uint8_t)(HostTest_Rand() % TOTAL_NUMBER_OF_SW_TIMERS);
+        if(SwTimerIsRunning(timerId))
+        {
+            HOST_CHECK(SwTimerStop(timerId) == LORAWAN_SUCCESS);
+            HOST_CHECK(SwTimerStop(timerId) == LORAWAN_INVALID_REQUEST);
+            simTimers[timerId].running = false;
+        }
+        else
+        {
+            /* Equal expiries are frequent enough to exercise the ties */
+            Sim_Start(timerId, 1000000U + (HostTest_Rand() % 64U) * 1000U,
+                    (HostTest_Rand() & 1U) ? 0U : HostTest_Rand() % 100000U);
+        }
+        Test_CheckHeap();
+    }
+
+    HOST_CHECK(SwTimerStart(0U, 100U, SW_TIMEOUT_RELATIVE, Sim_Callback, NULL) != LORAWAN_SUCCESS);
+    HOST_CHECK(SwTimerStart(TOTAL_NUMBER_OF_SW_TIMERS, 1000U, SW_TIMEOUT_RELATIVE,
+            Sim_Callback, NULL) == LORAWAN_INVALID_PARAMETER);
+    HOST_CHECK(SwTimerStop(TOTAL_NUMBER_OF_SW_TIMERS) == LORAWAN_INVALID_PARAMETER);
+}
+
+/* Random starts, stops and expiries, every callback is checked for order and lateness */
+static void Test_ExpiryRandom(uint32_t count)
+{
+    uint32_t round;
+    uint32_t started = 0U;
+    uint32_t stopped = 0U;
+    uint8_t timerId;
+    uint8_t idx;
+
+    Sim_Init(count);
+    simRestartInCallback = true;
+    for(round = 0; round < SIM_ROUNDS; round ++)
+    {
+        timerId = (uint8_t)(HostTest_Rand() % TOTAL_NUMBER_OF_SW_TIMERS);
+        if(!SwTimerIsRunning(timerId))
+        {
+            Sim_Start(timerId, 256U + (HostTest_Rand() % 20000U),
+                    (HostTest_Rand() & 1U) ? 0U : HostTest_Rand() % 2000U);
+            started ++;
+        }
+        else if((HostTest_Rand() & 7U) == 0U)
+        {
+            HOST_CHECK(SwTimerStop(timerId) == LORAWAN_SUCCESS);
+            simTimers[timerId].running = false;
+            stopped ++;
+        }
+        Test_CheckHeap();
+        Sim_Run(HostTest_Rand() % 500U);
+    }
+
+    simRestartInCallback = false;
+    Sim_Run(25000U);
+    for(idx = 0; idx < TOTAL_NUMBER_OF_SW_TIMERS; idx ++)
+    {
+        HOST_CHECK(!simTimers[idx].running);
+        HOST_CHECK(!SwTimerIsRunning(idx));
+    }
+    HOST_CHECK(runningTimers == 0U);
+    HOST_CHECK(simExpiries >= started - stopped);
+}
+
+/* The overflow is counted while the overflow interrupt is still pending */
+static void Test_TimeWrap(void)
+{
+    Sim_Init(0xFFFFFFF0U);
+    HOST_CHECK(SwTimerGetTime() == 0xFFFFFFF0U);
+
+    FakeTc_MaskInterrupts(true);
+    FakeTc_Advance(0x20U);
+    HOST_CHECK(sysTimeOvf == 0U);
+    HOST_CHECK(SwTimerGetTime() == 0x100000010ULL);
+    FakeTc_MaskInterrupts(false);
+    FakeTc_DeliverPending();
+    HOST_CHECK(sysTimeOvf == 1U);
+    HOST_CHECK(SwTimerGetTime() == 0x100000010ULL);
+
+    /* Timers on both sides of the counter wrap */
+    Sim_Init(0xFFFFF000U);
+    Sim_Start(0U, 0x800U, 0U);
+    Sim_Start(1U, 0x1800U, 0U);
+    Sim_Start(2U, 0x7FFFFFFFU, 0U);
+    Sim_Run(0x1000U);
+    HOST_CHECK(!simTimers[0].running && simTimers[1].running);
+    Sim_Run(0x1000U);
+    HOST_CHECK(!simTimers[1].running && simTimers[2].running);
+    HOST_CHECK(sysTimeOvf == 1U);
+    HOST_CHECK(SwTimerReadValue(2U) == 0x7FFFFFFFU - 0x2000U);
+    HOST_CHECK(SwTimerStop(2U) == LORAWAN_SUCCESS);
+}
+
+/* Overlapping expiry windows share one wakeup */
+static void Test_SlackBatching(void)
+{
+    uint32_t wakeups;
+    uint32_t saved;
+    uint32_t wakeupsAfter;
+    uint32_t savedAfter;
+
+    Sim_Init(0U);
+    SwTimerGetWakeupStats(&wakeups, &saved);
+    Sim_Start(0U, 10000U, 5000U);
+    Sim_Start(1U, 12000U, 0U);
+    Sim_Start(2U, 14000U, 1000U);
+    /* Armed for the earliest deadline, which the first two share */
+    HOST_CHECK(armedWakeTime == 12000U);
+    /* and a sleep lasts until then */
+    HOST_CHECK(SwTimerNextExpiryDuration() == 12000U);
+    Sim_Run(13000U);
+    HOST_CHECK(!simTimers[0].running && !simTimers[1].running && simTimers[2].running);
+    SwTimerGetWakeupStats(&wakeupsAfter, &savedAfter);
+    HOST_CHECK(wakeupsAfter - wakeups == 1U);
+    HOST_CHECK(savedAfter - saved == 1U);
+
+    /* Without slack every timer has its own wakeup */
+    Sim_Run(5000U);
+    HOST_CHECK(!simTimers[2].running);
+    Sim_Start(0U, 1000U, 0U);
+    Sim_Start(1U, 2000U, 0U);
+    Sim_Run(3000U);
+    SwTimerGetWakeupStats(&wakeups, &saved);
+    HOST_CHECK(wakeups - wakeupsAfter == 3U);
+    HOST_CHECK(saved == savedAfter);
+}
+
+int main(void)
+{
+    Test_HeapRandom();
+    Test_ExpiryRandom(0U);
+    Test_ExpiryRandom(0xFFFF0000U);
+    Test_TimeWrap();
+    Test_SlackBatching();
+
+    return HOST_TEST_RESULT();
+}